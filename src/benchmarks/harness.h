@@ -0,0 +1,49 @@
+/*
+ * btrc benchmark harness — force-included ahead of a benchmark's
+ * generated C (cc -include harness.h), so the program itself is unchanged.
+ *
+ * The program's main runs as bench_main_, timed by the main below, and
+ * every malloc/calloc/realloc it makes is counted. The result goes to
+ * stderr as "bench: <ns> ns <allocs> allocs"; the program's own stdout
+ * carries "ops: <n>".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static long long bench_allocs_ = 0;
+
+static void* bench_malloc_(size_t size) {
+    bench_allocs_++;
+    return malloc(size);
+}
+
+static void* bench_calloc_(size_t count, size_t size) {
+    bench_allocs_++;
+    return calloc(count, size);
+}
+
+static void* bench_realloc_(void* p, size_t size) {
+    bench_allocs_++;
+    return realloc(p, size);
+}
+
+static int bench_main_(void);
+
+int main(void) {
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    int rc = bench_main_();
+    timespec_get(&end, TIME_UTC);
+    long long ns = (long long)(end.tv_sec - start.tv_sec) * 1000000000LL
+                   + (end.tv_nsec - start.tv_nsec);
+    fflush(stdout);
+    fprintf(stderr, "bench: %lld ns %lld allocs\n", ns, bench_allocs_);
+    return rc;
+}
+
+#define malloc(size)        bench_malloc_(size)
+#define calloc(count, size) bench_calloc_(count, size)
+#define realloc(p, size)    bench_realloc_(p, size)
+#define main                bench_main_
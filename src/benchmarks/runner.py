@@ -0,0 +1,246 @@
+"""Benchmark runner for btrc.
+
+Runtime workloads: every bench_*.btrc in this directory is transpiled
+once, then built with each C compiler (gcc and clang by default, with
+-O2) and run several times under harness.h, which times its main and
+counts its allocations. A workload prints "ops: <n>"; the runner reports
+ns/op (the fastest run) and allocations/op, and checks every compiler
+printed the same output.
+
+Compiler throughput: the workloads and the tests in src/tests/algorithms
+are run through the lexer, parser, analyzer, IR generation (with the
+optimizer) and emitter, and each stage is reported in source lines per
+second, the stdlib included.
+
+Results are compared with baseline.json (recorded on the same machine by
+--save) and the run fails if any metric is worse by more than the
+threshold. Usage:
+
+    python3 src/benchmarks/runner.py [--save] [--runs N] [--threshold 0.15] [name ...]
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+from src.compiler.python.analyzer.analyzer import Analyzer  # noqa: E402
+from src.compiler.python.cache import get_stdlib_source_cached  # noqa: E402
+from src.compiler.python.ir.emitter import CEmitter  # noqa: E402
+from src.compiler.python.ir.gen.generator import IRGenerator  # noqa: E402
+from src.compiler.python.ir.optimizer import optimize  # noqa: E402
+from src.compiler.python.lexer import Lexer  # noqa: E402
+from src.compiler.python.parser.parser import Parser  # noqa: E402
+from src.compiler.python.sources import resolve_includes  # noqa: E402
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+BASELINE = os.path.join(BENCH_DIR, "baseline.json")
+HARNESS = os.path.join(BENCH_DIR, "harness.h")
+CORPUS_DIRS = [BENCH_DIR, os.path.join(BENCH_DIR, "..", "tests", "algorithms")]
+GPU_DIR = os.path.join(BENCH_DIR, "..", "stdlib", "gpu")
+
+BENCH_CCS = os.environ.get("BTRC_BENCH_CCS", "gcc clang").split()
+BENCH_CFLAGS = os.environ.get("BTRC_BENCH_CFLAGS", "-std=c11 -O2").split()
+
+STAGES = ("lexer", "parser", "analyzer", "ir", "emitter")
+
+
+def _source(path: str) -> str:
+    with open(path) as f:
+        source = resolve_includes(f.read(), path)
+    stdlib = get_stdlib_source_cached(source)
+    return stdlib + "\n" + source if stdlib else source
+
+
+def _transpile(source: str, name: str, times: dict[str, float] | None = None) -> str:
+    """C for `source`, adding each stage's seconds to `times`."""
+    stages = [
+        ("lexer", lambda _: Lexer(source, name).tokenize()),
+        ("parser", lambda tokens: Parser(tokens).parse()),
+        ("analyzer", lambda program: Analyzer().analyze(program)),
+        ("ir", lambda analyzed: optimize(IRGenerator(analyzed).generate())),
+        ("emitter", lambda module: CEmitter().emit(module)),
+    ]
+    value = None
+    for stage, run in stages:
+        start = time.perf_counter()
+        value = run(value)
+        if times is not None:
+            times[stage] = times.get(stage, 0.0) + time.perf_counter() - start
+        if stage == "analyzer" and value.errors:
+            raise SystemExit(f"{name}: analyzer errors: {value.errors}")
+    return value
+
+
+def _gpu_flags() -> list[str] | None:
+    """Link flags for the GPU runtime, or None if it isn't built."""
+    build = os.path.join(GPU_DIR, "build")
+    if not os.path.exists(os.path.join(build, "libbtrc_gpu.a")):
+        return None
+    flags = [f"-I{GPU_DIR}", f"-L{build}", "-lbtrc_gpu"]
+    if platform.system() == "Darwin":
+        for pkg, lib in (("wgpu-native", "-lwgpu_native"), ("glfw", "-lglfw")):
+            prefix = subprocess.check_output(["brew", "--prefix", pkg], text=True).strip()
+            flags += [f"-I{prefix}/include", f"-L{prefix}/lib", lib]
+        for framework in ("Metal", "QuartzCore", "Cocoa", "IOKit", "CoreVideo"):
+            flags += ["-framework", framework]
+        return flags
+    return flags + ["-lwgpu_native", "-lglfw", "-lpthread"]
+
+
+# --- Runtime workloads ---
+
+def _run_workload(name: str, c_source: str, cc: str, runs: int, tmp: str):
+    """(ns/op, allocs/op, stdout) for one workload built with `cc`,
+    or a reason it was skipped."""
+    c_path = os.path.join(tmp, f"{name}.c")
+    bin_path = os.path.join(tmp, f"{name}-{cc}")
+    with open(c_path, "w") as f:
+        f.write(c_source)
+    flags = [cc] + BENCH_CFLAGS + ["-include", HARNESS, c_path, "-o", bin_path, "-lm"]
+    if "pthread.h" in c_source:
+        flags.append("-lpthread")
+    if "btrc_gpu.h" in c_source:
+        gpu = _gpu_flags()
+        if gpu is None:
+            return "GPU runtime not built (run make gpu)"
+        flags += gpu
+    built = subprocess.run(flags, capture_output=True, text=True)
+    if built.returncode != 0:
+        raise SystemExit(f"{name}: {cc} failed:\n{built.stderr}")
+    best, allocs, stdout = None, 0, ""
+    for _ in range(runs):
+        result = subprocess.run([bin_path], capture_output=True, text=True, timeout=300)
+        if result.returncode != 0:
+            raise SystemExit(f"{name} ({cc}) exited with {result.returncode}:\n{result.stderr}")
+        report = [line.split() for line in result.stderr.splitlines() if line.startswith("bench:")]
+        ns, allocs = int(report[-1][1]), int(report[-1][3])
+        best = ns if best is None else min(best, ns)
+        stdout = result.stdout
+    ops = int(next(line.split()[1] for line in stdout.splitlines() if line.startswith("ops:")))
+    return best / ops, allocs / ops, stdout
+
+
+def run_runtime(names: list[str], runs: int) -> dict[str, dict[str, float]]:
+    results = {}
+    ccs = [cc for cc in BENCH_CCS if shutil.which(cc)]
+    for cc in BENCH_CCS:
+        if cc not in ccs:
+            print(f"  {cc}: not found, skipped")
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in names:
+            path = os.path.join(BENCH_DIR, f"bench_{name}.btrc")
+            c_source = _transpile(_source(path), os.path.basename(path))
+            outputs = {}
+            for cc in ccs:
+                measured = _run_workload(name, c_source, cc, runs, tmp)
+                if isinstance(measured, str):
+                    print(f"  {name}: {measured}, skipped")
+                    break
+                ns_per_op, allocs_per_op, outputs[cc] = measured
+                results[f"{cc}/{name}"] = {"ns_per_op": ns_per_op, "allocs_per_op": allocs_per_op}
+            if len(set(outputs.values())) > 1:
+                raise SystemExit(f"{name}: compilers disagree on the output: {outputs}")
+    return results
+
+
+# --- Compiler throughput ---
+
+def run_compiler(runs: int) -> dict[str, dict[str, float]]:
+    paths = sorted(
+        os.path.join(d, f) for d in CORPUS_DIRS for f in os.listdir(d)
+        if f.endswith(".btrc") and (f.startswith("bench_") or f.startswith("test_")))
+    # The GPU workload needs gpu.btrc; its include is resolved like any other
+    sources = [(_source(p), os.path.basename(p)) for p in paths]
+    lines = sum(s.count("\n") + 1 for s, _ in sources)
+    best = {}
+    for _ in range(runs):
+        times = {}
+        for source, name in sources:
+            _transpile(source, name, times)
+        for stage, seconds in times.items():
+            best[stage] = min(best.get(stage, seconds), seconds)
+    best["total"] = sum(best[s] for s in STAGES)
+    return {f"compiler/{stage}": {"lines_per_sec": lines / best[stage]}
+            for stage in (*STAGES, "total")}
+
+
+# --- Comparison ---
+
+# Metric -> whether a larger value is better
+_METRICS = {"ns_per_op": False, "allocs_per_op": False, "lines_per_sec": True}
+
+
+def compare(results, baseline, threshold: float) -> list[str]:
+    """Print every result next to its baseline; return the regressions."""
+    regressions = []
+    print(f"\n{'benchmark':<28} {'metric':<14} {'value':>12} {'baseline':>12} {'change':>8}")
+    for key, metrics in results.items():
+        for metric, value in metrics.items():
+            old = baseline.get(key, {}).get(metric)
+            change = ""
+            if old:
+                ratio = value / old - 1
+                change = f"{ratio:+.1%}"
+                worse = -ratio if _METRICS[metric] else ratio
+                if worse > threshold:
+                    change += " !"
+                    regressions.append(f"{key} {metric}: {old:.4g} -> {value:.4g} ({ratio:+.1%})")
+            old_text = f"{old:.4g}" if old is not None else "-"
+            print(f"{key:<28} {metric:<14} {value:>12.4g} {old_text:>12} {change:>8}")
+    return regressions
+
+
+def main():
+    argparser = argparse.ArgumentParser(description="Run the btrc benchmarks")
+    argparser.add_argument("names", nargs="*", help="Workloads to run (default: all)")
+    argparser.add_argument("--runs", type=int, default=5, help="Runs per workload; the fastest counts")
+    argparser.add_argument("--threshold", type=float, default=0.15,
+                           help="Fail when a metric is worse than the baseline by more than this")
+    argparser.add_argument("--save", action="store_true", help="Record the results as the baseline")
+    args = argparser.parse_args()
+
+    available = sorted(f[len("bench_"):-len(".btrc")] for f in os.listdir(BENCH_DIR)
+                       if f.startswith("bench_") and f.endswith(".btrc"))
+    names = args.names or available
+    unknown = set(names) - set(available) - {"compiler"}
+    if unknown:
+        raise SystemExit(f"unknown benchmark(s): {', '.join(sorted(unknown))}")
+
+    print("Running benchmarks...")
+    results = run_runtime([n for n in names if n != "compiler"], args.runs)
+    if not args.names or "compiler" in names:
+        results.update(run_compiler(min(args.runs, 3)))
+
+    baseline = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as f:
+            baseline = json.load(f)
+    if args.save:
+        baseline.update(results)
+        with open(BASELINE, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+    regressions = compare(results, baseline, args.threshold)
+    if args.save:
+        print(f"\nBaseline saved to {os.path.relpath(BASELINE)}")
+    elif not baseline:
+        print("\nNo baseline yet: record one on this machine with `make bench-baseline`.")
+    elif regressions:
+        print(f"\n{len(regressions)} regression(s) beyond {args.threshold:.0%}:")
+        for line in regressions:
+            print(f"  {line}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
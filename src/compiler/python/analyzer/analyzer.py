@@ -1,5 +1,6 @@
 """Analyzer assembly: combines all analysis mixins into the final Analyzer class."""
 
+from .arena import ArenaMixin
 from .core import (
     AnalyzedProgram,
     AnalyzerBase,
@@ -9,6 +10,7 @@ from .core import (
     Scope,
     SymbolInfo,
 )
+from .escape import EscapeMixin
 from .expressions import ExpressionsMixin
 from .functions import FunctionsMixin
 from .registration import RegistrationMixin
@@ -24,6 +26,8 @@ class Analyzer(
     ValidationMixin,
     ExpressionsMixin,
     StatementsMixin,
+    ArenaMixin,
+    EscapeMixin,
     FunctionsMixin,
     RegistrationMixin,
     AnalyzerBase,
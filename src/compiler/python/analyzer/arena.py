@@ -0,0 +1,227 @@
+"""Arena block analysis: keep arena-allocated values from outliving the block.
+
+Objects and strings created lexically inside `arena { ... }` are freed
+together when the block ends. This pass walks the block after normal
+analysis, tracking which of the block's own locals hold arena values,
+and checks every place such a value could leave:
+
+  - storing an arena object into a variable, field or element that lives
+    outside the block is an error; arena strings in the same positions
+    (and thrown strings) are copied out instead, recorded in
+    `arena_copies`;
+  - calls are followed through the escape summaries (escape.py): an arena
+    object may be passed to a function, method or constructor, or be the
+    receiver of a method, only if no callee can keep that parameter or
+    `self`. A callee that only stores the parameter into a field of its
+    receiver may also take it when the receiver is itself arena-owned.
+    Arena strings passed anywhere else are copied out; objects are an
+    error. The block's own collections (Vector, Map, ...) take anything;
+    calls to C functions and builtins are not checked;
+  - `return`, and `break`/`continue` aimed at a loop outside the block,
+    are errors, so the block always reaches its single release point;
+  - `delete`/`release` of an arena object is an error.
+
+  - capturing an arena value in a lambda or `spawn` is an error: the
+    lambda may run after the block has freed it.
+
+Since the summaries need every function analyzed, blocks are collected
+while analyzing and checked once the summaries exist. Following calls is
+in arena_calls.py; classifying values (which expressions may hold arena
+memory) is in arena_values.py.
+"""
+
+from __future__ import annotations
+
+from ..ast_nodes import (
+    ArenaStmt,
+    AssignExpr,
+    Block,
+    BreakStmt,
+    CallExpr,
+    CForStmt,
+    ContinueStmt,
+    DeleteStmt,
+    DoWhileStmt,
+    ElseBlock,
+    ElseIf,
+    ExprStmt,
+    FieldAccessExpr,
+    ForInitExpr,
+    ForInitVar,
+    ForInStmt,
+    Identifier,
+    IfStmt,
+    KeepStmt,
+    LambdaExpr,
+    NewExpr,
+    ParallelForStmt,
+    ReleaseStmt,
+    ReturnStmt,
+    SwitchStmt,
+    ThrowStmt,
+    TryCatchStmt,
+    VarDeclStmt,
+    WhileStmt,
+)
+from .arena_calls import ArenaCallsMixin
+from .arena_values import ArenaValuesMixin, _Local
+
+
+class ArenaMixin(ArenaCallsMixin, ArenaValuesMixin):
+
+    def _analyze_arena(self, stmt: ArenaStmt):
+        self._analyze_block(stmt.body)
+        self._arena_blocks[id(stmt)] = stmt
+
+    def _check_arenas(self, blocks):
+        """Check `blocks` against the escape summaries of `_analyze_escapes`."""
+        for stmt in blocks:
+            # Taint only grows, so a second pass sees values that reach a
+            # variable later in a loop body than the statement that reads it.
+            records: dict[int, _Local] = {}
+            for report in (False, True):
+                self._arena_state = (records, [], report)
+                self._arena_stmt(stmt.body, loops=0, breaks=0)
+        self._arena_state = None
+
+    # ---- Statements ----
+
+    def _arena_stmt(self, stmt, loops: int, breaks: int):
+        records, scopes, report = self._arena_state
+        if isinstance(stmt, Block):
+            scopes.append({})
+            for s in stmt.statements:
+                self._arena_stmt(s, loops, breaks)
+            scopes.pop()
+        elif isinstance(stmt, VarDeclStmt):
+            rec = records.setdefault(id(stmt), _Local())
+            if stmt.initializer is not None:
+                self._arena_expr(stmt.initializer)
+                rec.kind = rec.kind or self._arena_kind(stmt.initializer)
+                rec.fresh = rec.fresh or self._arena_fresh(stmt.initializer)
+            if scopes:
+                scopes[-1][stmt.name] = rec
+        elif isinstance(stmt, IfStmt):
+            self._arena_expr(stmt.condition)
+            self._arena_stmt(stmt.then_block, loops, breaks)
+            if isinstance(stmt.else_block, ElseIf):
+                self._arena_stmt(stmt.else_block.if_stmt, loops, breaks)
+            elif isinstance(stmt.else_block, ElseBlock):
+                self._arena_stmt(stmt.else_block.body, loops, breaks)
+        elif isinstance(stmt, (WhileStmt, DoWhileStmt)):
+            self._arena_expr(stmt.condition)
+            self._arena_stmt(stmt.body, loops + 1, breaks + 1)
+        elif isinstance(stmt, (ForInStmt, ParallelForStmt)):
+            self._arena_expr(stmt.iterable)
+            names = [stmt.var_name, getattr(stmt, 'var_name2', None)]
+            elem = self._arena_elem_kind(stmt.iterable)
+            scopes.append({n: _Local(kind=elem) for n in names if n})
+            self._arena_stmt(stmt.body, loops + 1, breaks + 1)
+            scopes.pop()
+        elif isinstance(stmt, CForStmt):
+            scopes.append({})
+            if isinstance(stmt.init, ForInitVar):
+                self._arena_stmt(stmt.init.var_decl, loops, breaks)
+            elif isinstance(stmt.init, ForInitExpr):
+                self._arena_expr(stmt.init.expression)
+            self._arena_expr(stmt.condition)
+            self._arena_expr(stmt.update)
+            self._arena_stmt(stmt.body, loops + 1, breaks + 1)
+            scopes.pop()
+        elif isinstance(stmt, SwitchStmt):
+            self._arena_expr(stmt.value)
+            for case in stmt.cases:
+                self._arena_expr(case.value)
+                scopes.append({})
+                for s in case.body:
+                    self._arena_stmt(s, loops, breaks + 1)
+                scopes.pop()
+        elif isinstance(stmt, TryCatchStmt):
+            self._arena_stmt(stmt.try_block, loops, breaks)
+            scopes.append({stmt.catch_var: _Local()})
+            self._arena_stmt(stmt.catch_block, loops, breaks)
+            scopes.pop()
+            if stmt.finally_block:
+                self._arena_stmt(stmt.finally_block, loops, breaks)
+        elif isinstance(stmt, ReturnStmt):
+            if report:
+                self._error("'return' cannot leave an arena block", stmt.line, stmt.col)
+        elif isinstance(stmt, BreakStmt):
+            if report and breaks == 0:
+                self._error("'break' cannot leave an arena block", stmt.line, stmt.col)
+        elif isinstance(stmt, ContinueStmt):
+            if report and loops == 0:
+                self._error("'continue' cannot leave an arena block", stmt.line, stmt.col)
+        elif isinstance(stmt, (DeleteStmt, ReleaseStmt)):
+            self._arena_expr(stmt.expr)
+            if report and self._arena_kind(stmt.expr) == "object":
+                what = "delete" if isinstance(stmt, DeleteStmt) else "release"
+                self._error(f"Cannot {what} an object allocated in an arena block; "
+                            f"it is freed when the block ends", stmt.line, stmt.col)
+        elif isinstance(stmt, ThrowStmt):
+            self._arena_expr(stmt.expr)
+            if self._arena_kind(stmt.expr) == "string":
+                self.arena_copies.add(id(stmt.expr))
+        elif isinstance(stmt, (ExprStmt, KeepStmt)):
+            self._arena_expr(stmt.expr)
+        # A nested ArenaStmt runs its own, stricter check
+
+    # ---- Expressions ----
+
+    def _arena_expr(self, expr):
+        if expr is None:
+            return
+        if isinstance(expr, LambdaExpr):
+            self._arena_captures(expr)
+            return  # lambda bodies are separate functions, outside the arena
+        if isinstance(expr, AssignExpr):
+            self._arena_assign(expr)
+        elif isinstance(expr, CallExpr) and isinstance(expr.callee, FieldAccessExpr):
+            self._arena_method_call(expr)
+        elif isinstance(expr, CallExpr) and isinstance(expr.callee, Identifier):
+            self._arena_function_call(expr)
+        elif isinstance(expr, NewExpr):
+            self._arena_constructor(expr.type, expr.args, expr.type.base)
+        for name in expr.__dataclass_fields__:
+            value = getattr(expr, name)
+            for child in (value if isinstance(value, list) else [value]):
+                if hasattr(child, '__dataclass_fields__') and hasattr(child, 'line'):
+                    self._arena_expr(child)
+                elif hasattr(child, 'expression'):
+                    self._arena_expr(child.expression)  # f-string part
+                elif hasattr(child, 'key'):
+                    self._arena_expr(child.key)  # map entry
+                    self._arena_expr(child.value)
+
+    def _arena_captures(self, expr: LambdaExpr):
+        if not self._arena_state[2]:
+            return
+        for capture in expr.captures:
+            owner = self._arena_lookup(capture.name)
+            if owner is not None and (owner.kind or owner.fresh):
+                self._error(f"Arena-allocated '{capture.name}' cannot be captured by a "
+                            f"lambda or spawn; it is freed when the block ends",
+                            expr.line, expr.col)
+
+    def _arena_assign(self, expr: AssignExpr):
+        report = self._arena_state[2]
+        kind = self._arena_kind(expr.value)
+        target_owner = self._arena_owner(expr.target)
+        if isinstance(expr.target, Identifier) and target_owner is not None:
+            # Assigning an arena-local variable: it now may hold arena values
+            if expr.op == "+=" and self._arena_is_string(expr.target):
+                target_owner.kind = "string"
+            elif kind:
+                target_owner.kind = kind
+            return
+        if target_owner is not None and (target_owner.kind == "object" or target_owner.fresh):
+            return  # field/element of an object that dies with the block
+        if expr.op == "+=" and self._arena_is_string(expr.target):
+            self.arena_copies.add(id(expr))  # concatenation result must outlive the block
+        elif kind == "string":
+            self.arena_copies.add(id(expr.value))
+        elif kind == "object" and report:
+            where = (f"'{expr.target.name}'" if isinstance(expr.target, Identifier)
+                     else "a location outside it")
+            self._error(f"Object allocated in an arena block cannot escape to {where}",
+                        expr.line, expr.col)
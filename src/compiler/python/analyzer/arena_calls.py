@@ -0,0 +1,99 @@
+"""Arena block analysis, continued: following calls that take arena values.
+
+A call is followed through the escape summaries (escape.py) of every
+function it can reach. An arena object may go to a parameter, or be the
+`self` of a method, that no callee keeps; a parameter a callee only
+stores into a field of its receiver may also take it when that receiver
+belongs to the block. Anything the summaries can't show to stay (calls
+through lambdas, generic classes) is an error for objects and a copy for
+strings.
+"""
+
+from __future__ import annotations
+
+from ..ast_nodes import CallExpr, Identifier
+from .arena_values import _VALUE_TYPES
+
+# Collections whose methods only store their arguments in the collection
+_CONTAINERS = {"Vector", "Array", "List", "Map", "Set"}
+
+
+class ArenaCallsMixin:
+
+    def _arena_method_call(self, expr: CallExpr):
+        receiver, method = expr.callee.obj, expr.callee.field
+        rtype = self.node_types.get(id(receiver))
+        if rtype and rtype.base in _VALUE_TYPES and rtype.pointer_depth == 0:
+            return
+        root = self._arena_root(receiver)
+        owner = self._arena_lookup(root.name) if isinstance(root, Identifier) else None
+        if owner is None and isinstance(root, Identifier) and root.name in self.class_table:
+            found = self.class_table[root.name].methods.get(method)
+            self._arena_args(expr.args, [found] if found else None, method, into=False)
+            return  # static method: treated like a free function
+        inside = (owner is not None and (owner.kind == "object" or owner.fresh)) \
+            or self._arena_kind(receiver) == "object"
+        if inside and rtype and rtype.base in _CONTAINERS:
+            return  # the block's own collection: it only holds its elements
+        decls = self._esc_methods(rtype, method)
+        if (self._arena_kind(receiver) == "object" and self._arena_state[2]
+                and self._arena_fate(decls, lambda d: "self") != "stays"):
+            self._error(f"Object allocated in an arena block cannot call '{method}', "
+                        f"which may keep it", receiver.line, receiver.col)
+        self._arena_args(expr.args, decls, method, into=inside)
+
+    def _arena_function_call(self, expr: CallExpr):
+        name = expr.callee.name
+        if name in self.class_table:
+            self._arena_constructor(self.node_types.get(id(expr)), expr.args, name)
+        elif name in self.function_table:
+            self._arena_args(expr.args, [self.function_table[name]], name, into=False)
+        else:
+            t = self.node_types.get(id(expr.callee))
+            if t is not None and t.base == "__fn_ptr":
+                self._arena_args(expr.args, None, name, into=False)  # through a lambda
+            # otherwise a builtin or C function
+
+    def _arena_constructor(self, t, args, name: str):
+        """The new instance belongs to the block, so it may keep its arguments."""
+        cls = self.class_table.get(name)
+        if cls is None or name in _CONTAINERS:
+            return
+        if cls.generic_params or (t is not None and t.generic_args):
+            decls = None
+        else:
+            decls = [cls.constructor] if cls.constructor else []
+        self._arena_args(args, decls, name, into=True)
+
+    def _arena_args(self, args, decls, callee: str, into: bool):
+        """Arena values passed to `decls`, which store them into the block's
+        own receiver at most when `into` is set."""
+        for i, arg in enumerate(args):
+            kind = self._arena_kind(arg)
+            if not kind:
+                continue
+            fate = self._arena_fate(decls, lambda d: d.params[i].name
+                                    if i < len(d.params) and not d.params[i].keep else None)
+            if fate == "stays" or (into and fate == "stored"):
+                continue
+            if kind == "string":
+                self.arena_copies.add(id(arg))
+            elif self._arena_state[2]:
+                self._error(f"Object allocated in an arena block cannot be passed to "
+                            f"'{callee}', which may keep it", arg.line, arg.col)
+
+    def _arena_fate(self, decls, name_of) -> str:
+        """"stays" if no callee in `decls` keeps the parameter `name_of` picks,
+        "stored" if some only store it into their receiver, else ""."""
+        if decls is None:
+            return ""
+        summary, fate = self._esc_summary, "stays"
+        for d in decls:
+            name = name_of(d)
+            if name is None or id(d) not in summary.known:
+                return ""
+            if (id(d), name) in summary.escaping:
+                if name not in summary.stored.get(id(d), ()):
+                    return ""
+                fate = "stored"
+        return fate
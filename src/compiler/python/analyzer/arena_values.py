@@ -0,0 +1,116 @@
+"""Arena block analysis, continued: which expressions may hold arena memory.
+
+A value is "object" or "string" when it may be (or read out of) an
+allocation owned by the arena block: a `new`, a constructor call, an
+f-string or concatenation, or a field, element or method result of one
+of the block's own arena-holding locals.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+from ..ast_nodes import (
+    AssignExpr,
+    BinaryExpr,
+    CallExpr,
+    CastExpr,
+    FieldAccessExpr,
+    FStringLiteral,
+    Identifier,
+    IndexExpr,
+    ListLiteral,
+    MapLiteral,
+    NewExpr,
+    TernaryExpr,
+)
+
+# Receivers whose methods never keep their arguments
+_VALUE_TYPES = {"string", "int", "float", "double", "long", "char", "bool", "short"}
+
+
+@dataclass
+class _Local:
+    """A variable declared inside the arena block."""
+    kind: str = ""       # "object" / "string" once it may hold an arena value
+    fresh: bool = False  # initialized with a new allocation owned by the block
+
+
+class ArenaValuesMixin:
+
+    def _arena_kind(self, expr) -> str:
+        """"object"/"string" if `expr` may evaluate to an arena allocation."""
+        if isinstance(expr, NewExpr):
+            return "object"
+        # Reading a field, element or method result of an arena-owned object
+        inner = expr.callee if isinstance(expr, CallExpr) else expr
+        if isinstance(inner, (FieldAccessExpr, IndexExpr)):
+            owner = self._arena_owner(inner.obj)
+            if owner is not None and (owner.kind == "object" or owner.fresh):
+                return self._arena_type_kind(self.node_types.get(id(expr)))
+        if isinstance(expr, CallExpr):
+            if isinstance(expr.callee, Identifier) and expr.callee.name in self.class_table:
+                return "object"
+            if isinstance(expr.callee, FieldAccessExpr) and self._arena_is_string(expr):
+                rtype = self.node_types.get(id(expr.callee.obj))
+                if rtype and rtype.base in _VALUE_TYPES:
+                    return "string"
+            return ""
+        if isinstance(expr, FStringLiteral):
+            return "string"
+        if isinstance(expr, BinaryExpr):
+            if (expr.op == "+" and self._arena_is_string(expr.left)
+                    and self._arena_is_string(expr.right)):
+                return "string"
+            return ""
+        if isinstance(expr, Identifier):
+            owner = self._arena_lookup(expr.name)
+            return owner.kind if owner else ""
+        if isinstance(expr, TernaryExpr):
+            return self._arena_kind(expr.true_expr) or self._arena_kind(expr.false_expr)
+        if isinstance(expr, CastExpr):
+            return self._arena_kind(expr.expr)
+        if isinstance(expr, AssignExpr):
+            return self._arena_kind(expr.value)
+        return ""
+
+    def _arena_type_kind(self, t) -> str:
+        if t is None:
+            return ""
+        if t.base == "string" and t.pointer_depth == 0:
+            return "string"
+        return "object" if t.base in self.class_table else ""
+
+    def _arena_elem_kind(self, iterable) -> str:
+        """Kind of the loop variable when iterating an arena-owned collection."""
+        owner = self._arena_owner(iterable)
+        if owner is None or not (owner.kind == "object" or owner.fresh):
+            return ""
+        t = self.node_types.get(id(iterable))
+        args = t.generic_args if t else None
+        return self._arena_type_kind(args[0]) if args else ""
+
+    def _arena_fresh(self, expr) -> bool:
+        if isinstance(expr, (NewExpr, ListLiteral, MapLiteral)):
+            return True
+        return (isinstance(expr, CallExpr) and isinstance(expr.callee, Identifier)
+                and expr.callee.name in self.class_table)
+
+    def _arena_is_string(self, expr) -> bool:
+        t = self.node_types.get(id(expr))
+        return t is not None and t.base == "string" and t.pointer_depth == 0
+
+    def _arena_root(self, expr):
+        while isinstance(expr, (FieldAccessExpr, IndexExpr)):
+            expr = expr.obj
+        return expr
+
+    def _arena_owner(self, target) -> _Local | None:
+        root = self._arena_root(target)
+        return self._arena_lookup(root.name) if isinstance(root, Identifier) else None
+
+    def _arena_lookup(self, name: str) -> _Local | None:
+        for scope in reversed(self._arena_state[1]):
+            if name in scope:
+                return scope[name]
+        return None
@@ -5,6 +5,7 @@ from __future__ import annotations
 from dataclasses import dataclass, field
 
 from ..ast_nodes import (
+    ArenaStmt,
     FieldDecl,
     FunctionDecl,
     MethodDecl,
@@ -80,6 +81,12 @@ class AnalyzedProgram:
     enum_table: dict[str, list[str]] = field(default_factory=dict)
     interface_table: dict[str, InterfaceInfo] = field(default_factory=dict)
     rich_enum_table: dict[str, RichEnumDecl] = field(default_factory=dict)
+    # Ids of string expressions inside arena blocks whose values must be
+    # copied out of the arena (see analyzer/arena.py)
+    arena_copies: set[int] = field(default_factory=set)
+    # Ids of VarDeclStmts whose new instance never escapes and is placed on
+    # the stack (see analyzer/escape.py)
+    stack_objects: set[int] = field(default_factory=set)
     errors: list[str] = field(default_factory=list)
     warnings: list[str] = field(default_factory=list)
 
@@ -103,16 +110,31 @@ class AnalyzerBase:
         self.enum_table: dict[str, list[str]] = {}
         self.interface_table: dict[str, InterfaceInfo] = {}
         self.rich_enum_table: dict[str, RichEnumDecl] = {}
+        self.arena_copies: set[int] = set()
+        self._arena_state = None
+        self._arena_blocks: dict[int, ArenaStmt] = {}  # checked after the escape pass
+        self.stack_objects: set[int] = set()
+        self._esc_state = None
+        self._esc_summary = None
 
     def analyze(self, program: Program) -> AnalyzedProgram:
+        self._prepare(program)
+        for decl in program.declarations:
+            self._analyze_decl(decl)
+        self._analyze_escapes(program)
+        self._check_arenas(self._arena_blocks.values())
+        return self._result(program)
+
+    def _prepare(self, program: Program):
+        """Build the tables: everything declarations see of each other."""
         self._register_declarations(program)
         self._resolve_interface_parents(program)
         self._validate_inheritance(program)
         self._validate_interfaces(program)
         self._validate_overrides(program)
         self._compute_cyclable_flags()
-        for decl in program.declarations:
-            self._analyze_decl(decl)
+
+    def _result(self, program: Program) -> AnalyzedProgram:
         return AnalyzedProgram(
             program=program,
             generic_instances=self.generic_instances,
@@ -122,6 +144,8 @@ class AnalyzerBase:
             enum_table=self.enum_table,
             interface_table=self.interface_table,
             rich_enum_table=self.rich_enum_table,
+            arena_copies=self.arena_copies,
+            stack_objects=self.stack_objects,
             errors=self.errors,
             warnings=self.warnings,
         )
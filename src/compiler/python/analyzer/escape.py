@@ -0,0 +1,263 @@
+"""Escape analysis: find class instances that can live on the stack.
+
+A local initialized with `C(...)` or `new C(...)` is stack-allocated
+(recorded in `stack_objects`, lowered by ir/gen/stack_objects.py) when
+the object provably never outlives the function that creates it: it is
+not returned, thrown, assigned to a variable, field or element, captured
+by a lambda or `spawn`, used inside a `parallel for`, or handed to
+`keep`, `delete` or `release`. Calling its methods or passing it as an
+argument is allowed when the callee's `self` or parameter doesn't escape
+either; those per-parameter facts are computed for every non-generic
+function and method together, repeating until nothing changes. Anything
+the pass can't follow (calls through lambdas or interfaces, generic and
+C functions, properties) counts as an escape. String parameters get
+summaries too, and all of them are kept in `_esc_summary` for the arena
+check (arena.py), which follows calls through them.
+
+Only classes that own nothing qualify, the same rule arena allocation
+uses: no destructor, no class-typed fields, not generic. A stack instance
+is never destroyed, so there must be nothing for its destroy to release.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from ..ast_nodes import (
+    ArenaStmt,
+    AssignExpr,
+    BinaryExpr,
+    Block,
+    CallExpr,
+    CForStmt,
+    ClassDecl,
+    DeleteStmt,
+    DoWhileStmt,
+    ElseBlock,
+    ElseIf,
+    ExprStmt,
+    FieldAccessExpr,
+    FStringLiteral,
+    ForInitExpr,
+    ForInitVar,
+    ForInStmt,
+    FunctionDecl,
+    Identifier,
+    IfStmt,
+    KeepStmt,
+    LambdaExpr,
+    MethodDecl,
+    ParallelForStmt,
+    ReleaseStmt,
+    ReturnStmt,
+    SelfExpr,
+    SwitchStmt,
+    ThrowStmt,
+    TryCatchStmt,
+    UnaryExpr,
+    VarDeclStmt,
+    WhileStmt,
+)
+from .escape_calls import EscapeCallsMixin
+from .escape_decls import EscapeDeclsMixin
+
+@dataclass
+class _EscapeState:
+    # (id(function), name) for every parameter, `self` or local that may escape
+    escaping: set[tuple[int, str]] = field(default_factory=set)
+    known: set[int] = field(default_factory=set)  # functions with a body to follow
+    # id(function) -> its parameters (or `self`) whose only escape is being
+    # stored into a field of `self`; arena.py lets those take the block's values
+    stored: dict[int, set[str]] = field(default_factory=dict)
+    # Per function being walked
+    cls: object = None
+    tracked: set[str] = field(default_factory=set)
+    escaped: set[str] = field(default_factory=set)
+    into_self: set[str] = field(default_factory=set)
+
+
+class EscapeMixin(EscapeCallsMixin, EscapeDeclsMixin):
+
+    def _analyze_escapes(self, program):
+        bodies = []
+        for decl in program.declarations:
+            if isinstance(decl, FunctionDecl) and decl.body and not decl.is_gpu:
+                bodies.append((decl, None))
+            elif isinstance(decl, ClassDecl) and not decl.generic_params:
+                cls = self.class_table.get(decl.name)
+                bodies += [(m, cls) for m in decl.members
+                           if isinstance(m, MethodDecl) and m.body and not m.is_gpu]
+        state = self._esc_state = _EscapeState(known={id(decl) for decl, _ in bodies})
+        # Declarations don't change from one round to the next
+        scopes = [(decl, cls, self._esc_scope(decl)) for decl, cls in bodies]
+        # Escapes only ever get added, so this settles
+        changed = True
+        while changed:
+            changed = False
+            for decl, cls, scope in scopes:
+                state.cls, state.tracked = cls, set()
+                state.escaped, state.into_self = set(), set()
+                for name in self._esc_function(decl, *scope):
+                    if (id(decl), name) not in state.escaping:
+                        state.escaping.add((id(decl), name))
+                        changed = True
+        for decl, _, (_, candidates) in scopes:
+            for stmt in candidates:
+                ctor = self.class_table[stmt.type.base].constructor
+                if (id(decl), stmt.name) not in state.escaping and (
+                        ctor is None or self._esc_self_stays(ctor)):
+                    self.stack_objects.add(id(stmt))
+        self._esc_summary, self._esc_state = state, None
+
+    def _esc_scope(self, decl) -> tuple[set[str], list[VarDeclStmt]]:
+        """Names `decl` declares more than once, and its candidate locals."""
+        counts: dict[str, int] = {}
+        for name in [p.name for p in decl.params] + self._esc_declared(decl.body):
+            counts[name] = counts.get(name, 0) + 1
+        return {n for n, c in counts.items() if c > 1}, self._esc_candidates(decl.body)
+
+    def _esc_function(self, decl, repeated: set[str], candidates: list) -> set[str]:
+        """Names of `decl`'s parameters, `self` and candidate locals that escape."""
+        state = self._esc_state
+        tracked, escaped = state.tracked, state.escaped
+        tracked.update(p.name for p in decl.params
+                       if self._esc_class_type(p.type) or self._esc_string_type(p.type))
+        tracked.update(s.name for s in candidates)
+        if self._esc_state.cls is not None and decl.access != "class":
+            tracked.add("self")
+        # A name declared twice can't be told apart; give up on it
+        escaped.update(tracked & repeated)
+        self._esc_stmt(decl.body)
+        state.stored[id(decl)] = state.into_self - escaped
+        return escaped | state.into_self
+
+    # ---- Statements ----
+
+    def _esc_stmt(self, stmt):
+        if stmt is None:
+            return
+        if isinstance(stmt, Block):
+            for s in stmt.statements:
+                self._esc_stmt(s)
+        elif isinstance(stmt, VarDeclStmt):
+            self._esc_expr(stmt.initializer)
+        elif isinstance(stmt, ExprStmt):
+            if self._esc_name(stmt.expr) is None:
+                self._esc_expr(stmt.expr)
+        elif isinstance(stmt, IfStmt):
+            self._esc_condition(stmt.condition)
+            self._esc_stmt(stmt.then_block)
+            if isinstance(stmt.else_block, ElseIf):
+                self._esc_stmt(stmt.else_block.if_stmt)
+            elif isinstance(stmt.else_block, ElseBlock):
+                self._esc_stmt(stmt.else_block.body)
+        elif isinstance(stmt, (WhileStmt, DoWhileStmt)):
+            self._esc_condition(stmt.condition)
+            self._esc_stmt(stmt.body)
+        elif isinstance(stmt, ForInStmt):
+            self._esc_expr(stmt.iterable)
+            self._esc_stmt(stmt.body)
+        elif isinstance(stmt, CForStmt):
+            if isinstance(stmt.init, ForInitVar):
+                self._esc_stmt(stmt.init.var_decl)
+            elif isinstance(stmt.init, ForInitExpr):
+                self._esc_expr(stmt.init.expression)
+            self._esc_condition(stmt.condition)
+            self._esc_expr(stmt.update)
+            self._esc_stmt(stmt.body)
+        elif isinstance(stmt, ParallelForStmt):
+            self._esc_expr(stmt.iterable)
+            self._esc_capture(stmt.body)  # the body runs on worker threads
+        elif isinstance(stmt, SwitchStmt):
+            self._esc_expr(stmt.value)
+            for case in stmt.cases:
+                for s in case.body:
+                    self._esc_stmt(s)
+        elif isinstance(stmt, TryCatchStmt):
+            self._esc_stmt(stmt.try_block)
+            self._esc_stmt(stmt.catch_block)
+            self._esc_stmt(stmt.finally_block)
+        elif isinstance(stmt, ArenaStmt):
+            self._esc_stmt(stmt.body)
+        elif isinstance(stmt, (ReturnStmt, ThrowStmt)):
+            self._esc_expr(getattr(stmt, 'value', None) or getattr(stmt, 'expr', None))
+        elif isinstance(stmt, (DeleteStmt, ReleaseStmt, KeepStmt)):
+            self._esc_expr(stmt.expr)
+
+    def _esc_condition(self, cond):
+        if self._esc_name(cond) is None:  # `if (obj)` only tests for null
+            self._esc_expr(cond)
+
+    # ---- Expressions ----
+
+    def _esc_name(self, expr) -> str | None:
+        """The tracked name `expr` refers to, if it is a bare tracked variable."""
+        if isinstance(expr, SelfExpr):
+            name = "self"
+        elif isinstance(expr, Identifier):
+            name = expr.name
+        else:
+            return None
+        return name if name in self._esc_state.tracked else None
+
+    def _esc_escape(self, name: str):
+        self._esc_state.escaped.add(name)
+
+    def _esc_expr(self, expr):
+        """Walk `expr`, whose value may be kept: tracked names reached here escape."""
+        if expr is None:
+            return
+        name = self._esc_name(expr)
+        if name is not None:
+            self._esc_escape(name)
+        elif isinstance(expr, LambdaExpr):
+            self._esc_capture(expr)
+        elif isinstance(expr, FieldAccessExpr):
+            self._esc_field_owner(expr)
+        elif isinstance(expr, CallExpr):
+            self._esc_call(expr)
+        elif isinstance(expr, AssignExpr):
+            if isinstance(expr.target, FieldAccessExpr):
+                self._esc_field_owner(expr.target)
+                stored = self._esc_name(expr.value)
+                if stored is not None and isinstance(expr.target.obj, SelfExpr):
+                    self._esc_state.into_self.add(stored)
+                    return
+            else:
+                self._esc_expr(expr.target)  # rebinding a tracked variable counts too
+            self._esc_expr(expr.value)
+        elif isinstance(expr, BinaryExpr):
+            self._esc_binary(expr)
+        elif isinstance(expr, FStringLiteral):
+            for part in expr.parts:  # formatting copies string parts
+                value = getattr(part, 'expression', None)
+                if not (self._esc_name(value) and self._esc_string(value)):
+                    self._esc_expr(value)
+        elif isinstance(expr, UnaryExpr) and expr.op in ("!", "-"):
+            operand = self._esc_name(expr.operand)
+            if operand is None:
+                self._esc_expr(expr.operand)
+            elif expr.op == "-":
+                self._esc_receiver(expr.operand, "__neg__")
+        else:
+            for child in self._esc_children(expr):
+                self._esc_expr(child)
+
+    def _esc_children(self, expr):
+        for name in expr.__dataclass_fields__:
+            value = getattr(expr, name)
+            for child in (value if isinstance(value, list) else [value]):
+                if hasattr(child, '__dataclass_fields__') and hasattr(child, 'line'):
+                    yield child
+                elif hasattr(child, 'expression'):
+                    yield child.expression  # f-string part
+                elif hasattr(child, 'key'):
+                    yield child.key  # map entry
+                    yield child.value
+
+    def _esc_capture(self, node):
+        """Everything tracked that `node` mentions escapes (lambda and thread bodies)."""
+        for n in self._esc_nodes(node, into_lambdas=True):
+            name = self._esc_name(n)
+            if name is not None:
+                self._esc_escape(name)
@@ -0,0 +1,127 @@
+"""Escape analysis, continued: what calls and operators do with their operands.
+
+A tracked object used as a receiver, operand or argument stays put only
+if every function the call can reach (the static callee and its
+overrides in subclasses) leaves that `self` or parameter alone according
+to the summaries computed so far. Calls the analysis can't resolve to a
+body count as escapes.
+"""
+
+from __future__ import annotations
+
+from ..ast_nodes import BinaryExpr, CallExpr, FieldAccessExpr, Identifier, SuperExpr
+
+# Operators lowered to calls of the left operand's methods (ir/gen/operators.py)
+_OPERATOR_METHODS = {"+": "__add__", "-": "__sub__", "*": "__mul__", "/": "__div__",
+                     "%": "__mod__", "==": "__eq__", "!=": "__ne__", "<": "__lt__",
+                     ">": "__gt__", "<=": "__le__", ">=": "__ge__"}
+# Operators whose result is a plain value even for object operands
+_VALUE_OPS = {"==", "!=", "<", ">", "<=", ">=", "&&", "||"}
+
+
+class EscapeCallsMixin:
+
+    def _esc_field_owner(self, expr: FieldAccessExpr):
+        """`obj.field` reads or writes through `obj` without keeping it."""
+        name = self._esc_name(expr.obj)
+        if name is None:
+            self._esc_expr(expr.obj)
+            return
+        t = self.node_types.get(id(expr.obj))
+        cls = self.class_table.get(t.base) if t else None
+        if cls is None or expr.field in cls.properties:
+            self._esc_escape(name)  # property accessors are not followed
+
+    def _esc_binary(self, expr: BinaryExpr):
+        magic = _OPERATOR_METHODS.get(expr.op)
+        t = self.node_types.get(id(expr.left))
+        cls = self.class_table.get(t.base) if t else None
+        if cls is not None and magic in cls.methods:
+            self._esc_receiver(expr.left, magic)
+            self._esc_args([expr.right], self._esc_methods(t, magic))
+            return
+        # Comparisons give plain values, concatenation copies its strings
+        keeps = expr.op not in _VALUE_OPS and not (expr.op == "+" and self._esc_string(expr))
+        for operand in (expr.left, expr.right):
+            if keeps or self._esc_name(operand) is None:
+                self._esc_expr(operand)
+
+    def _esc_call(self, expr: CallExpr):
+        callee = expr.callee
+        decls = None
+        if isinstance(callee, FieldAccessExpr):
+            obj = callee.obj
+            if isinstance(obj, Identifier) and obj.name in self.class_table \
+                    and self._esc_name(obj) is None:
+                method = self.class_table[obj.name].methods.get(callee.field)
+                decls = [method] if method else None  # static method
+            elif isinstance(obj, SuperExpr):
+                cls = self._esc_state.cls
+                parent = self.class_table.get(cls.parent) if cls and cls.parent else None
+                method = parent.methods.get(callee.field) if parent else None
+                decls = [method] if method else None
+                if "self" in self._esc_state.tracked and not (
+                        decls and all(self._esc_self_stays(d) for d in decls)):
+                    self._esc_escape("self")
+            else:
+                decls = self._esc_receiver(obj, callee.field)
+        elif isinstance(callee, Identifier) and self._esc_name(callee) is None:
+            cls = self.class_table.get(callee.name)
+            if cls is not None:
+                if not cls.generic_params:
+                    decls = [cls.constructor] if cls.constructor else []
+            elif callee.name in self.function_table:
+                decls = [self.function_table[callee.name]]
+        else:
+            self._esc_expr(callee)
+        self._esc_args(expr.args, decls)
+
+    def _esc_receiver(self, obj, method: str):
+        """Check `obj` used as the receiver of `method`; return the possible callees."""
+        decls = self._esc_methods(self.node_types.get(id(obj)), method)
+        name = self._esc_name(obj)
+        if name is None:
+            self._esc_expr(obj)
+        elif self._esc_string(obj):
+            pass  # string methods return new strings or plain values
+        elif not (decls and all(self._esc_self_stays(d) for d in decls)):
+            self._esc_escape(name)
+        return decls
+
+    def _esc_args(self, args, decls):
+        """Arguments escape unless every possible callee leaves that parameter alone."""
+        escaping, known = self._esc_state.escaping, self._esc_state.known
+        for i, arg in enumerate(args):
+            name = self._esc_name(arg)
+            if name is None:
+                self._esc_expr(arg)
+                continue
+            if decls is None or any(
+                    id(d) not in known or i >= len(d.params) or d.params[i].keep
+                    or (id(d), d.params[i].name) in escaping for d in decls):
+                self._esc_escape(name)
+
+    def _esc_self_stays(self, decl) -> bool:
+        state = self._esc_state
+        return id(decl) in state.known and (id(decl), "self") not in state.escaping
+
+    def _esc_methods(self, t, method: str):
+        """`method` of static type `t` and every override below it, or None."""
+        if t is None or t.generic_args:
+            return None
+        cls = self.class_table.get(t.base)
+        if cls is None or cls.generic_params or method not in cls.methods:
+            return None
+        decls = [cls.methods[method]]
+        for other in self.class_table.values():
+            found = other.methods.get(method)
+            if found is not None and found not in decls and self._esc_derives(other, t.base):
+                decls.append(found)
+        return decls
+
+    def _esc_derives(self, cls, base: str) -> bool:
+        while cls is not None and cls.parent:
+            if cls.parent == base:
+                return True
+            cls = self.class_table.get(cls.parent)
+        return False
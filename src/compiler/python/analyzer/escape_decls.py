@@ -0,0 +1,81 @@
+"""Escape analysis, continued: the names a function declares and tracks.
+
+Tracked names are the parameters of class or string type, `self`, and
+the locals that are candidates for stack allocation: initialized with a
+new instance of a class that owns nothing.
+"""
+
+from __future__ import annotations
+
+from ..ast_nodes import (
+    CallExpr,
+    ForInStmt,
+    Identifier,
+    LambdaExpr,
+    NewExpr,
+    ParallelForStmt,
+    TryCatchStmt,
+    VarDeclStmt,
+)
+
+
+class EscapeDeclsMixin:
+
+    def _esc_candidates(self, body) -> list[VarDeclStmt]:
+        """Locals initialized with a new instance of a class that may go on the stack."""
+        found = []
+        for node in self._esc_nodes(body, into_lambdas=False):
+            if not isinstance(node, VarDeclStmt) or node.type is None:
+                continue
+            init = node.initializer
+            if isinstance(init, NewExpr) and not init.type.generic_args:
+                created = init.type.base
+            elif isinstance(init, CallExpr) and isinstance(init.callee, Identifier):
+                created = init.callee.name
+            else:
+                continue
+            if (created == node.type.base and not node.type.generic_args
+                    and self._esc_stack_class(created)):
+                found.append(node)
+        return found
+
+    def _esc_stack_class(self, name: str) -> bool:
+        cls = self.class_table.get(name)
+        if cls is None or cls.generic_params or cls.is_abstract or "__del__" in cls.methods:
+            return False
+        return not any(fd.type and fd.type.base in self.class_table
+                       for fd in cls.fields.values())
+
+    def _esc_class_type(self, t) -> bool:
+        return (t is not None and t.base in self.class_table and not t.generic_args
+                and t.pointer_depth <= 1)
+
+    def _esc_string_type(self, t) -> bool:
+        return t is not None and t.base == "string" and t.pointer_depth == 0
+
+    def _esc_string(self, expr) -> bool:
+        return self._esc_string_type(self.node_types.get(id(expr)))
+
+    def _esc_declared(self, body) -> list[str]:
+        names = []
+        for node in self._esc_nodes(body, into_lambdas=True):
+            if isinstance(node, VarDeclStmt):
+                names.append(node.name)
+            elif isinstance(node, (ForInStmt, ParallelForStmt)):
+                names += [n for n in (node.var_name, getattr(node, 'var_name2', None)) if n]
+            elif isinstance(node, TryCatchStmt):
+                names.append(node.catch_var)
+            elif isinstance(node, LambdaExpr):
+                names += [p.name for p in node.params]
+        return names
+
+    def _esc_nodes(self, node, into_lambdas: bool):
+        """Every AST node under `node`, optionally skipping lambda bodies."""
+        if isinstance(node, LambdaExpr) and not into_lambdas:
+            return
+        if hasattr(node, '__dataclass_fields__'):
+            yield node
+            for name in node.__dataclass_fields__:
+                value = getattr(node, name)
+                for child in (value if isinstance(value, list) else [value]):
+                    yield from self._esc_nodes(child, into_lambdas)
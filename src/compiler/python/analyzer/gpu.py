@@ -1,8 +1,9 @@
 """GPU function validation for @gpu-annotated functions.
 
 Validates that @gpu functions only use the WGSL-compatible subset of btrc:
-- Parameters must be scalar primitives or typed arrays
-- Return type must be void or typed array
+- Parameters must be scalar primitives, typed arrays, Vector<T>/Array<T>,
+  or GpuArray<T> (see gpu_types.py)
+- Return type must be void, a typed array, or GpuArray<T>
 - Body must use only arithmetic, comparisons, if/else, for, while, var decls
 - Rejects: strings, classes, collections, print, new/delete, lambdas, try/catch
 """
@@ -51,19 +52,24 @@ from ..ast_nodes import (
     WhileStmt,
 )
 
+from .gpu_types import GPU_ARRAY_ELEM_TYPES, is_gpu_resident_type, validate_gpu_type
+
 if TYPE_CHECKING:
     from .core import AnalyzerBase
 
-# Types allowed in @gpu functions
-_GPU_SCALAR_TYPES = {"int", "float", "bool"}
-_GPU_ARRAY_ELEM_TYPES = {"int", "float"}
-
-# Built-in GPU functions
+# Built-in GPU functions (all take no arguments)
 GPU_BUILTINS = {
-    "gpu_id": TypeExpr(base="int", generic_args=[], pointer_depth=0,
-                       is_array=False, array_size=None, line=0, col=0),
+    name: TypeExpr(base=ret, generic_args=[], pointer_depth=0,
+                   is_array=False, array_size=None, line=0, col=0)
+    for name, ret in (("gpu_id", "int"), ("gpu_id_x", "int"),
+                      ("gpu_id_y", "int"), ("gpu_id_z", "int"),
+                      ("gpu_local_id", "int"), ("gpu_group_id", "int"),
+                      ("gpu_barrier", "void"))
 }
 
+# `T[] tile = gpu_shared(N);` declares workgroup-shared memory
+GPU_SHARED = "gpu_shared"
+
 
 def validate_gpu_function(analyzer: AnalyzerBase, func) -> None:
     """Validate that a @gpu function uses only WGSL-compatible constructs."""
@@ -72,14 +78,18 @@ def validate_gpu_function(analyzer: AnalyzerBase, func) -> None:
 
     # Validate parameters
     for param in func.params:
-        _validate_gpu_type(analyzer, param.type, f"parameter '{param.name}'",
-                           name, line, col, allow_array=True)
+        validate_gpu_type(analyzer, param.type, f"parameter '{param.name}'",
+                          name, line, col, allow_array=True,
+                          allow_collection=True)
 
     # Validate return type
     ret = func.return_type
     if ret and ret.base != "void":
-        if ret.is_array:
-            if ret.base not in _GPU_ARRAY_ELEM_TYPES:
+        if is_gpu_resident_type(ret):
+            validate_gpu_type(analyzer, ret, "return type", name, line, col,
+                              allow_array=True)
+        elif ret.is_array:
+            if ret.base not in GPU_ARRAY_ELEM_TYPES:
                 analyzer._error(
                     f"@gpu function '{name}' return type must be void or a "
                     f"typed array (int[] or float[]), got '{ret.base}[]'",
@@ -89,56 +99,15 @@ def validate_gpu_function(analyzer: AnalyzerBase, func) -> None:
                 f"@gpu function '{name}' must return void or a typed array, "
                 f"got '{ret.base}'", line, col)
 
+    if getattr(func, 'gpu_workgroup', None):
+        from .gpu_workgroup import validate_gpu_workgroup
+        validate_gpu_workgroup(analyzer, func)
+
     # Validate body
     if func.body:
         _validate_gpu_block(analyzer, func.body, name)
 
 
-def _validate_gpu_type(analyzer, type_expr: TypeExpr, context: str,
-                       func_name: str, line: int, col: int,
-                       allow_array: bool = False) -> None:
-    """Validate a type is GPU-compatible."""
-    if type_expr is None:
-        return
-
-    if type_expr.is_nullable:
-        analyzer._error(
-            f"@gpu function '{func_name}': nullable types not allowed "
-            f"in {context}", line, col)
-        return
-
-    if type_expr.pointer_depth > 0:
-        analyzer._error(
-            f"@gpu function '{func_name}': pointer types not allowed "
-            f"in {context}", line, col)
-        return
-
-    if type_expr.is_array and allow_array:
-        if type_expr.base not in _GPU_ARRAY_ELEM_TYPES:
-            analyzer._error(
-                f"@gpu function '{func_name}': array element type must be "
-                f"int or float in {context}, got '{type_expr.base}'",
-                line, col)
-        return
-
-    if type_expr.is_array and not allow_array:
-        analyzer._error(
-            f"@gpu function '{func_name}': array types not allowed "
-            f"in {context}", line, col)
-        return
-
-    if type_expr.generic_args:
-        analyzer._error(
-            f"@gpu function '{func_name}': generic types not allowed "
-            f"in {context}", line, col)
-        return
-
-    if type_expr.base not in _GPU_SCALAR_TYPES:
-        analyzer._error(
-            f"@gpu function '{func_name}': type '{type_expr.base}' not "
-            f"allowed in {context} (use int, float, or bool)", line, col)
-
-
 def _validate_gpu_block(analyzer, block: Block, func_name: str) -> None:
     """Validate all statements in a block are GPU-compatible."""
     if block is None:
@@ -152,10 +121,14 @@ def _validate_gpu_stmt(analyzer, stmt, func_name: str) -> None:
     line = getattr(stmt, 'line', 0)
     col = getattr(stmt, 'col', 0)
 
-    if isinstance(stmt, VarDeclStmt):
+    if isinstance(stmt, VarDeclStmt) and _is_shared_call(stmt.initializer):
+        from .gpu_workgroup import validate_gpu_shared
+        validate_gpu_shared(analyzer, stmt, func_name)
+
+    elif isinstance(stmt, VarDeclStmt):
         if stmt.type:
-            _validate_gpu_type(analyzer, stmt.type, f"variable '{stmt.name}'",
-                               func_name, line, col, allow_array=True)
+            validate_gpu_type(analyzer, stmt.type, f"variable '{stmt.name}'",
+                              func_name, line, col, allow_array=True)
         if stmt.initializer:
             _validate_gpu_expr(analyzer, stmt.initializer, func_name)
 
@@ -235,7 +208,12 @@ def _validate_gpu_expr(analyzer, expr, func_name: str) -> None:
                     f"in GPU functions", line, col)
                 return
             if name in GPU_BUILTINS:
-                return  # gpu_id() is allowed
+                return  # gpu_id() and friends are allowed
+            if name == GPU_SHARED:
+                analyzer._error(
+                    f"@gpu function '{func_name}': {GPU_SHARED}() can only "
+                    f"initialize an array variable", line, col)
+                return
         else:
             _validate_gpu_expr(analyzer, expr.callee, func_name)
         for arg in expr.args:
@@ -277,3 +255,8 @@ def _validate_gpu_expr(analyzer, expr, func_name: str) -> None:
 
     else:
         pass  # allow unknown exprs through (analyzer will catch type errors)
+
+
+def _is_shared_call(expr) -> bool:
+    return (isinstance(expr, CallExpr) and isinstance(expr.callee, Identifier)
+            and expr.callee.name == GPU_SHARED)
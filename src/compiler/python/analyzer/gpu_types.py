@@ -0,0 +1,126 @@
+"""Types accepted by @gpu functions and their call sites.
+
+Scalars (int, float, bool) become uniforms. Buffers come from typed
+arrays (`float[]`), host collections (`Vector<T>` / `Array<T>`, uploaded
+straight from ->data and sized by ->len) and device-resident
+`GpuArray<T>` (bound in place).
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..ast_nodes import Identifier, TypeExpr
+
+if TYPE_CHECKING:
+    from .core import AnalyzerBase
+
+_GPU_SCALAR_TYPES = {"int", "float", "bool"}
+GPU_ARRAY_ELEM_TYPES = {"int", "float"}
+
+# Device-resident array class from gpu.btrc (bound without host copies)
+GPU_RESIDENT_CLASS = "GpuArray"
+
+# Host collections with `T* data` and `int len` fields
+GPU_COLLECTION_CLASSES = ("Vector", "Array")
+
+
+def is_gpu_resident_type(type_expr: TypeExpr | None) -> bool:
+    """True for GpuArray<T> (with or without the class-pointer upgrade)."""
+    return (type_expr is not None and type_expr.base == GPU_RESIDENT_CLASS
+            and len(type_expr.generic_args) == 1 and not type_expr.is_array)
+
+
+def validate_gpu_type(analyzer, type_expr: TypeExpr, context: str,
+                      func_name: str, line: int, col: int,
+                      allow_array: bool = False,
+                      allow_collection: bool = False) -> None:
+    """Validate a type is GPU-compatible."""
+    if type_expr is None:
+        return
+
+    if type_expr.is_nullable:
+        analyzer._error(
+            f"@gpu function '{func_name}': nullable types not allowed "
+            f"in {context}", line, col)
+        return
+
+    if ((is_gpu_resident_type(type_expr) and allow_array)
+            or (is_gpu_collection_type(type_expr) and allow_collection)):
+        elem = type_expr.generic_args[0]
+        if elem.base not in GPU_ARRAY_ELEM_TYPES or elem.generic_args:
+            analyzer._error(
+                f"@gpu function '{func_name}': {type_expr.base} element type "
+                f"must be int or float in {context}, got '{elem.base}'",
+                line, col)
+        return
+
+    if type_expr.pointer_depth > 0:
+        analyzer._error(
+            f"@gpu function '{func_name}': pointer types not allowed "
+            f"in {context}", line, col)
+        return
+
+    if type_expr.is_array and allow_array:
+        if type_expr.base not in GPU_ARRAY_ELEM_TYPES:
+            analyzer._error(
+                f"@gpu function '{func_name}': array element type must be "
+                f"int or float in {context}, got '{type_expr.base}'",
+                line, col)
+        return
+
+    if type_expr.is_array and not allow_array:
+        analyzer._error(
+            f"@gpu function '{func_name}': array types not allowed "
+            f"in {context}", line, col)
+        return
+
+    if type_expr.generic_args:
+        analyzer._error(
+            f"@gpu function '{func_name}': generic types not allowed "
+            f"in {context}", line, col)
+        return
+
+    if type_expr.base not in _GPU_SCALAR_TYPES:
+        analyzer._error(
+            f"@gpu function '{func_name}': type '{type_expr.base}' not "
+            f"allowed in {context} (use int, float, or bool)", line, col)
+
+
+def is_gpu_collection_type(type_expr: TypeExpr | None) -> bool:
+    """True for Vector<T> / Array<T> (with or without the pointer upgrade)."""
+    return (type_expr is not None and type_expr.base in GPU_COLLECTION_CLASSES
+            and len(type_expr.generic_args) == 1 and not type_expr.is_array)
+
+
+def is_gpu_buffer_type(type_expr: TypeExpr | None) -> bool:
+    """True for any parameter type that is bound as a storage buffer."""
+    return type_expr is not None and (
+        type_expr.is_array or is_gpu_resident_type(type_expr)
+        or is_gpu_collection_type(type_expr))
+
+
+def gpu_buffer_elem(type_expr: TypeExpr) -> TypeExpr:
+    """Element type of a buffer parameter (the T of float[] or Vector<T>)."""
+    if is_gpu_resident_type(type_expr) or is_gpu_collection_type(type_expr):
+        return type_expr.generic_args[0]
+    return type_expr
+
+
+def validate_gpu_call_args(analyzer: AnalyzerBase, func, args: list,
+                           line: int, col: int) -> None:
+    """Reject array arguments whose length is unknown at the call site.
+
+    Dispatch size comes from the first buffer argument. A `T[]` function
+    parameter is a plain pointer in C, so sizeof() would not give its
+    length; it has to be passed as a Vector<T>, Array<T> or GpuArray<T>.
+    """
+    for param, arg in zip(func.params, args):
+        if not (param.type and param.type.is_array and isinstance(arg, Identifier)):
+            continue
+        sym = analyzer.scope.lookup(arg.name) if analyzer.scope else None
+        if sym and sym.kind == "param" and sym.type and sym.type.is_array:
+            analyzer._error(
+                f"@gpu call '{func.name}': array parameter '{arg.name}' has "
+                f"no length here; pass a Vector<T>, Array<T> or GpuArray<T>",
+                line, col)
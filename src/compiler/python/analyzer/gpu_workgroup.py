@@ -0,0 +1,107 @@
+"""Workgroup shape and shared memory of @gpu functions.
+
+`@gpu(workgroup=16x16)` sets the shape. 1-D kernels (the default, 64
+threads) are launched over the length of their first array. Multi-D
+kernels are launched over a grid whose extents are the function's first
+scalar parameters, in order (e.g. `width, height` for a 2-D kernel);
+gpu_id_x/y/z index into it.
+`T[] tile = gpu_shared(N);` declares an N-element workgroup array.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..ast_nodes import IntLiteral
+from .gpu import GPU_SHARED
+from .gpu_types import is_gpu_buffer_type
+
+if TYPE_CHECKING:
+    from .core import AnalyzerBase
+
+DEFAULT_WORKGROUP = (64, 1, 1)
+
+# WebGPU default limits (maxComputeWorkgroupSize{X,Y,Z} and
+# maxComputeInvocationsPerWorkgroup)
+_MAX_WORKGROUP = (256, 256, 64)
+_MAX_INVOCATIONS = 256
+_MAX_SHARED_BYTES = 16384  # maxComputeWorkgroupStorageSize
+
+
+def workgroup_dims(func) -> tuple[int, int, int]:
+    """Workgroup size as (x, y, z), defaulting to 64x1x1."""
+    dims = list(getattr(func, 'gpu_workgroup', None) or DEFAULT_WORKGROUP)
+    while len(dims) < 3:
+        dims.append(1)
+    return tuple(dims[:3])
+
+
+def grid_params(func) -> list[str]:
+    """Names of the scalar parameters giving a multi-D kernel's grid extents."""
+    rank = len(getattr(func, 'gpu_workgroup', None) or [])
+    if rank < 2:
+        return []
+    return [p.name for p in _scalar_params(func)][:rank]
+
+
+def validate_gpu_workgroup(analyzer: AnalyzerBase, func) -> None:
+    """Check workgroup dimensions and, for multi-D kernels, grid extents."""
+    name = func.name
+    line, col = func.line, func.col
+    dims = func.gpu_workgroup
+
+    if len(dims) > 3:
+        analyzer._error(
+            f"@gpu function '{name}': workgroup has at most 3 dimensions, "
+            f"got {len(dims)}", line, col)
+        return
+    for axis, (size, limit) in enumerate(zip(dims, _MAX_WORKGROUP)):
+        if size < 1 or size > limit:
+            analyzer._error(
+                f"@gpu function '{name}': workgroup size {'xyz'[axis]} must "
+                f"be between 1 and {limit}, got {size}", line, col)
+            return
+    total = 1
+    for size in dims:
+        total *= size
+    if total > _MAX_INVOCATIONS:
+        analyzer._error(
+            f"@gpu function '{name}': workgroup has {total} threads, "
+            f"more than the {_MAX_INVOCATIONS} allowed", line, col)
+        return
+
+    rank = len(dims)
+    if rank < 2:
+        return
+    extents = _scalar_params(func)[:rank]
+    if len(extents) < rank or any(p.type.base != "int" for p in extents):
+        analyzer._error(
+            f"@gpu function '{name}': a {rank}-D workgroup needs its first "
+            f"{rank} scalar parameters to be int grid extents", line, col)
+
+
+def validate_gpu_shared(analyzer: AnalyzerBase, stmt, func_name: str) -> None:
+    """Check `T[] name = gpu_shared(N);` (int/float elements, literal N)."""
+    line, col = stmt.line, stmt.col
+    t = stmt.type
+    if t is None or not t.is_array or t.base not in ("int", "float"):
+        analyzer._error(
+            f"@gpu function '{func_name}': {GPU_SHARED}() must initialize "
+            f"an int[] or float[] variable", line, col)
+        return
+    args = stmt.initializer.args
+    if len(args) != 1 or not isinstance(args[0], IntLiteral):
+        analyzer._error(
+            f"@gpu function '{func_name}': {GPU_SHARED}() takes one integer "
+            f"literal size", line, col)
+        return
+    size = args[0].value
+    if size < 1 or size * 4 > _MAX_SHARED_BYTES:
+        analyzer._error(
+            f"@gpu function '{func_name}': {GPU_SHARED}({size}) must hold "
+            f"between 1 and {_MAX_SHARED_BYTES // 4} elements", line, col)
+
+
+def _scalar_params(func) -> list:
+    return [p for p in func.params
+            if p.type and not is_gpu_buffer_type(p.type)]
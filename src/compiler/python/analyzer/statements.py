@@ -1,6 +1,7 @@
 """Statement analysis: block, dispatch, var_decl, for loops, control flow."""
 
 from ..ast_nodes import (
+    ArenaStmt,
     Block,
     BreakStmt,
     CallExpr,
@@ -98,6 +99,8 @@ class StatementsMixin:
             self._analyze_expr(stmt.expr)
         elif isinstance(stmt, Block):
             self._analyze_block(stmt)
+        elif isinstance(stmt, ArenaStmt):
+            self._analyze_arena(stmt)
         elif isinstance(stmt, TryCatchStmt):
             self._analyze_block(stmt.try_block)
             self._push_scope()
@@ -33,6 +33,7 @@ from ..ast_nodes import (
     TypeExpr,
     UnaryExpr,
 )
+from .gpu import GPU_BUILTINS
 
 
 class TypeInferenceMixin:
@@ -163,9 +164,9 @@ class TypeInferenceMixin:
 
     def _infer_call_type(self, expr):
         if isinstance(expr.callee, Identifier):
-            # gpu_id() → int
-            if expr.callee.name == "gpu_id":
-                return TypeExpr(base="int")
+            # gpu_id(), gpu_id_x() ... → int; gpu_barrier() → void
+            if expr.callee.name in GPU_BUILTINS:
+                return TypeExpr(base=GPU_BUILTINS[expr.callee.name].base)
             # Mutex(val) → Mutex<T> where T = type of val
             if expr.callee.name == "Mutex" and expr.args:
                 arg_type = self._infer_type(expr.args[0])
@@ -248,11 +249,13 @@ class TypeInferenceMixin:
         if (iter_type.base == "string"
                 or (iter_type.base == "char" and iter_type.pointer_depth >= 1)):
             return TypeExpr(base="char")
-        # Generic class with iterGet method → iterable
-        if iter_type.generic_args and iter_type.base in self.class_table:
+        # Class with iterGet (indexed) or iterNext/iterValue (streaming) → iterable
+        if iter_type.base in self.class_table:
             cls = self.class_table[iter_type.base]
-            if "iterGet" in cls.methods:
-                ret = cls.methods["iterGet"].return_type
+            method = ("iterValue" if "iterValue" in cls.methods and "iterNext" in cls.methods
+                      else "iterGet" if "iterGet" in cls.methods else None)
+            if method is not None:
+                ret = cls.methods[method].return_type
                 if cls.generic_params and iter_type.generic_args:
                     subs = dict(zip(cls.generic_params, iter_type.generic_args))
                     return self._substitute_type(ret, subs)
@@ -3,8 +3,14 @@
 from ..ast_nodes import (
     FieldAccessExpr,
     Identifier,
+    LambdaExpr,
     TypeExpr,
 )
+from .gpu import GPU_BUILTINS, GPU_SHARED
+from .gpu_types import validate_gpu_call_args
+
+# Vector methods whose function argument runs on the thread pool
+_POOL_METHODS = {"parMap", "parFilter", "parReduce", "parForEach"}
 
 
 class ValidationMixin:
@@ -24,13 +30,16 @@ class ValidationMixin:
         for arg in expr.args:
             self._analyze_expr(arg)
 
-        # Validate gpu_id() builtin
-        if isinstance(expr.callee, Identifier) and expr.callee.name == "gpu_id":
+        # Validate gpu_id(), gpu_barrier(), gpu_shared() ... builtins
+        if (isinstance(expr.callee, Identifier)
+                and (expr.callee.name in GPU_BUILTINS
+                     or expr.callee.name == GPU_SHARED)):
+            name = expr.callee.name
             if not self.in_gpu_function:
-                self._error("gpu_id() can only be called inside @gpu functions",
+                self._error(f"{name}() can only be called inside @gpu functions",
                             expr.line, expr.col)
-            if len(expr.args) > 0:
-                self._error("gpu_id() takes no arguments", expr.line, expr.col)
+            if name in GPU_BUILTINS and len(expr.args) > 0:
+                self._error(f"{name}() takes no arguments", expr.line, expr.col)
 
         if isinstance(expr.callee, Identifier) and expr.callee.name in self.class_table:
             cls = self.class_table[expr.callee.name]
@@ -43,6 +52,9 @@ class ValidationMixin:
             if func.body is not None:
                 self._validate_call_arity(func.name, func.params, expr.args,
                                           expr.line, expr.col)
+            if func.is_gpu:
+                validate_gpu_call_args(self, func, expr.args,
+                                       expr.line, expr.col)
         elif isinstance(expr.callee, FieldAccessExpr):
             obj_type = self._infer_type(expr.callee.obj)
             if obj_type and obj_type.base in self.class_table:
@@ -53,6 +65,8 @@ class ValidationMixin:
                     self._validate_call_arity(
                         f"{cls.name}.{method_name}", method.params, expr.args,
                         expr.line, expr.col)
+                if cls.name == "Vector" and method_name in _POOL_METHODS:
+                    self._validate_pool_fn(method_name, expr.args)
 
         # Register generic return types from method calls (e.g. Map.keys() → List<K>)
         if isinstance(expr.callee, FieldAccessExpr):
@@ -68,6 +82,14 @@ class ValidationMixin:
                         if resolved and resolved.generic_args:
                             self._collect_generic_instances(resolved)
 
+    def _validate_pool_fn(self, method_name, args):
+        """Pool threads call the function bare, without a lambda's captures."""
+        for arg in args:
+            if isinstance(arg, LambdaExpr) and arg.captures:
+                self._error(f"Lambda passed to '{method_name}' cannot capture "
+                            f"'{arg.captures[0].name}'; it runs on pool threads",
+                            arg.line, arg.col)
+
     def _validate_call_arity(self, name, params, args, line, col):
         """Validate argument count for function/method calls."""
         required = sum(1 for p in params if p.default is None)
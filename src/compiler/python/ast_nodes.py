@@ -47,6 +47,7 @@ class FunctionDecl:
     params: list[Param] = field(default_factory=list)
     body: Block | None = None
     is_gpu: bool = False
+    gpu_workgroup: list[int] = field(default_factory=list)
     keep_return: bool = False
     line: int = 0
     col: int = 0
@@ -282,6 +283,12 @@ class ReleaseStmt:
     line: int = 0
     col: int = 0
 
+@dataclass
+class ArenaStmt:
+    body: Block = None
+    line: int = 0
+    col: int = 0
+
 @dataclass
 class ElseBlock:
     body: Block = None
@@ -517,7 +524,7 @@ class Capture:
 
 decl = Union[PreprocessorDirective, ClassDecl, InterfaceDecl, FunctionDecl, StructDecl, EnumDecl, RichEnumDecl, TypedefDecl]
 class_member = Union[FieldDecl, MethodDecl, PropertyDecl]
-stmt = Union[VarDeclStmt, ReturnStmt, IfStmt, WhileStmt, DoWhileStmt, ForInStmt, CForStmt, ParallelForStmt, SwitchStmt, BreakStmt, ContinueStmt, ExprStmt, DeleteStmt, TryCatchStmt, ThrowStmt, KeepStmt, ReleaseStmt]
+stmt = Union[VarDeclStmt, ReturnStmt, IfStmt, WhileStmt, DoWhileStmt, ForInStmt, CForStmt, ParallelForStmt, SwitchStmt, BreakStmt, ContinueStmt, ExprStmt, DeleteStmt, TryCatchStmt, ThrowStmt, KeepStmt, ReleaseStmt, ArenaStmt]
 if_else = Union[ElseBlock, ElseIf]
 for_init = Union[ForInitVar, ForInitExpr]
 expr = Union[IntLiteral, FloatLiteral, StringLiteral, CharLiteral, BoolLiteral, NullLiteral, Identifier, SelfExpr, SuperExpr, BinaryExpr, UnaryExpr, CallExpr, IndexExpr, FieldAccessExpr, CastExpr, SizeofExpr, TernaryExpr, AssignExpr, ListLiteral, MapLiteral, BraceInitializer, FStringLiteral, NewExpr, TupleLiteral, LambdaExpr, SpawnExpr]
@@ -663,6 +670,9 @@ class NodeVisitor:
     def visit_ReleaseStmt(self, node: ReleaseStmt):
         return self.generic_visit(node)
 
+    def visit_ArenaStmt(self, node: ArenaStmt):
+        return self.generic_visit(node)
+
     def visit_ElseBlock(self, node: ElseBlock):
         return self.generic_visit(node)
 
@@ -9,7 +9,7 @@ from __future__ import annotations
 
 import os
 
-from .main import _CLASS_NAME_RE, _discover_stdlib_files, _get_stdlib_dir
+from .sources import _CLASS_NAME_RE, _discover_stdlib_files, _get_stdlib_dir
 
 # Cache: frozenset of user class names → (stdlib_source, stdlib_tokens)
 _stdlib_source_cache: dict[frozenset[str], str] = {}
@@ -4,31 +4,75 @@ Caches compiled C output keyed by SHA256 of the fully resolved source
 (including stdlib). When source hasn't changed, the cached .c output
 is returned immediately, skipping the entire compilation pipeline.
 
-Cache location: .btrc-cache/ in the project root.
-Invalidation: automatic — any source change produces a different hash.
+Below that, an incremental layer stores pickled records per piece of the
+build under .btrc-cache/<kind>/: the AST of each source file (unit_cache.py)
+and the IR of each top-level declaration (ir/gen/decl_cache.py), so that a
+change to one file or one function only recompiles what it affects.
+
+Cache location: a per-user directory, $BTRC_CACHE_DIR or
+$XDG_CACHE_HOME/btrc (~/.cache/btrc), with one subdirectory per project
+keyed by the hash of its root path. Records are pickles, and unpickling
+runs code, so nothing is read from the working directory, and a cache
+directory that someone else owns or can write to is not used at all.
+Invalidation: automatic — any source change produces a different hash,
+and so does any change to the compiler's own files (their sizes and
+modification times are part of every key).
 """
 
 from __future__ import annotations
 
 import hashlib
 import os
+import pickle
+import tempfile
+
+# Version stamp — bump when the cache layout changes
+_CACHE_VERSION = "7"
+
+_COMPILER_ROOT = os.path.dirname(os.path.abspath(__file__))
+_fingerprint: str | None = None
 
-# Version stamp — bump when compiler output changes for the same input
-_CACHE_VERSION = "3"
 
-_CACHE_DIR = ".btrc-cache"
+def cache_dir() -> str | None:
+    """This project's cache directory, created if needed; None if it is
+    not private to the current user (then nothing is cached)."""
+    root = os.environ.get("BTRC_CACHE_DIR") or os.path.join(
+        os.environ.get("XDG_CACHE_HOME") or os.path.join(os.path.expanduser("~"), ".cache"),
+        "btrc")
+    project = hashlib.sha256(os.getcwd().encode("utf-8")).hexdigest()[:16]
+    cache = os.path.join(root, project)
+    try:
+        os.makedirs(cache, mode=0o700, exist_ok=True)
+    except OSError:
+        return None
+    return cache if _private(root) and _private(cache) else None
 
 
-def _cache_dir() -> str:
-    """Get the cache directory path, creating it if needed."""
-    cache = os.path.join(os.getcwd(), _CACHE_DIR)
-    os.makedirs(cache, exist_ok=True)
-    return cache
+def _private(path: str) -> bool:
+    if not hasattr(os, "getuid"):  # no POSIX owners to check
+        return True
+    st = os.stat(path)
+    return st.st_uid == os.getuid() and not st.st_mode & 0o022
+
+
+def _compiler_fingerprint() -> str:
+    """Hash of the compiler's own files, so an edited compiler misses."""
+    global _fingerprint
+    if _fingerprint is None:
+        h = hashlib.sha256(f"v{_CACHE_VERSION}".encode("utf-8"))
+        for dirpath, dirnames, filenames in os.walk(_COMPILER_ROOT):
+            dirnames[:] = sorted(d for d in dirnames if d not in ("__pycache__", "tests"))
+            for name in sorted(filenames):
+                if name.endswith(".py"):
+                    st = os.stat(os.path.join(dirpath, name))
+                    h.update(f"{dirpath}/{name}:{st.st_size}:{st.st_mtime_ns}\0".encode("utf-8"))
+        _fingerprint = h.hexdigest()
+    return _fingerprint
 
 
 def _cache_key(resolved_source: str) -> str:
-    """Compute cache key from compiler version + full resolved source."""
-    content = f"v{_CACHE_VERSION}\n{resolved_source}"
+    """Compute cache key from the compiler + full resolved source."""
+    content = f"{_compiler_fingerprint()}\n{resolved_source}"
     return hashlib.sha256(content.encode("utf-8")).hexdigest()
 
 
@@ -37,8 +81,10 @@ def get_cached(resolved_source: str) -> str | None:
 
     Returns the cached C source string, or None if not cached.
     """
-    key = _cache_key(resolved_source)
-    path = os.path.join(_cache_dir(), f"{key}.c")
+    cache = cache_dir()
+    if cache is None:
+        return None
+    path = os.path.join(cache, f"{_cache_key(resolved_source)}.c")
     if os.path.exists(path):
         with open(path) as f:
             return f.read()
@@ -47,7 +93,50 @@ def get_cached(resolved_source: str) -> str | None:
 
 def store(resolved_source: str, c_output: str) -> None:
     """Store compiled C output in the disk cache."""
-    key = _cache_key(resolved_source)
-    path = os.path.join(_cache_dir(), f"{key}.c")
+    cache = cache_dir()
+    if cache is None:
+        return
+    path = os.path.join(cache, f"{_cache_key(resolved_source)}.c")
     with open(path, "w") as f:
         f.write(c_output)
+
+
+def record_key(*parts: str) -> str:
+    """Key of an incremental record: the compiler + its inputs."""
+    h = hashlib.sha256(_compiler_fingerprint().encode("utf-8"))
+    for part in parts:
+        h.update(b"\0")
+        h.update(part.encode("utf-8"))
+    return h.hexdigest()
+
+
+def load_record(kind: str, key: str):
+    """The record stored under `kind`/`key`, or None (missing or unreadable)."""
+    cache = cache_dir()
+    if cache is None:
+        return None
+    path = os.path.join(cache, kind, f"{key}.pickle")
+    try:
+        with open(path, "rb") as f:
+            return pickle.load(f)
+    except (OSError, EOFError, pickle.UnpicklingError, AttributeError,
+            ImportError, RecursionError):
+        return None
+
+
+def store_record(kind: str, key: str, record) -> None:
+    """Store a record; written to a temp file and renamed, so concurrent
+    builds never read a partial file."""
+    cache = cache_dir()
+    if cache is None:
+        return
+    directory = os.path.join(cache, kind)
+    os.makedirs(directory, mode=0o700, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=directory, suffix=".tmp")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            pickle.dump(record, f, protocol=pickle.HIGHEST_PROTOCOL)
+    except RecursionError:  # a very deeply nested tree; just don't cache it
+        os.remove(tmp)
+        return
+    os.replace(tmp, os.path.join(directory, f"{key}.pickle"))
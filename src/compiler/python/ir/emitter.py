@@ -19,7 +19,6 @@ from .nodes import (
     IRExprStmt,
     IRFor,
     IRFunctionDef,
-    IRGpuKernel,
     IRIf,
     IRModule,
     IRRawC,
@@ -30,6 +29,7 @@ from .nodes import (
     IRVarDecl,
     IRWhile,
 )
+from .nodes_gpu import IRGpuKernel
 
 
 class CEmitter(_GpuEmitterMixin, _ExprEmitterMixin):
@@ -10,7 +10,6 @@ from .nodes import (
     IRDeref,
     IRExpr,
     IRFieldAccess,
-    IRGpuDispatch,
     IRIndex,
     IRLiteral,
     IRRawExpr,
@@ -21,6 +20,7 @@ from .nodes import (
     IRUnaryOp,
     IRVar,
 )
+from .nodes_gpu import IRGpuDispatch
 
 
 class _ExprEmitterMixin:
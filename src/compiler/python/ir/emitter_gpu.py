@@ -5,7 +5,7 @@ Mixed into CEmitter to handle GPU compute shader and dispatch nodes.
 
 from __future__ import annotations
 
-from .nodes import IRGpuDispatch, IRGpuKernel
+from .nodes_gpu import IRGpuDispatch, IRGpuKernel
 
 
 class _GpuEmitterMixin:
@@ -29,53 +29,107 @@ class _GpuEmitterMixin:
         """Emit GPU dispatch as standard C11 statements + result variable.
 
         Hoists all setup/dispatch/readback statements before the enclosing
-        statement and returns the result variable name. No GCC statement
-        expressions — produces portable C11 code.
+        statement and returns the result variable name. The setup lives in
+        its own block, skipped when the length is 0, so several dispatches
+        can share a C scope; only the length and result variables
+        (numbered per dispatch) escape it.
+        No GCC statement expressions — produces portable C11 code.
         """
         kname = dispatch.kernel_name
-        ws = dispatch.workgroup_size
+        ws = dispatch.workgroup_size[0]
         n_bufs = len(dispatch.param_buffers)
         has_output = dispatch.output_buffer is not None
         has_uniforms = len(dispatch.uniform_params) > 0
         total_bindings = (n_bufs + (1 if has_output else 0)
                           + (1 if has_uniforms else 0))
-
-        # 1. Lazy GPU singleton init
-        self._line("static void* __gpu = NULL;")
-        self._line("if (!__gpu) { __gpu = btrc_gpu_init_compute(); }")
-
-        # 2. Get array length from first array arg
+        resident_out = has_output and dispatch.output_buffer.resident
+        assign_target = getattr(dispatch, 'assign_target', '')
+        self._gpu_dispatch_count = getattr(self, '_gpu_dispatch_count', 0) + 1
+        n = self._gpu_dispatch_count
+        glen = f"__gpu_len{n}"
+        result = f"__gpu_result{n}"
+
+        # Consecutive dispatches share one command batch (set by the
+        # optimizer); the runtime records until the batch is submitted
+        if dispatch.batch_begin:
+            self._line("btrc_gpu_batch_begin(btrc_gpu_default_compute());")
+
+        # 1. Get array length from first array arg (GpuArray<T>, Vector<T>
+        #    and Array<T> args carry their own length)
         first_arr = (self._expr(dispatch.args[0])
                      if dispatch.args else "NULL")
-        self._line(f"int __gpu_len = sizeof({first_arr})"
-                   f" / sizeof({first_arr}[0]);")
-
-        # 3. Create buffers for array params
+        first_buf = dispatch.param_buffers[0] if dispatch.param_buffers else None
+        if first_buf and (first_buf.resident or first_buf.collection):
+            self._line(f"int {glen} = {self._expr(dispatch.array_len_expr)};")
+        else:
+            self._line(f"int {glen} = sizeof({first_arr})"
+                       f" / sizeof({first_arr}[0]);")
+
+        # 2. Result variable; a GpuArray<T> result owns its output buffer
+        #    and stays on the device. An array result has at least one
+        #    element: a zero-length array is not valid C
+        if resident_out:
+            cls = dispatch.result_class
+            self._line(f"{cls}* {result} = {cls}_new({glen});")
+        elif has_output and not assign_target:
+            c_elem = (dispatch.result_elem_type
+                      or _wgsl_to_c(dispatch.output_buffer.elem_type))
+            self._line(f"{c_elem} {result}[{glen} > 0 ? {glen} : 1];")
+
+        # Nothing to dispatch for empty inputs
+        self._line(f"if ({glen} > 0) {{")
+        self._indent += 1
+
+        # 3. Shared headless context (lazily created by the runtime, so
+        #    GpuArray<T> buffers are valid for every kernel)
+        self._line("void* __gpu = btrc_gpu_default_compute();")
+        if dispatch.profile_label:
+            self._line(f'btrc_gpu_label(__gpu, "{dispatch.profile_label}");')
+
+        # 4. Create buffers for array params (resident GpuArray<T> args
+        #    are bound in place: no upload). Vector<T>/Array<T> args are
+        #    uploaded straight from their storage, sized by their own length
+        #    (at least one element: WebGPU rejects empty bindings)
         for i, buf in enumerate(dispatch.param_buffers):
             arg_e = (self._expr(dispatch.args[i])
                      if i < len(dispatch.args) else "NULL")
+            if buf.resident:
+                self._line(f"void* __buf_{buf.name} = {arg_e}->_buffer;")
+                continue
             usage_r = "BTRC_GPU_STORAGE | BTRC_GPU_COPY_DST"
             usage_rw = ("BTRC_GPU_STORAGE | BTRC_GPU_COPY_DST"
                         " | BTRC_GPU_COPY_SRC")
             usage = usage_rw if buf.access == "read_write" else usage_r
             c_elem = _wgsl_to_c(buf.elem_type)
+            if buf.collection:
+                size = f"{arg_e}->len * sizeof({c_elem})"
+                self._line(
+                    f"void* __buf_{buf.name} = btrc_gpu_create_buffer("
+                    f"__gpu, ({arg_e}->len > 0 ? {arg_e}->len : 1)"
+                    f" * sizeof({c_elem}), {usage});")
+                self._line(
+                    f"btrc_gpu_write_buffer(__gpu, __buf_{buf.name}, "
+                    f"{arg_e}->data, {size});")
+                continue
             self._line(
                 f"void* __buf_{buf.name} = btrc_gpu_create_buffer("
-                f"__gpu, __gpu_len * sizeof({c_elem}), {usage});")
+                f"__gpu, {glen} * sizeof({c_elem}), {usage});")
             self._line(
                 f"btrc_gpu_write_buffer(__gpu, __buf_{buf.name}, "
-                f"{arg_e}, __gpu_len * sizeof({c_elem}));")
+                f"{arg_e}, {glen} * sizeof({c_elem}));")
 
-        # 4. Create output buffer (if function returns an array)
-        if has_output:
+        # 5. Create output buffer (if function returns an array)
+        if resident_out:
+            self._line(f"void* __buf_output = {result}->_buffer;")
+        elif has_output:
             c_elem = _wgsl_to_c(dispatch.output_buffer.elem_type)
             self._line(
                 f"void* __buf_output = btrc_gpu_create_buffer("
-                f"__gpu, __gpu_len * sizeof({c_elem}), "
+                f"__gpu, {glen} * sizeof({c_elem}), "
                 f"BTRC_GPU_STORAGE | BTRC_GPU_COPY_DST"
                 f" | BTRC_GPU_COPY_SRC);")
 
-        # 5. Create uniform buffer (if there are scalar params)
+        # 6. Create uniform buffer (if there are scalar params)
         if has_uniforms:
             uniform_fields = " ".join(
                 f"{_wgsl_to_c(utype)} {uname};"
@@ -95,15 +149,13 @@ class _GpuEmitterMixin:
                 "btrc_gpu_write_buffer(__gpu, __buf_uniforms, "
                 "&__uniforms, sizeof(__uniforms));")
 
-        # 6. Compile shader and create compute pipeline
-        self._line(
-            f"void* __shader = btrc_gpu_create_shader("
-            f"__gpu, (char*){kname}_wgsl);")
+        # 7. Look up the compute pipeline (compiled once per context,
+        #    cached in the runtime and keyed by the kernel's WGSL constant)
         self._line(
-            'void* __pipeline = btrc_gpu_create_compute_pipeline('
-            '__gpu, __shader, "main");')
+            f"void* __pipeline = btrc_gpu_get_compute_pipeline("
+            f'__gpu, (char*){kname}_wgsl, "main");')
 
-        # 7. Create bind group
+        # 8. Create bind group
         self._line(f"void* __bindings[{total_bindings}];")
         bind_idx = 0
         for buf in dispatch.param_buffers:
@@ -119,54 +171,73 @@ class _GpuEmitterMixin:
             f"void* __bg = btrc_gpu_create_bind_group("
             f"__gpu, __pipeline, __bindings, {total_bindings});")
 
-        # 8. Dispatch
-        self._line(
-            f"int __workgroups = (__gpu_len + {ws - 1}) / {ws};")
-        self._line(
-            "btrc_gpu_dispatch(__gpu, __pipeline, __bg, __workgroups);")
-
-        # 9. Readback
-        assign_target = getattr(dispatch, 'assign_target', '')
-        if has_output and assign_target:
-            # Readback directly into the assignment target (memcpy)
-            c_elem = (dispatch.result_elem_type
-                      or _wgsl_to_c(dispatch.output_buffer.elem_type))
+        # 9. Dispatch: 1-D over the array length (the runtime splits
+        #    oversized launches across Y), multi-D over the grid extents
+        if dispatch.grid_params:
+            groups = [
+                f"(__uniforms.{name} + {size - 1}) / {size}"
+                for name, size in zip(dispatch.grid_params,
+                                      dispatch.workgroup_size)]
+            groups += ["1"] * (3 - len(groups))
             self._line(
-                f"btrc_gpu_read_buffer(__gpu, __buf_output, "
-                f"{assign_target}, __gpu_len * sizeof({c_elem}));")
+                f"btrc_gpu_dispatch3(__gpu, __pipeline, __bg, "
+                f"{', '.join(groups)});")
+        else:
+            self._line(
+                f"int __workgroups = ({glen} + {ws - 1}) / {ws};")
+            self._line(
+                "btrc_gpu_dispatch(__gpu, __pipeline, __bg, __workgroups);")
+
+        # 10. Readback
+        if resident_out:
+            pass  # result stays on the device
         elif has_output:
+            # Readback directly into the assignment target (memcpy)
+            # or into the hoisted result array
             c_elem = (dispatch.result_elem_type
                       or _wgsl_to_c(dispatch.output_buffer.elem_type))
-            self._line(f"{c_elem} __gpu_result[__gpu_len];")
+            dst = assign_target or result
             self._line(
                 f"btrc_gpu_read_buffer(__gpu, __buf_output, "
-                f"__gpu_result, __gpu_len * sizeof({c_elem}));")
+                f"{dst}, {glen} * sizeof({c_elem}));")
         else:
             for i, buf in enumerate(dispatch.param_buffers):
-                if buf.access == "read_write":
+                if buf.access == "read_write" and not buf.resident:
                     arg_e = (self._expr(dispatch.args[i])
                              if i < len(dispatch.args) else "NULL")
                     c_elem = _wgsl_to_c(buf.elem_type)
+                    if buf.collection:
+                        self._line(
+                            f"btrc_gpu_read_buffer(__gpu, __buf_{buf.name}"
+                            f", {arg_e}->data, {arg_e}->len"
+                            f" * sizeof({c_elem}));")
+                        continue
                     self._line(
                         f"btrc_gpu_read_buffer(__gpu, __buf_{buf.name}"
-                        f", {arg_e}, __gpu_len * sizeof({c_elem}));")
+                        f", {arg_e}, {glen} * sizeof({c_elem}));")
 
-        # 10. Cleanup
+        # 11. Cleanup
         for buf in dispatch.param_buffers:
-            self._line(f"btrc_gpu_buffer_destroy(__buf_{buf.name});")
-        if has_output:
+            if not buf.resident:
+                self._line(f"btrc_gpu_buffer_destroy(__buf_{buf.name});")
+        if has_output and not resident_out:
             self._line("btrc_gpu_buffer_destroy(__buf_output);")
         if has_uniforms:
             self._line("btrc_gpu_buffer_destroy(__buf_uniforms);")
         self._line("btrc_gpu_bind_group_destroy(__bg);")
-        self._line("btrc_gpu_compute_pipeline_destroy(__pipeline);")
-        self._line("btrc_gpu_shader_destroy(__shader);")
+        if dispatch.profile_label:
+            self._line("btrc_gpu_label(__gpu, NULL);")
+
+        self._indent -= 1
+        self._line("}")
+        if dispatch.batch_end:
+            self._line("btrc_gpu_batch_submit(btrc_gpu_default_compute());")
 
         # Return result variable (or void expression)
         if assign_target:
             return "(void)0"  # readback done directly into target
         if has_output:
-            return "__gpu_result"
+            return result
         return "(void)0"
 
 
@@ -23,6 +23,7 @@ from ..nodes import (
     IRVar,
 )
 from .expressions import lower_expr
+from .shared_rc import is_shared
 
 if TYPE_CHECKING:
     from ...ast_nodes import ReleaseStmt
@@ -73,37 +74,41 @@ def _emit_scope_release(managed: list[tuple[str, str]],
     2. Destroy any with rc <= 0 (cascade may free others)
     3. Suspect those still alive (rc > 0) for cycle collection
     """
-    has_cyclable = False
     if gen:
-        for _, cls_name in managed:
-            cls_info = _lookup_cls_info(gen, cls_name)
-            if cls_info and cls_info.is_cyclable:
-                has_cyclable = True
-                break
+        # Shared objects never reach the per-thread collector: each release
+        # is one atomic decrement whose result decides the destroy
+        shared = [m for m in managed if is_shared(gen, m[1])]
+        local = [m for m in managed if not is_shared(gen, m[1])]
+        if any(_is_cyclable(gen, cls_name) for _, cls_name in local):
+            return ([_release(gen, var, cls_name) for var, cls_name in reversed(shared)]
+                    + _emit_scope_release_phased(local, gen))
+    # Simple path: no cyclable types, just rc-- and destroy
+    return [_release(gen, var, cls_name) for var, cls_name in reversed(managed)]
 
-    if has_cyclable and gen:
-        return _emit_scope_release_phased(managed, gen)
 
-    # Simple path: no cyclable types, just rc-- and destroy
-    stmts = []
-    for var_name, cls_name in reversed(managed):
-        destroy_fn = _destroy_fn_for_managed(gen, cls_name) if gen else f"{cls_name}_destroy"
-        stmts.append(IRIf(
+def _release(gen: IRGenerator | None, var_name: str, cls_name: str) -> IRStmt:
+    """if (var != NULL) { if (--var->__rc <= 0) destroy(var); }"""
+    destroy_fn = _destroy_fn_for_managed(gen, cls_name) if gen else f"{cls_name}_destroy"
+    return IRIf(
+        condition=IRBinOp(
+            left=IRVar(name=var_name), op="!=",
+            right=IRLiteral(text="NULL")),
+        then_block=IRBlock(stmts=[IRIf(
             condition=IRBinOp(
-                left=IRVar(name=var_name), op="!=",
-                right=IRLiteral(text="NULL")),
-            then_block=IRBlock(stmts=[IRIf(
-                condition=IRBinOp(
-                    left=IRUnaryOp(op="--", operand=IRFieldAccess(
-                        obj=IRVar(name=var_name), field="__rc", arrow=True),
-                        prefix=True),
-                    op="<=", right=IRLiteral(text="0")),
-                then_block=IRBlock(stmts=[IRExprStmt(
-                    expr=IRCall(callee=destroy_fn,
-                                args=[IRVar(name=var_name)]))]),
-            )]),
-        ))
-    return stmts
+                left=IRUnaryOp(op="--", operand=IRFieldAccess(
+                    obj=IRVar(name=var_name), field="__rc", arrow=True),
+                    prefix=True),
+                op="<=", right=IRLiteral(text="0")),
+            then_block=IRBlock(stmts=[IRExprStmt(
+                expr=IRCall(callee=destroy_fn,
+                            args=[IRVar(name=var_name)]))]),
+        )]),
+    )
+
+
+def _is_cyclable(gen: IRGenerator, cls_name: str) -> bool:
+    cls_info = _lookup_cls_info(gen, cls_name)
+    return bool(cls_info and cls_info.is_cyclable)
 
 
 def _lookup_cls_info(gen: IRGenerator, cls_name: str):
@@ -135,9 +140,9 @@ def _emit_scope_release_phased(managed: list[tuple[str, str]],
     stmts.append(IRAssign(
         target=IRVar(name="__btrc_tracking"),
         value=IRLiteral(text="1")))
-    stmts.append(IRAssign(
-        target=IRVar(name="__btrc_destroyed_count"),
-        value=IRLiteral(text="0")))
+    stmts.append(IRExprStmt(expr=IRCall(
+        callee="__btrc_destroyed_reset",
+        helper_ref="__btrc_destroyed_tracking", args=[])))
 
     # Phase 1: Decrement rc for ALL managed vars
     for var_name, _cls_name in reversed(managed):
@@ -183,10 +188,10 @@ def _emit_scope_release_phased(managed: list[tuple[str, str]],
             )]),
         ))
 
-    # Phase 3: Suspect those still alive (rc > 0) for cycle collection
+    # Phase 3: Suspect those still alive (rc > 0) for cycle collection.
+    # The buffer holds one scope's suspects; Phase 4 collects them all.
     for var_name, cls_name in reversed(managed):
-        cls_info = _lookup_cls_info(gen, cls_name)
-        if not cls_info or not cls_info.is_cyclable:
+        if not _is_cyclable(gen, cls_name):
             continue
         destroy_fn = _destroy_fn_for_managed(gen, cls_name)
         stmts.append(IRIf(
@@ -207,7 +212,7 @@ def _emit_scope_release_phased(managed: list[tuple[str, str]],
                     then_block=IRBlock(stmts=[IRExprStmt(
                         expr=IRCall(
                             callee="__btrc_suspect",
-                            helper_ref="__btrc_suspect_buf",
+                            helper_ref="__btrc_collect_cycles",
                             args=[
                                 IRVar(name=var_name),
                                 IRRawExpr(
@@ -237,30 +242,13 @@ def _emit_scope_release_phased(managed: list[tuple[str, str]],
     return stmts
 
 
-def _emit_return_release(gen: IRGenerator, returned_var: str | None) -> list[IRStmt]:
-    """Emit rc-- for all managed vars across all scopes, except the returned var."""
-    stmts = []
-    all_managed = gen.get_all_managed_vars()
-    for var_name, cls_name in reversed(all_managed):
-        if var_name == returned_var:
-            continue  # Skip the returned variable — ownership transfers to caller
-        destroy_fn = _destroy_fn_for_managed(gen, cls_name)
-        stmts.append(IRIf(
-            condition=IRBinOp(
-                left=IRVar(name=var_name), op="!=",
-                right=IRLiteral(text="NULL")),
-            then_block=IRBlock(stmts=[IRIf(
-                condition=IRBinOp(
-                    left=IRUnaryOp(op="--", operand=IRFieldAccess(
-                        obj=IRVar(name=var_name), field="__rc", arrow=True),
-                        prefix=True),
-                    op="<=", right=IRLiteral(text="0")),
-                then_block=IRBlock(stmts=[IRExprStmt(
-                    expr=IRCall(callee=destroy_fn,
-                                args=[IRVar(name=var_name)]))]),
-            )]),
-        ))
-    return stmts
+def _emit_return_release(gen: IRGenerator, returned_var: str | None,
+                         since: int = 0) -> list[IRStmt]:
+    """Emit rc-- for all managed vars across all scopes (from depth `since`
+    on), except the returned var."""
+    all_managed = gen.get_all_managed_vars(since)
+    return [_release(gen, var_name, cls_name) for var_name, cls_name in reversed(all_managed)
+            if var_name != returned_var]  # the returned var's reference goes to the caller
 
 
 def _lower_release(gen: IRGenerator, node: ReleaseStmt) -> list[IRStmt]:
@@ -0,0 +1,136 @@
+"""Arena blocks: `arena { ... }` lowering and arena-aware allocation sites.
+
+    arena { body }
+ →  __btrc_arena* __arena_N = __btrc_arena_new();
+    body
+    __btrc_arena_free(__arena_N);
+
+While a block is open (gen.arena_stack is non-empty) the allocation sites
+lexically inside it change:
+
+  - `new C(...)` / `C(...)` bump-allocate C from the arena, run C_init and
+    mark the instance __BTRC_RC_IMMORTAL, so ARC inc/dec on it never frees
+    it and the local is not auto-managed. Only classes that own nothing
+    (no destructor, no class-typed fields) qualify; anything else would
+    leak what its destroy releases, so it keeps normal ARC allocation.
+  - f-string buffers come from the arena; other new strings (concatenation,
+    string methods, toString) are handed to the arena with
+    __btrc_arena_own instead of the global __btrc_str_track pool.
+
+The analyzer (analyzer/arena.py) guarantees control only leaves the block
+through its end (or a throw, covered by a try cleanup) and lists the
+string expressions that must be copied out (`arena_copies`).
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..nodes import (
+    CType,
+    IRAssign,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRExprStmt,
+    IRFieldAccess,
+    IRLiteral,
+    IRRawExpr,
+    IRSizeof,
+    IRStmt,
+    IRStmtExpr,
+    IRVar,
+    IRVarDecl,
+)
+
+if TYPE_CHECKING:
+    from ...ast_nodes import ArenaStmt
+    from .generator import IRGenerator
+
+
+def lower_arena(gen: IRGenerator, node: ArenaStmt) -> list[IRStmt]:
+    from .statements import lower_block
+    gen.use_helper("__btrc_arena")
+    name = gen.fresh_temp("__arena")
+    decl = IRVarDecl(c_type=CType(text="__btrc_arena*"), name=name,
+                     init=IRCall(callee="__btrc_arena_new", helper_ref="__btrc_arena"))
+    gen._func_var_decls.append(decl)
+    stmts: list[IRStmt] = [decl]
+    if gen.in_try_depth > 0:
+        # A throw skips the release below; the try's cleanup frees the arena
+        decl.is_volatile = True
+        gen.use_helper("__btrc_register_cleanup")
+        stmts.append(IRExprStmt(expr=IRCall(
+            callee="__btrc_register_cleanup",
+            args=[IRRawExpr(text=f"(void**)&{name}"),
+                  IRRawExpr(text="(__btrc_cleanup_fn)__btrc_arena_free")],
+            helper_ref="__btrc_register_cleanup")))
+    gen.arena_stack.append(name)
+    stmts.extend(lower_block(gen, node.body).stmts)
+    gen.arena_stack.pop()
+    stmts.append(IRExprStmt(expr=IRCall(callee="__btrc_arena_free", args=[IRVar(name=name)],
+                                        helper_ref="__btrc_arena")))
+    if gen.in_try_depth > 0:
+        stmts.append(IRAssign(target=IRVar(name=name), value=IRLiteral(text="NULL")))
+    return stmts
+
+
+def arena_class(gen: IRGenerator, class_name: str) -> bool:
+    """True if instances of `class_name` are bump-allocated inside arenas."""
+    if not gen.arena_stack:
+        return False
+    cls = gen.analyzed.class_table.get(class_name)
+    if cls is None or cls.generic_params or "__del__" in cls.methods:
+        return False
+    table = gen.analyzed.class_table
+    for fd in cls.fields.values():
+        if fd.type and fd.type.pointer_depth <= 1 and fd.type.base in table:
+            return False
+    return True
+
+
+def arena_new(gen: IRGenerator, class_name: str, call: IRCall) -> IRExpr:
+    """Rewrite `class_name`_new(args) to an arena allocation, if it applies."""
+    if not arena_class(gen, class_name):
+        return call
+    gen.use_helper("__btrc_arena")
+    ptr = CType(text=f"{class_name}*")
+    obj = gen.fresh_temp("__aobj")
+    return IRStmtExpr(stmts=[
+        IRVarDecl(c_type=ptr, name=obj, init=IRCast(target_type=ptr, expr=IRCall(
+            callee="__btrc_arena_alloc",
+            args=[IRVar(name=gen.arena_stack[-1]), IRSizeof(operand=class_name)],
+            helper_ref="__btrc_arena"))),
+        IRExprStmt(expr=IRCall(callee=f"{class_name}_init",
+                               args=[IRVar(name=obj)] + call.args)),
+        IRAssign(target=IRFieldAccess(obj=IRVar(name=obj), field="__rc", arrow=True),
+                 value=IRLiteral(text="__BTRC_RC_IMMORTAL")),
+    ], result=IRVar(name=obj))
+
+
+def string_buffer(gen: IRGenerator, size: IRExpr) -> IRExpr:
+    """Storage for a newly built string of `size` bytes."""
+    if gen.arena_stack:
+        gen.use_helper("__btrc_arena")
+        return IRCast(target_type=CType(text="char*"), expr=IRCall(
+            callee="__btrc_arena_alloc", args=[IRVar(name=gen.arena_stack[-1]), size],
+            helper_ref="__btrc_arena"))
+    return track_string(gen, IRCast(target_type=CType(text="char*"),
+                                    expr=IRCall(callee="malloc", args=[size])))
+
+
+def track_string(gen: IRGenerator, s: IRExpr, escapes: bool = False) -> IRExpr:
+    """Register the malloc'd string `s` with its owner: the arena, or the pool."""
+    if gen.arena_stack and not escapes:
+        gen.use_helper("__btrc_arena")
+        return IRCall(callee="__btrc_arena_own", args=[IRVar(name=gen.arena_stack[-1]), s],
+                      helper_ref="__btrc_arena")
+    gen.use_helper("__btrc_str_track")
+    return IRCall(callee="__btrc_str_track", args=[s], helper_ref="__btrc_str_track")
+
+
+def copy_out(gen: IRGenerator, s: IRExpr) -> IRExpr:
+    """Copy an arena string so it outlives the block (analyzer's arena_copies)."""
+    gen.use_helper("__btrc_strdup")
+    return track_string(gen, IRCall(callee="__btrc_strdup", args=[s],
+                                    helper_ref="__btrc_strdup"), escapes=True)
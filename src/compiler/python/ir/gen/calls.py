@@ -22,6 +22,9 @@ from ..nodes import (
     IRTernary,
     IRUnaryOp,
 )
+from .arena import arena_new
+from .pools import lower_pooled_free
+from .thread_methods import lower_mutex_constructor
 from .types import format_spec_for_type, is_string_type
 
 if TYPE_CHECKING:
@@ -49,7 +52,7 @@ def _lower_call(gen: IRGenerator, node: CallExpr) -> IRExpr:
 
         # Mutex(val) constructor → __btrc_mutex_val_create(boxed_val)
         if name == "Mutex":
-            return _lower_mutex_constructor(gen, node.args, args)
+            return lower_mutex_constructor(gen, node.args, args)
 
         # Constructor call: ClassName(args) where ClassName is a known class
         if name in gen.analyzed.class_table:
@@ -60,6 +63,11 @@ def _lower_call(gen: IRGenerator, node: CallExpr) -> IRExpr:
             return _lower_print(gen, node.args)
         if name == "printf":
             return IRCall(callee="printf", args=args)
+        if name == "free" and len(node.args) == 1:
+            # free(obj) on a pooled class instance returns it to its pool
+            freed = lower_pooled_free(gen, node.args[0], args[0])
+            if freed:
+                return freed
         if name == "sizeof":
             if node.args:
                 return IRSizeof(operand=_expr_text(args[0]))
@@ -132,13 +140,7 @@ def _lower_constructor_call(gen: IRGenerator, class_name: str,
                         ir_args.append(lower_expr(gen, p.default))
                     else:
                         ir_args.append(IRLiteral(text="0"))
-        # Generic class: need to find mangled name
-        if cls_info.generic_params:
-            # Try to infer from context (node_types may have the resolved type)
-            # For now, return mangled_new if we can find the instance
-            # The caller will need to patch this in VarDecl context
-            pass
-    return IRCall(callee=f"{class_name}_new", args=ir_args)
+    return arena_new(gen, class_name, IRCall(callee=f"{class_name}_new", args=ir_args))
 
 
 def get_keep_param_indices(gen: IRGenerator, node: CallExpr) -> list[int]:
@@ -292,28 +294,3 @@ def _lower_print(gen: IRGenerator, args: list) -> IRExpr:
     fmt_str = " ".join(parts) + "\\n"
     return IRCall(callee="printf",
                   args=[IRLiteral(text=f'"{fmt_str}"')] + ir_args)
-
-
-_MUTEX_PRIMITIVE_TYPES = {"int", "float", "double", "char", "bool", "short", "long"}
-
-
-def _lower_mutex_constructor(gen, ast_args, ir_args):
-    """Lower Mutex(val) → __btrc_mutex_val_create(boxed_val)."""
-    gen.use_helper("__btrc_mutex_val_create")
-    if "pthread.h" not in gen.module.includes:
-        gen.module.includes.append("pthread.h")
-    if not ast_args:
-        return IRCall(callee="__btrc_mutex_val_create",
-                      args=[IRLiteral(text="NULL")],
-                      helper_ref="__btrc_mutex_val_create")
-    # Box the initial value
-    arg_type = gen.analyzed.node_types.get(id(ast_args[0]))
-    from .expressions import lower_expr
-    val = lower_expr(gen, ast_args[0])
-    if arg_type and arg_type.base in _MUTEX_PRIMITIVE_TYPES and not arg_type.generic_args:
-        boxed = IRCast(target_type="void*",
-                       expr=IRCast(target_type="intptr_t", expr=val))
-    else:
-        boxed = IRCast(target_type="void*", expr=val)
-    return IRCall(callee="__btrc_mutex_val_create", args=[boxed],
-                  helper_ref="__btrc_mutex_val_create")
@@ -23,6 +23,8 @@ from ..nodes import (
     IRUnaryOp,
     IRVar,
 )
+from .arena import arena_new
+from .pools import free_instance, uses_pool
 from .types import is_generic_class_type, mangle_generic_type, type_to_c
 
 if TYPE_CHECKING:
@@ -73,7 +75,10 @@ def emit_destructor(gen: IRGenerator, decl: ClassDecl, cls_info: ClassInfo):
                             helper_ref="__btrc_destroyed_tracking",
                             args=[IRVar(name="self")]))])))
     # Free self at the end
-    body_stmts.append(IRExprStmt(expr=IRCall(callee="free", args=[IRVar(name="self")])))
+    if uses_pool(gen, name):
+        body_stmts.append(free_instance(gen, name, IRVar(name="self")))
+    else:
+        body_stmts.append(IRExprStmt(expr=IRCall(callee="free", args=[IRVar(name="self")])))
 
     gen.module.function_defs.append(IRFunctionDef(
         name=f"{name}_destroy",
@@ -97,9 +102,11 @@ def emit_method(gen: IRGenerator, decl: ClassDecl, method: MethodDecl):
 
     body = IRBlock()
     if method.body:
+        from .error_flag import flag_routine
         from .statements import lower_block
         gen._func_var_decls = []
-        body = lower_block(gen, method.body)
+        with flag_routine(gen, method, ret_type):
+            body = lower_block(gen, method.body)
 
     gen.module.function_defs.append(IRFunctionDef(
         name=f"{name}_{method.name}",
@@ -210,4 +217,4 @@ def lower_new_expr(gen: IRGenerator, node: NewExpr):
     if node.type.generic_args:
         type_name = mangle_generic_type(node.type.base, node.type.generic_args)
     args = [lower_expr(gen, a) for a in node.args]
-    return IRCall(callee=f"{type_name}_new", args=args)
+    return arena_new(gen, type_name, IRCall(callee=f"{type_name}_new", args=args))
@@ -21,18 +21,15 @@ from ..nodes import (
     IRAssign,
     IRBlock,
     IRCall,
-    IRCast,
     IRExprStmt,
     IRFieldAccess,
     IRFunctionDef,
     IRLiteral,
     IRParam,
-    IRRawExpr,
     IRReturn,
     IRStructDef,
     IRStructField,
     IRVar,
-    IRVarDecl,
 )
 from .class_members import (
     emit_destructor as _emit_destructor,
@@ -46,6 +43,8 @@ from .class_members import (
 from .class_members import (
     emit_property as _emit_property,
 )
+from .pools import alloc_self
+from .shared_rc import rc_field_type
 from .types import is_generic_class_type, mangle_generic_type, type_to_c
 
 if TYPE_CHECKING:
@@ -144,7 +143,11 @@ def _emit_method_forward_decls(gen: IRGenerator, decl: ClassDecl,
                                 cls_info: ClassInfo):
     """Emit forward declarations for own + inherited methods."""
     name = decl.name
-    fwd_lines = []
+    # Constructor and destructor too, so classes can use classes declared later
+    ctor_params = [f"{type_to_c(p.type)} {p.name}"
+                   for p in (cls_info.constructor.params if cls_info.constructor else [])]
+    fwd_lines = [f"{name}* {name}_new({', '.join(ctor_params) or 'void'});",
+                 f"void {name}_destroy({name}* self);"]
     for member in decl.members:
         if isinstance(member, MethodDecl) and member.name != decl.name and member.name != "__del__":
             is_static = member.access == "class"
@@ -171,8 +174,7 @@ def _emit_method_forward_decls(gen: IRGenerator, decl: ClassDecl,
             ret = type_to_c(method.return_type) if method.return_type else "void"
             fwd_lines.append(f"{ret} {name}_{mname}({', '.join(params)});")
         parent_name = parent_info.parent
-    if fwd_lines:
-        gen.module.forward_decls.extend(fwd_lines)
+    gen.module.forward_decls.extend(fwd_lines)
 
 
 def _lower_field_init(gen: IRGenerator, field: FieldDecl):
@@ -203,7 +205,7 @@ def _emit_class_struct(gen: IRGenerator, decl: ClassDecl, cls_info: ClassInfo):
     fields: list[IRStructField] = []
 
     # ARC: refcount as the first field (before everything else)
-    fields.append(IRStructField(c_type=CType(text="int"), name="__rc"))
+    fields.append(IRStructField(c_type=rc_field_type(gen, decl.name), name="__rc"))
 
     # Parent fields (if inheriting)
     if cls_info.parent and cls_info.parent in gen.analyzed.class_table:
@@ -268,20 +270,8 @@ def _emit_constructor(gen: IRGenerator, decl: ClassDecl, cls_info: ClassInfo):
         body=IRBlock(stmts=init_body_stmts),
     ))
 
-    # _new function: malloc + memset + init + return
-    new_body_stmts = [
-        IRVarDecl(
-            c_type=CType(text=f"{name}*"), name="self",
-            init=IRCast(
-                target_type=f"{name}*",
-                expr=IRCall(callee="malloc", args=[IRRawExpr(text=f"sizeof({name})")]),
-            ),
-        ),
-        IRExprStmt(expr=IRCall(
-            callee="memset",
-            args=[IRVar(name="self"), IRLiteral(text="0"),
-                  IRRawExpr(text=f"sizeof({name})")],
-        )),
+    # _new function: allocate zeroed (pooled or malloc + memset) + init + return
+    new_body_stmts = alloc_self(gen, name, name) + [
         IRExprStmt(expr=IRCall(
             callee=f"{name}_init",
             args=[IRVar(name="self")] + [IRVar(name=p.name) for p in ctor_params],
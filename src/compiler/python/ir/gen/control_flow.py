@@ -1,17 +1,25 @@
-"""Control flow statement lowering: if, switch, delete, try/catch, throw."""
+"""Control flow statement lowering: if, switch, delete, try/catch, throw;
+the try/catch scan that decides whether setjmp.h is included."""
 
 from __future__ import annotations
 
 from typing import TYPE_CHECKING
 
 from ...ast_nodes import (
+    Block,
+    CForStmt,
+    ClassDecl,
     DeleteStmt,
+    DoWhileStmt,
     ElseBlock,
     ElseIf,
+    ForInStmt,
+    FunctionDecl,
     IfStmt,
     SwitchStmt,
     ThrowStmt,
     TryCatchStmt,
+    WhileStmt,
 )
 from ..nodes import (
     CType,
@@ -87,10 +95,17 @@ def _lower_delete(gen: IRGenerator, node: DeleteStmt) -> list[IRStmt]:
     stmts.append(IRAssign(target=obj, value=IRLiteral(text="NULL")))
     return stmts
 
+# Condition of the `if` a setjmp try lowers to; its else branch is the catch
+SETJMP_TRY = "setjmp(__btrc_try_stack[__btrc_try_top]) == 0"
+
 
 def _lower_try_catch(gen: IRGenerator, node: TryCatchStmt) -> list[IRStmt]:
     """Lower try/catch to setjmp/longjmp boilerplate."""
+    from .error_flag import lower_flag_try
     from .statements import lower_block
+    flagged = lower_flag_try(gen, node)
+    if flagged is not None:
+        return flagged
     gen.use_helper("__btrc_trycatch_globals")
     gen.use_helper("__btrc_throw")
     stmts: list[IRStmt] = []
@@ -115,7 +130,9 @@ def _lower_try_catch(gen: IRGenerator, node: TryCatchStmt) -> list[IRStmt]:
 
     # if (setjmp(...) == 0) { try block } else { catch block }
     gen.in_try_depth += 1
+    gen.flag_tries.append(None)
     try_body = lower_block(gen, node.try_block)
+    gen.flag_tries.pop()
     gen.in_try_depth -= 1
     # Normal exit: discard cleanup registrations (scope release already freed them)
     # then decrement try level
@@ -133,7 +150,7 @@ def _lower_try_catch(gen: IRGenerator, node: TryCatchStmt) -> list[IRStmt]:
             init=IRVar(name="__btrc_error_msg")))
 
     stmts.append(IRIf(
-        condition=IRRawExpr(text="setjmp(__btrc_try_stack[__btrc_try_top]) == 0"),
+        condition=IRRawExpr(text=SETJMP_TRY),
         then_block=try_body,
         else_block=catch_body,
     ))
@@ -146,8 +163,12 @@ def _lower_try_catch(gen: IRGenerator, node: TryCatchStmt) -> list[IRStmt]:
 
 
 def _lower_throw(gen: IRGenerator, node: ThrowStmt) -> list[IRStmt]:
-    gen.use_helper("__btrc_throw")
+    from .error_flag import lower_flag_throw
     expr = _lower_expr(gen, node.expr)
+    flagged = lower_flag_throw(gen, expr)
+    if flagged is not None:
+        return flagged
+    gen.use_helper("__btrc_throw")
     return [IRExprStmt(expr=IRCall(callee="__btrc_throw", args=[expr],
                                    helper_ref="__btrc_throw"))]
 
@@ -156,3 +177,72 @@ def _lower_expr(gen, node):
     """Convenience wrapper to avoid circular import at module level."""
     from .expressions import lower_expr
     return lower_expr(gen, node)
+
+
+def _uses_trycatch(decl) -> bool:
+    """Check if a declaration uses try/catch (simple scan)."""
+    if isinstance(decl, (ClassDecl, FunctionDecl)):
+        return _block_uses_trycatch(getattr(decl, 'body', None))
+    return False
+
+
+def _block_uses_trycatch(block) -> bool:
+    if block is None:
+        return False
+    if isinstance(block, Block):
+        for s in block.statements:
+            if isinstance(s, (TryCatchStmt, ThrowStmt)):
+                return True
+            if isinstance(s, IfStmt):
+                if _block_uses_trycatch(s.then_block):
+                    return True
+                if s.else_block:
+                    if isinstance(s.else_block, ElseBlock):
+                        if _block_uses_trycatch(s.else_block.body):
+                            return True
+                    elif isinstance(s.else_block, ElseIf):
+                        if _stmt_uses_trycatch(s.else_block.if_stmt):
+                            return True
+            elif isinstance(s, (WhileStmt, DoWhileStmt, ForInStmt, CForStmt)):
+                if _block_uses_trycatch(s.body):
+                    return True
+            elif isinstance(s, SwitchStmt):
+                for case in s.cases:
+                    for cs in case.body:
+                        if isinstance(cs, (TryCatchStmt, ThrowStmt)):
+                            return True
+                        if _stmt_uses_trycatch(cs):
+                            return True
+            elif isinstance(s, TryCatchStmt):
+                if _block_uses_trycatch(s.try_block):
+                    return True
+                if _block_uses_trycatch(s.catch_block):
+                    return True
+                if _block_uses_trycatch(s.finally_block):
+                    return True
+    return False
+
+
+def _stmt_uses_trycatch(s) -> bool:
+    """Check if a single statement (or nested if) uses try/catch."""
+    if isinstance(s, (TryCatchStmt, ThrowStmt)):
+        return True
+    if isinstance(s, IfStmt):
+        if _block_uses_trycatch(s.then_block):
+            return True
+        if s.else_block:
+            if isinstance(s.else_block, ElseBlock):
+                if _block_uses_trycatch(s.else_block.body):
+                    return True
+            elif isinstance(s.else_block, ElseIf):
+                if _stmt_uses_trycatch(s.else_block.if_stmt):
+                    return True
+    elif isinstance(s, (WhileStmt, DoWhileStmt, ForInStmt, CForStmt)):
+        if _block_uses_trycatch(s.body):
+            return True
+    elif isinstance(s, SwitchStmt):
+        for case in s.cases:
+            for cs in case.body:
+                if _stmt_uses_trycatch(cs):
+                    return True
+    return False
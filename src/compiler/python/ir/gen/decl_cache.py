@@ -0,0 +1,219 @@
+"""Per-declaration lowering: each top-level function and class on its own.
+
+Every function and non-generic class is lowered into a fresh scope: an
+empty IRModule, helper set, fn-pointer typedef table and par* method table,
+with temp and lambda numbering restarted (lambda names carry the
+declaration's name). The resulting `_Record` is then merged into the real
+module: lists appended, includes and forward declarations kept once, the
+tables unioned. A declaration's IR so depends only on its own source and on
+what analysis says about the rest of the program, so records can be reused
+across builds and computed in any order:
+
+- With the cache on, a record is stored under a key made of the
+  declaration's body fingerprint (unit_cache.py), the signatures of all
+  top-level declarations, and the whole-program facts lowering reads:
+  generic instances, shared-rc classes, string summaries, and the escape
+  and arena facts for nodes inside the declaration. A later build reuses
+  every record whose key is unchanged.
+- With `--jobs N`, the records still missing are lowered in N forked
+  processes and merged in declaration order, so the output is the same as
+  a serial build's.
+
+@gpu functions are lowered first, straight into the module: a dispatch
+anywhere reads the kernel they register on the generator.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import re
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING
+
+from ...ast_nodes import ClassDecl, FunctionDecl, PreprocessorDirective, VarDeclStmt
+from ...disk_cache import load_record, record_key, store_record
+from ...workers import map_in_processes
+from ..nodes import IRModule
+from . import types
+from .string_scopes import _summaries
+from .types import mangle_generic_type, type_to_c
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+_KIND = "ir"
+_APPENDED = ("helper_decls", "enum_defs", "struct_defs", "vtable_defs",
+             "global_vars", "function_defs", "gpu_kernels", "raw_sections")
+
+
+@dataclass
+class _Record:
+    module: IRModule
+    helpers: set[str] = field(default_factory=set)
+    typedefs: dict[str, str] = field(default_factory=dict)
+    parallel_methods: dict[str, tuple] = field(default_factory=dict)
+
+
+def lower_declarations(gen: IRGenerator):
+    """Emit all top-level declarations in order."""
+    decls = gen.analyzed.program.declarations
+    for decl in decls:
+        if _is_kernel(decl):
+            emit_declaration(gen, decl)
+    scoped = [d for d in decls if _scoped(d)]
+    keys = _keys(gen, decls, scoped) if gen.use_cache else {}
+    records = {}
+    for decl in scoped:
+        record = load_record(_KIND, keys[id(decl)]) if keys else None
+        if record is not None:
+            records[id(decl)] = record
+    loaded = set(records)
+    missing = [d for d in scoped if id(d) not in loaded]
+    if gen.jobs > 1 and len(missing) > 1:
+        global _worker_job
+        _summaries(gen)  # computed once, before the workers fork
+        _worker_job = (gen, missing)
+        lowered = map_in_processes(_lower_missing, list(range(len(missing))), gen.jobs)
+        _worker_job = None
+        records.update(zip(map(id, missing), lowered))
+    for decl in decls:
+        if _is_kernel(decl):
+            continue
+        if not _scoped(decl):
+            emit_declaration(gen, decl)
+            continue
+        record = records.get(id(decl))
+        if record is None:
+            record = lower_scoped(gen, decl)
+        if keys and id(decl) not in loaded:
+            store_record(_KIND, keys[id(decl)], record)  # before the optimizer edits it
+        _merge(gen, record)
+
+
+def lower_scoped(gen: IRGenerator, decl) -> _Record:
+    """Lower `decl` into a record of its own, leaving the module untouched."""
+    saved = (gen.module, gen._used_helpers, types._fn_ptr_typedefs, gen.parallel_methods,
+             gen._temp_counter, gen._lambda_counter, gen._fn_ptr_envs)
+    record = _Record(module=IRModule())
+    gen.module, gen._used_helpers = record.module, record.helpers
+    types._fn_ptr_typedefs, gen.parallel_methods = record.typedefs, record.parallel_methods
+    gen._temp_counter = gen._lambda_counter = 0
+    gen._lambda_scope, gen._fn_ptr_envs = f"{decl.name}_", {}
+    try:
+        emit_declaration(gen, decl)
+    finally:
+        (gen.module, gen._used_helpers, types._fn_ptr_typedefs, gen.parallel_methods,
+         gen._temp_counter, gen._lambda_counter, gen._fn_ptr_envs) = saved
+        gen._lambda_scope = ""
+    return record
+
+
+def emit_declaration(gen: IRGenerator, decl):
+    """Emit one top-level declaration straight into the module."""
+    from .classes import emit_class_decl
+    from .functions import emit_function_decl
+    if isinstance(decl, ClassDecl):
+        if not decl.generic_params:
+            emit_class_decl(gen, decl)
+    elif isinstance(decl, FunctionDecl):
+        emit_function_decl(gen, decl)
+    elif isinstance(decl, VarDeclStmt):
+        # Top-level variable → global variable in C
+        c_type = type_to_c(decl.type) if decl.type else "int"
+        if decl.initializer:
+            from .expressions import lower_expr
+            from .statements import _quick_text
+            init_text = _quick_text(lower_expr(gen, decl.initializer))
+            gen.module.raw_sections.append(
+                f"static {c_type} {decl.name} = {init_text};")
+        else:
+            gen.module.raw_sections.append(
+                f"static {c_type} {decl.name};")
+    elif isinstance(decl, PreprocessorDirective):
+        text = decl.text.strip()
+        if text.startswith("#include"):
+            m = re.search(r'[<"]([^>"]+)[>"]', text)
+            if m:
+                gen.module.includes.append(m.group(1))
+            else:
+                gen.module.includes.append(text)
+        else:
+            gen.module.raw_sections.append(text)
+
+
+_worker_job = None  # (generator, declarations), inherited by forked workers
+
+
+def _lower_missing(index: int) -> _Record:
+    gen, missing = _worker_job
+    return lower_scoped(gen, missing[index])
+
+
+def _merge(gen: IRGenerator, record: _Record):
+    module, part = gen.module, record.module
+    for name in ("includes", "forward_decls"):
+        have = getattr(module, name)
+        seen = set(have)
+        have += [item for item in getattr(part, name) if item not in seen]
+    for name in _APPENDED:
+        getattr(module, name).extend(getattr(part, name))
+    gen._used_helpers |= record.helpers
+    for name, text in record.typedefs.items():
+        types._fn_ptr_typedefs.setdefault(name, text)
+    for key, method in record.parallel_methods.items():
+        gen.parallel_methods.setdefault(key, method)
+
+
+def _scoped(decl) -> bool:
+    return (isinstance(decl, FunctionDecl) and not decl.is_gpu) or (
+        isinstance(decl, ClassDecl) and not decl.generic_params)
+
+
+def _is_kernel(decl) -> bool:
+    return isinstance(decl, FunctionDecl) and decl.is_gpu
+
+
+# ---- Cache keys ----
+
+def _keys(gen: IRGenerator, decls: list, scoped: list) -> dict[int, str]:
+    """Cache key per scoped declaration, or {} when fingerprints are missing."""
+    prints = gen.decl_prints
+    if prints is None or any(id(d) not in prints for d in decls):
+        return {}
+    analyzed = gen.analyzed
+    shared = hashlib.sha256()
+    instances = sorted(mangle_generic_type(base, list(args))
+                       for base, all_args in analyzed.generic_instances.items()
+                       for args in all_args)
+    for part in ([prints[id(d)][1] for d in decls] + instances
+                 + sorted(gen.shared_rc_classes)
+                 + [repr(sorted(_summaries(gen).items())), str(gen.atomic_rc)]):
+        shared.update(part.encode("utf-8"))
+        shared.update(b"\0")
+    program = shared.hexdigest()
+    return {id(d): record_key(_KIND, prints[id(d)][0], program,
+                              _facts(d, analyzed.stack_objects, analyzed.arena_copies))
+            for d in scoped}
+
+
+def _facts(decl, stack_objects: set[int], arena_copies: set[int]) -> str:
+    """Preorder positions of the nodes in `decl` that analysis marked."""
+    marks = []
+    index = 0
+    stack = [decl]
+    while stack:
+        node = stack.pop()
+        if id(node) in stack_objects:
+            marks.append(f"s{index}")
+        if id(node) in arena_copies:
+            marks.append(f"a{index}")
+        index += 1
+        children = []
+        for name in node.__dataclass_fields__:
+            value = getattr(node, name)
+            if isinstance(value, list):
+                children += [v for v in value if hasattr(v, "__dataclass_fields__")]
+            elif hasattr(value, "__dataclass_fields__"):
+                children.append(value)
+        stack += reversed(children)
+    return " ".join(marks)
@@ -0,0 +1,173 @@
+"""Error-flag exception lowering (--exceptions=flag; the plan is throws.py).
+
+A throw in a flagged routine, outside any try, copies the message, sets
+`__btrc_pending`, releases the managed locals and returns a zero value.
+A call to a flagged routine is followed by a test of the flag:
+
+    f(x);
+    if (__btrc_pending) { <release>; goto __btrc_catch_N; }
+
+Inside a flag try the test (and any throw) releases what the try body
+opened and jumps to the catch; outside one, a flagged routine passes the
+exception on by returning, and any other code -- or a setjmp try -- turns
+it into a longjmp with __btrc_rethrow. A flag try is
+
+    if (1) {
+        <try body>
+    } else {
+    __btrc_catch_N:
+        __btrc_pending = 0;
+        const char* e = __btrc_error_msg;
+        <catch body>
+    }
+    <finally body>
+
+with no else branch when nothing in the body can throw.
+"""
+
+from __future__ import annotations
+
+from contextlib import contextmanager
+from dataclasses import dataclass
+from typing import TYPE_CHECKING
+
+from ..nodes import (
+    CType,
+    IRBlock,
+    IRCall,
+    IRExprStmt,
+    IRIf,
+    IRLiteral,
+    IRRawC,
+    IRRawExpr,
+    IRReturn,
+    IRStmt,
+    IRVar,
+    IRVarDecl,
+)
+from .arc import _emit_return_release
+from .throws import routine_key
+
+if TYPE_CHECKING:
+    from ...ast_nodes import CallExpr, ReturnStmt, TryCatchStmt
+    from .generator import IRGenerator
+
+
+@dataclass
+class FlagTry:
+    label: str
+    scopes: int  # managed scopes and arenas open outside the try body
+    arenas: int
+    jumps: int = 0
+
+
+@contextmanager
+def flag_routine(gen: IRGenerator, decl, ret_type: str):
+    """Lower `decl`'s body knowing whether it reports throws through the flag."""
+    plan = gen.throw_plan
+    saved = gen.flag_routine
+    gen.flag_routine = ret_type if plan and routine_key(decl) in plan.flagged else None
+    try:
+        yield
+    finally:
+        gen.flag_routine = saved
+
+
+def lower_flag_try(gen: IRGenerator, node: TryCatchStmt) -> list[IRStmt] | None:
+    """The try without setjmp, or None if it needs one."""
+    from .statements import lower_block
+    plan = gen.throw_plan
+    # Cleanups registered by an enclosing setjmp try would see our releases
+    if plan is None or id(node) not in plan.flag_tries or gen.in_try_depth > 0:
+        return None
+    ctx = FlagTry(label=gen.fresh_temp("__btrc_catch"),
+                  scopes=len(gen._managed_vars_stack), arenas=len(gen.arena_stack))
+    gen.flag_tries.append(ctx)
+    try_body = lower_block(gen, node.try_block)
+    gen.flag_tries.pop()
+    # Nothing in the body can throw: the catch is unreachable
+    catch_body = None
+    if ctx.jumps:
+        catch_body = lower_block(gen, node.catch_block)
+        if node.catch_var:
+            catch_body.stmts.insert(0, IRVarDecl(
+                c_type=CType(text="const char*"), name=node.catch_var,
+                init=IRVar(name="__btrc_error_msg")))
+        catch_body.stmts.insert(0, IRRawC(
+            text=f"{ctx.label}:\n__btrc_pending = 0;", helper_refs=["__btrc_pending"]))
+    stmts: list[IRStmt] = [IRIf(condition=IRLiteral(text="1"),
+                                then_block=try_body, else_block=catch_body)]
+    if node.finally_block:
+        stmts.extend(lower_block(gen, node.finally_block).stmts)
+    return stmts
+
+
+def lower_flag_throw(gen: IRGenerator, message) -> list[IRStmt] | None:
+    """`throw message` through the flag, or None if it must longjmp."""
+    if gen.throw_plan is None:
+        return None
+    exit_stmts = _leave(gen)
+    if exit_stmts is None:
+        return None
+    gen.use_helper("__btrc_raise")
+    return [IRExprStmt(expr=IRCall(callee="__btrc_raise", args=[message],
+                                   helper_ref="__btrc_raise"))] + exit_stmts
+
+
+def check_call(gen: IRGenerator, call: CallExpr, stmts: list[IRStmt]) -> list[IRStmt]:
+    """`stmts` (a call statement), then the flag test if `call` may raise it."""
+    plan = gen.throw_plan
+    if plan is None or not plan.checked(call):
+        return stmts
+    return stmts + [_test(gen)]
+
+
+def lower_checked_return(gen: IRGenerator, node: ReturnStmt) -> list[IRStmt] | None:
+    """`return f(...)` with the flag tested before the locals are released."""
+    from .expressions import lower_expr
+    from .types import type_to_c
+    plan = gen.throw_plan
+    if plan is None or not plan.checked(node.value):
+        return None
+    ret_type = gen.analyzed.node_types.get(id(node.value))
+    if ret_type is None:
+        return None
+    tmp = gen.fresh_temp("__ret")
+    decl = IRVarDecl(c_type=CType(text=type_to_c(ret_type)), name=tmp,
+                     init=lower_expr(gen, node.value))
+    return ([decl, _test(gen)] + _emit_return_release(gen, None)
+            + [IRReturn(value=IRVar(name=tmp))])
+
+
+def _test(gen: IRGenerator) -> IRIf:
+    exit_stmts = _leave(gen)
+    if exit_stmts is None:
+        gen.use_helper("__btrc_rethrow")
+        exit_stmts = [IRExprStmt(expr=IRCall(callee="__btrc_rethrow", args=[],
+                                             helper_ref="__btrc_rethrow"))]
+    gen.use_helper("__btrc_pending")
+    return IRIf(condition=IRRawExpr(text="__btrc_pending"),
+                then_block=IRBlock(stmts=exit_stmts))
+
+
+def _leave(gen: IRGenerator) -> list[IRStmt] | None:
+    """Leave for the catch or the caller with the flag set, or None when
+    only a longjmp reaches the handler."""
+    if gen.flag_tries:
+        ctx = gen.flag_tries[-1]
+        if ctx is None:
+            return None  # a setjmp try
+        ctx.jumps += 1
+        return _unwind(gen, ctx.scopes, ctx.arenas) + [IRRawC(text=f"goto {ctx.label};")]
+    if gen.flag_routine is None:
+        return None
+    value = None if gen.flag_routine == "void" else IRRawExpr(text=f"({gen.flag_routine}){{0}}")
+    return _unwind(gen, 0, 0) + [IRReturn(value=value)]
+
+
+def _unwind(gen: IRGenerator, scopes: int, arenas: int) -> list[IRStmt]:
+    stmts = _emit_return_release(gen, None, scopes)
+    for name in reversed(gen.arena_stack[arenas:]):
+        stmts.append(IRExprStmt(expr=IRCall(callee="__btrc_arena_free", args=[IRVar(name=name)],
+                                            helper_ref="__btrc_arena")))
+    return stmts
@@ -56,6 +56,15 @@ if TYPE_CHECKING:
 
 def lower_expr(gen: IRGenerator, node) -> IRExpr:
     """Lower an AST expression node to an IRExpr."""
+    if (gen.arena_stack and id(node) in gen.analyzed.arena_copies
+            and not isinstance(node, AssignExpr)):
+        # Arena string flowing out of its block (analyzer/arena.py)
+        from .arena import copy_out
+        return copy_out(gen, _lower_expr_node(gen, node))
+    return _lower_expr_node(gen, node)
+
+
+def _lower_expr_node(gen: IRGenerator, node) -> IRExpr:
     if node is None:
         return IRLiteral(text="0")
 
@@ -7,6 +7,7 @@ from typing import TYPE_CHECKING
 from ...ast_nodes import (
     AssignExpr,
     BraceInitializer,
+    CallExpr,
     FieldAccessExpr,
     Identifier,
     IndexExpr,
@@ -28,6 +29,7 @@ from ..nodes import (
     IRUnaryOp,
     IRVar,
 )
+from .arena import track_string
 from .types import is_generic_class_type, is_string_type, mangle_generic_type
 
 if TYPE_CHECKING:
@@ -165,8 +167,12 @@ def get_field_assign_arc_stmts(gen: IRGenerator, node: AssignExpr
         )]),
     ))
 
-    # POST: rc++ on new value — skip if value is `new` (already rc=1 from ctor)
-    if not isinstance(node.value, NewExpr):
+    # POST: rc++ on new value — skip if value is `new` or a constructor call
+    # (already rc=1 from ctor)
+    fresh = isinstance(node.value, NewExpr) or (
+        isinstance(node.value, CallExpr) and isinstance(node.value.callee, Identifier)
+        and node.value.callee.name in gen.analyzed.class_table)
+    if not fresh:
         value_ir = lower_expr(gen, node.value)
         post.append(IRExprStmt(expr=IRUnaryOp(
             op="++",
@@ -230,10 +236,11 @@ def _lower_assign(gen: IRGenerator, node: AssignExpr) -> IRExpr:
         if (isinstance(node.value, CallExpr)
                 and isinstance(node.value.callee, Identifier)
                 and is_gpu_function(gen, node.value.callee.name)):
-            from ..nodes import IRGpuDispatch
+            from ..nodes_gpu import IRGpuDispatch
             target = lower_expr(gen, node.target)
             value = lower_expr(gen, node.value)
-            if isinstance(value, IRGpuDispatch) and value.output_buffer:
+            if (isinstance(value, IRGpuDispatch) and value.output_buffer
+                    and not value.output_buffer.resident):
                 from .statements import _quick_text
                 value.assign_target = _quick_text(target)
                 return value  # Emitter handles memcpy readback
@@ -244,12 +251,12 @@ def _lower_assign(gen: IRGenerator, node: AssignExpr) -> IRExpr:
     # String += → target = __btrc_str_track(__btrc_strcat(target, value))
     if node.op == "+=" and is_string_type(gen.analyzed.node_types.get(id(node.target))):
         gen.use_helper("__btrc_strcat")
-        gen.use_helper("__btrc_str_track")
         cat = IRCall(callee="__btrc_strcat", args=[target, value],
                      helper_ref="__btrc_strcat")
-        tracked = IRCall(callee="__btrc_str_track", args=[cat],
-                         helper_ref="__btrc_str_track")
-        return IRBinOp(left=target, op="=", right=tracked)
+        # An arena block appending to a string that outlives it keeps the
+        # result in the global pool
+        escapes = id(node) in gen.analyzed.arena_copies
+        return IRBinOp(left=target, op="=", right=track_string(gen, cat, escapes))
 
     if node.op == "=":
         return IRBinOp(left=target, op="=", right=value)
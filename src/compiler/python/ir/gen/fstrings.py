@@ -16,7 +16,6 @@ from ..nodes import (
     CType,
     IRBinOp,
     IRCall,
-    IRCast,
     IRExpr,
     IRExprStmt,
     IRLiteral,
@@ -24,6 +23,7 @@ from ..nodes import (
     IRVar,
     IRVarDecl,
 )
+from .arena import string_buffer
 from .types import format_spec_for_type
 
 if TYPE_CHECKING:
@@ -37,8 +37,9 @@ def lower_fstring(gen: IRGenerator, node: FStringLiteral) -> IRExpr:
         int __len = snprintf(NULL, 0, "fmt", args...);
         char* __buf = __btrc_str_track((char*)malloc(__len + 1));
         snprintf(__buf, __len + 1, "fmt", args...);
+
+    Inside an arena block the buffer is bump-allocated from the arena.
     """
-    gen.use_helper("__btrc_str_track")
 
     # Build the format string and collect arguments
     fmt_parts = []
@@ -112,10 +113,7 @@ def lower_fstring(gen: IRGenerator, node: FStringLiteral) -> IRExpr:
         # char* __buf = __btrc_str_track((char*)malloc(__len + 1));
         IRVarDecl(
             c_type=CType(text="char*"), name=buf_var,
-            init=IRCall(callee="__btrc_str_track", args=[
-                IRCast(target_type=CType(text="char*"),
-                       expr=IRCall(callee="malloc", args=[len_plus_1])),
-            ]),
+            init=string_buffer(gen, len_plus_1),
         ),
         # snprintf(__buf, __len + 1, "fmt", args...);
         IRExprStmt(expr=IRCall(
@@ -33,9 +33,11 @@ def emit_function_decl(gen: IRGenerator, decl: FunctionDecl):
         gen.module.forward_decls.append(f"{ret_type} {decl.name}({param_str});")
         return
 
+    from .error_flag import flag_routine
     from .statements import lower_block
     gen._func_var_decls = []
-    body = lower_block(gen, decl.body)
+    with flag_routine(gen, decl, ret_type):
+        body = lower_block(gen, decl.body)
 
     # Special handling for main: ensure it returns int
     name = decl.name
@@ -5,11 +5,12 @@ Walks AnalyzedProgram → IRModule. All lowering happens here and in sub-modules
 
 from __future__ import annotations
 
+from typing import TYPE_CHECKING
+
 from ...analyzer.core import AnalyzedProgram, ClassInfo
 from ...ast_nodes import (
     ClassDecl,
     FunctionDecl,
-    PreprocessorDirective,
     StructDecl,
     TypeExpr,
 )
@@ -21,6 +22,11 @@ from ..nodes import (
 )
 from .types import is_concrete_instance, mangle_generic_type, type_to_c
 
+if TYPE_CHECKING:
+    from ...unit_cache import DeclPrint
+    from .error_flag import FlagTry
+    from .throws import ThrowPlan
+
 _STANDARD_INCLUDES = [
     "stdio.h", "stdlib.h", "string.h", "stdbool.h", "stdint.h",
     "ctype.h", "math.h", "assert.h", "limits.h",
@@ -31,12 +37,28 @@ class IRGenerator:
     """Walks an analyzed AST and produces an IRModule."""
 
     def __init__(self, analyzed: AnalyzedProgram, *,
-                 debug: bool = False, source_file: str = ""):
+                 debug: bool = False, source_file: str = "",
+                 atomic_rc: bool = False, exceptions: str = "setjmp",
+                 decl_prints: dict[int, DeclPrint] | None = None,
+                 use_cache: bool = False, jobs: int = 1):
         self.analyzed = analyzed
         self.debug = debug
+        # Per-declaration IR cache and parallel lowering (decl_cache.py)
+        self.decl_prints = decl_prints
+        self.use_cache = use_cache
+        self.jobs = jobs
+        # ARC: atomic __rc for every class (--atomic-rc), or only for the
+        # classes reachable from spawn captures (see shared_rc.py)
+        self.atomic_rc = atomic_rc
+        self.shared_rc_classes: set[str] = set()
+        # Vector<T>.par*() methods called: "mangled_method" → (mangled,
+        # method, element type), emitted after the declarations (parallel.py)
+        self.parallel_methods: dict[str, tuple[str, str, TypeExpr]] = {}
         self.source_file = source_file
         self.module = IRModule()
         self._lambda_counter = 0
+        # Prefix of lambda IDs: the name of the declaration being lowered
+        self._lambda_scope = ""
         self._temp_counter = 0
         # Track which helpers are needed
         self._used_helpers: set[str] = set()
@@ -49,8 +71,21 @@ class IRGenerator:
         # Stack of sets — each set contains (var_name, class_type_name) tuples
         # for variables auto-managed in the current scope
         self._managed_vars_stack: list[list[tuple[str, str]]] = []
-        # Exception safety: tracks nesting depth of try blocks
+        # Arena blocks: C names of the open arenas, innermost last (arena.py)
+        self.arena_stack: list[str] = []
+        # String temp scopes: per enclosing loop, its iteration mark or None
+        # when the body is not flushed (string_scopes.py)
+        self.str_marks: list[str | None] = []
+        # Exception safety: tracks nesting depth of (setjmp) try blocks
         self.in_try_depth: int = 0
+        # --exceptions=flag: the whole-program plan (throws.py), the try
+        # bodies being lowered (a FlagTry, or None for a setjmp try) and the
+        # C return type of the routine if it throws through the flag
+        # (error_flag.py)
+        self.exceptions = exceptions
+        self.throw_plan: ThrowPlan | None = None
+        self.flag_tries: list[FlagTry | None] = []
+        self.flag_routine: str | None = None
         # setjmp/longjmp volatile: tracks IRVarDecls in current function
         # so _lower_try_catch can retroactively mark preceding ones volatile
         self._func_var_decls: list = []
@@ -58,16 +93,22 @@ class IRGenerator:
         # Maps fn_ptr variable name → env variable name
         self._fn_ptr_envs: dict[str, str] = {}
         # Last lambda ID assigned (for linking lambda to var decl)
-        self._last_lambda_id: int = 0
+        self._last_lambda_id: str = ""
 
     def generate(self) -> IRModule:
         """Generate the complete IR module from the analyzed program."""
+        from .shared_rc import collect_shared_classes
+        self.shared_rc_classes = collect_shared_classes(self)
+        if self.exceptions == "flag":
+            from .throws import plan_throws
+            self.throw_plan = plan_throws(self)
         self._emit_includes()
         self._emit_forward_decls()
         self._emit_structs()
         self._emit_generic_collections()
         self._emit_enums()
         self._emit_declarations()
+        self._emit_parallel_methods()
         self._emit_fn_ptr_typedefs()
         self._emit_helpers()
         return self.module
@@ -77,10 +118,10 @@ class IRGenerator:
         self._temp_counter += 1
         return f"{prefix}_{self._temp_counter}"
 
-    def fresh_lambda_id(self) -> int:
+    def fresh_lambda_id(self) -> str:
         """Generate a unique lambda ID."""
         self._lambda_counter += 1
-        return self._lambda_counter
+        return f"{self._lambda_scope}{self._lambda_counter}"
 
     def use_helper(self, name: str):
         """Mark a runtime helper as used."""
@@ -103,10 +144,11 @@ class IRGenerator:
         if self._managed_vars_stack:
             self._managed_vars_stack[-1].append((var_name, class_type))
 
-    def get_all_managed_vars(self) -> list[tuple[str, str]]:
-        """Get all managed vars across all active scopes (for return/break)."""
+    def get_all_managed_vars(self, since: int = 0) -> list[tuple[str, str]]:
+        """Get all managed vars across all active scopes (for return/break),
+        or across the scopes from depth `since` on."""
         result = []
-        for scope in self._managed_vars_stack:
+        for scope in self._managed_vars_stack[since:]:
             result.extend(scope)
         return result
 
@@ -116,6 +158,7 @@ class IRGenerator:
         for inc in _STANDARD_INCLUDES:
             self.module.includes.append(inc)
         # Check if try/catch is used
+        from .control_flow import _uses_trycatch
         for decl in self.analyzed.program.declarations:
             if _uses_trycatch(decl):
                 self.module.includes.append("setjmp.h")
@@ -176,38 +219,12 @@ class IRGenerator:
 
     def _emit_declarations(self):
         """Emit classes, functions, and other top-level declarations."""
-        from ...ast_nodes import VarDeclStmt
-        from .classes import emit_class_decl
-        from .functions import emit_function_decl
-        for decl in self.analyzed.program.declarations:
-            if isinstance(decl, ClassDecl):
-                if not decl.generic_params:
-                    emit_class_decl(self, decl)
-            elif isinstance(decl, FunctionDecl):
-                emit_function_decl(self, decl)
-            elif isinstance(decl, VarDeclStmt):
-                # Top-level variable → global variable in C
-                c_type = type_to_c(decl.type) if decl.type else "int"
-                if decl.initializer:
-                    from .expressions import lower_expr
-                    from .statements import _quick_text
-                    init_text = _quick_text(lower_expr(self, decl.initializer))
-                    self.module.raw_sections.append(
-                        f"static {c_type} {decl.name} = {init_text};")
-                else:
-                    self.module.raw_sections.append(
-                        f"static {c_type} {decl.name};")
-            elif isinstance(decl, PreprocessorDirective):
-                text = decl.text.strip()
-                if text.startswith("#include"):
-                    import re
-                    m = re.search(r'[<"]([^>"]+)[>"]', text)
-                    if m:
-                        self.module.includes.append(m.group(1))
-                    else:
-                        self.module.includes.append(text)
-                else:
-                    self.module.raw_sections.append(text)
+        from .decl_cache import lower_declarations
+        lower_declarations(self)
+
+    def _emit_parallel_methods(self):
+        from .parallel import emit_parallel_methods
+        emit_parallel_methods(self)
 
     def _emit_fn_ptr_typedefs(self):
         """Emit function pointer typedefs accumulated during code generation."""
@@ -265,104 +282,18 @@ class IRGenerator:
 
 
 def generate_ir(analyzed: AnalyzedProgram, *,
-                debug: bool = False, source_file: str = "") -> IRModule:
+                debug: bool = False, source_file: str = "",
+                atomic_rc: bool = False, exceptions: str = "setjmp",
+                decl_prints: dict[int, DeclPrint] | None = None,
+                use_cache: bool = False, jobs: int = 1) -> IRModule:
     """Generate an IR module from an analyzed program.
 
     This is the main entry point for the IR generation pipeline.
+    `decl_prints` (from unit_cache.py) enables the per-declaration IR
+    cache when `use_cache` is set; `jobs` > 1 lowers in parallel.
+    `exceptions` is "setjmp" or "flag" (see throws.py).
     """
-    gen = IRGenerator(analyzed, debug=debug, source_file=source_file)
+    gen = IRGenerator(analyzed, debug=debug, source_file=source_file,
+                      atomic_rc=atomic_rc, exceptions=exceptions, decl_prints=decl_prints,
+                      use_cache=use_cache, jobs=jobs)
     return gen.generate()
-
-
-def _uses_trycatch(decl) -> bool:
-    """Check if a declaration uses try/catch (simple scan)."""
-    if isinstance(decl, (ClassDecl, FunctionDecl)):
-        return _block_uses_trycatch(getattr(decl, 'body', None))
-    return False
-
-
-def _block_uses_trycatch(block) -> bool:
-    from ...ast_nodes import (
-        Block,
-        CForStmt,
-        DoWhileStmt,
-        ElseBlock,
-        ElseIf,
-        ForInStmt,
-        IfStmt,
-        SwitchStmt,
-        ThrowStmt,
-        TryCatchStmt,
-        WhileStmt,
-    )
-    if block is None:
-        return False
-    if isinstance(block, Block):
-        for s in block.statements:
-            if isinstance(s, (TryCatchStmt, ThrowStmt)):
-                return True
-            if isinstance(s, IfStmt):
-                if _block_uses_trycatch(s.then_block):
-                    return True
-                if s.else_block:
-                    if isinstance(s.else_block, ElseBlock):
-                        if _block_uses_trycatch(s.else_block.body):
-                            return True
-                    elif isinstance(s.else_block, ElseIf):
-                        if _stmt_uses_trycatch(s.else_block.if_stmt):
-                            return True
-            elif isinstance(s, (WhileStmt, DoWhileStmt, ForInStmt, CForStmt)):
-                if _block_uses_trycatch(s.body):
-                    return True
-            elif isinstance(s, SwitchStmt):
-                for case in s.cases:
-                    for cs in case.body:
-                        if isinstance(cs, (TryCatchStmt, ThrowStmt)):
-                            return True
-                        if _stmt_uses_trycatch(cs):
-                            return True
-            elif isinstance(s, TryCatchStmt):
-                if _block_uses_trycatch(s.try_block):
-                    return True
-                if _block_uses_trycatch(s.catch_block):
-                    return True
-                if _block_uses_trycatch(s.finally_block):
-                    return True
-    return False
-
-
-def _stmt_uses_trycatch(s) -> bool:
-    """Check if a single statement (or nested if) uses try/catch."""
-    from ...ast_nodes import (
-        CForStmt,
-        DoWhileStmt,
-        ElseBlock,
-        ElseIf,
-        ForInStmt,
-        IfStmt,
-        SwitchStmt,
-        ThrowStmt,
-        TryCatchStmt,
-        WhileStmt,
-    )
-    if isinstance(s, (TryCatchStmt, ThrowStmt)):
-        return True
-    if isinstance(s, IfStmt):
-        if _block_uses_trycatch(s.then_block):
-            return True
-        if s.else_block:
-            if isinstance(s.else_block, ElseBlock):
-                if _block_uses_trycatch(s.else_block.body):
-                    return True
-            elif isinstance(s.else_block, ElseIf):
-                if _stmt_uses_trycatch(s.else_block.if_stmt):
-                    return True
-    elif isinstance(s, (WhileStmt, DoWhileStmt, ForInStmt, CForStmt)):
-        if _block_uses_trycatch(s.body):
-            return True
-    elif isinstance(s, SwitchStmt):
-        for case in s.cases:
-            for cs in case.body:
-                if _stmt_uses_trycatch(cs):
-                    return True
-    return False
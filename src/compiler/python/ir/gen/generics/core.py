@@ -88,7 +88,7 @@ _GENERIC_MACROS = (
     "#define __btrc_hash(k) __builtin_choose_expr( \\\n"
     "    __builtin_types_compatible_p(__typeof__(k), char*), \\\n"
     "    __btrc_hash_str((const char*)(void*)(intptr_t)(k)), \\\n"
-    "    (unsigned int)(intptr_t)(k))"
+    "    __btrc_hash_int((uint64_t)(intptr_t)(k)))"
 )
 
 
@@ -101,4 +101,5 @@ def _emit_generic_macros(gen: IRGenerator):
     )
     if has_generics:
         gen.use_helper("__btrc_hash_str")
+        gen.use_helper("__btrc_hash_int")
         gen.module.raw_sections.append(_GENERIC_MACROS)
@@ -0,0 +1,224 @@
+"""Vector higher-order methods specialized per lambda literal.
+
+`v.map(fn)` normally calls btrc_Vector_T_map, which invokes `fn` through
+a function pointer for every element. When the argument is a lambda
+literal, each call site instead gets its own copy of the method:
+
+    v.map((int x) => x * k)
+ →  static btrc_Vector_int* btrc_Vector_int_map__lambda_N(btrc_Vector_int* __self, int k) {
+        ...
+        for (int __i = 0; __i < __self->len; __i++) {
+            int x = __self->data[__i];
+            __result->data[__i] = (x * k);
+        }
+        return __result;
+    }
+    btrc_Vector_int_map__lambda_N(v, k)
+
+Expression-bodied lambdas are lowered straight into the loop; block
+bodies become a static function taking the element and the captures,
+called directly (no pointer), which the C compiler can inline. Captures
+are passed by value as trailing arguments, the same values a capturing
+lambda's env struct would hold.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ....ast_nodes import LambdaBlock, LambdaExpr, TypeExpr
+from ...nodes import (
+    CType,
+    IRAssign,
+    IRBinOp,
+    IRBlock,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRExprStmt,
+    IRFor,
+    IRFunctionDef,
+    IRIf,
+    IRIndex,
+    IRLiteral,
+    IRParam,
+    IRReturn,
+    IRSizeof,
+    IRStmt,
+    IRUnaryOp,
+    IRVar,
+    IRVarDecl,
+)
+from ..lambdas import lower_lambda, separate_function
+from ..shorthands import _arrow, _v
+from ..types import mangle_generic_type, type_to_c
+
+if TYPE_CHECKING:
+    from ..generator import IRGenerator
+
+INLINED_METHODS = ("map", "filter", "findIndex", "forEach", "any", "all", "reduce")
+
+
+def is_inlinable(obj_type: TypeExpr | None, method_name: str, arg_nodes: list) -> bool:
+    return (obj_type is not None and obj_type.base == "Vector"
+            and bool(obj_type.generic_args) and method_name in INLINED_METHODS
+            and bool(arg_nodes) and isinstance(arg_nodes[-1], LambdaExpr))
+
+
+def lower_inlined_call(gen: IRGenerator, obj: IRExpr, method_name: str,
+                       obj_type: TypeExpr, arg_nodes: list) -> IRExpr:
+    """Emit the specialization for this lambda and call it."""
+    from ..expressions import lower_expr
+    lam: LambdaExpr = arg_nodes[-1]
+    leading = [lower_expr(gen, a) for a in arg_nodes[:-1]]  # reduce's init
+    mangled = mangle_generic_type("Vector", obj_type.generic_args)
+    elem_c = type_to_c(obj_type.generic_args[0])
+    caps = [(type_to_c(c.type) if c.type else "int", c.name) for c in lam.captures]
+
+    name = f"{mangled}_{method_name}__lambda_{gen.fresh_lambda_id()}"
+    params = [IRParam(c_type=CType(text=f"{mangled}*"), name="__self")]
+    if method_name == "reduce":
+        params.append(IRParam(c_type=CType(text=elem_c), name="__init"))
+    params += [IRParam(c_type=CType(text=c), name=n) for c, n in caps]
+
+    if method_name == "map":
+        gen.use_helper("__btrc_safe_realloc")
+    prologue: list[IRStmt] = []
+    vec = _Source(_arrow(_v("__self"), "len"), _arrow(_v("__self"), "data"))
+    if not isinstance(lam.body, LambdaBlock):
+        # Read len/data once so the loop has no reloads through __self and
+        # can be vectorized; as with par*, the lambda must not resize the vector
+        prologue = [IRVarDecl(c_type=CType(text="int"), name="__n", init=vec.n),
+                    IRVarDecl(c_type=CType(text=f"{elem_c}*"), name="__data", init=vec.data)]
+        vec = _Source(_v("__n"), _v("__data"))
+    with separate_function(gen):
+        apply = _applier(gen, lam, elem_c)
+        ret_c, body = _BODIES[method_name](mangled, elem_c, apply, vec)
+    body = prologue + body
+    gen.module.function_defs.append(IRFunctionDef(
+        name=name, return_type=CType(text=ret_c), params=params,
+        body=IRBlock(stmts=body), is_static=True))
+    param_text = ", ".join(f"{p.c_type} {p.name}" for p in params)
+    gen.module.raw_sections.append(f"static {ret_c} {name}({param_text});")
+    return IRCall(callee=name, args=[obj] + leading + [IRVar(name=n) for _, n in caps])
+
+
+def _applier(gen: IRGenerator, lam: LambdaExpr, elem_c: str):
+    """apply(args) -> (statements, value) evaluating the lambda on `args`."""
+    from ..expressions import lower_expr
+    if isinstance(lam.body, LambdaBlock):
+        fn = lower_lambda(gen, lam, captures_as_params=True).text
+        caps = [IRVar(name=c.name) for c in lam.captures]
+        return lambda args: ([], IRCall(callee=fn, args=list(args) + caps))
+
+    def apply(args):
+        stmts: list[IRStmt] = []
+        for p, a in zip(lam.params, args):
+            c_type = type_to_c(p.type) if p.type else elem_c
+            stmts.append(IRVarDecl(c_type=CType(text=c_type), name=p.name, init=a))
+        return stmts, lower_expr(gen, lam.body.expression)
+    return apply
+
+
+# --- Per-method bodies: (return C type, statements) ---
+
+def _map(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    n = vec.n
+    size = IRBinOp(left=IRSizeof(operand=elem_c), op="*",
+                   right=IRBinOp(left=n, op="+", right=IRLiteral(text="1")))
+    return f"{mangled}*", [
+        IRVarDecl(c_type=CType(text=f"{mangled}*"), name="__result",
+                  init=IRCall(callee=f"{mangled}_new")),
+        # Sized up front so the loop is plain stores, not push() calls
+        IRIf(condition=IRBinOp(left=n, op=">", right=IRLiteral(text="0")),
+             then_block=IRBlock(stmts=[
+                 IRAssign(target=_arrow(_v("__result"), "data"),
+                          value=IRCast(target_type=CType(text=f"{elem_c}*"), expr=IRCall(
+                              callee="__btrc_safe_realloc",
+                              args=[IRLiteral(text="NULL"), size],
+                              helper_ref="__btrc_safe_realloc"))),
+                 IRAssign(target=_arrow(_v("__result"), "cap"), value=n),
+                 IRAssign(target=_arrow(_v("__result"), "len"), value=n),
+             ])),
+        IRVarDecl(c_type=CType(text=f"{elem_c}*"), name="__out",
+                  init=_arrow(_v("__result"), "data")),
+        vec.loop(stmts + [IRAssign(target=IRIndex(obj=_v("__out"), index=_v("__i")),
+                                   value=value)]),
+        IRReturn(value=_v("__result")),
+    ]
+
+
+def _filter(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    push = IRExprStmt(expr=IRCall(callee=f"{mangled}_push",
+                                  args=[_v("__result"), vec.at()]))
+    return f"{mangled}*", [
+        IRVarDecl(c_type=CType(text=f"{mangled}*"), name="__result",
+                  init=IRCall(callee=f"{mangled}_new")),
+        vec.loop(stmts + [IRIf(condition=value, then_block=IRBlock(stmts=[push]))]),
+        IRReturn(value=_v("__result")),
+    ]
+
+
+def _find_index(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    return "int", [
+        vec.loop(stmts + [IRIf(condition=value,
+                            then_block=IRBlock(stmts=[IRReturn(value=_v("__i"))]))]),
+        IRReturn(value=IRLiteral(text="-1")),
+    ]
+
+
+def _for_each(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    return "void", [vec.loop(stmts + [IRExprStmt(expr=value)])]
+
+
+def _any(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    return "bool", [
+        vec.loop(stmts + [IRIf(condition=value,
+                            then_block=IRBlock(stmts=[IRReturn(value=IRLiteral(text="true"))]))]),
+        IRReturn(value=IRLiteral(text="false")),
+    ]
+
+
+def _all(mangled, elem_c, apply, vec):
+    stmts, value = apply([vec.at()])
+    return "bool", [
+        vec.loop(stmts + [IRIf(condition=IRUnaryOp(op="!", operand=value),
+                            then_block=IRBlock(stmts=[IRReturn(value=IRLiteral(text="false"))]))]),
+        IRReturn(value=IRLiteral(text="true")),
+    ]
+
+
+def _reduce(mangled, elem_c, apply, vec):
+    stmts, value = apply([_v("__acc"), vec.at()])
+    return elem_c, [
+        IRVarDecl(c_type=CType(text=elem_c), name="__acc", init=_v("__init")),
+        vec.loop(stmts + [IRAssign(target=_v("__acc"), value=value)]),
+        IRReturn(value=_v("__acc")),
+    ]
+
+
+_BODIES = {"map": _map, "filter": _filter, "findIndex": _find_index,
+           "forEach": _for_each, "any": _any, "all": _all, "reduce": _reduce}
+
+
+class _Source:
+    """The vector being iterated: its length and data expressions."""
+
+    def __init__(self, n: IRExpr, data: IRExpr):
+        self.n = n
+        self.data = data
+
+    def at(self) -> IRIndex:
+        return IRIndex(obj=self.data, index=_v("__i"))
+
+    def loop(self, body: list[IRStmt]) -> IRFor:
+        return IRFor(
+            init=IRVarDecl(c_type=CType(text="int"), name="__i", init=IRLiteral(text="0")),
+            condition=IRBinOp(left=_v("__i"), op="<", right=self.n),
+            update=IRUnaryOp(op="++", operand=_v("__i"), prefix=False),
+            body=IRBlock(stmts=body))
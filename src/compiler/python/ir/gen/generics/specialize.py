@@ -0,0 +1,116 @@
+"""Per-instance method specializations chosen at monomorphization time.
+
+A generic method body is written once in the stdlib, but some element
+types have a much faster algorithm that the generic body cannot express.
+specialized_prologue() returns statements placed in front of the generic
+body for one instance; they handle the fast case and return early.
+specialized_body() replaces a body outright, keeping only its leading
+guards (the empty and length-mismatch checks). has_method() drops the
+arithmetic methods from instances whose element type has no arithmetic.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ...helpers.numeric import NUMERIC_TYPES
+from ...nodes import (
+    IRBinOp,
+    IRBlock,
+    IRCall,
+    IRExprStmt,
+    IRFieldAccess,
+    IRIf,
+    IRLiteral,
+    IRReturn,
+    IRStmt,
+    IRVar,
+)
+
+if TYPE_CHECKING:
+    from ..generator import IRGenerator
+
+# Vector<T>.sort(): LSD radix sort for 32-bit keys. Below the cutoff the
+# introsort's insertion-sort runs beat the fixed cost of the radix passes.
+RADIX_SORTS = {"int": "__btrc_radix_sort_int", "float": "__btrc_radix_sort_float"}
+_RADIX_CUTOFF = 256
+
+
+# Vector methods that add or multiply elements, and the C element types
+# they are declared and defined for
+_ARITHMETIC_METHODS = {"sum", "dot", "axpy", "scale", "add"}
+_ARITHMETIC_C = {"int", "long", "short", "unsigned int", "unsigned char",
+                 "size_t", "char", "bool", "float", "double"}
+
+
+def has_method(base_name: str, method_name: str, elem_c: str) -> bool:
+    """Does the `base_name<elem_c>` instance get `method_name` at all?"""
+    return not (base_name == "Vector" and method_name in _ARITHMETIC_METHODS
+                and elem_c not in _ARITHMETIC_C)
+
+
+def specialized_prologue(gen: IRGenerator, base_name: str, method_name: str,
+                         elem_c: str) -> list[IRStmt]:
+    """Fast-path statements for `base_name<elem_c>.method_name`, or []."""
+    if base_name == "Vector" and method_name == "sort" and elem_c in RADIX_SORTS:
+        helper = RADIX_SORTS[elem_c]
+        gen.use_helper(helper)
+        length = IRFieldAccess(obj=IRVar(name="self"), field="len", arrow=True)
+        data = IRFieldAccess(obj=IRVar(name="self"), field="data", arrow=True)
+        return [IRIf(
+            condition=IRBinOp(left=length, op=">=",
+                              right=IRLiteral(text=str(_RADIX_CUTOFF))),
+            then_block=IRBlock(stmts=[
+                IRExprStmt(expr=IRCall(callee=helper, args=[data, length],
+                                       helper_ref=helper)),
+                IRReturn(),
+            ]))]
+    return []
+
+
+# Vector/Array method -> (numeric helper stem, arguments, result). An
+# argument "x.f" is x->f; "found" turns an index into a bool.
+_BULK_METHODS = {
+    "sum": ("sum", ["self.data", "self.len"], "return"),
+    "min": ("min", ["self.data", "self.len"], "return"),
+    "max": ("max", ["self.data", "self.len"], "return"),
+    "fill": ("fill", ["self.data", "self.len", "val"], "call"),
+    "contains": ("index", ["self.data", "self.len", "val"], "found"),
+    "indexOf": ("index", ["self.data", "self.len", "val"], "return"),
+    "count": ("count", ["self.data", "self.len", "val"], "return"),
+    "dot": ("dot", ["self.data", "other.data", "self.len"], "return"),
+    "scale": ("scale", ["self.data", "self.len", "a"], "call"),
+    "axpy": ("axpy", ["self.data", "x.data", "self.len", "a"], "call"),
+    "add": ("add", ["self.data", "other.data", "self.len"], "call"),
+}
+
+
+def _bulk_arg(text: str):
+    if "." not in text:
+        return IRVar(name=text)
+    obj, field = text.split(".")
+    return IRFieldAccess(obj=IRVar(name=obj), field=field, arrow=True)
+
+
+def specialized_body(gen: IRGenerator, base_name: str, method_name: str,
+                     elem_c: str, body: list[IRStmt]) -> list[IRStmt]:
+    """`body` with its loop replaced by a numeric bulk-op helper (see
+    ir/helpers/numeric.py) when the element type is a primitive number."""
+    if (base_name not in ("Vector", "Array") or method_name not in _BULK_METHODS
+            or elem_c not in NUMERIC_TYPES):
+        return body
+    stem, args, result = _BULK_METHODS[method_name]
+    helper = f"__btrc_vec_{stem}_{NUMERIC_TYPES[elem_c]}"
+    gen.use_helper(helper)
+    call = IRCall(callee=helper, args=[_bulk_arg(a) for a in args],
+                  helper_ref=helper)
+    guards = []
+    for stmt in body:
+        if not isinstance(stmt, IRIf):
+            break
+        guards.append(stmt)
+    if result == "call":
+        return guards + [IRExprStmt(expr=call)]
+    if result == "found":
+        call = IRBinOp(left=call, op=">=", right=IRLiteral(text="0"))
+    return guards + [IRReturn(value=call)]
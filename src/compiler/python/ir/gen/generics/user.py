@@ -6,6 +6,7 @@ from typing import TYPE_CHECKING
 
 from ....ast_nodes import TypeExpr
 from ...nodes import CType, IRStructDef, IRStructField
+from ..shared_rc import rc_field_type
 from ..types import mangle_generic_type, type_to_c
 from .core import _resolve_type
 from .user_methods import _emit_user_generic_methods
@@ -93,7 +94,7 @@ def _emit_user_generic_instance(gen: IRGenerator, base_name: str,
         gen.module.forward_decls.append(fwd)
 
     # Emit struct with resolved types (ARC: __rc as first field)
-    fields = [IRStructField(c_type=CType(text="int"), name="__rc")]
+    fields = [IRStructField(c_type=rc_field_type(gen, mangled), name="__rc")]
     for name, fd in cls_info.fields.items():
         resolved = _resolve_type(fd.type, type_map)
         fields.append(IRStructField(c_type=CType(text=type_to_c(resolved)), name=name))
@@ -0,0 +1,124 @@
+"""Destructor emission for user-defined generic class instances."""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ...nodes import (
+    CType,
+    IRBinOp,
+    IRBlock,
+    IRCall,
+    IRExprStmt,
+    IRFieldAccess,
+    IRFunctionDef,
+    IRIf,
+    IRLiteral,
+    IRParam,
+    IRUnaryOp,
+    IRVar,
+)
+from ..pools import free_instance, uses_pool
+from ..types import mangle_generic_type, type_to_c
+from .core import _resolve_type
+from .user_emitter import _UserGenericEmitter
+
+if TYPE_CHECKING:
+    from ..generator import IRGenerator
+
+
+def build_destroy_func(gen: IRGenerator, base_name: str, mangled: str,
+                       cls_info, type_map) -> IRFunctionDef:
+    """`{mangled}_destroy`: release the fields, then free the instance."""
+    stmts = _build_generic_destructor_stmts(cls_info, type_map, mangled, gen)
+    if uses_pool(gen, base_name):
+        stmts.append(free_instance(gen, mangled, IRVar(name="self")))
+    else:
+        stmts.append(IRExprStmt(
+            expr=IRCall(callee="free", args=[IRVar(name="self")])))
+    return IRFunctionDef(
+        name=f"{mangled}_destroy",
+        return_type=CType(text="void"),
+        params=[IRParam(c_type=CType(text=f"{mangled}*"), name="self")],
+        body=IRBlock(stmts=stmts),
+        is_static=True,
+    )
+
+
+def _build_generic_destructor_stmts(cls_info, type_map, mangled, gen):
+    """Build the destructor body as IR statements with ARC-aware field release.
+
+    For each class-type field: if (field) { if (--field->__rc <= 0) destroy(field); }
+    For other fields: nothing (primitives don't need cleanup).
+    """
+    stmts = []
+
+    # Check for user-defined __del__ method
+    dtor = cls_info.methods.get("__del__")
+    if dtor and dtor.body:
+        emitter = _UserGenericEmitter(type_map, mangled,
+                                       lambda t: type_to_c(_resolve_type(t, type_map)),
+                                       gen=gen)
+        stmts.extend(emitter.emit_stmts(dtor.body.statements))
+
+    for fname, fd in cls_info.fields.items():
+        if not fd.type:
+            continue
+        resolved = _resolve_type(fd.type, type_map)
+        # Only release class instance fields (pointer_depth == 0).
+        if resolved.pointer_depth > 0:
+            continue
+        # Generic class field -> mangled destroy/free
+        if resolved.generic_args and resolved.base in gen.analyzed.class_table:
+            target = mangle_generic_type(resolved.base, resolved.generic_args)
+            field_cls = gen.analyzed.class_table.get(resolved.base)
+            dtor_name = "free" if field_cls and "free" in field_cls.methods else "destroy"
+            stmts.append(IRIf(
+                condition=IRFieldAccess(
+                    obj=IRVar(name="self"), field=fname, arrow=True),
+                then_block=IRBlock(stmts=[IRIf(
+                    condition=IRBinOp(
+                        left=IRUnaryOp(
+                            op="--",
+                            operand=IRFieldAccess(
+                                obj=IRFieldAccess(
+                                    obj=IRVar(name="self"),
+                                    field=fname, arrow=True),
+                                field="__rc", arrow=True),
+                            prefix=True),
+                        op="<=",
+                        right=IRLiteral(text="0")),
+                    then_block=IRBlock(stmts=[IRExprStmt(
+                        expr=IRCall(
+                            callee=f"{target}_{dtor_name}",
+                            args=[IRFieldAccess(
+                                obj=IRVar(name="self"),
+                                field=fname, arrow=True)]))]),
+                )]),
+            ))
+        # Plain class field -> ClassName_destroy
+        elif resolved.base in gen.analyzed.class_table:
+            stmts.append(IRIf(
+                condition=IRFieldAccess(
+                    obj=IRVar(name="self"), field=fname, arrow=True),
+                then_block=IRBlock(stmts=[IRIf(
+                    condition=IRBinOp(
+                        left=IRUnaryOp(
+                            op="--",
+                            operand=IRFieldAccess(
+                                obj=IRFieldAccess(
+                                    obj=IRVar(name="self"),
+                                    field=fname, arrow=True),
+                                field="__rc", arrow=True),
+                            prefix=True),
+                        op="<=",
+                        right=IRLiteral(text="0")),
+                    then_block=IRBlock(stmts=[IRExprStmt(
+                        expr=IRCall(
+                            callee=f"{resolved.base}_destroy",
+                            args=[IRFieldAccess(
+                                obj=IRVar(name="self"),
+                                field=fname, arrow=True)]))]),
+                )]),
+            ))
+    return stmts
@@ -23,12 +23,8 @@ from ...nodes import (
     IRVarDecl,
 )
 from .core import _resolve_type
-from .user_emitter_stmts import (
-    _ir_expr_to_text,
-    _ir_stmt_to_text,
-    _ir_stmts_to_text,
-    _UserGenericStmtMixin,
-)
+from .ir_text import _ir_expr_to_text, _ir_stmt_to_text, _ir_stmts_to_text
+from .user_emitter_stmts import _UserGenericStmtMixin
 
 if TYPE_CHECKING:
     pass
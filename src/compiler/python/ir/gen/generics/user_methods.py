@@ -2,37 +2,43 @@
 
 from __future__ import annotations
 
+import re
 from typing import TYPE_CHECKING
 
 from ....ast_nodes import TypeExpr
 from ...nodes import (
     CType,
     IRAssign,
-    IRBinOp,
     IRBlock,
     IRCall,
     IRCast,
     IRExprStmt,
     IRFieldAccess,
     IRFunctionDef,
-    IRIf,
     IRLiteral,
     IRParam,
     IRReturn,
-    IRUnaryOp,
     IRVar,
-    IRVarDecl,
 )
-from ..types import mangle_generic_type, type_to_c
-from .core import _resolve_type
+from ..parallel import PARALLEL_METHODS
+from ..pools import alloc_self
+from .ir_text import _ir_stmts_to_text
+from .specialize import has_method, specialized_body, specialized_prologue
+from .user_destroy import build_destroy_func
 from .user_emitter import _UserGenericEmitter
-from .user_emitter_stmts import _ir_stmts_to_text
 
 if TYPE_CHECKING:
     from ..generator import IRGenerator
 
 # Runtime helpers to register when referenced in emitted code
-_KNOWN_HELPERS = {"__btrc_safe_realloc", "__btrc_safe_calloc"}
+_KNOWN_HELPERS = {"__btrc_safe_realloc", "__btrc_safe_calloc", "__btrc_ctrl"}
+
+# Methods emitted on first call instead of with the instance
+_LAZY_METHODS = {"Vector": set(PARALLEL_METHODS)}
+
+
+# An element of self->data as an operand of + or *
+_ELEMENT_ARITHMETIC = re.compile(r"[+*] \(?self->data\[|self->data\[\w+\] [+*]")
 
 
 def _is_type_incompatible(body_text: str, first_arg_c: str) -> bool:
@@ -48,8 +54,8 @@ def _is_type_incompatible(body_text: str, first_arg_c: str) -> bool:
         if "strlen(self->" in body_text or "memcpy(" in body_text:
             return True
     if is_pointer:
-        # ptr + ptr is invalid C (sum-like methods use T + T arithmetic)
-        if "+ self->data[" in body_text:
+        # ptr + ptr and ptr * ptr are invalid C (sum, dot, scale, ...)
+        if _ELEMENT_ARITHMETIC.search(body_text):
             return True
         # strlen/strncmp/memcpy on non-string pointer types
         if first_arg_c != "char*":
@@ -109,8 +115,11 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
     fwd_decls.append(
         f"static {mangled}* {mangled}_new({ctor_params_text});")
     fwd_decls.append(f"static void {mangled}_destroy({mangled}* self);")
+    # Lazy methods come later; methods this instance lacks never do
+    omitted = _LAZY_METHODS.get(base_name, set()) | {
+        m for m in cls_info.methods if not has_method(base_name, m, first_arg_c)}
     for mname, method in cls_info.methods.items():
-        if mname == "__del__" or mname == base_name:
+        if mname == "__del__" or mname == base_name or mname in omitted:
             continue
         ret_c = emitter.resolve_c(method.return_type) if method.return_type else "void"
         m_params = [f"{mangled}* self"]
@@ -143,24 +152,12 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
     ctor_arg_names = []
     if ctor:
         ctor_arg_names = [IRVar(name=p.name) for p in ctor.params]
+    alloc_stmts = alloc_self(gen, base_name, mangled)
     new_func = IRFunctionDef(
         name=f"{mangled}_new",
         return_type=CType(text=f"{mangled}*"),
         params=list(ctor_params_ir),
-        body=IRBlock(stmts=[
-            IRVarDecl(
-                c_type=CType(text=f"{mangled}*"), name="self",
-                init=IRCast(
-                    target_type=CType(text=f"{mangled}*"),
-                    expr=IRCall(callee="malloc",
-                                args=[IRCall(callee="sizeof",
-                                             args=[IRVar(name=mangled)])]))),
-            IRExprStmt(
-                expr=IRCall(callee="memset",
-                            args=[IRVar(name="self"),
-                                  IRLiteral(text="0"),
-                                  IRCall(callee="sizeof",
-                                         args=[IRVar(name=mangled)])])),
+        body=IRBlock(stmts=alloc_stmts + [
             IRExprStmt(
                 expr=IRCall(callee=f"{mangled}_init",
                             args=[IRVar(name="self")] + ctor_arg_names)),
@@ -171,17 +168,7 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
     gen.module.function_defs.append(new_func)
 
     # --- _destroy() function ---
-    dtor_stmts = _build_generic_destructor_stmts(cls_info, type_map,
-                                                   mangled, gen)
-    dtor_stmts.append(IRExprStmt(
-        expr=IRCall(callee="free", args=[IRVar(name="self")])))
-    destroy_func = IRFunctionDef(
-        name=f"{mangled}_destroy",
-        return_type=CType(text="void"),
-        params=[IRParam(c_type=CType(text=f"{mangled}*"), name="self")],
-        body=IRBlock(stmts=dtor_stmts),
-        is_static=True,
-    )
+    destroy_func = build_destroy_func(gen, base_name, mangled, cls_info, type_map)
     gen.module.function_defs.append(destroy_func)
 
     # --- Emit methods ---
@@ -189,7 +176,7 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
     emitted = {}
     skipped = set()
     for mname, method in cls_info.methods.items():
-        if mname == "__del__" or mname == base_name:
+        if mname == "__del__" or mname == base_name or mname in omitted:
             continue
         emitter.reset_var_types(method.params)
         ret_c = emitter.resolve_c(method.return_type) if method.return_type else "void"
@@ -200,6 +187,10 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
                         name=p.name))
         body_stmts = (emitter.emit_stmts(method.body.statements)
                       if method.body else [])
+        body_stmts = specialized_body(gen, base_name, mname, first_arg_c,
+                                      body_stmts)
+        body_stmts = (specialized_prologue(gen, base_name, mname, first_arg_c)
+                      + body_stmts)
         if not body_stmts:
             body_stmts = [IRExprStmt(
                 expr=IRCast(target_type=CType(text="void"),
@@ -240,82 +231,3 @@ def _emit_user_generic_methods(gen: IRGenerator, base_name: str, mangled: str,
     for h in _KNOWN_HELPERS:
         if h in all_text:
             gen.use_helper(h)
-
-
-def _build_generic_destructor_stmts(cls_info, type_map, mangled, gen):
-    """Build the destructor body as IR statements with ARC-aware field release.
-
-    For each class-type field: if (field) { if (--field->__rc <= 0) destroy(field); }
-    For other fields: nothing (primitives don't need cleanup).
-    """
-    stmts = []
-
-    # Check for user-defined __del__ method
-    dtor = cls_info.methods.get("__del__")
-    if dtor and dtor.body:
-        emitter = _UserGenericEmitter(type_map, mangled,
-                                       lambda t: type_to_c(_resolve_type(t, type_map)),
-                                       gen=gen)
-        stmts.extend(emitter.emit_stmts(dtor.body.statements))
-
-    for fname, fd in cls_info.fields.items():
-        if not fd.type:
-            continue
-        resolved = _resolve_type(fd.type, type_map)
-        # Only release class instance fields (pointer_depth == 0).
-        if resolved.pointer_depth > 0:
-            continue
-        # Generic class field -> mangled destroy/free
-        if resolved.generic_args and resolved.base in gen.analyzed.class_table:
-            target = mangle_generic_type(resolved.base, resolved.generic_args)
-            field_cls = gen.analyzed.class_table.get(resolved.base)
-            dtor_name = "free" if field_cls and "free" in field_cls.methods else "destroy"
-            stmts.append(IRIf(
-                condition=IRFieldAccess(
-                    obj=IRVar(name="self"), field=fname, arrow=True),
-                then_block=IRBlock(stmts=[IRIf(
-                    condition=IRBinOp(
-                        left=IRUnaryOp(
-                            op="--",
-                            operand=IRFieldAccess(
-                                obj=IRFieldAccess(
-                                    obj=IRVar(name="self"),
-                                    field=fname, arrow=True),
-                                field="__rc", arrow=True),
-                            prefix=True),
-                        op="<=",
-                        right=IRLiteral(text="0")),
-                    then_block=IRBlock(stmts=[IRExprStmt(
-                        expr=IRCall(
-                            callee=f"{target}_{dtor_name}",
-                            args=[IRFieldAccess(
-                                obj=IRVar(name="self"),
-                                field=fname, arrow=True)]))]),
-                )]),
-            ))
-        # Plain class field -> ClassName_destroy
-        elif resolved.base in gen.analyzed.class_table:
-            stmts.append(IRIf(
-                condition=IRFieldAccess(
-                    obj=IRVar(name="self"), field=fname, arrow=True),
-                then_block=IRBlock(stmts=[IRIf(
-                    condition=IRBinOp(
-                        left=IRUnaryOp(
-                            op="--",
-                            operand=IRFieldAccess(
-                                obj=IRFieldAccess(
-                                    obj=IRVar(name="self"),
-                                    field=fname, arrow=True),
-                                field="__rc", arrow=True),
-                            prefix=True),
-                        op="<=",
-                        right=IRLiteral(text="0")),
-                    then_block=IRBlock(stmts=[IRExprStmt(
-                        expr=IRCall(
-                            callee=f"{resolved.base}_destroy",
-                            args=[IRFieldAccess(
-                                obj=IRVar(name="self"),
-                                field=fname, arrow=True)]))]),
-                )]),
-            ))
-    return stmts
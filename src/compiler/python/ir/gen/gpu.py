@@ -10,20 +10,27 @@ from __future__ import annotations
 
 from typing import TYPE_CHECKING
 
+from ...analyzer.gpu_types import (
+    GPU_RESIDENT_CLASS,
+    gpu_buffer_elem,
+    is_gpu_buffer_type,
+    is_gpu_collection_type,
+    is_gpu_resident_type,
+)
+from ...analyzer.gpu_workgroup import grid_params, workgroup_dims
 from ...ast_nodes import FunctionDecl
 from ..nodes import (
-    IRGpuBuffer,
-    IRGpuDispatch,
-    IRGpuKernel,
+    IRFieldAccess,
     IRRawExpr,
 )
+from ..nodes_gpu import IRGpuBuffer, IRGpuDispatch, IRGpuKernel
 from .gpu_wgsl import WgslEmitter, btrc_type_to_wgsl_elem
+from .gpu_wgsl_builtins import MAIN_PARAMS, calls_builtin
+from .types import mangle_generic_type
 
 if TYPE_CHECKING:
     from .generator import IRGenerator
 
-_WORKGROUP_SIZE = 64
-
 
 def emit_gpu_kernel(gen: IRGenerator, decl: FunctionDecl) -> None:
     """Generate an IRGpuKernel for a @gpu function declaration.
@@ -35,19 +42,26 @@ def emit_gpu_kernel(gen: IRGenerator, decl: FunctionDecl) -> None:
     param_buffers: list[IRGpuBuffer] = []
     uniform_params: list[tuple[str, str]] = []
     binding = 0
-
-    # Classify parameters into buffers (arrays) and uniforms (scalars)
-    for param in decl.params:
-        if param.type and param.type.is_array:
-            elem_type = btrc_type_to_wgsl_elem(param.type)
+    buffer_args: list[int] = []
+    uniform_args: list[int] = []
+
+    # Classify parameters into buffers (arrays, Vector<T>/Array<T>,
+    # GpuArray<T>) and uniforms (scalars)
+    for index, param in enumerate(decl.params):
+        if is_gpu_buffer_type(param.type):
+            buffer_args.append(index)
+            elem_type = btrc_type_to_wgsl_elem(gpu_buffer_elem(param.type))
             param_buffers.append(IRGpuBuffer(
                 name=param.name,
                 elem_type=elem_type,
                 access="read",
                 binding=binding,
+                resident=is_gpu_resident_type(param.type),
+                collection=is_gpu_collection_type(param.type),
             ))
             binding += 1
         else:
+            uniform_args.append(index)
             wgsl_type = btrc_type_to_wgsl_elem(param.type) if param.type else "i32"
             uniform_params.append((param.name, wgsl_type))
 
@@ -55,14 +69,17 @@ def emit_gpu_kernel(gen: IRGenerator, decl: FunctionDecl) -> None:
     output_buffer = None
     has_output = False
     ret = decl.return_type
-    if ret and ret.base != "void" and ret.is_array:
+    ret_resident = is_gpu_resident_type(ret)
+    if ret and ret.base != "void" and (ret.is_array or ret_resident):
         has_output = True
-        elem_type = btrc_type_to_wgsl_elem(ret)
+        elem_type = btrc_type_to_wgsl_elem(
+            ret.generic_args[0] if ret_resident else ret)
         output_buffer = IRGpuBuffer(
             name="_output",
             elem_type=elem_type,
             access="read_write",
             binding=binding,
+            resident=ret_resident,
         )
 
     # For void-returning @gpu functions, mark array params as read_write
@@ -72,16 +89,21 @@ def emit_gpu_kernel(gen: IRGenerator, decl: FunctionDecl) -> None:
             buf.access = "read_write"
 
     # Generate WGSL source
+    workgroup = workgroup_dims(decl)
+    grid = grid_params(decl)
     wgsl = _generate_wgsl(name, param_buffers, uniform_params,
-                          output_buffer, decl.body, has_output)
+                          output_buffer, decl.body, has_output,
+                          workgroup, grid)
 
     kernel = IRGpuKernel(
         name=name,
         wgsl_source=wgsl,
-        workgroup_size=_WORKGROUP_SIZE,
+        workgroup_size=workgroup,
+        grid_params=grid,
         param_buffers=param_buffers,
         output_buffer=output_buffer,
         uniform_params=uniform_params,
+        arg_order=buffer_args + uniform_args,
     )
 
     # Store kernel metadata on the generator for call-site lookup
@@ -98,7 +120,9 @@ def emit_gpu_kernel(gen: IRGenerator, decl: FunctionDecl) -> None:
 
 def _generate_wgsl(name: str, param_buffers: list[IRGpuBuffer],
                    uniform_params: list[tuple[str, str]],
-                   output_buffer, body, has_output: bool) -> str:
+                   output_buffer, body, has_output: bool,
+                   workgroup: tuple[int, int, int],
+                   grid: list[str]) -> str:
     """Generate complete WGSL compute shader source."""
     lines: list[str] = []
 
@@ -128,16 +152,28 @@ def _generate_wgsl(name: str, param_buffers: list[IRGpuBuffer],
             f"@group(0) @binding({uniform_binding}) "
             f"var<uniform> uniforms: Uniforms;")
 
-    lines.append("")
-    lines.append(f"@compute @workgroup_size({_WORKGROUP_SIZE})")
-    lines.append("fn main(@builtin(global_invocation_id) gid: vec3<u32>) {")
-
-    # Emit function body as WGSL
+    # Emit function body as WGSL (first, so gpu_shared() arrays are known)
     array_params = [buf.name for buf in param_buffers]
     uniform_names = [uname for uname, _ in uniform_params]
+    synced = calls_builtin(body, "gpu_barrier")
     emitter = WgslEmitter(array_params, has_output=has_output,
-                          uniform_params=uniform_names)
+                          uniform_params=uniform_names, grid_rank=len(grid),
+                          guard_output=synced)
     body_text = emitter.emit_block(body)
+
+    # Workgroup-shared arrays live at module scope
+    if emitter.shared_arrays:
+        lines.append("")
+    for sname, elem, size in emitter.shared_arrays:
+        lines.append(f"var<workgroup> {sname}: array<{elem}, {size}>;")
+
+    lines.append("")
+    sizes = ", ".join(str(d) for d in workgroup[:max(len(grid), 1)])
+    lines.append(f"@compute @workgroup_size({sizes})")
+    params = ",\n        ".join(MAIN_PARAMS)
+    lines.append(f"fn main({params}) {{")
+    lines.extend(_index_prologue(param_buffers, output_buffer,
+                                 workgroup, grid, synced))
     if body_text:
         lines.append(body_text)
 
@@ -146,6 +182,39 @@ def _generate_wgsl(name: str, param_buffers: list[IRGpuBuffer],
     return "\n".join(lines)
 
 
+def _index_prologue(param_buffers, output_buffer, workgroup,
+                    grid: list[str], synced: bool) -> list[str]:
+    """Compute the linear thread index `_gid` and skip out-of-range threads.
+
+    1-D launches that exceed the per-dimension workgroup limit are split
+    across Y by the runtime, so the index folds gid.y back in. Multi-D
+    launches are bounded by their grid extents (row-major linear index).
+    Kernels that call gpu_barrier() must keep every thread running to the
+    barrier, so they record the bound in `_active` instead of returning.
+    """
+    if not grid:
+        index = f"gid.x + gid.y * nwg.x * {workgroup[0]}u"
+        first = (param_buffers[0].name if param_buffers
+                 else output_buffer.name if output_buffer else "")
+        in_range = f"_gid < arrayLength(&{first})" if first else "true"
+    else:
+        extents = [f"u32(uniforms.{name})" for name in grid]
+        axes = "xyz"
+        in_range = " && ".join(f"gid.{axes[i]} < {e}"
+                               for i, e in enumerate(extents))
+        index = "gid.x"
+        stride = ""
+        for i in range(1, len(grid)):
+            stride = f"{stride} * {extents[i - 1]}" if stride else extents[i - 1]
+            index += f" + gid.{axes[i]} * {stride}"
+    lines = [f"    let _gid = {index};"]
+    if synced:
+        lines.append(f"    let _active = {in_range};")
+    elif in_range != "true":
+        lines.append(f"    if (!({in_range})) {{ return; }}")
+    return lines
+
+
 def lower_gpu_call(gen: IRGenerator, func_name: str,
                    ast_args: list, ir_args: list) -> IRGpuDispatch:
     """Generate an IRGpuDispatch for a call to a @gpu function.
@@ -154,21 +223,35 @@ def lower_gpu_call(gen: IRGenerator, func_name: str,
     generate WebGPU buffer creation, upload, dispatch, and readback code.
     """
     kernel = gen._gpu_kernels[func_name]
+    # Buffers first, then uniforms, whatever the declaration order
+    if len(ir_args) == len(kernel.arg_order):
+        ir_args = [ir_args[i] for i in kernel.arg_order]
 
     # Determine array length from first array argument
     array_len_expr = None
-    for i, _param in enumerate(kernel.param_buffers):
+    for i, param in enumerate(kernel.param_buffers):
+        if i < len(ir_args) and (param.resident or param.collection):
+            # GpuArray<T>, Vector<T> and Array<T> carry their element count
+            array_len_expr = IRFieldAccess(obj=ir_args[i], field="len",
+                                           arrow=True)
+            break
         if i < len(ir_args):
             # Use the first array param's length for dispatch size
             array_len_expr = IRRawExpr(
                 text=f"(sizeof({_ir_expr_text(ir_args[i])}) / sizeof({_ir_expr_text(ir_args[i])}[0]))")
             break
 
-    # Determine result type
+    # Determine result type (a resident output is wrapped in a new
+    # GpuArray<T> instead of being read back)
     result_elem_type = ""
     result_var = ""
+    result_class = ""
     if kernel.output_buffer:
         result_elem_type = _wgsl_to_c_type(kernel.output_buffer.elem_type)
+        if kernel.output_buffer.resident:
+            from ...ast_nodes import TypeExpr
+            result_class = mangle_generic_type(
+                GPU_RESIDENT_CLASS, [TypeExpr(base=result_elem_type)])
 
     return IRGpuDispatch(
         kernel_name=func_name,
@@ -180,6 +263,8 @@ def lower_gpu_call(gen: IRGenerator, func_name: str,
         output_buffer=kernel.output_buffer,
         uniform_params=kernel.uniform_params,
         workgroup_size=kernel.workgroup_size,
+        grid_params=kernel.grid_params,
+        result_class=result_class,
     )
 
 
@@ -31,6 +31,7 @@ from ...ast_nodes import (
     VarDeclStmt,
     WhileStmt,
 )
+from .gpu_wgsl_builtins import shared_decl, wgsl_thread_builtin
 
 # btrc type → WGSL type
 _TYPE_MAP = {
@@ -72,12 +73,20 @@ class WgslEmitter:
     """Emits WGSL text from btrc AST nodes (GPU-compatible subset)."""
 
     def __init__(self, array_params: list[str], has_output: bool = True,
-                 uniform_params: list[str] | None = None):
+                 uniform_params: list[str] | None = None, grid_rank: int = 0,
+                 guard_output: bool = False):
         self._indent = 1  # function body starts at indent 1
         self._lines: list[str] = []
         self._array_params = set(array_params)
         self._uniform_params = set(uniform_params or [])
         self._has_output = has_output
+        self._grid_rank = grid_rank  # 0 for 1-D kernels
+        # Kernels with barriers keep out-of-range threads alive (no early
+        # return), so their output writes are guarded by `_active`
+        self._guard_output = guard_output
+        # gpu_shared() arrays: (name, elem type, size), declared by gpu.py
+        # at module scope as var<workgroup>
+        self.shared_arrays: list[tuple[str, str, int]] = []
 
     def emit_block(self, block) -> str:
         """Emit a block of statements, return WGSL text."""
@@ -91,7 +100,11 @@ class WgslEmitter:
         self._lines.append("    " * self._indent + text)
 
     def _emit_stmt(self, stmt):
-        if isinstance(stmt, VarDeclStmt):
+        shared = shared_decl(stmt)
+        if shared:
+            self.shared_arrays.append(shared)
+
+        elif isinstance(stmt, VarDeclStmt):
             wgsl_type = _TYPE_MAP.get(stmt.type.base, "i32") if stmt.type else "i32"
             if stmt.initializer:
                 init = self._expr(stmt.initializer)
@@ -102,7 +115,10 @@ class WgslEmitter:
         elif isinstance(stmt, ReturnStmt):
             if stmt.value and self._has_output:
                 val = self._expr(stmt.value)
-                self._line(f"_output[gid.x] = {val};")
+                if self._guard_output:
+                    self._line(f"if (_active) {{ _output[_gid] = {val}; }}")
+                else:
+                    self._line(f"_output[_gid] = {val};")
                 self._line("return;")
             else:
                 self._line("return;")
@@ -219,8 +235,9 @@ class WgslEmitter:
         if isinstance(expr, CallExpr):
             if isinstance(expr.callee, Identifier):
                 name = expr.callee.name
-                if name == "gpu_id":
-                    return "i32(gid.x)"
+                builtin = wgsl_thread_builtin(name, self._grid_rank)
+                if builtin is not None:
+                    return builtin
                 # Map btrc math functions to WGSL builtins
                 wgsl_builtins = {
                     "abs": "abs", "min": "min", "max": "max",
@@ -0,0 +1,71 @@
+"""WGSL lowering of the @gpu thread and workgroup builtins.
+
+gpu_id()/gpu_id_x/y/z() index threads in the launch grid, gpu_local_id()
+and gpu_group_id() index them within and across workgroups, gpu_barrier()
+synchronizes a workgroup, and `T[] tile = gpu_shared(N)` declares an
+N-element var<workgroup> array shared by the threads of a workgroup.
+"""
+
+from __future__ import annotations
+
+from ...ast_nodes import CallExpr, Identifier, IntLiteral, VarDeclStmt
+
+# Entry point parameters that every builtin below reads from
+MAIN_PARAMS = (
+    "@builtin(global_invocation_id) gid: vec3<u32>",
+    "@builtin(local_invocation_index) lid: u32",
+    "@builtin(workgroup_id) wid: vec3<u32>",
+    "@builtin(num_workgroups) nwg: vec3<u32>",
+)
+
+_TYPE_MAP = {"int": "i32", "float": "f32"}
+
+
+def wgsl_thread_builtin(name: str, grid_rank: int) -> str | None:
+    """WGSL for a builtin call, or None if `name` is not a builtin.
+
+    gpu_id() is the linear thread index (`_gid`, set by the prologue).
+    In 1-D kernels gpu_id_x() is that same index and y/z are 0.
+    """
+    if name == "gpu_id":
+        return "i32(_gid)"
+    if name in ("gpu_id_x", "gpu_id_y", "gpu_id_z"):
+        axis = name[-1]
+        if axis == "x" and not grid_rank:
+            return "i32(_gid)"
+        if "xyz".index(axis) >= max(grid_rank, 1):
+            return "0"
+        return f"i32(gid.{axis})"
+    if name == "gpu_local_id":
+        return "i32(lid)"
+    if name == "gpu_group_id":
+        return "i32(wid.x + wid.y * nwg.x + wid.z * nwg.x * nwg.y)"
+    if name == "gpu_barrier":
+        return "workgroupBarrier()"
+    return None
+
+
+def shared_decl(stmt) -> tuple[str, str, int] | None:
+    """(name, wgsl elem type, size) for `T[] name = gpu_shared(N);`."""
+    if not isinstance(stmt, VarDeclStmt) or stmt.type is None:
+        return None
+    init = stmt.initializer
+    if not (isinstance(init, CallExpr) and isinstance(init.callee, Identifier)
+            and init.callee.name == "gpu_shared"):
+        return None
+    size = init.args[0].value if (
+        init.args and isinstance(init.args[0], IntLiteral)) else 1
+    return stmt.name, _TYPE_MAP.get(stmt.type.base, "f32"), size
+
+
+def calls_builtin(node, name: str) -> bool:
+    """True if the AST subtree contains a call to `name`."""
+    if (isinstance(node, CallExpr) and isinstance(node.callee, Identifier)
+            and node.callee.name == name):
+        return True
+    if isinstance(node, list):
+        return any(calls_builtin(n, name) for n in node)
+    fields = getattr(node, '__dataclass_fields__', None)
+    if not fields:
+        return False
+    return any(calls_builtin(getattr(node, f), name) for f in fields)
@@ -43,8 +43,9 @@ def collect_helpers(gen: IRGenerator):
             needed_cats.add(name_to_info[name][0])
 
     # Emit helpers in category order, preserving dependency order
-    category_order = ["alloc", "divmod", "string_pool", "string", "math",
-                      "trycatch", "hash", "collections", "cycles", "threads"]
+    category_order = ["alloc", "arena", "divmod", "string_pool", "string",
+                      "math", "trycatch", "hash", "collections", "cycles",
+                      "threads", "sort", "numeric"]
     for cat in category_order:
         if cat not in HELPERS:
             continue
@@ -25,7 +25,10 @@ from ..nodes import (
     IRUnaryOp,
     IRVar,
     IRVarDecl,
+    IRWhile,
 )
+from .calls import has_keep_return
+from .string_scopes import lower_loop_body
 from .types import mangle_generic_type, type_to_c
 
 if TYPE_CHECKING:
@@ -34,7 +37,6 @@ if TYPE_CHECKING:
 
 def _lower_for_in(gen: IRGenerator, node) -> list[IRStmt]:
     """Lower for-in to C-style for loop."""
-    from .statements import lower_block
     iterable = node.iterable
     var_name = node.var_name
     var_name2 = getattr(node, 'var_name2', None)
@@ -48,12 +50,14 @@ def _lower_for_in(gen: IRGenerator, node) -> list[IRStmt]:
     iter_type = gen.analyzed.node_types.get(id(iterable))
     ir_iter = _lower_expr(gen, iterable)
 
-    # Iterable protocol: any class with iterLen + iterGet methods
-    if iter_type and iter_type.generic_args:
-        cls_info = gen.analyzed.class_table.get(iter_type.base)
-        if cls_info and "iterLen" in cls_info.methods and "iterGet" in cls_info.methods:
-            return _lower_iterable_for_in(gen, node, ir_iter, iter_type,
-                                          cls_info, var_name, var_name2)
+    # Iterable protocol: any class with iterLen + iterGet methods, or a
+    # streaming iterator with iterNext + iterValue
+    cls_info = gen.analyzed.class_table.get(iter_type.base) if iter_type else None
+    if cls_info and "iterNext" in cls_info.methods and "iterValue" in cls_info.methods:
+        return _lower_streaming_for_in(gen, node, ir_iter, iter_type, cls_info, var_name)
+    if cls_info and "iterLen" in cls_info.methods and "iterGet" in cls_info.methods:
+        return _lower_iterable_for_in(gen, node, ir_iter, iter_type,
+                                      cls_info, var_name, var_name2)
 
     # String iteration: for c in str
     if iter_type and iter_type.base == "string":
@@ -70,7 +74,7 @@ def _lower_for_in(gen: IRGenerator, node) -> list[IRStmt]:
         iter_c_type = type_to_c(iter_type)
         if not iter_c_type.endswith("*"):
             iter_c_type += "*"
-    body_block = lower_block(gen, node.body)
+    body_block = lower_loop_body(gen, node.body, [var_name])
     body_block.stmts.insert(0, IRVarDecl(
         c_type=CType(text="int"), name=var_name,
         init=IRIndex(obj=IRVar(name=tmp_iter), index=IRVar(name=idx))))
@@ -92,16 +96,16 @@ def _lower_for_in(gen: IRGenerator, node) -> list[IRStmt]:
 def _lower_iterable_for_in(gen, node, ir_iter, iter_type, cls_info,
                             var_name, var_name2) -> list[IRStmt]:
     """Lower for-in via Iterable protocol (iterLen/iterGet/iterValueAt)."""
-    from .statements import lower_block
 
-    mangled = mangle_generic_type(iter_type.base, iter_type.generic_args)
+    mangled = _class_c_name(iter_type)
 
     idx = gen.fresh_temp("__i")
     n_var = gen.fresh_temp("__n")
-    body_block = lower_block(gen, node.body)
+    body_block = lower_loop_body(gen, node.body, [var_name, var_name2])
 
     # Element type from first generic arg
-    elem_c = type_to_c(iter_type.generic_args[0]) if iter_type.generic_args else "int"
+    elem_c = (type_to_c(iter_type.generic_args[0]) if iter_type.generic_args
+              else _element_c(cls_info, "iterGet"))
 
     # Two-variable iteration (e.g., for k, v in map): also call iterValueAt
     if var_name2 and "iterValueAt" in cls_info.methods and len(iter_type.generic_args) > 1:
@@ -135,12 +139,50 @@ def _lower_iterable_for_in(gen, node, ir_iter, iter_type, cls_info,
     ]
 
 
+def _lower_streaming_for_in(gen, node, ir_iter, iter_type, cls_info,
+                            var_name) -> list[IRStmt]:
+    """Lower for-in over a streaming iterator (iterNext/iterValue).
+
+    T* __it = iterable;
+    while (TYPE_iterNext(__it)) { T x = TYPE_iterValue(__it); body }
+    """
+    mangled = _class_c_name(iter_type)
+    if iter_type.generic_args:
+        elem_c = type_to_c(iter_type.generic_args[0])
+    else:
+        elem_c = _element_c(cls_info, "iterValue")
+    it = gen.fresh_temp("__it")
+    if (isinstance(node.iterable, CallExpr) and not iter_type.generic_args
+            and has_keep_return(gen, node.iterable)):
+        gen.register_managed_var(it, iter_type.base)  # e.g. f.lines(): ours to free
+    body_block = lower_loop_body(gen, node.body, [var_name])
+    body_block.stmts.insert(0, IRVarDecl(
+        c_type=CType(text=elem_c), name=var_name,
+        init=IRCall(callee=f"{mangled}_iterValue", args=[IRVar(name=it)])))
+    return [
+        IRVarDecl(c_type=CType(text=f"{mangled}*"), name=it, init=ir_iter),
+        IRWhile(condition=IRCall(callee=f"{mangled}_iterNext", args=[IRVar(name=it)]),
+                body=body_block),
+    ]
+
+
+def _class_c_name(iter_type) -> str:
+    if iter_type.generic_args:
+        return mangle_generic_type(iter_type.base, iter_type.generic_args)
+    return iter_type.base
+
+
+def _element_c(cls_info, method: str) -> str:
+    """C type a non-generic class's iterGet/iterValue returns."""
+    ret = cls_info.methods[method].return_type
+    return type_to_c(ret) if ret else "int"
+
+
 def _lower_string_for_in(gen, node, ir_iter, var_name) -> list[IRStmt]:
     """Lower for c in str to char-by-char iteration."""
-    from .statements import lower_block
 
     idx = gen.fresh_temp("__i")
-    body_block = lower_block(gen, node.body)
+    body_block = lower_loop_body(gen, node.body, [var_name])
     char_decl = IRVarDecl(
         c_type=CType(text="char"), name=var_name,
         init=IRIndex(obj=ir_iter, index=IRVar(name=idx)))
@@ -160,8 +202,7 @@ def _lower_string_for_in(gen, node, ir_iter, var_name) -> list[IRStmt]:
 def _lower_range_for(gen: IRGenerator, var_name: str,
                      args: list, body) -> list[IRStmt]:
     """Lower for x in range(...) to a C for loop."""
-    from .statements import lower_block
-    body_block = lower_block(gen, body)
+    body_block = lower_loop_body(gen, body, [var_name])
     if len(args) == 1:
         end = _lower_expr(gen, args[0])
         return [IRFor(
@@ -209,7 +250,6 @@ def _lower_range_for(gen: IRGenerator, var_name: str,
 
 def _lower_c_for(gen: IRGenerator, node: CForStmt) -> IRFor:
     """Lower a C-style for statement."""
-    from .statements import lower_block
     init_node = None
     if node.init:
         if isinstance(node.init, ForInitVar):
@@ -225,7 +265,7 @@ def _lower_c_for(gen: IRGenerator, node: CForStmt) -> IRFor:
     update_node = _lower_expr(gen, node.update) if node.update else None
 
     return IRFor(init=init_node, condition=cond_node, update=update_node,
-                 body=lower_block(gen, node.body))
+                 body=lower_loop_body(gen, node.body))
 
 
 def _lower_expr(gen, node):
@@ -2,6 +2,7 @@
 
 from __future__ import annotations
 
+from contextlib import contextmanager
 from typing import TYPE_CHECKING
 
 from ...ast_nodes import (
@@ -29,17 +30,41 @@ if TYPE_CHECKING:
     from .generator import IRGenerator
 
 
-def lower_lambda(gen: IRGenerator, node: LambdaExpr) -> IRRawExpr:
+@contextmanager
+def separate_function(gen: IRGenerator):
+    """Lower a nested C function: it must not inherit the enclosing
+    function's ARC-managed variables, try depth, arenas or string marks,
+    nor its error-flag context."""
+    saved = (gen._managed_vars_stack, gen.in_try_depth, gen._func_var_decls,
+             gen.arena_stack, gen.str_marks, gen.flag_tries, gen.flag_routine)
+    gen._managed_vars_stack = []
+    gen.arena_stack = []
+    gen.str_marks = []
+    gen.in_try_depth = 0
+    gen._func_var_decls = []
+    gen.flag_tries = []
+    gen.flag_routine = None
+    try:
+        yield
+    finally:
+        (gen._managed_vars_stack, gen.in_try_depth, gen._func_var_decls,
+         gen.arena_stack, gen.str_marks, gen.flag_tries, gen.flag_routine) = saved
+
+
+def lower_lambda(gen: IRGenerator, node: LambdaExpr,
+                 captures_as_params: bool = False) -> IRRawExpr:
     """Lower a lambda expression to a static function + capture struct.
 
     Returns an IRRawExpr referencing the function name, since lambdas
-    are used as function pointer values.
+    are used as function pointer values. With captures_as_params the
+    captured values become trailing plain parameters instead of an env
+    struct; only a direct caller that knows them can use that form.
     """
     lambda_id = gen.fresh_lambda_id()
     fn_name = f"__btrc_lambda_{lambda_id}"
     env_name = f"__btrc_lambda_{lambda_id}_env"
 
-    has_captures = bool(node.captures)
+    has_captures = bool(node.captures) and not captures_as_params
 
     # Build capture struct if needed
     if has_captures:
@@ -60,6 +85,10 @@ def lower_lambda(gen: IRGenerator, node: LambdaExpr) -> IRRawExpr:
     # directly by name (bypassing the function pointer) with the env arg.
     if has_captures:
         params.append(IRParam(c_type=CType(text="void*"), name="__btrc_env"))
+    elif captures_as_params:
+        for cap in node.captures:
+            params.append(IRParam(c_type=CType(text=type_to_c(cap.type) if cap.type else "int"),
+                                  name=cap.name))
 
     # Return type: use explicit annotation, or infer from node_types (__fn_ptr)
     if node.return_type:
@@ -94,25 +123,16 @@ def lower_lambda(gen: IRGenerator, node: LambdaExpr) -> IRRawExpr:
                                    field=cap.name, arrow=True),
             ))
 
-    # Lambda body — isolate managed scope since the lambda is a separate
-    # C function and must not inherit the parent's ARC-managed variables.
-    saved_managed = gen._managed_vars_stack
-    saved_try_depth = gen.in_try_depth
-    saved_func_var_decls = gen._func_var_decls
-    gen._managed_vars_stack = []
-    gen.in_try_depth = 0
-    gen._func_var_decls = []
-    if isinstance(node.body, LambdaBlock) and node.body.body:
-        from .statements import lower_block
-        block = lower_block(gen, node.body.body)
-        body_stmts.extend(block.stmts)
-    elif isinstance(node.body, LambdaExprBody) and node.body.expression:
-        from .expressions import lower_expr
-        expr = lower_expr(gen, node.body.expression)
-        body_stmts.append(IRReturn(value=expr))
-    gen._managed_vars_stack = saved_managed
-    gen.in_try_depth = saved_try_depth
-    gen._func_var_decls = saved_func_var_decls
+    # Lambda body — a separate C function with its own ARC scope
+    with separate_function(gen):
+        if isinstance(node.body, LambdaBlock) and node.body.body:
+            from .statements import lower_block
+            block = lower_block(gen, node.body.body)
+            body_stmts.extend(block.stmts)
+        elif isinstance(node.body, LambdaExprBody) and node.body.expression:
+            from .expressions import lower_expr
+            expr = lower_expr(gen, node.body.expression)
+            body_stmts.append(IRReturn(value=expr))
 
     gen.module.function_defs.append(IRFunctionDef(
         name=fn_name,
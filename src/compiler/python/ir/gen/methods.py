@@ -12,12 +12,12 @@ from ..nodes import (
     IRLiteral,
     IRVar,
 )
+from .arena import track_string
 from .expressions import lower_expr
-from .types import (
-    is_string_type,
-    mangle_generic_type,
-    type_to_c,
-)
+from .generics.inline_lambdas import is_inlinable, lower_inlined_call
+from .parallel import PARALLEL_METHODS, lower_vector_parallel
+from .thread_methods import lower_mutex_method, lower_thread_method
+from .types import is_string_type, mangle_generic_type
 
 if TYPE_CHECKING:
     from .generator import IRGenerator
@@ -115,9 +115,14 @@ def lower_method_call(gen: IRGenerator, node: CallExpr) -> IRExpr:
         return IRCall(callee=f"{obj_node.name}_{method_name}", args=args)
 
     obj = lower_expr(gen, obj_node)
-    args = [lower_expr(gen, a) for a in node.args]
     obj_type = gen.analyzed.node_types.get(id(obj_node))
 
+    # Vector<T>.map/filter/...(lambda literal): specialized per call site
+    if is_inlinable(obj_type, method_name, node.args):
+        return lower_inlined_call(gen, obj, method_name, obj_type, node.args)
+
+    args = [lower_expr(gen, a) for a in node.args]
+
     # String methods (helper-backed)
     if is_string_type(obj_type) and method_name in _STRING_METHODS:
         return _lower_string_method(gen, obj, method_name, args)
@@ -153,11 +158,16 @@ def lower_method_call(gen: IRGenerator, node: CallExpr) -> IRExpr:
 
     # Thread<T> methods: .join() → __btrc_thread_join with unboxing
     if obj_type and obj_type.base == "Thread" and obj_type.generic_args:
-        return _lower_thread_method(gen, obj, method_name, obj_type)
+        return lower_thread_method(gen, obj, method_name, obj_type)
 
     # Mutex<T> methods: .get(), .set(), .destroy()
     if obj_type and obj_type.base == "Mutex" and obj_type.generic_args:
-        return _lower_mutex_method(gen, obj, method_name, obj_type, args)
+        return lower_mutex_method(gen, obj, method_name, obj_type, args)
+
+    # Vector<T>.par*(): chunked loops on the thread pool, emitted on demand
+    if (obj_type and obj_type.base == "Vector" and obj_type.generic_args
+            and method_name in PARALLEL_METHODS):
+        return lower_vector_parallel(gen, obj, method_name, obj_type, args)
 
     # Class method: obj.method(args) → ClassName_method(obj, args)
     if obj_type and obj_type.base in gen.analyzed.class_table:
@@ -190,9 +200,7 @@ def _lower_string_method(gen: IRGenerator, obj: IRExpr,
     gen.use_helper(helper)
     call = IRCall(callee=helper, args=[obj] + args, helper_ref=helper)
     if method in _STRING_TRACK_METHODS:
-        gen.use_helper("__btrc_str_track")
-        return IRCall(callee="__btrc_str_track", args=[call],
-                      helper_ref="__btrc_str_track")
+        return track_string(gen, call)
     return call
 
 
@@ -222,69 +230,8 @@ def _lower_to_string(gen: IRGenerator, obj: IRExpr, obj_type, args) -> IRExpr:
     }
     helper = helper_map.get(base, "__btrc_intToString")
     gen.use_helper(helper)
-    gen.use_helper("__btrc_str_track")
     call = IRCall(callee=helper, args=[obj], helper_ref=helper)
-    return IRCall(callee="__btrc_str_track", args=[call],
-                  helper_ref="__btrc_str_track")
-
-
-_THREAD_PRIMITIVE_TYPES = {"int", "float", "double", "char", "bool", "short", "long"}
-
-
-def _lower_thread_method(gen, obj, method_name, obj_type):
-    """Lower Thread<T> method calls (.join())."""
-    if method_name == "join":
-        gen.use_helper("__btrc_thread_join")
-        ret_type = obj_type.generic_args[0] if obj_type.generic_args else None
-        join_call = IRCall(
-            callee="__btrc_thread_join", args=[obj],
-            helper_ref="__btrc_thread_join",
-        )
-        if ret_type is None or ret_type.base == "void":
-            return join_call
-        c_type = type_to_c(ret_type)
-        if ret_type.base in _THREAD_PRIMITIVE_TYPES and not ret_type.generic_args:
-            return IRCast(target_type=c_type,
-                          expr=IRCast(target_type="intptr_t", expr=join_call))
-        else:
-            return IRCast(target_type=c_type, expr=join_call)
-    # Unknown Thread method — fallback
-    return IRCall(callee=f"__btrc_thread_{method_name}", args=[obj])
-
-
-def _lower_mutex_method(gen, obj, method_name, obj_type, args):
-    """Lower Mutex<T> method calls (.get(), .set(), .destroy())."""
-    val_type = obj_type.generic_args[0] if obj_type.generic_args else None
-    if method_name == "get":
-        gen.use_helper("__btrc_mutex_val_get")
-        get_call = IRCall(callee="__btrc_mutex_val_get", args=[obj],
-                          helper_ref="__btrc_mutex_val_get")
-        if val_type and val_type.base in _THREAD_PRIMITIVE_TYPES and not val_type.generic_args:
-            c_type = type_to_c(val_type)
-            return IRCast(target_type=c_type,
-                          expr=IRCast(target_type="intptr_t", expr=get_call))
-        elif val_type:
-            c_type = type_to_c(val_type)
-            return IRCast(target_type=c_type, expr=get_call)
-        return get_call
-    if method_name == "set":
-        gen.use_helper("__btrc_mutex_val_set")
-        if args:
-            if val_type and val_type.base in _THREAD_PRIMITIVE_TYPES and not val_type.generic_args:
-                boxed = IRCast(target_type="void*",
-                               expr=IRCast(target_type="intptr_t", expr=args[0]))
-            else:
-                boxed = IRCast(target_type="void*", expr=args[0])
-            return IRCall(callee="__btrc_mutex_val_set", args=[obj, boxed],
-                          helper_ref="__btrc_mutex_val_set")
-        return IRCall(callee="__btrc_mutex_val_set", args=[obj] + args,
-                      helper_ref="__btrc_mutex_val_set")
-    if method_name == "destroy":
-        gen.use_helper("__btrc_mutex_val_destroy")
-        return IRCall(callee="__btrc_mutex_val_destroy", args=[obj],
-                      helper_ref="__btrc_mutex_val_destroy")
-    # Unknown Mutex method — fallback
-    return IRCall(callee=f"__btrc_mutex_val_{method_name}", args=[obj] + args)
+    return track_string(gen, call)
 
 
 def _obj_text(expr: IRExpr) -> str:
@@ -19,6 +19,7 @@ from ..nodes import (
     IRVar,
     IRVarDecl,
 )
+from .arena import track_string
 from .types import is_numeric_type, is_string_type, mangle_generic_type, type_to_c
 
 if TYPE_CHECKING:
@@ -42,11 +43,9 @@ def _lower_binary(gen: IRGenerator, node: BinaryExpr) -> IRExpr:
     # Only when BOTH sides are strings (string + int is pointer arithmetic)
     if op == "+" and is_string_type(left_type) and is_string_type(right_type):
         gen.use_helper("__btrc_strcat")
-        gen.use_helper("__btrc_str_track")
         cat = IRCall(callee="__btrc_strcat", args=[left, right],
                      helper_ref="__btrc_strcat")
-        return IRCall(callee="__btrc_str_track", args=[cat],
-                      helper_ref="__btrc_str_track")
+        return track_string(gen, cat)
 
     # String comparison: a == b → strcmp(a, b) == 0
     if op in ("==", "!=") and is_string_type(left_type) and is_string_type(right_type):
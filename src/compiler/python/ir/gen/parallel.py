@@ -0,0 +1,122 @@
+"""Parallel Vector methods: parMap, parFilter, parReduce, parForEach, parSort.
+
+vector.btrc declares them with sequential bodies for the analyzer; the
+generic-instance emitter skips them. Call sites record which Vector<T>
+instances need which methods, and once all declarations are lowered two
+static functions are emitted here for each:
+
+    static void btrc_Vector_T_parMap_chunk(__btrc_par_ctx_t* ctx,
+                                           int chunk, int lo, int hi);
+    static btrc_Vector_T* btrc_Vector_T_parMap(btrc_Vector_T* self, fn);
+
+The driver fills a __btrc_par_ctx_t and hands the chunk body to
+__btrc_parallel_for, which runs the chunks on the spawn thread pool.
+Programs that never call a par* method do not pull in pthreads at all.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ...ast_nodes import TypeExpr
+from ..nodes import (
+    CType,
+    IRAssign,
+    IRBlock,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRFunctionDef,
+    IRLiteral,
+    IRParam,
+    IRVarDecl,
+)
+from .generics.core import _resolve_type
+from .parallel_bodies import PAR_BODIES
+from .parallel_sort import par_sort_bodies
+from .shorthands import _arrow, _dot, _v
+from .types import mangle_generic_type, type_to_c
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+PARALLEL_METHODS = ("parMap", "parFilter", "parReduce", "parForEach", "parSort")
+
+
+def lower_vector_parallel(gen: IRGenerator, obj: IRExpr, method_name: str,
+                          obj_type: TypeExpr, args: list[IRExpr]) -> IRExpr:
+    """Lower `v.parMap(fn)` etc. to a call of the instance's parallel driver."""
+    mangled = mangle_generic_type("Vector", obj_type.generic_args)
+    key = f"{mangled}_{method_name}"
+    if key not in gen.parallel_methods:
+        gen.parallel_methods[key] = (mangled, method_name, obj_type.generic_args[0])
+        for inc in ("pthread.h", "unistd.h"):
+            if inc not in gen.module.includes:
+                gen.module.includes.append(inc)
+        gen.use_helper("__btrc_parallel_for")
+        gen.use_helper("__btrc_safe_realloc")
+    return IRCall(callee=key, args=[obj] + args,
+                  helper_ref="__btrc_parallel_for")
+
+
+def emit_parallel_methods(gen: IRGenerator):
+    """Emit the drivers of every instance method a call site needed."""
+    for mangled, method_name, elem in gen.parallel_methods.values():
+        _emit_method(gen, mangled, method_name, elem)
+
+
+def _emit_method(gen: IRGenerator, mangled: str, method_name: str,
+                 elem: TypeExpr):
+    elem_c = type_to_c(elem)
+    method = gen.analyzed.class_table["Vector"].methods[method_name]
+    type_map = {"T": elem}
+    params = [IRParam(c_type=CType(text=f"{mangled}*"), name="self")]
+    for p in method.params:
+        params.append(IRParam(
+            c_type=CType(text=type_to_c(_resolve_type(p.type, type_map))),
+            name=p.name))
+    ret_c = type_to_c(_resolve_type(method.return_type, type_map))
+    fn_c = params[-1].c_type.text if method.params else ""
+
+    if method_name == "parSort":
+        chunk_body, driver_body = par_sort_bodies(gen, mangled, elem_c)
+    else:
+        chunk_body, driver_body = PAR_BODIES[method_name](mangled, elem_c, fn_c)
+
+    chunk_name = f"{mangled}_{method_name}_chunk"
+    chunk_params = [IRParam(c_type=CType(text="__btrc_par_ctx_t*"), name="ctx"),
+                    IRParam(c_type=CType(text="int"), name="chunk"),
+                    IRParam(c_type=CType(text="int"), name="lo"),
+                    IRParam(c_type=CType(text="int"), name="hi")]
+    chunk_prologue = [
+        IRVarDecl(c_type=CType(text=f"{mangled}*"), name="src",
+                  init=IRCast(target_type=CType(text=f"{mangled}*"),
+                              expr=_arrow(_v("ctx"), "src"))),
+    ]
+    if fn_c:
+        chunk_prologue.append(
+            IRVarDecl(c_type=CType(text=fn_c), name="fn",
+                      init=IRCast(target_type=CType(text=fn_c),
+                                  expr=_arrow(_v("ctx"), "fn"))))
+    gen.module.function_defs.append(IRFunctionDef(
+        name=chunk_name, return_type=CType(text="void"), params=chunk_params,
+        body=IRBlock(stmts=chunk_prologue + chunk_body), is_static=True))
+
+    driver_prologue = [
+        IRVarDecl(c_type=CType(text="__btrc_par_ctx_t"), name="ctx",
+                  init=IRLiteral(text="{0}")),
+        IRAssign(target=_dot("ctx", "src"), value=_v("self")),
+    ]
+    if fn_c:
+        driver_prologue.append(
+            IRAssign(target=_dot("ctx", "fn"),
+                     value=IRCast(target_type=CType(text="void (*)(void)"),
+                                  expr=_v(params[-1].name))))
+    gen.module.function_defs.append(IRFunctionDef(
+        name=f"{mangled}_{method_name}", return_type=CType(text=ret_c),
+        params=params,
+        body=IRBlock(stmts=driver_prologue + driver_body(chunk_name)),
+        is_static=True))
+    param_text = ", ".join(f"{p.c_type} {p.name}" for p in params)
+    gen.module.raw_sections.append(
+        f"static {ret_c} {mangled}_{method_name}({param_text});")
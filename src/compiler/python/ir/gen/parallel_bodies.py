@@ -0,0 +1,186 @@
+"""Chunk bodies and drivers of parMap, parFilter, parReduce and parForEach.
+
+Each builder returns the chunk body (run by __btrc_parallel_for on
+src->data[lo..hi)) and a function from the chunk's name to the driver
+body; parallel.py wraps both in their functions.
+"""
+
+from __future__ import annotations
+
+from ..nodes import (
+    CType,
+    IRAddressOf,
+    IRAssign,
+    IRBinOp,
+    IRBlock,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRExprStmt,
+    IRFieldAccess,
+    IRFor,
+    IRIf,
+    IRIndex,
+    IRLiteral,
+    IRReturn,
+    IRSizeof,
+    IRStmt,
+    IRUnaryOp,
+    IRVarDecl,
+)
+from .shorthands import _arrow, _dot, _unused, _v
+
+
+def _par_map(mangled, elem_c, fn_c):
+    chunk = [
+        IRVarDecl(c_type=CType(text=f"{mangled}*"), name="dst",
+                  init=IRCast(target_type=CType(text=f"{mangled}*"),
+                              expr=_arrow(_v("ctx"), "dst"))),
+        _unused("chunk"),
+        _index_loop(_v("lo"), _v("hi"), [IRAssign(
+            target=_elem("dst", "i"), value=_call_fn(_elem("src", "i")))]),
+    ]
+
+    def driver(chunk_name):
+        return [
+            IRVarDecl(c_type=CType(text=f"{mangled}*"), name="result",
+                      init=IRCall(callee=f"{mangled}_new")),
+            IRIf(condition=IRBinOp(left=_len("self"), op=">",
+                                   right=IRLiteral(text="0")),
+                 then_block=IRBlock(stmts=[
+                     IRAssign(target=_arrow(_v("result"), "data"),
+                              value=_alloc(elem_c, _len("self"))),
+                     IRAssign(target=_arrow(_v("result"), "cap"),
+                              value=_len("self")),
+                     IRAssign(target=_arrow(_v("result"), "len"),
+                              value=_len("self")),
+                 ])),
+            IRAssign(target=_dot("ctx", "dst"), value=_v("result")),
+            _run(chunk_name),
+            IRReturn(value=_v("result")),
+        ]
+    return chunk, driver
+
+
+def _par_filter(mangled, elem_c, fn_c):
+    chunk = [
+        IRVarDecl(c_type=CType(text="bool*"), name="keep",
+                  init=IRCast(target_type=CType(text="bool*"),
+                              expr=_arrow(_v("ctx"), "partial"))),
+        _unused("chunk"),
+        _index_loop(_v("lo"), _v("hi"), [IRAssign(
+            target=IRIndex(obj=_v("keep"), index=_v("i")),
+            value=_call_fn(_elem("src", "i")))]),
+    ]
+
+    def driver(chunk_name):
+        return [
+            IRVarDecl(c_type=CType(text="bool*"), name="keep",
+                      init=_alloc("bool", _len("self"))),
+            IRAssign(target=_dot("ctx", "partial"), value=_v("keep")),
+            _run(chunk_name),
+            # Compact in index order so the result keeps the input order
+            IRVarDecl(c_type=CType(text=f"{mangled}*"), name="result",
+                      init=IRCall(callee=f"{mangled}_new")),
+            _index_loop(IRLiteral(text="0"), _len("self"), [IRIf(
+                condition=IRIndex(obj=_v("keep"), index=_v("i")),
+                then_block=IRBlock(stmts=[IRExprStmt(expr=IRCall(
+                    callee=f"{mangled}_push",
+                    args=[_v("result"), _elem("self", "i")]))]))]),
+            _free("keep"),
+            IRReturn(value=_v("result")),
+        ]
+    return chunk, driver
+
+
+def _par_reduce(mangled, elem_c, fn_c):
+    chunk = [
+        IRVarDecl(c_type=CType(text=elem_c), name="acc",
+                  init=_elem("src", "lo")),
+        _index_loop(IRBinOp(left=_v("lo"), op="+", right=IRLiteral(text="1")),
+                    _v("hi"), [IRAssign(
+                        target=_v("acc"),
+                        value=_call_fn(_v("acc"), _elem("src", "i")))]),
+        IRAssign(target=IRIndex(
+            obj=IRCast(target_type=CType(text=f"{elem_c}*"),
+                       expr=_arrow(_v("ctx"), "partial")),
+            index=_v("chunk")), value=_v("acc")),
+    ]
+
+    def driver(chunk_name):
+        chunks = IRCall(callee="__btrc_par_chunks", args=[_len("self")])
+        return [
+            IRVarDecl(c_type=CType(text="int"), name="chunks", init=chunks),
+            IRVarDecl(c_type=CType(text=f"{elem_c}*"), name="partial",
+                      init=_alloc(elem_c, _v("chunks"))),
+            IRAssign(target=_dot("ctx", "partial"), value=_v("partial")),
+            _run(chunk_name),
+            # Fold the chunk results left to right, starting from init
+            IRVarDecl(c_type=CType(text=elem_c), name="acc", init=_v("init")),
+            _index_loop(IRLiteral(text="0"), _v("chunks"), [IRAssign(
+                target=_v("acc"),
+                value=IRCall(callee="fn", args=[
+                    _v("acc"), IRIndex(obj=_v("partial"), index=_v("i"))]))]),
+            _free("partial"),
+            IRReturn(value=_v("acc")),
+        ]
+    return chunk, driver
+
+
+def _par_for_each(mangled, elem_c, fn_c):
+    chunk = [
+        _unused("chunk"),
+        _index_loop(_v("lo"), _v("hi"), [
+            IRExprStmt(expr=_call_fn(_elem("src", "i")))]),
+    ]
+
+    def driver(chunk_name):
+        return [_run(chunk_name)]
+    return chunk, driver
+
+
+PAR_BODIES = {"parMap": _par_map, "parFilter": _par_filter,
+              "parReduce": _par_reduce, "parForEach": _par_for_each}
+
+
+# --- IR shorthands ---
+
+def _len(var: str) -> IRFieldAccess:
+    return _arrow(_v(var), "len")
+
+
+def _elem(vec: str, index: str) -> IRIndex:
+    return IRIndex(obj=_arrow(_v(vec), "data"), index=_v(index))
+
+
+def _call_fn(*args: IRExpr) -> IRCall:
+    return IRCall(callee="fn", args=list(args))
+
+
+def _index_loop(lo: IRExpr, hi: IRExpr, body: list[IRStmt]) -> IRFor:
+    return IRFor(
+        init=IRVarDecl(c_type=CType(text="int"), name="i", init=lo),
+        condition=IRBinOp(left=_v("i"), op="<", right=hi),
+        update=IRUnaryOp(op="++", operand=_v("i"), prefix=False),
+        body=IRBlock(stmts=body))
+
+
+def _alloc(elem_c: str, count: IRExpr) -> IRCast:
+    """(elem_c*)__btrc_safe_realloc(NULL, sizeof(elem_c) * (count + 1))."""
+    size = IRBinOp(left=IRSizeof(operand=elem_c), op="*",
+                   right=IRBinOp(left=count, op="+", right=IRLiteral(text="1")))
+    return IRCast(target_type=CType(text=f"{elem_c}*"),
+                  expr=IRCall(callee="__btrc_safe_realloc",
+                              args=[IRLiteral(text="NULL"), size],
+                              helper_ref="__btrc_safe_realloc"))
+
+
+def _free(var: str) -> IRStmt:
+    return IRExprStmt(expr=IRCall(callee="free", args=[_v(var)]))
+
+
+def _run(chunk_name: str) -> IRStmt:
+    return IRExprStmt(expr=IRCall(
+        callee="__btrc_parallel_for",
+        args=[_len("self"), _v(chunk_name), IRAddressOf(expr=_v("ctx"))],
+        helper_ref="__btrc_parallel_for"))
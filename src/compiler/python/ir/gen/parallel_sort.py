@@ -0,0 +1,144 @@
+"""Vector<T>.parSort(): parallel merge sort on the spawn thread pool.
+
+Each __btrc_parallel_for chunk sorts its own slice -- with the radix sort
+for int/float elements, otherwise with the instance's introsort
+(sortRange) -- and __btrc_par_merge_runs then merges the sorted slices
+pairwise, one pass per doubling of the run width, through a scratch
+buffer in ctx.dst. The per-instance merge step is emitted here:
+
+    static void btrc_Vector_T_parSort_merge(__btrc_par_ctx_t* ctx,
+                                            int lo, int mid, int hi);
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..nodes import (
+    CType,
+    IRAddressOf,
+    IRAssign,
+    IRBinOp,
+    IRBlock,
+    IRCall,
+    IRCast,
+    IRExprStmt,
+    IRFor,
+    IRFunctionDef,
+    IRIf,
+    IRIndex,
+    IRLiteral,
+    IRParam,
+    IRSizeof,
+    IRStmt,
+    IRUnaryOp,
+    IRVarDecl,
+    IRWhile,
+)
+from .generics.specialize import RADIX_SORTS
+from .shorthands import _arrow, _dot, _unused, _v
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+
+def par_sort_bodies(gen: IRGenerator, mangled: str, elem_c: str):
+    """Chunk body and driver builder for parSort, in parallel.py's shape."""
+    merge_name = f"{mangled}_parSort_merge"
+    _emit_merge(gen, mangled, elem_c, merge_name)
+    gen.use_helper("__btrc_par_merge_runs")
+
+    src_data = _arrow(_v("src"), "data")
+    if elem_c in RADIX_SORTS:
+        helper = RADIX_SORTS[elem_c]
+        gen.use_helper(helper)
+        sort_chunk = IRCall(callee=helper, helper_ref=helper, args=[
+            IRBinOp(left=src_data, op="+", right=_v("lo")),
+            IRBinOp(left=_v("hi"), op="-", right=_v("lo"))])
+    else:
+        sort_chunk = IRCall(callee=f"{mangled}_sortRange", args=[
+            _v("src"), _v("lo"), _v("hi"),
+            IRLiteral(text="NULL"), IRLiteral(text="NULL")])
+    chunk = [_unused("chunk"), IRExprStmt(expr=sort_chunk)]
+
+    def driver(chunk_name):
+        size = IRBinOp(left=IRSizeof(operand=elem_c), op="*",
+                       right=_arrow(_v("self"), "len"))
+        return [
+            _call("__btrc_parallel_for", _arrow(_v("self"), "len"),
+                  _v(chunk_name), IRAddressOf(expr=_v("ctx"))),
+            IRIf(condition=IRBinOp(
+                     left=IRCall(callee="__btrc_par_chunks",
+                                 args=[_arrow(_v("self"), "len")]),
+                     op=">", right=IRLiteral(text="1")),
+                 then_block=IRBlock(stmts=[
+                     IRAssign(target=_dot("ctx", "dst"),
+                              value=IRCall(callee="__btrc_safe_realloc",
+                                           args=[IRLiteral(text="NULL"), size],
+                                           helper_ref="__btrc_safe_realloc")),
+                     _call("__btrc_par_merge_runs", _arrow(_v("self"), "len"),
+                           _v(merge_name), IRAddressOf(expr=_v("ctx"))),
+                     IRExprStmt(expr=IRCall(callee="free",
+                                            args=[_dot("ctx", "dst")])),
+                 ])),
+        ]
+    return chunk, driver
+
+
+def _emit_merge(gen: IRGenerator, mangled: str, elem_c: str, name: str):
+    ptr = CType(text=f"{elem_c}*")
+    def data(i: str) -> IRIndex:
+        return IRIndex(obj=_v("data"), index=_v(i))
+
+    buf_k = IRIndex(obj=_v("buf"), index=_v("k"))
+
+    def take(i: str) -> list[IRStmt]:
+        return [IRAssign(target=buf_k, value=data(i)), _inc(i), _inc("k")]
+
+    body = [
+        IRVarDecl(c_type=ptr, name="data", init=_arrow(IRCast(
+            target_type=CType(text=f"{mangled}*"),
+            expr=_arrow(_v("ctx"), "src")), "data")),
+        IRVarDecl(c_type=ptr, name="buf",
+                  init=IRCast(target_type=ptr, expr=_arrow(_v("ctx"), "dst"))),
+        IRVarDecl(c_type=CType(text="int"), name="i", init=_v("lo")),
+        IRVarDecl(c_type=CType(text="int"), name="j", init=_v("mid")),
+        IRVarDecl(c_type=CType(text="int"), name="k", init=_v("lo")),
+        # Ties take the left run first
+        IRWhile(condition=IRBinOp(left=_lt("i", "mid"), op="&&",
+                                  right=_lt("j", "hi")),
+                body=IRBlock(stmts=[IRIf(
+                    condition=IRCall(callee="__btrc_lt",
+                                     args=[data("j"), data("i")]),
+                    then_block=IRBlock(stmts=take("j")),
+                    else_block=IRBlock(stmts=take("i")))])),
+        IRWhile(condition=_lt("i", "mid"), body=IRBlock(stmts=take("i"))),
+        # The tail of the right run is already in place
+        IRFor(init=IRVarDecl(c_type=CType(text="int"), name="t", init=_v("lo")),
+              condition=_lt("t", "k"), update=IRUnaryOp(
+                  op="++", operand=_v("t"), prefix=False),
+              body=IRBlock(stmts=[IRAssign(
+                  target=data("t"),
+                  value=IRIndex(obj=_v("buf"), index=_v("t")))])),
+    ]
+    params = [IRParam(c_type=CType(text="__btrc_par_ctx_t*"), name="ctx")]
+    params += [IRParam(c_type=CType(text="int"), name=n)
+               for n in ("lo", "mid", "hi")]
+    gen.module.function_defs.append(IRFunctionDef(
+        name=name, return_type=CType(text="void"), params=params,
+        body=IRBlock(stmts=body), is_static=True))
+    gen.module.raw_sections.append(
+        f"static void {name}(__btrc_par_ctx_t* ctx, int lo, int mid, int hi);")
+
+
+def _lt(a: str, b: str) -> IRBinOp:
+    return IRBinOp(left=_v(a), op="<", right=_v(b))
+
+
+def _inc(name: str) -> IRStmt:
+    return IRExprStmt(expr=IRUnaryOp(op="++", operand=_v(name), prefix=False))
+
+
+def _call(helper: str, *args) -> IRStmt:
+    return IRExprStmt(expr=IRCall(callee=helper, args=list(args),
+                                  helper_ref=helper))
@@ -0,0 +1,90 @@
+"""Pooled allocation of class instances.
+
+`new` takes instances from the __btrc_pool_alloc size-class slabs and
+`_destroy` hands them back with __btrc_pool_free, which needs the
+instance size. That size is only known statically when the released
+pointer's type is the instance's real type, so classes in an
+inheritance chain (where a Base_destroy may free a Derived) keep plain
+malloc/free. The pools' remote-free lists need <stdatomic.h>.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..nodes import (
+    CType,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRExprStmt,
+    IRLiteral,
+    IRSizeof,
+    IRStmt,
+    IRVar,
+    IRVarDecl,
+)
+from .types import mangle_generic_type
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+
+def uses_pool(gen: IRGenerator, class_name: str) -> bool:
+    """True if instances of `class_name` (the unmangled name) are pooled."""
+    table = gen.analyzed.class_table
+    cls = table.get(class_name)
+    if cls is None or cls.parent:
+        return False
+    return not any(other.parent == class_name for other in table.values())
+
+
+def alloc_instance(gen: IRGenerator, struct_name: str) -> IRExpr:
+    """Zeroed storage for one `struct_name` instance, as a typed pointer."""
+    _use_pool(gen)
+    return IRCast(target_type=CType(text=f"{struct_name}*"), expr=IRCall(
+        callee="__btrc_pool_alloc", args=[IRSizeof(operand=struct_name)],
+        helper_ref="__btrc_pool_alloc"))
+
+
+def alloc_self(gen: IRGenerator, class_name: str, struct_name: str) -> list[IRStmt]:
+    """`struct_name* self` on zeroed storage: pooled, or malloc + memset."""
+    ptr = CType(text=f"{struct_name}*")
+    if uses_pool(gen, class_name):
+        return [IRVarDecl(c_type=ptr, name="self", init=alloc_instance(gen, struct_name))]
+    size = IRSizeof(operand=struct_name)
+    return [
+        IRVarDecl(c_type=ptr, name="self", init=IRCast(
+            target_type=ptr, expr=IRCall(callee="malloc", args=[size]))),
+        IRExprStmt(expr=IRCall(callee="memset",
+                               args=[IRVar(name="self"), IRLiteral(text="0"), size])),
+    ]
+
+
+def free_instance(gen: IRGenerator, struct_name: str, obj: IRExpr) -> IRStmt:
+    """Return a pooled `struct_name` instance to its size class."""
+    _use_pool(gen)
+    return IRExprStmt(expr=IRCall(
+        callee="__btrc_pool_free", args=[obj, IRSizeof(operand=struct_name)],
+        helper_ref="__btrc_pool_alloc"))
+
+
+def lower_pooled_free(gen: IRGenerator, ast_arg, arg: IRExpr) -> IRExpr | None:
+    """free(obj) on a pooled class instance, or None if obj isn't pooled."""
+    arg_type = gen.analyzed.node_types.get(id(ast_arg))
+    if (not arg_type or arg_type.pointer_depth > 1
+            or not uses_pool(gen, arg_type.base)):
+        return None
+    cls = gen.analyzed.class_table[arg_type.base]
+    struct = arg_type.base
+    if cls.generic_params:
+        if len(arg_type.generic_args or []) != len(cls.generic_params):
+            return None
+        struct = mangle_generic_type(arg_type.base, arg_type.generic_args)
+    return free_instance(gen, struct, arg).expr
+
+
+def _use_pool(gen: IRGenerator):
+    gen.use_helper("__btrc_pool_alloc")
+    if "stdatomic.h" not in gen.module.includes:
+        gen.module.includes.append("stdatomic.h")
@@ -0,0 +1,112 @@
+"""Thread-shared ARC: which classes get an atomic reference count.
+
+A class instance's `__rc` is a plain `int` unless the object can be
+reached from more than one thread. These classes are promoted to
+`_Atomic int`: those captured by a `spawn` lambda, the elements of a
+Vector whose par* methods hand them to pool threads, and, in a program
+that starts pool work at all, the types of globals (any thread can reach
+a global). So is everything a worker can reach through them (field
+types, generic arguments) and their whole inheritance chain, so upcasts
+see one struct layout. C11 makes `++`/`--` on an `_Atomic` lvalue an atomic
+read-modify-write whose result is the new count, so a release
+`if (--obj->__rc <= 0) destroy(obj)` decides on the value its own
+decrement produced. Single-threaded programs keep plain counts.
+`--atomic-rc` promotes every class. `parallel for` lowers to a
+sequential loop on the calling thread, so it shares nothing.
+
+The cycle collector's state is per thread (helpers/cycles.py), and its
+trial deletion reads and rewrites counts without synchronization, so
+shared objects never enter it: scope exit releases them one at a time
+instead of through the phased release (arc.py). A reference cycle among
+shared objects is therefore not collected.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ...ast_nodes import CallExpr, FieldAccessExpr, LambdaExpr, SpawnExpr, TypeExpr, VarDeclStmt
+from ..nodes import CType
+from .generics.core import _resolve_type
+from .parallel import PARALLEL_METHODS
+from .types import mangle_generic_type
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+
+def is_shared(gen: IRGenerator, struct_name: str) -> bool:
+    """Does `struct_name` (a class or instance) have an atomic `__rc`?"""
+    return gen.atomic_rc or struct_name in gen.shared_rc_classes
+
+
+def rc_field_type(gen: IRGenerator, struct_name: str) -> CType:
+    """C type of the `__rc` field of `struct_name` (a class or instance)."""
+    return CType(text="_Atomic int" if is_shared(gen, struct_name) else "int")
+
+
+def collect_shared_classes(gen: IRGenerator) -> set[str]:
+    """Struct names (mangled for generic instances) other threads reach."""
+    shared: set[str] = set()
+    threaded = False
+    decls = gen.analyzed.program.declarations
+    for node in _walk(decls):
+        if isinstance(node, SpawnExpr):
+            threaded = True
+            if isinstance(node.fn, LambdaExpr):
+                for cap in node.fn.captures:
+                    _promote(gen, cap.type, shared)
+        elif (isinstance(node, CallExpr) and isinstance(node.callee, FieldAccessExpr)
+              and node.callee.field in PARALLEL_METHODS):
+            t = gen.analyzed.node_types.get(id(node.callee.obj))
+            if t is not None and t.base == "Vector" and t.generic_args:
+                threaded = True
+                _promote(gen, t.generic_args[0], shared)
+    if threaded:
+        for decl in decls:
+            if isinstance(decl, VarDeclStmt):
+                _promote(gen, decl.type, shared)
+    return shared
+
+
+def _promote(gen: IRGenerator, t: TypeExpr | None, shared: set[str]):
+    if t is None:
+        return
+    for arg in t.generic_args or []:
+        _promote(gen, arg, shared)
+    table = gen.analyzed.class_table
+    cls = table.get(t.base)
+    if cls is None:
+        return
+    args = list(t.generic_args or [])
+    if cls.generic_params and len(args) != len(cls.generic_params):
+        return  # unresolved generic parameter
+    name = mangle_generic_type(t.base, args) if cls.generic_params else t.base
+    if name in shared:
+        return
+    shared.add(name)
+
+    type_map = dict(zip(cls.generic_params, args))
+    for fd in cls.fields.values():
+        _promote(gen, _resolve_type(fd.type, type_map), shared)
+    if cls.parent:
+        _promote(gen, TypeExpr(base=cls.parent), shared)
+    for sub in table.values():
+        if sub.parent == t.base and not sub.generic_params:
+            _promote(gen, TypeExpr(base=sub.name), shared)
+
+
+def _walk(node):
+    """Yield every AST node in a subtree."""
+    if isinstance(node, (list, tuple)):
+        for item in node:
+            yield from _walk(item)
+        return
+    fields = getattr(node, '__dataclass_fields__', None)
+    if not fields:
+        return
+    yield node
+    for name in fields:
+        value = getattr(node, name)
+        if isinstance(value, (list, tuple)) or hasattr(value, '__dataclass_fields__'):
+            yield from _walk(value)
@@ -0,0 +1,23 @@
+"""IR shorthands for generators that build whole functions out of IR nodes
+(the parallel Vector methods, parSort's merge step, inlined lambdas)."""
+
+from __future__ import annotations
+
+from ..nodes import CType, IRCast, IRExpr, IRExprStmt, IRFieldAccess, IRStmt, IRVar
+
+
+def _v(name: str) -> IRVar:
+    return IRVar(name=name)
+
+
+def _arrow(obj: IRExpr, field: str) -> IRFieldAccess:
+    return IRFieldAccess(obj=obj, field=field, arrow=True)
+
+
+def _dot(var: str, field: str) -> IRFieldAccess:
+    return IRFieldAccess(obj=_v(var), field=field)
+
+
+def _unused(name: str) -> IRStmt:
+    """(void)name; -- silences -Wunused-parameter."""
+    return IRExprStmt(expr=IRCast(target_type=CType(text="void"), expr=_v(name)))
@@ -0,0 +1,54 @@
+"""Stack allocation of class instances that never escape.
+
+    Vec3 v = Vec3(1, 2, 3);
+ →  Vec3 __sobj_N;
+    memset(&__sobj_N, 0, sizeof(Vec3));
+    Vec3_init(&__sobj_N, 1, 2, 3);
+    Vec3* v = &__sobj_N;
+
+The analyzer (analyzer/escape.py) lists the declarations this applies to
+in `stack_objects`: the object is only read, written and passed where no
+reference to it survives, so nothing but `v` ever points at it. The local
+is not ARC-managed and the instance is never destroyed; its class owns
+nothing a destroy would release. Arena blocks keep their own allocation.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ..nodes import (
+    CType,
+    IRAddressOf,
+    IRCall,
+    IRExprStmt,
+    IRLiteral,
+    IRSizeof,
+    IRStmt,
+    IRVar,
+    IRVarDecl,
+)
+
+if TYPE_CHECKING:
+    from ...ast_nodes import VarDeclStmt
+    from ..nodes import IRExpr
+    from .generator import IRGenerator
+
+
+def stack_object(gen: IRGenerator, node: VarDeclStmt, init: IRExpr) -> list[IRStmt] | None:
+    """Statements placing `node`'s new instance on the stack, or None."""
+    class_name = node.type.base
+    if (id(node) not in gen.analyzed.stack_objects or gen.arena_stack
+            or not isinstance(init, IRCall) or init.callee != f"{class_name}_new"):
+        return None
+    obj = gen.fresh_temp("__sobj")
+
+    def addr():
+        return IRAddressOf(expr=IRVar(name=obj))
+    return [
+        IRVarDecl(c_type=CType(text=class_name), name=obj),
+        IRExprStmt(expr=IRCall(callee="memset", args=[
+            addr(), IRLiteral(text="0"), IRSizeof(operand=class_name)])),
+        IRExprStmt(expr=IRCall(callee=f"{class_name}_init", args=[addr()] + init.args)),
+        IRVarDecl(c_type=CType(text=f"{class_name}*"), name=node.name, init=addr()),
+    ]
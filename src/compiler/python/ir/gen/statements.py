@@ -10,8 +10,10 @@ from __future__ import annotations
 from typing import TYPE_CHECKING
 
 from ...ast_nodes import (
+    ArenaStmt,
     Block,
     BreakStmt,
+    CallExpr,
     CForStmt,
     ContinueStmt,
     DeleteStmt,
@@ -50,7 +52,9 @@ from ..nodes import (
     IRWhile,
 )
 from .arc import _emit_return_release, _emit_scope_release, _lower_release
+from .error_flag import check_call, lower_checked_return
 from .expressions import lower_expr
+from .string_scopes import continue_release, lower_flushed_stmt, lower_loop_body
 from .variables import _emit_keep_for_call, _lower_var_decl
 
 if TYPE_CHECKING:
@@ -65,7 +69,7 @@ def lower_block(gen: IRGenerator, block: Block | None) -> IRBlock:
     stmts = []
     for s in block.statements:
         ir_stmts = lower_stmt(gen, s)
-        stmts.extend(ir_stmts)
+        stmts.extend(lower_flushed_stmt(gen, s, ir_stmts))
     # ARC: scope-exit release for managed vars (only if not already handled
     # by return/break/continue inside this block)
     managed = gen.pop_managed_scope()
@@ -86,9 +90,16 @@ def lower_stmt(gen: IRGenerator, node) -> list[IRStmt]:
     )
 
     if isinstance(node, VarDeclStmt):
-        return _lower_var_decl(gen, node)
+        stmts = _lower_var_decl(gen, node)
+        if isinstance(node.initializer, CallExpr):
+            return check_call(gen, node.initializer, stmts)
+        return stmts
 
     if isinstance(node, ReturnStmt):
+        if isinstance(node.value, CallExpr):
+            checked = lower_checked_return(gen, node)
+            if checked is not None:
+                return checked
         val = lower_expr(gen, node.value) if node.value else None
         # ARC: release all managed vars before return, EXCEPT the returned var
         returned_var = None
@@ -103,12 +114,12 @@ def lower_stmt(gen: IRGenerator, node) -> list[IRStmt]:
     if isinstance(node, WhileStmt):
         return [IRWhile(
             condition=lower_expr(gen, node.condition),
-            body=lower_block(gen, node.body),
+            body=lower_loop_body(gen, node.body),
         )]
 
     if isinstance(node, DoWhileStmt):
         return [IRDoWhile(
-            body=lower_block(gen, node.body),
+            body=lower_loop_body(gen, node.body),
             condition=lower_expr(gen, node.condition),
         )]
 
@@ -129,7 +140,7 @@ def lower_stmt(gen: IRGenerator, node) -> list[IRStmt]:
         return [IRBreak()]
 
     if isinstance(node, ContinueStmt):
-        return [IRContinue()]
+        return continue_release(gen) + [IRContinue()]
 
     if isinstance(node, ExprStmt):
         from ...ast_nodes import AssignExpr
@@ -141,7 +152,10 @@ def lower_stmt(gen: IRGenerator, node) -> list[IRStmt]:
                 return pre + [IRExprStmt(expr=lower_expr(gen, node.expr))] + post
         # ARC: emit rc++ for keep params before the call
         pre_stmts = _emit_keep_for_call(gen, node.expr)
-        return pre_stmts + [IRExprStmt(expr=lower_expr(gen, node.expr))]
+        stmts = pre_stmts + [IRExprStmt(expr=lower_expr(gen, node.expr))]
+        if isinstance(node.expr, CallExpr):
+            return check_call(gen, node.expr, stmts)
+        return stmts
 
     if isinstance(node, DeleteStmt):
         return _lower_delete(gen, node)
@@ -168,6 +182,10 @@ def lower_stmt(gen: IRGenerator, node) -> list[IRStmt]:
         # release expr -> if (--expr->__rc <= 0) destroy(expr); expr = NULL;
         return _lower_release(gen, node)
 
+    if isinstance(node, ArenaStmt):
+        from .arena import lower_arena
+        return lower_arena(gen, node)
+
     return [IRRawC(text=f"/* unhandled stmt: {type(node).__name__} */")]
 
 
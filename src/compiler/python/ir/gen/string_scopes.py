@@ -0,0 +1,300 @@
+"""String temp scopes: flush the string pool at loop-iteration and statement ends.
+
+Temporary strings (f-strings, concatenation, string methods) are pushed
+onto the per-thread pool by __btrc_str_track and, without a flush, live
+until exit. Where it is provably safe the generator brackets a region
+
+    int __sm_N = __btrc_str_mark();
+    ...region...
+    __btrc_str_release(__sm_N);
+
+which frees exactly the strings created inside it. Regions are loop
+bodies (released at the end of every iteration and before `continue`)
+and, outside flushed loops, single expression statements.
+
+A region is safe when none of its strings can outlive it: nothing of a
+string type (string, or a type with string generic arguments) is stored
+anywhere but a variable declared inside the region, and every user
+function, method and constructor it calls is summarized the same way
+(whole-program fixpoint). Lambdas, spawn, calls through function
+pointers and collection methods taking strings (other than lookups)
+count as storing. C functions are assumed not to keep their arguments.
+"""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from ...ast_nodes import (
+    AssignExpr,
+    BinaryExpr,
+    Block,
+    CallExpr,
+    CForStmt,
+    ExprStmt,
+    FieldAccessExpr,
+    ForInitVar,
+    ForInStmt,
+    FStringLiteral,
+    Identifier,
+    IndexExpr,
+    LambdaExpr,
+    NewExpr,
+    ParallelForStmt,
+    SpawnExpr,
+    TryCatchStmt,
+    VarDeclStmt,
+)
+from ..nodes import CType, IRBlock, IRCall, IRExprStmt, IRStmt, IRVar, IRVarDecl
+from .methods import _STRING_TRACK_METHODS
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+# Collection methods that read their string argument without storing it
+_LOOKUP_METHODS = {"get", "contains", "has", "indexOf", "lastIndexOf", "count",
+                   "getOrDefault", "join"}
+_OPERATOR_METHODS = {"+": "__add__", "-": "__sub__", "*": "__mul__", "/": "__div__",
+                     "%": "__mod__", "==": "__eq__", "<": "__lt__", ">": "__gt__"}
+
+
+def lower_loop_body(gen: IRGenerator, body: Block | None, loop_vars=()) -> IRBlock:
+    """Lower a loop body, releasing its temporary strings every iteration."""
+    from .statements import lower_block
+    retains, makes = _scan(gen, body, set(loop_vars)) if body else (True, False)
+    if retains or not makes:
+        gen.str_marks.append(None)
+        block = lower_block(gen, body)
+        gen.str_marks.pop()
+        return block
+    mark = gen.fresh_temp("__sm")
+    gen.str_marks.append(mark)
+    block = lower_block(gen, body)
+    gen.str_marks.pop()
+    block.stmts.insert(0, _mark_decl(gen, mark))
+    block.stmts.append(release_stmt(mark))
+    return block
+
+
+def lower_flushed_stmt(gen: IRGenerator, node, lowered: list[IRStmt]) -> list[IRStmt]:
+    """Bracket an expression statement whose temporaries all die with it."""
+    if (not isinstance(node, ExprStmt) or gen.arena_stack
+            or any(m is not None for m in gen.str_marks)):
+        return lowered
+    retains, makes = _scan(gen, node, set())
+    if retains or not makes:
+        return lowered
+    mark = gen.fresh_temp("__sm")
+    return [_mark_decl(gen, mark)] + lowered + [release_stmt(mark)]
+
+
+def continue_release(gen: IRGenerator) -> list[IRStmt]:
+    """Release the innermost loop's iteration strings before `continue`."""
+    if gen.str_marks and gen.str_marks[-1] is not None:
+        return [release_stmt(gen.str_marks[-1])]
+    return []
+
+
+def release_stmt(mark: str) -> IRStmt:
+    return IRExprStmt(expr=IRCall(callee="__btrc_str_release", args=[IRVar(name=mark)],
+                                  helper_ref="__btrc_str_release"))
+
+
+def _mark_decl(gen: IRGenerator, mark: str) -> IRVarDecl:
+    gen.use_helper("__btrc_str_release")
+    decl = IRVarDecl(c_type=CType(text="int"), name=mark,
+                     init=IRCall(callee="__btrc_str_mark", helper_ref="__btrc_str_release"))
+    gen._func_var_decls.append(decl)  # read after a longjmp: may need volatile
+    return decl
+
+
+# ---- Whole-program summaries ----
+
+def _summaries(gen: IRGenerator) -> dict:
+    """(retains, makes) per free function ("f", name) and method name ("m", name)."""
+    cached = getattr(gen, "_str_summaries", None)
+    if cached is not None:
+        return cached
+    bodies = []
+    for name, decl in gen.analyzed.function_table.items():
+        if decl.body is not None:
+            bodies.append((("f", name), decl.params, decl.body))
+    for cls in gen.analyzed.class_table.values():
+        if cls.generic_params:
+            continue  # collections: handled by _LOOKUP_METHODS at the call site
+        for name, m in cls.methods.items():
+            if m.body is not None:
+                bodies.append((("m", name), m.params, m.body))
+        if cls.constructor is not None and cls.constructor.body is not None:
+            bodies.append((("m", cls.name), cls.constructor.params, cls.constructor.body))
+    summary = {key: (False, False) for key, _, _ in bodies}
+    gen._str_summaries = summary
+    changed = True
+    while changed:
+        changed = False
+        for key, params, body in bodies:
+            old = summary[key]
+            r, m = _scan(gen, body, {p.name for p in params})
+            new = (old[0] or r, old[1] or m)
+            if new != old:
+                summary[key] = new
+                changed = True
+    return summary
+
+
+def _scan(gen: IRGenerator, node, outer_locals: set[str]) -> tuple[bool, bool]:
+    scan = _Scan(gen, _summaries(gen))
+    scan.scopes.append(set(outer_locals))
+    scan.visit(node)
+    return scan.retains, scan.makes
+
+
+def _stringy(t) -> bool:
+    if t is None:
+        return False
+    if t.base == "string" and t.pointer_depth == 0:
+        return True
+    return any(_stringy(a) for a in (t.generic_args or []))
+
+
+class _Scan:
+    """One pass over a region: does it store strings outside, does it make any."""
+
+    def __init__(self, gen: IRGenerator, summary: dict):
+        self.types = gen.analyzed.node_types
+        self.classes = gen.analyzed.class_table
+        self.functions = gen.analyzed.function_table
+        self.summary = summary
+        self.scopes: list[set[str]] = []
+        self.retains = False
+        self.makes = False
+
+    def visit(self, node):
+        if self.retains or node is None:
+            return
+        if isinstance(node, list):
+            for n in node:
+                self.visit(n)
+            return
+        if isinstance(node, (LambdaExpr, SpawnExpr)):
+            self.retains = True  # runs later or elsewhere: anything may outlive us
+            return
+        if isinstance(node, Block):
+            self.scopes.append(set())
+            self.visit(node.statements)
+            self.scopes.pop()
+            return
+        if isinstance(node, VarDeclStmt):
+            self.visit(node.initializer)
+            self.scopes[-1].add(node.name)
+            return
+        if isinstance(node, (ForInStmt, ParallelForStmt, CForStmt, TryCatchStmt)):
+            self._visit_scoped(node)
+            return
+        if isinstance(node, AssignExpr):
+            self._assign(node)
+        elif isinstance(node, CallExpr):
+            self._call(node)
+        elif isinstance(node, NewExpr):
+            self._use(("m", node.type.base) if node.type else None)
+        elif isinstance(node, FStringLiteral):
+            self.makes = True
+        elif isinstance(node, BinaryExpr):
+            self._binary(node)
+        self._children(node)
+
+    def _visit_scoped(self, node):
+        if isinstance(node, TryCatchStmt):
+            self.visit(node.try_block)
+            self.scopes.append({node.catch_var})
+            self.visit(node.catch_block)
+            self.scopes.pop()
+            self.visit(node.finally_block)
+            return
+        self.scopes.append(set())
+        if isinstance(node, CForStmt):
+            if isinstance(node.init, ForInitVar):
+                self.visit(node.init.var_decl)
+            elif node.init is not None:
+                self.visit(node.init.expression)
+            self.visit(node.condition)
+            self.visit(node.update)
+        else:
+            self.visit(node.iterable)
+            self.scopes[-1].update(n for n in (node.var_name, getattr(node, "var_name2", None)) if n)
+        self.visit(node.body)
+        self.scopes.pop()
+
+    def _children(self, node):
+        for name in getattr(node, "__dataclass_fields__", ()):
+            value = getattr(node, name)
+            for child in (value if isinstance(value, list) else [value]):
+                if hasattr(child, "__dataclass_fields__") and not hasattr(child, "base"):
+                    self.visit(child)  # TypeExpr annotations carry no code
+
+    def _local(self, name: str) -> bool:
+        return any(name in s for s in self.scopes)
+
+    def _use(self, key):
+        retains, makes = self.summary.get(key, (False, False))
+        self.retains = self.retains or retains
+        self.makes = self.makes or makes
+
+    def _assign(self, node: AssignExpr):
+        t = self.types.get(id(node.target))
+        if _stringy(t) and node.op == "+=":
+            self.makes = True
+        target = node.target
+        if isinstance(target, IndexExpr):
+            # m[key] = v stores the key too: check the container, not the element
+            t = self.types.get(id(target.obj))
+            if _stringy(self.types.get(id(target.index))):
+                t = self.types.get(id(target.index))
+            target = target.obj
+        if not (_stringy(t) or _stringy(self.types.get(id(node.value)))):
+            return
+        if not (isinstance(target, Identifier) and self._local(target.name)):
+            self.retains = True
+
+    def _binary(self, node: BinaryExpr):
+        t = self.types.get(id(node.left))
+        if t is None:
+            return
+        if t.base == "string" and t.pointer_depth == 0 and node.op == "+":
+            self.makes = True
+        elif t.base in self.classes:
+            self._use(("m", _OPERATOR_METHODS.get(node.op, "")))
+
+    def _call(self, node: CallExpr):
+        callee = node.callee
+        if isinstance(callee, Identifier):
+            if callee.name in self.classes:
+                self._use(("m", callee.name))
+            elif callee.name in self.functions:
+                self._use(("f", callee.name))
+            else:
+                t = self.types.get(id(callee))
+                if self._local(callee.name) or (t is not None and t.base == "__fn_ptr"):
+                    self.retains = True  # function pointer: unknown target
+            return
+        if not isinstance(callee, FieldAccessExpr):
+            self.retains = True
+            return
+        if _stringy(self.types.get(id(node))):
+            self.makes = True
+        rtype = self.types.get(id(callee.obj))
+        if isinstance(callee.obj, Identifier) and callee.obj.name in self.classes \
+                and not self._local(callee.obj.name):
+            self._use(("m", callee.field))  # static method
+        elif rtype is None:
+            self.retains = self.retains or any(_stringy(self.types.get(id(a))) for a in node.args)
+        elif rtype.pointer_depth == 0 and rtype.base not in self.classes:
+            self.makes = self.makes or callee.field in _STRING_TRACK_METHODS
+        elif rtype.generic_args or (self.classes.get(rtype.base) is not None
+                                    and self.classes[rtype.base].generic_params):
+            if callee.field not in _LOOKUP_METHODS and any(
+                    _stringy(self.types.get(id(a))) for a in node.args):
+                self.retains = True
+        else:
+            self._use(("m", callee.field))
+
@@ -0,0 +1,90 @@
+"""Thread<T> and Mutex<T> calls: Mutex(val), join, get, set, destroy.
+
+Both are opaque runtime handles storing values as void*; primitive
+values are boxed and unboxed through intptr_t.
+"""
+
+from __future__ import annotations
+
+from ..nodes import IRCall, IRCast, IRLiteral
+from .types import type_to_c
+
+_THREAD_PRIMITIVE_TYPES = {"int", "float", "double", "char", "bool", "short", "long"}
+
+
+def lower_thread_method(gen, obj, method_name, obj_type):
+    """Lower Thread<T> method calls (.join())."""
+    if method_name == "join":
+        gen.use_helper("__btrc_thread_join")
+        ret_type = obj_type.generic_args[0] if obj_type.generic_args else None
+        join_call = IRCall(
+            callee="__btrc_thread_join", args=[obj],
+            helper_ref="__btrc_thread_join",
+        )
+        if ret_type is None or ret_type.base == "void":
+            return join_call
+        c_type = type_to_c(ret_type)
+        if ret_type.base in _THREAD_PRIMITIVE_TYPES and not ret_type.generic_args:
+            return IRCast(target_type=c_type,
+                          expr=IRCast(target_type="intptr_t", expr=join_call))
+        else:
+            return IRCast(target_type=c_type, expr=join_call)
+    # Unknown Thread method — fallback
+    return IRCall(callee=f"__btrc_thread_{method_name}", args=[obj])
+
+
+def lower_mutex_method(gen, obj, method_name, obj_type, args):
+    """Lower Mutex<T> method calls (.get(), .set(), .destroy())."""
+    val_type = obj_type.generic_args[0] if obj_type.generic_args else None
+    if method_name == "get":
+        gen.use_helper("__btrc_mutex_val_get")
+        get_call = IRCall(callee="__btrc_mutex_val_get", args=[obj],
+                          helper_ref="__btrc_mutex_val_get")
+        if val_type and val_type.base in _THREAD_PRIMITIVE_TYPES and not val_type.generic_args:
+            c_type = type_to_c(val_type)
+            return IRCast(target_type=c_type,
+                          expr=IRCast(target_type="intptr_t", expr=get_call))
+        elif val_type:
+            c_type = type_to_c(val_type)
+            return IRCast(target_type=c_type, expr=get_call)
+        return get_call
+    if method_name == "set":
+        gen.use_helper("__btrc_mutex_val_set")
+        if args:
+            if val_type and val_type.base in _THREAD_PRIMITIVE_TYPES and not val_type.generic_args:
+                boxed = IRCast(target_type="void*",
+                               expr=IRCast(target_type="intptr_t", expr=args[0]))
+            else:
+                boxed = IRCast(target_type="void*", expr=args[0])
+            return IRCall(callee="__btrc_mutex_val_set", args=[obj, boxed],
+                          helper_ref="__btrc_mutex_val_set")
+        return IRCall(callee="__btrc_mutex_val_set", args=[obj] + args,
+                      helper_ref="__btrc_mutex_val_set")
+    if method_name == "destroy":
+        gen.use_helper("__btrc_mutex_val_destroy")
+        return IRCall(callee="__btrc_mutex_val_destroy", args=[obj],
+                      helper_ref="__btrc_mutex_val_destroy")
+    # Unknown Mutex method — fallback
+    return IRCall(callee=f"__btrc_mutex_val_{method_name}", args=[obj] + args)
+
+
+def lower_mutex_constructor(gen, ast_args, ir_args):
+    """Lower Mutex(val) → __btrc_mutex_val_create(boxed_val)."""
+    from .expressions import lower_expr
+    gen.use_helper("__btrc_mutex_val_create")
+    if "pthread.h" not in gen.module.includes:
+        gen.module.includes.append("pthread.h")
+    if not ast_args:
+        return IRCall(callee="__btrc_mutex_val_create",
+                      args=[IRLiteral(text="NULL")],
+                      helper_ref="__btrc_mutex_val_create")
+    # Box the initial value
+    arg_type = gen.analyzed.node_types.get(id(ast_args[0]))
+    val = lower_expr(gen, ast_args[0])
+    if arg_type and arg_type.base in _THREAD_PRIMITIVE_TYPES and not arg_type.generic_args:
+        boxed = IRCast(target_type="void*",
+                       expr=IRCast(target_type="intptr_t", expr=val))
+    else:
+        boxed = IRCast(target_type="void*", expr=val)
+    return IRCall(callee="__btrc_mutex_val_create", args=[boxed],
+                  helper_ref="__btrc_mutex_val_create")
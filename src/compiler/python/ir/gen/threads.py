@@ -3,10 +3,11 @@
 spawn(lambda) lowers to:
 1. A static wrapper function with void*(*)(void*) signature
 2. A capture struct allocation (if lambda has captures)
-3. A call to __btrc_thread_spawn(wrapper, capture_ptr)
+3. A call to __btrc_thread_spawn(wrapper, capture_ptr), which queues the
+   wrapper as a task on the runtime's work-stealing pool
 
 Thread<T> at the C level is just __btrc_thread_t* — no class struct.
-.join() is handled in calls.py as __btrc_thread_join with result casting.
+.join() is handled in thread_methods.py as __btrc_thread_join with result casting.
 """
 
 from __future__ import annotations
@@ -51,9 +52,10 @@ def lower_spawn(gen: IRGenerator, node):
     """
     fn = node.fn
 
-    # Add pthread.h include and register helpers
-    if "pthread.h" not in gen.module.includes:
-        gen.module.includes.append("pthread.h")
+    # Add pthread.h/unistd.h (core count for the pool) and register helpers
+    for inc in ("pthread.h", "unistd.h"):
+        if inc not in gen.module.includes:
+            gen.module.includes.append(inc)
     gen.use_helper("__btrc_thread_spawn")
 
     if not isinstance(fn, LambdaExpr):
@@ -179,8 +181,12 @@ def _build_wrapper_body(gen, fn, env_name, has_captures, ret_c_type):
     # don't get released inside the wrapper function
     saved_managed = gen._managed_vars_stack
     saved_func_var_decls = gen._func_var_decls
+    saved_arenas = gen.arena_stack
+    saved_marks = gen.str_marks
     gen._managed_vars_stack = []
     gen._func_var_decls = []
+    gen.arena_stack = []
+    gen.str_marks = []
     if isinstance(fn.body, LambdaBlock) and fn.body.body:
         from .statements import lower_block
         block = lower_block(gen, fn.body.body)
@@ -211,6 +217,8 @@ def _build_wrapper_body(gen, fn, env_name, has_captures, ret_c_type):
 
     gen._managed_vars_stack = saved_managed
     gen._func_var_decls = saved_func_var_decls
+    gen.arena_stack = saved_arenas
+    gen.str_marks = saved_marks
 
     # Ensure void wrappers return NULL (with cleanup first)
     # Only append if the body doesn't already end with a return (which would
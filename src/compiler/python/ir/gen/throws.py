@@ -0,0 +1,216 @@
+"""Which throws can use the error flag instead of longjmp (--exceptions=flag).
+
+By default every `try` pushes a jmp_buf and calls setjmp, and each managed
+local declared inside it goes on the cleanup stack. In flag mode a routine
+(a top-level function, or an explicit method of a non-generic class; calls
+are keyed by name as in string_scopes.py) reports a throw by setting
+`__btrc_pending` and returning, and the caller tests the flag right after
+the call. Unwinding is then the ordinary scope-exit release, and a `try`
+whose body can only be left that way needs no setjmp: a throw inside it
+releases what the body opened and jumps to the catch (error_flag.py).
+
+A routine reports through the flag only when every call to it is a whole
+statement the caller can follow with a test: `f(...);`, `T x = f(...);`
+or `return f(...);`. A routine that can throw otherwise keeps longjmp, and
+a try whose body calls anything that may longjmp keeps setjmp.
+
+Code the walk doesn't follow -- lambdas, spawned functions, constructors,
+properties, operator and iterator methods, generic classes, functions
+used as values -- must neither throw nor call a routine that can; if any
+does, there is no plan and the whole program keeps setjmp.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING
+
+from ...ast_nodes import (
+    CallExpr,
+    ClassDecl,
+    ExprStmt,
+    FieldAccessExpr,
+    FunctionDecl,
+    Identifier,
+    LambdaExpr,
+    MethodDecl,
+    ReturnStmt,
+    SpawnExpr,
+    ThrowStmt,
+    TryCatchStmt,
+    VarDeclStmt,
+)
+
+if TYPE_CHECKING:
+    from .generator import IRGenerator
+
+# Methods the generator calls on its own (destroy, printing, for-in)
+_IMPLICIT_METHODS = {"toString", "free"}
+
+
+@dataclass
+class ThrowPlan:
+    flagged: set[tuple[str, str]] = field(default_factory=set)  # throw through the flag
+    flag_tries: set[int] = field(default_factory=set)  # id() of tries lowered without setjmp
+
+    def checked(self, call) -> bool:
+        """Must the caller test the flag after `call`?"""
+        return any(key in self.flagged for key in call_keys(call))
+
+
+def call_keys(call: CallExpr) -> tuple[tuple[str, str], ...]:
+    callee = call.callee
+    if isinstance(callee, Identifier):
+        return (("f", callee.name), ("m", callee.name))
+    if isinstance(callee, FieldAccessExpr):
+        return (("m", callee.field),)
+    return ()
+
+
+def routine_key(decl) -> tuple[str, str] | None:
+    """The key of a routine the plan covers, or None."""
+    if isinstance(decl, FunctionDecl):
+        return ("f", decl.name)
+    if isinstance(decl, MethodDecl):
+        return ("m", decl.name)
+    return None
+
+
+def plan_throws(gen: IRGenerator) -> ThrowPlan | None:
+    walk = _Walk(set(gen.analyzed.function_table), gen.analyzed.node_types)
+    for decl in gen.analyzed.program.declarations:
+        if isinstance(decl, FunctionDecl) and decl.body and not decl.is_gpu:
+            walk.routine(decl)
+        elif isinstance(decl, ClassDecl) and not decl.generic_params:
+            for member in decl.members:
+                if _explicit_method(decl, member):
+                    walk.routine(member)
+                else:
+                    walk.visit(member, walk.other)
+        else:
+            walk.visit(decl, walk.other)
+    return walk.solve()
+
+
+def _explicit_method(cls: ClassDecl, member) -> bool:
+    return (isinstance(member, MethodDecl) and member.body is not None
+            and not member.is_gpu and member.name != cls.name
+            and not member.name.startswith(("__", "iter"))
+            and member.name not in _IMPLICIT_METHODS)
+
+
+@dataclass
+class _Body:
+    key: tuple[str, str] | None  # None: everything outside the routines
+    returns_value: bool = False
+    throws: list[bool] = field(default_factory=list)  # per throw: inside a try body
+    calls: list[tuple[tuple, bool]] = field(default_factory=list)  # (keys, inside a try body)
+    tries: list[tuple[int, set]] = field(default_factory=list)  # (id, keys called in the body)
+
+
+class _Walk:
+
+    def __init__(self, functions: set[str], types: dict):
+        self.functions = functions
+        self.types = types
+        self.bodies: list[_Body] = []
+        self.other = _Body(None)
+        self.unchecked: set[tuple[str, str]] = set()  # called where no test can follow
+        self.values: set[str] = set()  # functions used as values
+        self._checkable: set[int] = set()
+        self._open: list[set] = []  # keys called in each enclosing try body
+
+    def routine(self, decl):
+        rt = decl.return_type
+        body = _Body(routine_key(decl), returns_value=rt is not None and not (
+            rt.base == "void" and rt.pointer_depth == 0))
+        self.bodies.append(body)
+        self.visit(decl.body, body)
+
+    def visit(self, node, body: _Body):
+        if node is None:
+            return
+        if isinstance(node, list):
+            for n in node:
+                self.visit(n, body)
+            return
+        if isinstance(node, (LambdaExpr, SpawnExpr)):
+            saved, self._open = self._open, []
+            self._children(node, self.other)  # runs elsewhere, unchecked
+            self._open = saved
+            return
+        if isinstance(node, ThrowStmt):
+            body.throws.append(bool(self._open))
+        elif isinstance(node, TryCatchStmt):
+            self._open.append(set())
+            self.visit(node.try_block, body)
+            body.tries.append((id(node), self._open.pop()))
+            self.visit(node.catch_block, body)
+            self.visit(node.finally_block, body)
+            return
+        elif isinstance(node, ExprStmt) and isinstance(node.expr, CallExpr):
+            self._checkable.add(id(node.expr))
+        elif (isinstance(node, VarDeclStmt) and isinstance(node.initializer, CallExpr)
+              and not (node.type and node.type.is_array)):
+            self._checkable.add(id(node.initializer))
+        elif (isinstance(node, ReturnStmt) and isinstance(node.value, CallExpr)
+              and body.returns_value):
+            self._checkable.add(id(node.value))
+        elif isinstance(node, CallExpr):
+            self._call(node, body)
+            return
+        elif (isinstance(node, Identifier) and node.name in self.functions
+              and self.types.get(id(node)) is None):  # not a local of that name
+            self.values.add(node.name)
+        self._children(node, body)
+
+    def _call(self, node: CallExpr, body: _Body):
+        keys = call_keys(node)
+        body.calls.append((keys, bool(self._open)))
+        for open_keys in self._open:
+            open_keys.update(keys)
+        if body.key is None or id(node) not in self._checkable:
+            self.unchecked.update(keys)
+        if not isinstance(node.callee, Identifier):
+            self.visit(node.callee, body)
+        self.visit(node.args, body)
+
+    def _children(self, node, body: _Body):
+        for name in getattr(node, "__dataclass_fields__", ()):
+            value = getattr(node, name)
+            for child in (value if isinstance(value, list) else [value]):
+                if hasattr(child, "__dataclass_fields__") and not hasattr(child, "base"):
+                    self.visit(child, body)  # TypeExpr annotations carry no code
+
+    def solve(self) -> ThrowPlan | None:
+        keys = {b.key for b in self.bodies}
+        flag = keys - self.unchecked - {("f", "main")} - {("f", n) for n in self.values}
+        # Raises: may leave its body with an exception (flag or longjmp)
+        raising = _fixpoint(self.bodies, lambda b, out: any(not t for t in b.throws) or any(
+            not in_try and out.intersection(k) for k, in_try in b.calls))
+        other = self.other
+        if other.throws or any(raising.intersection(k) for k, _ in other.calls) \
+                or any(("f", n) in raising for n in self.values):
+            return None
+        # Longjmps: may leave its body by longjmp, past any flag test
+        longjmps = _fixpoint(self.bodies, lambda b, out: (
+            b.key in raising and b.key not in flag) or any(
+            not in_try and out.intersection(k) for k, in_try in b.calls))
+        return ThrowPlan(
+            flagged=flag & raising,
+            flag_tries={tid for b in self.bodies for tid, called in b.tries
+                        if not called & longjmps})
+
+
+def _fixpoint(bodies: list[_Body], holds) -> set:
+    """Keys of the bodies for which `holds(body, result)` holds; the
+    result only grows, so repeating until nothing changes settles."""
+    result: set = set()
+    changed = True
+    while changed:
+        changed = False
+        for b in bodies:
+            if b.key not in result and holds(b, result):
+                result.add(b.key)
+                changed = True
+    return result
@@ -15,7 +15,9 @@ from ...ast_nodes import (
     VarDeclStmt,
 )
 from ..nodes import CType, IRCall, IRExprStmt, IRRawExpr, IRStmt, IRVar, IRVarDecl
+from .arena import arena_class
 from .expressions import lower_expr
+from .stack_objects import stack_object
 from .types import type_to_c
 
 if TYPE_CHECKING:
@@ -108,6 +110,10 @@ def _lower_var_decl(gen: IRGenerator, node: VarDeclStmt) -> list[IRStmt]:
                     init = IRCall(callee=f"{mangled}_new", args=init.args)
     # ARC: emit rc++ for keep params if initializer is a call
     pre_stmts = _emit_keep_for_call(gen, node.initializer)
+    # Instances that never escape live on the stack, outside ARC
+    on_stack = stack_object(gen, node, init) if init is not None else None
+    if on_stack:
+        return pre_stmts + on_stack
     var_decl = IRVarDecl(c_type=CType(text=c_type), name=node.name, init=init)
     gen._func_var_decls.append(var_decl)
     result = pre_stmts + [var_decl]
@@ -156,6 +162,11 @@ def _lower_var_decl(gen: IRGenerator, node: VarDeclStmt) -> list[IRStmt]:
             if isinstance(node.initializer, NewExpr) or (isinstance(node.initializer, CallExpr)
                   and isinstance(node.initializer.callee, Identifier)
                   and node.initializer.callee.name in gen.analyzed.class_table):
+                # Arena instances are freed with their block, not by ARC
+                init = node.initializer
+                if arena_class(gen, init.type.base if isinstance(init, NewExpr)
+                               else init.callee.name):
+                    return result
                 gen.register_managed_var(node.name, arc_type)
                 _maybe_register_cleanup(gen, node.name, arc_type, result)
             elif isinstance(node.initializer, CallExpr):
@@ -184,7 +195,9 @@ def _emit_keep_for_call(gen: IRGenerator, expr) -> list[IRStmt]:
     from ...ast_nodes import CallExpr as CE
     if not isinstance(expr, CE):
         return []
-    from .calls import emit_keep_rc_increments
+    from .calls import emit_keep_rc_increments, get_keep_param_indices
+    if not get_keep_param_indices(gen, expr):
+        return []  # lowering twice would emit lambdas and specializations twice
     # We need the lowered args to emit rc++ on. Lower args separately.
     ir_args = [lower_expr(gen, a) for a in expr.args]
     # For method calls, the args in the IR don't include 'self' -- that's
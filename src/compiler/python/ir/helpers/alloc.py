@@ -1,4 +1,5 @@
-"""Alloc runtime helpers -- safe wrappers for realloc/calloc (always emitted)."""
+"""Alloc runtime helpers -- safe wrappers for realloc/calloc (always emitted) and
+the size-class slab pools behind small class instances."""
 
 from .core import HelperDef
 
@@ -33,4 +34,82 @@ ALLOC = {
             "}"
         ),
     ),
+    "__btrc_pool_alloc": HelperDef(
+        c_source=(
+            "/* Slab pools for class instances of up to __BTRC_POOL_MAX bytes: one\n"
+            " * free list per 16-byte size class, refilled by carving a 16 KB slab.\n"
+            " * Each thread owns the slabs it carves, and its lists take no lock. A\n"
+            " * slab is aligned to its size, so a block finds its slab -- and the\n"
+            " * owner in the slab header -- by rounding its address down. A block\n"
+            " * freed on another thread is pushed onto the owner's lock-free remote\n"
+            " * list, which the owner takes back whole before carving a new slab,\n"
+            " * so a thread that only frees never hoards blocks. Owners outlive\n"
+            " * their threads (pool workers run until exit) and slabs are kept for\n"
+            " * reuse. Larger instances go straight to __btrc_safe_calloc. Blocks\n"
+            " * come back zeroed. */\n"
+            "#define __BTRC_POOL_MAX 256\n"
+            "#define __BTRC_POOL_SLAB 16384\n"
+            "#define __BTRC_POOL_HEADER 16\n"
+            "#define __BTRC_POOL_CLASSES (__BTRC_POOL_MAX / 16)\n"
+            "typedef struct __btrc_pool_block { struct __btrc_pool_block* next; } __btrc_pool_block;\n"
+            "typedef struct __btrc_pool_owner {\n"
+            "    __btrc_pool_block* lists[__BTRC_POOL_CLASSES];\n"
+            "    __btrc_pool_block* _Atomic remote[__BTRC_POOL_CLASSES];\n"
+            "} __btrc_pool_owner;\n"
+            "static _Thread_local __btrc_pool_owner* __btrc_pool_me;\n"
+            "\n"
+            "static __btrc_pool_owner* __btrc_pool_self(void) {\n"
+            "    if (!__btrc_pool_me) {\n"
+            "        __btrc_pool_me = (__btrc_pool_owner*)__btrc_safe_calloc(1, sizeof(__btrc_pool_owner));\n"
+            "        for (int i = 0; i < __BTRC_POOL_CLASSES; i++) atomic_init(&__btrc_pool_me->remote[i], NULL);\n"
+            "    }\n"
+            "    return __btrc_pool_me;\n"
+            "}\n"
+            "\n"
+            "static __btrc_pool_block* __btrc_pool_refill(__btrc_pool_owner* me, int cls) {\n"
+            "    __btrc_pool_block* back = atomic_exchange_explicit(&me->remote[cls], NULL, memory_order_acquire);\n"
+            "    if (back) return back;\n"
+            "    size_t block = (size_t)(cls + 1) * 16;\n"
+            "    char* slab = (char*)aligned_alloc(__BTRC_POOL_SLAB, __BTRC_POOL_SLAB);\n"
+            '    if (!slab) { fprintf(stderr, "btrc: out of memory (pool slab %d bytes)\\n", __BTRC_POOL_SLAB); exit(1); }\n'
+            "    *(__btrc_pool_owner**)slab = me;\n"
+            "    char* first = slab + __BTRC_POOL_HEADER;\n"
+            "    size_t count = (__BTRC_POOL_SLAB - __BTRC_POOL_HEADER) / block;\n"
+            "    for (size_t i = 0; i + 1 < count; i++)\n"
+            "        ((__btrc_pool_block*)(first + i * block))->next = (__btrc_pool_block*)(first + (i + 1) * block);\n"
+            "    ((__btrc_pool_block*)(first + (count - 1) * block))->next = NULL;\n"
+            "    return (__btrc_pool_block*)first;\n"
+            "}\n"
+            "\n"
+            "static inline void* __btrc_pool_alloc(size_t size) {\n"
+            "    if (size > __BTRC_POOL_MAX) return __btrc_safe_calloc(1, size);\n"
+            "    int cls = (int)((size + 15) / 16) - 1;\n"
+            "    __btrc_pool_owner* me = __btrc_pool_self();\n"
+            "    __btrc_pool_block* b = me->lists[cls];\n"
+            "    if (!b) b = __btrc_pool_refill(me, cls);\n"
+            "    me->lists[cls] = b->next;\n"
+            "    memset(b, 0, size);\n"
+            "    return b;\n"
+            "}\n"
+            "\n"
+            "static inline void __btrc_pool_free(void* p, size_t size) {\n"
+            "    if (!p) return;\n"
+            "    if (size > __BTRC_POOL_MAX) { free(p); return; }\n"
+            "    int cls = (int)((size + 15) / 16) - 1;\n"
+            "    __btrc_pool_block* b = (__btrc_pool_block*)p;\n"
+            "    __btrc_pool_owner* owner = *(__btrc_pool_owner**)((uintptr_t)p & ~(uintptr_t)(__BTRC_POOL_SLAB - 1));\n"
+            "    if (owner == __btrc_pool_me) {\n"
+            "        b->next = owner->lists[cls];\n"
+            "        owner->lists[cls] = b;\n"
+            "        return;\n"
+            "    }\n"
+            "    __btrc_pool_block* head = atomic_load_explicit(&owner->remote[cls], memory_order_relaxed);\n"
+            "    do {\n"
+            "        b->next = head;\n"
+            "    } while (!atomic_compare_exchange_weak_explicit(&owner->remote[cls], &head, b,\n"
+            "                                                    memory_order_release, memory_order_relaxed));\n"
+            "}"
+        ),
+        depends_on=["__btrc_safe_calloc"],
+    ),
 }
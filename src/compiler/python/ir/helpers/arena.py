@@ -0,0 +1,88 @@
+"""Arena runtime helpers -- the bump allocator behind `arena { ... }` blocks."""
+
+from .core import HelperDef
+
+ARENA = {
+    "__btrc_arena": HelperDef(
+        c_source=(
+            "/* Region allocator for `arena { }` blocks. Objects are bumped out of\n"
+            " * 64 KB chunks (16-byte aligned, zeroed) and strings built inside the\n"
+            " * block are recorded in `owned`; __btrc_arena_free releases both in one\n"
+            " * pass at block exit. Arena objects carry __BTRC_RC_IMMORTAL so ARC\n"
+            " * traffic on them never reaches a destroy. One spare chunk per thread\n"
+            " * is kept so a block entered in a loop does not go back to malloc. */\n"
+            "#define __BTRC_ARENA_CHUNK 65536\n"
+            "#define __BTRC_RC_IMMORTAL (1 << 30)\n"
+            "typedef struct __btrc_arena_chunk {\n"
+            "    struct __btrc_arena_chunk* next;\n"
+            "    size_t cap;\n"
+            "    size_t used;\n"
+            "    size_t pad;\n"
+            "    unsigned char data[];\n"
+            "} __btrc_arena_chunk;\n"
+            "typedef struct {\n"
+            "    __btrc_arena_chunk* head;\n"
+            "    char** owned;\n"
+            "    int owned_len;\n"
+            "    int owned_cap;\n"
+            "} __btrc_arena;\n"
+            "static _Thread_local __btrc_arena_chunk* __btrc_arena_spare;\n"
+            "\n"
+            "static inline __btrc_arena* __btrc_arena_new(void) {\n"
+            "    return (__btrc_arena*)__btrc_safe_calloc(1, sizeof(__btrc_arena));\n"
+            "}\n"
+            "\n"
+            "static __btrc_arena_chunk* __btrc_arena_grow(__btrc_arena* a, size_t size) {\n"
+            "    __btrc_arena_chunk* c;\n"
+            "    if (size <= __BTRC_ARENA_CHUNK && __btrc_arena_spare) {\n"
+            "        c = __btrc_arena_spare;\n"
+            "        __btrc_arena_spare = NULL;\n"
+            "    } else {\n"
+            "        size_t cap = size > __BTRC_ARENA_CHUNK ? size : __BTRC_ARENA_CHUNK;\n"
+            "        c = (__btrc_arena_chunk*)malloc(sizeof(__btrc_arena_chunk) + cap);\n"
+            '        if (!c) { fprintf(stderr, "btrc: out of memory (arena chunk %zu bytes)\\n", cap); exit(1); }\n'
+            "        c->cap = cap;\n"
+            "    }\n"
+            "    c->used = 0;\n"
+            "    c->next = a->head;\n"
+            "    a->head = c;\n"
+            "    return c;\n"
+            "}\n"
+            "\n"
+            "static inline void* __btrc_arena_alloc(__btrc_arena* a, size_t size) {\n"
+            "    size = (size + 15) & ~(size_t)15;\n"
+            "    __btrc_arena_chunk* c = a->head;\n"
+            "    if (!c || c->cap - c->used < size) c = __btrc_arena_grow(a, size);\n"
+            "    void* p = c->data + c->used;\n"
+            "    c->used += size;\n"
+            "    memset(p, 0, size);\n"
+            "    return p;\n"
+            "}\n"
+            "\n"
+            "/* Takes ownership of a malloc'd string: freed with the arena */\n"
+            "static inline char* __btrc_arena_own(__btrc_arena* a, char* s) {\n"
+            "    if (a->owned_len == a->owned_cap) {\n"
+            "        a->owned_cap = a->owned_cap ? a->owned_cap * 2 : 16;\n"
+            "        a->owned = (char**)__btrc_safe_realloc(a->owned, sizeof(char*) * (size_t)a->owned_cap);\n"
+            "    }\n"
+            "    a->owned[a->owned_len++] = s;\n"
+            "    return s;\n"
+            "}\n"
+            "\n"
+            "static void __btrc_arena_free(__btrc_arena* a) {\n"
+            "    if (!a) return;\n"
+            "    for (int i = 0; i < a->owned_len; i++) free(a->owned[i]);\n"
+            "    free(a->owned);\n"
+            "    __btrc_arena_chunk* c = a->head;\n"
+            "    while (c) {\n"
+            "        __btrc_arena_chunk* next = c->next;\n"
+            "        if (!__btrc_arena_spare && c->cap == __BTRC_ARENA_CHUNK) __btrc_arena_spare = c;\n"
+            "        else free(c);\n"
+            "        c = next;\n"
+            "    }\n"
+            "    free(a);\n"
+            "}"
+        ),
+        depends_on=["__btrc_safe_calloc", "__btrc_safe_realloc"],
+    ),
+}
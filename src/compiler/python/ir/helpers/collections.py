@@ -74,7 +74,7 @@ COLLECTIONS = {
         c_source=(
             "static inline void {name}_forEach({name}* m, void (*fn)({k_type}, {v_type}, void*), void* __ctx) {{\n"
             "    for (int i = 0; i < m->cap; i++) {{\n"
-            "        if (m->occupied[i]) fn(m->keys[i], m->values[i], __ctx);\n"
+            "        if (m->ctrl[i] >= 128) fn(m->keys[i], m->values[i], __ctx);\n"
             "    }}\n"
             "}}"
         ),
@@ -83,7 +83,7 @@ COLLECTIONS = {
         c_source=(
             "static inline bool {name}_containsValue({name}* m, {v_type} value) {{\n"
             "    for (int i = 0; i < m->cap; i++) {{\n"
-            "        if (m->occupied[i] && {val_eq}) return true;\n"
+            "        if (m->ctrl[i] >= 128 && {val_eq}) return true;\n"
             "    }}\n"
             "    return false;\n"
             "}}"
@@ -94,7 +94,7 @@ COLLECTIONS = {
         c_source=(
             "static inline void {name}_forEach({name}* s, void (*fn)({c_type}, void*), void* __ctx) {{\n"
             "    for (int i = 0; i < s->cap; i++) {{\n"
-            "        if (s->occupied[i]) fn(s->keys[i], __ctx);\n"
+            "        if (s->ctrl[i] >= 128) fn(s->keys[i], __ctx);\n"
             "    }}\n"
             "}}"
         ),
@@ -104,7 +104,7 @@ COLLECTIONS = {
             "static inline {name}* {name}_filter({name}* s, bool (*fn)({c_type}, void*), void* __ctx) {{\n"
             "    {name}* result = {name}_new();\n"
             "    for (int i = 0; i < s->cap; i++) {{\n"
-            "        if (s->occupied[i] && fn(s->keys[i], __ctx)) {{\n"
+            "        if (s->ctrl[i] >= 128 && fn(s->keys[i], __ctx)) {{\n"
             "            {name}_add(result, s->keys[i]);\n"
             "        }}\n"
             "    }}\n"
@@ -116,7 +116,7 @@ COLLECTIONS = {
         c_source=(
             "static inline bool {name}_any({name}* s, bool (*fn)({c_type}, void*), void* __ctx) {{\n"
             "    for (int i = 0; i < s->cap; i++) {{\n"
-            "        if (s->occupied[i] && fn(s->keys[i], __ctx)) return true;\n"
+            "        if (s->ctrl[i] >= 128 && fn(s->keys[i], __ctx)) return true;\n"
             "    }}\n"
             "    return false;\n"
             "}}"
@@ -126,7 +126,7 @@ COLLECTIONS = {
         c_source=(
             "static inline bool {name}_all({name}* s, bool (*fn)({c_type}, void*), void* __ctx) {{\n"
             "    for (int i = 0; i < s->cap; i++) {{\n"
-            "        if (s->occupied[i] && !fn(s->keys[i], __ctx)) return false;\n"
+            "        if (s->ctrl[i] >= 128 && !fn(s->keys[i], __ctx)) return false;\n"
             "    }}\n"
             "    return true;\n"
             "}}"
@@ -136,7 +136,7 @@ COLLECTIONS = {
         c_source=(
             "static inline int {name}_findIndex({name}* s, bool (*fn)({c_type}, void*), void* __ctx) {{\n"
             "    for (int i = 0; i < s->cap; i++) {{\n"
-            "        if (s->occupied[i] && fn(s->keys[i], __ctx)) return i;\n"
+            "        if (s->ctrl[i] >= 128 && fn(s->keys[i], __ctx)) return i;\n"
             "    }}\n"
             "    return -1;\n"
             "}}"
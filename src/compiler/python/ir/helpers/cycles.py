@@ -1,4 +1,9 @@
-"""Cycle detection runtime helpers -- suspect buffer and trial deletion collector."""
+"""Cycle detection runtime helpers -- suspect buffer and trial deletion collector.
+
+All collector state is per thread: each thread tracks, suspects and
+collects only objects it owns. Objects of thread-shared classes never
+enter it (ir/gen/shared_rc.py).
+"""
 
 from .core import HelperDef
 
@@ -6,35 +11,73 @@ CYCLES = {
     "__btrc_destroyed_tracking": HelperDef(
         depends_on=["__btrc_safe_realloc"],
         c_source=(
-            "/* ARC cascade-destroy tracking: avoid reading freed memory */\n"
-            "static int __btrc_tracking = 0;\n"
-            "static void** __btrc_destroyed = NULL;\n"
-            "static int __btrc_destroyed_count = 0;\n"
-            "static int __btrc_destroyed_cap = 0;\n"
+            "/* ARC cascade-destroy tracking: avoid reading freed memory.\n"
+            " * Destroyed pointers go into an open-addressing hash set (NULL = empty\n"
+            " * slot, at most half full) so lookups stay O(1) in large teardowns. */\n"
+            "static _Thread_local int __btrc_tracking = 0;\n"
+            "static _Thread_local void** __btrc_destroyed = NULL;\n"
+            "static _Thread_local int __btrc_destroyed_count = 0;\n"
+            "static _Thread_local int __btrc_destroyed_cap = 0;\n"
+            "static size_t __btrc_ptr_slot(void* ptr, int cap) {\n"
+            "    uintptr_t h = (uintptr_t)ptr;\n"
+            "    h ^= h >> 17;\n"
+            "    h *= (uintptr_t)0x9E3779B1u;\n"
+            "    h ^= h >> 15;\n"
+            "    return (size_t)(h & (uintptr_t)(cap - 1));\n"
+            "}\n"
+            "static void __btrc_destroyed_insert(void** table, int cap, void* ptr) {\n"
+            "    size_t i = __btrc_ptr_slot(ptr, cap);\n"
+            "    while (table[i] && table[i] != ptr) i = (i + 1) & (size_t)(cap - 1);\n"
+            "    table[i] = ptr;\n"
+            "}\n"
             "static void __btrc_mark_destroyed(void* ptr) {\n"
-            "    if (__btrc_destroyed_count >= __btrc_destroyed_cap) {\n"
-            "        __btrc_destroyed_cap = __btrc_destroyed_cap ? __btrc_destroyed_cap * 2 : 256;\n"
-            "        __btrc_destroyed = (void**)__btrc_safe_realloc(__btrc_destroyed, sizeof(void*) * __btrc_destroyed_cap);\n"
+            "    if ((__btrc_destroyed_count + 1) * 2 > __btrc_destroyed_cap) {\n"
+            "        int cap = __btrc_destroyed_cap ? __btrc_destroyed_cap * 2 : 256;\n"
+            "        void** table = (void**)__btrc_safe_realloc(NULL, sizeof(void*) * cap);\n"
+            "        memset(table, 0, sizeof(void*) * cap);\n"
+            "        for (int i = 0; i < __btrc_destroyed_cap; i++)\n"
+            "            if (__btrc_destroyed[i]) __btrc_destroyed_insert(table, cap, __btrc_destroyed[i]);\n"
+            "        free(__btrc_destroyed);\n"
+            "        __btrc_destroyed = table;\n"
+            "        __btrc_destroyed_cap = cap;\n"
             "    }\n"
-            "    __btrc_destroyed[__btrc_destroyed_count++] = ptr;\n"
+            "    __btrc_destroyed_insert(__btrc_destroyed, __btrc_destroyed_cap, ptr);\n"
+            "    __btrc_destroyed_count++;\n"
             "}\n"
             "static int __btrc_is_destroyed(void* ptr) {\n"
-            "    for (int i = 0; i < __btrc_destroyed_count; i++)\n"
+            "    if (__btrc_destroyed_count == 0) return 0;\n"
+            "    size_t i = __btrc_ptr_slot(ptr, __btrc_destroyed_cap);\n"
+            "    while (__btrc_destroyed[i]) {\n"
             "        if (__btrc_destroyed[i] == ptr) return 1;\n"
+            "        i = (i + 1) & (size_t)(__btrc_destroyed_cap - 1);\n"
+            "    }\n"
             "    return 0;\n"
+            "}\n"
+            "/* Empty the set at the start of a scope release; a table grown by one\n"
+            " * big teardown is dropped rather than cleared on every later scope. */\n"
+            "static void __btrc_destroyed_reset(void) {\n"
+            "    if (__btrc_destroyed_count == 0) return;\n"
+            "    if (__btrc_destroyed_cap > 4096) {\n"
+            "        free(__btrc_destroyed);\n"
+            "        __btrc_destroyed = NULL;\n"
+            "        __btrc_destroyed_cap = 0;\n"
+            "    } else {\n"
+            "        memset(__btrc_destroyed, 0, sizeof(void*) * __btrc_destroyed_cap);\n"
+            "    }\n"
+            "    __btrc_destroyed_count = 0;\n"
             "}"
         ),
     ),
     "__btrc_suspect_buf": HelperDef(
         c_source=(
             "/* ARC cycle detection: suspect buffer */\n"
-            "static void** __btrc_suspects = NULL;\n"
-            "static int __btrc_suspect_count = 0;\n"
-            "static int __btrc_suspect_cap = 0;\n"
+            "static _Thread_local void** __btrc_suspects = NULL;\n"
+            "static _Thread_local int __btrc_suspect_count = 0;\n"
+            "static _Thread_local int __btrc_suspect_cap = 0;\n"
             "typedef void (*__btrc_visit_fn)(void*, void (*)(void**));\n"
             "typedef void (*__btrc_destroy_fn)(void*);\n"
-            "static __btrc_visit_fn* __btrc_visit_table = NULL;\n"
-            "static __btrc_destroy_fn* __btrc_destroy_table = NULL;\n"
+            "static _Thread_local __btrc_visit_fn* __btrc_visit_table = NULL;\n"
+            "static _Thread_local __btrc_destroy_fn* __btrc_destroy_table = NULL;\n"
             "static void __btrc_suspect(void* obj, __btrc_visit_fn visit,\n"
             "                           __btrc_destroy_fn destroy) {\n"
             "    if (__btrc_suspect_count >= __btrc_suspect_cap) {\n"
@@ -53,52 +96,103 @@ CYCLES = {
     ),
     "__btrc_collect_cycles": HelperDef(
         c_source=(
-            "/* ARC cycle collector: trial deletion with cycle-breaking */\n"
+            "/* ARC cycle collector: trial deletion over the suspect buffer.\n"
+            " * Suspects are indexed in a pointer hash table so only edges between\n"
+            " * suspects are trial-decremented; suspects still referenced from\n"
+            " * outside (rc > 0) and everything they reach are restored, and the\n"
+            " * rest is garbage. */\n"
+            "static _Thread_local void** __btrc_cc_keys = NULL;\n"
+            "static _Thread_local int* __btrc_cc_index = NULL;\n"
+            "static _Thread_local int __btrc_cc_mask = 0;\n"
+            "static _Thread_local char* __btrc_cc_live = NULL;\n"
+            "static _Thread_local int* __btrc_cc_work = NULL;\n"
+            "static _Thread_local int __btrc_cc_top = 0;\n"
+            "static _Thread_local int __btrc_cc_keys_cap = 0;\n"
+            "static _Thread_local int __btrc_cc_cap = 0;\n"
+            "static int __btrc_cc_find(void* ptr) {\n"
+            "    size_t i = __btrc_ptr_slot(ptr, __btrc_cc_mask + 1);\n"
+            "    while (__btrc_cc_keys[i]) {\n"
+            "        if (__btrc_cc_keys[i] == ptr) return __btrc_cc_index[i];\n"
+            "        i = (i + 1) & (size_t)__btrc_cc_mask;\n"
+            "    }\n"
+            "    return -1;\n"
+            "}\n"
             "static void __btrc_trial_dec(void** fp) {\n"
-            "    if (*fp) { int* rc = (int*)*fp; (*rc)--; }\n"
+            "    if (*fp && __btrc_cc_find(*fp) >= 0) { int* rc = (int*)*fp; (*rc)--; }\n"
             "}\n"
             "static void __btrc_trial_restore(void** fp) {\n"
-            "    if (*fp) { int* rc = (int*)*fp; (*rc)++; }\n"
+            "    int j = *fp ? __btrc_cc_find(*fp) : -1;\n"
+            "    if (j < 0) return;\n"
+            "    int* rc = (int*)*fp;\n"
+            "    (*rc)++;\n"
+            "    if (!__btrc_cc_live[j]) { __btrc_cc_live[j] = 1; __btrc_cc_work[__btrc_cc_top++] = j; }\n"
             "}\n"
             "static void __btrc_clear_field(void** fp) {\n"
-            "    *fp = NULL;\n"
+            "    if (*fp && __btrc_cc_find(*fp) >= 0) *fp = NULL;\n"
+            "}\n"
+            "static void __btrc_cc_reserve(int n) {\n"
+            "    if (n > __btrc_cc_cap) {\n"
+            "        __btrc_cc_cap = n;\n"
+            "        __btrc_cc_live = (char*)__btrc_safe_realloc(__btrc_cc_live, (size_t)n);\n"
+            "        __btrc_cc_work = (int*)__btrc_safe_realloc(__btrc_cc_work, sizeof(int) * n);\n"
+            "    }\n"
+            "    int cap = 16;\n"
+            "    while (cap < n * 2) cap *= 2;\n"
+            "    if (cap > __btrc_cc_keys_cap) {\n"
+            "        __btrc_cc_keys_cap = cap;\n"
+            "        __btrc_cc_keys = (void**)__btrc_safe_realloc(__btrc_cc_keys, sizeof(void*) * cap);\n"
+            "        __btrc_cc_index = (int*)__btrc_safe_realloc(__btrc_cc_index, sizeof(int) * cap);\n"
+            "    }\n"
+            "    memset(__btrc_cc_keys, 0, sizeof(void*) * cap);\n"
+            "    memset(__btrc_cc_live, 0, (size_t)n);\n"
+            "    __btrc_cc_mask = cap - 1;\n"
             "}\n"
             "static void __btrc_collect_cycles(void) {\n"
             "    int n = __btrc_suspect_count;\n"
             "    if (n == 0) return;\n"
-            "    /* Phase 1: trial decrement all suspects' cyclable children */\n"
+            "    __btrc_cc_reserve(n);\n"
+            "    /* Index the suspects, dropping duplicates */\n"
+            "    for (int i = 0; i < n; i++) {\n"
+            "        void* obj = __btrc_suspects[i];\n"
+            "        if (!obj) continue;\n"
+            "        size_t s = __btrc_ptr_slot(obj, __btrc_cc_mask + 1);\n"
+            "        while (__btrc_cc_keys[s] && __btrc_cc_keys[s] != obj) s = (s + 1) & (size_t)__btrc_cc_mask;\n"
+            "        if (__btrc_cc_keys[s]) { __btrc_suspects[i] = NULL; continue; }\n"
+            "        __btrc_cc_keys[s] = obj;\n"
+            "        __btrc_cc_index[s] = i;\n"
+            "    }\n"
+            "    /* Phase 1: trial decrement every suspect-to-suspect reference */\n"
             "    for (int i = 0; i < n; i++) {\n"
             "        if (__btrc_suspects[i] && __btrc_visit_table[i])\n"
-            "            __btrc_visit_table[i](__btrc_suspects[i], "
-            "__btrc_trial_dec);\n"
+            "            __btrc_visit_table[i](__btrc_suspects[i], __btrc_trial_dec);\n"
             "    }\n"
-            "    /* Phase 2: break cycles by NULLing cyclable fields, then "
-            "destroy */\n"
+            "    /* Phase 2: suspects with outside references are live, and so is\n"
+            "     * whatever they reach; restore the counts along those edges */\n"
             "    for (int i = 0; i < n; i++) {\n"
-            "        void* obj = __btrc_suspects[i];\n"
-            "        if (!obj) continue;\n"
-            "        int rc = *(int*)obj;\n"
-            "        if (rc <= 0) {\n"
-            "            /* NULL cyclable fields to prevent cascade recursion "
-            "*/\n"
-            "            if (__btrc_visit_table[i])\n"
-            "                __btrc_visit_table[i](obj, __btrc_clear_field);\n"
-            "            /* Restore rc for destroy to work, then destroy */\n"
-            "            *(int*)obj = 1;\n"
-            "            if (__btrc_destroy_table[i])\n"
-            "                __btrc_destroy_table[i](obj);\n"
-            "            __btrc_suspects[i] = NULL;\n"
-            "        } else {\n"
-            "            /* Restore trial decrements for still-live objects "
-            "*/\n"
-            "            if (__btrc_visit_table[i])\n"
-            "                __btrc_visit_table[i](obj, "
-            "__btrc_trial_restore);\n"
+            "        if (!__btrc_suspects[i] || __btrc_cc_live[i] || *(int*)__btrc_suspects[i] <= 0) continue;\n"
+            "        __btrc_cc_live[i] = 1;\n"
+            "        __btrc_cc_work[__btrc_cc_top++] = i;\n"
+            "        while (__btrc_cc_top > 0) {\n"
+            "            int j = __btrc_cc_work[--__btrc_cc_top];\n"
+            "            if (__btrc_visit_table[j])\n"
+            "                __btrc_visit_table[j](__btrc_suspects[j], __btrc_trial_restore);\n"
             "        }\n"
             "    }\n"
+            "    /* Phase 3: destroy the garbage. References into the suspect set are\n"
+            "     * already uncounted, so they are NULLed instead of released. */\n"
+            "    for (int i = 0; i < n; i++) {\n"
+            "        void* obj = __btrc_suspects[i];\n"
+            "        if (!obj || __btrc_cc_live[i]) continue;\n"
+            "        if (__btrc_visit_table[i])\n"
+            "            __btrc_visit_table[i](obj, __btrc_clear_field);\n"
+            "        *(int*)obj = 1;\n"
+            "        if (__btrc_destroy_table[i])\n"
+            "            __btrc_destroy_table[i](obj);\n"
+            "    }\n"
             "    __btrc_suspect_count = 0;\n"
             "}"
         ),
-        depends_on=["__btrc_suspect_buf"],
+        depends_on=["__btrc_destroyed_tracking", "__btrc_suspect_buf",
+                    "__btrc_safe_realloc"],
     ),
 }
@@ -1,14 +1,77 @@
-"""Hash runtime helpers -- hash helper for string-keyed collections."""
+"""Hash runtime helpers -- hashing and Swiss-table control bytes for Map/Set."""
 
 from .core import HelperDef
 
 HASH = {
     "__btrc_hash_str": HelperDef(
         c_source=(
+            "/* FNV-1a over the bytes, then a 64-bit finalizer so every output\n"
+            " * bit depends on every input byte */\n"
             "static inline unsigned int __btrc_hash_str(const char* s) {\n"
-            "    unsigned int h = 5381;\n"
-            "    while (*s) { h = ((h << 5) + h) + (unsigned char)*s++; }\n"
-            "    return h;\n"
+            "    uint64_t h = 0xcbf29ce484222325ULL;\n"
+            "    while (*s) { h ^= (unsigned char)*s++; h *= 0x100000001b3ULL; }\n"
+            "    h ^= h >> 33;\n"
+            "    h *= 0xff51afd7ed558ccdULL;\n"
+            "    h ^= h >> 33;\n"
+            "    return (unsigned int)h;\n"
+            "}"
+        ),
+    ),
+    "__btrc_hash_int": HelperDef(
+        c_source=(
+            "/* murmur3 fmix64: spreads small and aligned keys over all bits */\n"
+            "static inline unsigned int __btrc_hash_int(uint64_t k) {\n"
+            "    k ^= k >> 33;\n"
+            "    k *= 0xff51afd7ed558ccdULL;\n"
+            "    k ^= k >> 33;\n"
+            "    k *= 0xc4ceb9fe1a85ec53ULL;\n"
+            "    k ^= k >> 33;\n"
+            "    return (unsigned int)k;\n"
+            "}"
+        ),
+    ),
+    "__btrc_ctrl": HelperDef(
+        c_source=(
+            "/* Swiss-table control bytes for Map/Set. Each slot has one byte:\n"
+            " * 0 = empty, 1 = deleted, 0x80 | (hash >> 25) = full. Slots are\n"
+            " * probed 8 at a time; the first 8 bytes are mirrored after the last\n"
+            " * slot so a group never wraps. Match masks have bit k set for slot\n"
+            " * pos + k and may hold false positives, which the caller rejects by\n"
+            " * comparing the cached hash. */\n"
+            "static inline int __btrc_ctrl_tag(unsigned int h) {\n"
+            "    return 0x80 | (int)(h >> 25);\n"
+            "}\n"
+            "static inline uint64_t __btrc_ctrl_load(const unsigned char* ctrl, int pos) {\n"
+            "    uint64_t g = 0;\n"
+            "    for (int k = 7; k >= 0; k--) g = (g << 8) | ctrl[pos + k];\n"
+            "    return g;\n"
+            "}\n"
+            "/* High bit of each byte -> one bit per slot */\n"
+            "static inline int __btrc_ctrl_bits(uint64_t high) {\n"
+            "    return (int)((((high & 0x8080808080808080ULL) >> 7) * 0x0102040810204080ULL) >> 56);\n"
+            "}\n"
+            "static inline int __btrc_ctrl_zero_bytes(uint64_t g) {\n"
+            "    return __btrc_ctrl_bits((g - 0x0101010101010101ULL) & ~g);\n"
+            "}\n"
+            "static inline int __btrc_ctrl_match(const unsigned char* ctrl, int pos, int tag) {\n"
+            "    uint64_t g = __btrc_ctrl_load(ctrl, pos) ^ (0x0101010101010101ULL * (uint64_t)tag);\n"
+            "    return __btrc_ctrl_zero_bytes(g);\n"
+            "}\n"
+            "static inline int __btrc_ctrl_empty(const unsigned char* ctrl, int pos) {\n"
+            "    return __btrc_ctrl_zero_bytes(__btrc_ctrl_load(ctrl, pos));\n"
+            "}\n"
+            "/* Empty or deleted */\n"
+            "static inline int __btrc_ctrl_free(const unsigned char* ctrl, int pos) {\n"
+            "    return __btrc_ctrl_bits(~__btrc_ctrl_load(ctrl, pos));\n"
+            "}\n"
+            "static inline int __btrc_ctrl_lowest(int bits) {\n"
+            "    int k = 0;\n"
+            "    while (!(bits & 1)) { bits >>= 1; k++; }\n"
+            "    return k;\n"
+            "}\n"
+            "static inline void __btrc_ctrl_set(unsigned char* ctrl, int cap, int i, int byte) {\n"
+            "    ctrl[i] = (unsigned char)byte;\n"
+            "    if (i < 8) ctrl[cap + i] = (unsigned char)byte;\n"
             "}"
         ),
     ),
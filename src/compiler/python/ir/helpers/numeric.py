@@ -0,0 +1,167 @@
+"""Numeric bulk-op helpers -- the bodies of Vector/Array sum, min, max, fill,
+contains, indexOf, count, dot, axpy, scale and add for primitive element
+types (see ir/gen/generics/specialize.py).
+
+Every loop is blocked: an outer loop over groups of 8 elements and a
+fixed-width inner loop, then a scalar tail. GCC and clang vectorize the
+inner loops at -O2, where their cost models reject a plain loop that
+would need a runtime epilogue. Reductions keep 8 partial results and
+combine them at the end, so float and double sums round differently
+from a strict left-to-right sum. The pointers are restrict: distinct
+Vectors never share a buffer, and axpy/add handle x being y itself.
+"""
+
+from string import Template
+
+from .core import HelperDef
+
+# Element C type -> helper name suffix
+NUMERIC_TYPES = {
+    "int": "int",
+    "long": "long",
+    "short": "short",
+    "unsigned int": "uint",
+    "float": "float",
+    "double": "double",
+}
+
+_SUM = Template(
+    "static $T __btrc_vec_sum_$S(const $T* restrict data, int n) {\n"
+    "    $T lane[8] = {0};\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) lane[k] += data[i + k];\n"
+    "    $T s = 0;\n"
+    "    for (int k = 0; k < 8; k++) s += lane[k];\n"
+    "    for (; i < n; i++) s += data[i];\n"
+    "    return s;\n"
+    "}"
+)
+
+# n > 0; the caller reports an empty Vector
+_MIN_MAX = Template(
+    "static $T __btrc_vec_${NAME}_$S(const $T* restrict data, int n) {\n"
+    "    $T lane[8];\n"
+    "    for (int k = 0; k < 8; k++) lane[k] = data[0];\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) lane[k] = data[i + k] $OP lane[k] ? data[i + k] : lane[k];\n"
+    "    $T m = lane[0];\n"
+    "    for (int k = 1; k < 8; k++) m = lane[k] $OP m ? lane[k] : m;\n"
+    "    for (; i < n; i++) m = data[i] $OP m ? data[i] : m;\n"
+    "    return m;\n"
+    "}"
+)
+
+_FILL = Template(
+    "static void __btrc_vec_fill_$S($T* restrict data, int n, $T val) {\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) data[i + k] = val;\n"
+    "    for (; i < n; i++) data[i] = val;\n"
+    "}"
+)
+
+# Whole groups are tested at once; the scalar loop finds the hit within one
+_INDEX = Template(
+    "static int __btrc_vec_index_$S(const $T* restrict data, int n, $T val) {\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8) {\n"
+    "        int hit = 0;\n"
+    "        for (int k = 0; k < 8; k++) hit |= data[i + k] == val;\n"
+    "        if (hit) break;\n"
+    "    }\n"
+    "    for (; i < n; i++)\n"
+    "        if (data[i] == val) return i;\n"
+    "    return -1;\n"
+    "}"
+)
+
+_COUNT = Template(
+    "static int __btrc_vec_count_$S(const $T* restrict data, int n, $T val) {\n"
+    "    int lane[8] = {0};\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) lane[k] += data[i + k] == val;\n"
+    "    int c = 0;\n"
+    "    for (int k = 0; k < 8; k++) c += lane[k];\n"
+    "    for (; i < n; i++) c += data[i] == val;\n"
+    "    return c;\n"
+    "}"
+)
+
+_DOT = Template(
+    "static $T __btrc_vec_dot_$S(const $T* restrict x, const $T* restrict y, int n) {\n"
+    "    $T lane[8] = {0};\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) lane[k] += x[i + k] * y[i + k];\n"
+    "    $T s = 0;\n"
+    "    for (int k = 0; k < 8; k++) s += lane[k];\n"
+    "    for (; i < n; i++) s += x[i] * y[i];\n"
+    "    return s;\n"
+    "}"
+)
+
+_SCALE = Template(
+    "static void __btrc_vec_scale_$S($T* restrict data, int n, $T a) {\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) data[i + k] = a * data[i + k];\n"
+    "    for (; i < n; i++) data[i] = a * data[i];\n"
+    "}"
+)
+
+# y += a * x. When x is y only y is read, so restrict still holds.
+_AXPY = Template(
+    "static void __btrc_vec_axpy_$S($T* restrict y, const $T* restrict x, int n, $T a) {\n"
+    "    if (x == y) {\n"
+    "        int i = 0;\n"
+    "        for (; i + 8 <= n; i += 8)\n"
+    "            for (int k = 0; k < 8; k++) y[i + k] = a * y[i + k] + y[i + k];\n"
+    "        for (; i < n; i++) y[i] = a * y[i] + y[i];\n"
+    "        return;\n"
+    "    }\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) y[i + k] = a * x[i + k] + y[i + k];\n"
+    "    for (; i < n; i++) y[i] = a * x[i] + y[i];\n"
+    "}"
+)
+
+_ADD = Template(
+    "static void __btrc_vec_add_$S($T* restrict y, const $T* restrict x, int n) {\n"
+    "    if (x == y) {\n"
+    "        __btrc_vec_scale_$S(y, n, 2);\n"
+    "        return;\n"
+    "    }\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) y[i + k] = x[i + k] + y[i + k];\n"
+    "    for (; i < n; i++) y[i] = x[i] + y[i];\n"
+    "}"
+)
+
+
+def _numeric_helpers(c_type: str, suffix: str) -> dict[str, HelperDef]:
+    def render(template: Template, **extra) -> str:
+        return template.substitute(T=c_type, S=suffix, **extra)
+
+    return {
+        f"__btrc_vec_sum_{suffix}": HelperDef(c_source=render(_SUM)),
+        f"__btrc_vec_min_{suffix}": HelperDef(c_source=render(_MIN_MAX, NAME="min", OP="<")),
+        f"__btrc_vec_max_{suffix}": HelperDef(c_source=render(_MIN_MAX, NAME="max", OP=">")),
+        f"__btrc_vec_fill_{suffix}": HelperDef(c_source=render(_FILL)),
+        f"__btrc_vec_index_{suffix}": HelperDef(c_source=render(_INDEX)),
+        f"__btrc_vec_count_{suffix}": HelperDef(c_source=render(_COUNT)),
+        f"__btrc_vec_dot_{suffix}": HelperDef(c_source=render(_DOT)),
+        f"__btrc_vec_scale_{suffix}": HelperDef(c_source=render(_SCALE)),
+        f"__btrc_vec_axpy_{suffix}": HelperDef(c_source=render(_AXPY)),
+        f"__btrc_vec_add_{suffix}": HelperDef(
+            c_source=render(_ADD), depends_on=[f"__btrc_vec_scale_{suffix}"]),
+    }
+
+
+NUMERIC: dict[str, HelperDef] = {}
+for _c_type, _suffix in NUMERIC_TYPES.items():
+    NUMERIC.update(_numeric_helpers(_c_type, _suffix))
@@ -0,0 +1,183 @@
+"""Profiler runtime helpers for `--profile` (see ir/profile.py).
+
+Unlike the other helpers these are not looked up by name: the runtime is
+rendered for the program's function list, and the string pool and cycle
+collector helpers get instrumented variants of their usual text.
+"""
+
+from __future__ import annotations
+
+_RUNTIME = """\
+/* btrc profiler (--profile). Per thread: a stack of open calls, call
+ * counts, self and total time per function, ARC and string pool counters.
+ * The thread that runs main reports at exit, to stderr, and writes a
+ * Chrome trace to $BTRC_PROFILE_TRACE if that is set. */
+typedef struct { int fn; long long start; long long child; } __btrc_prof_frame;
+typedef struct { int fn; long long start; long long dur; } __btrc_prof_event;
+#define __BTRC_PROF_FNS {count}
+#define __BTRC_PROF_EVENT_LIMIT 1000000
+static const char* const __btrc_prof_names[__BTRC_PROF_FNS] = {
+{names}
+};
+static _Thread_local long long __btrc_prof_calls[__BTRC_PROF_FNS];
+static _Thread_local long long __btrc_prof_self[__BTRC_PROF_FNS];
+static _Thread_local long long __btrc_prof_total[__BTRC_PROF_FNS];
+static _Thread_local int __btrc_prof_active[__BTRC_PROF_FNS];
+static _Thread_local __btrc_prof_frame* __btrc_prof_stack = NULL;
+static _Thread_local int __btrc_prof_sp = 0;
+static _Thread_local int __btrc_prof_stack_cap = 0;
+static _Thread_local __btrc_prof_event* __btrc_prof_events = NULL;
+static _Thread_local int __btrc_prof_event_count = 0;
+static _Thread_local int __btrc_prof_event_cap = 0;
+static _Thread_local long long __btrc_prof_dropped = 0;
+static _Thread_local long long __btrc_prof_retains = 0;
+static _Thread_local long long __btrc_prof_releases = 0;
+static _Thread_local long long __btrc_prof_destroys = 0;
+static _Thread_local long long __btrc_prof_cc_runs = 0;
+static _Thread_local long long __btrc_prof_cc_time = 0;
+static _Thread_local int __btrc_prof_pool_peak = 0;
+static long long __btrc_prof_epoch = 0;
+static const char* __btrc_prof_trace = NULL;
+
+static long long __btrc_prof_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* __btrc_prof_grow(void* p, int* cap, size_t size) {
+    *cap = *cap ? *cap * 2 : 64;
+    p = realloc(p, size * (size_t)*cap);
+    if (!p) { fprintf(stderr, "btrc: profiler OOM\\n"); exit(1); }
+    return p;
+}
+
+static int __btrc_prof_enter(int fn) {
+    if (__btrc_prof_sp == __btrc_prof_stack_cap)
+        __btrc_prof_stack = (__btrc_prof_frame*)__btrc_prof_grow(
+            __btrc_prof_stack, &__btrc_prof_stack_cap, sizeof(__btrc_prof_frame));
+    __btrc_prof_calls[fn]++;
+    __btrc_prof_active[fn]++;
+    __btrc_prof_frame* f = &__btrc_prof_stack[__btrc_prof_sp];
+    f->fn = fn;
+    f->child = 0;
+    f->start = __btrc_prof_now();
+    return __btrc_prof_sp++;
+}
+
+/* Close the call opened at `slot`, and any above it that a throw unwound.
+ * A recursive call's time counts toward its function's total once. */
+static void __btrc_prof_leave(int slot) {
+    long long now = __btrc_prof_now();
+    while (__btrc_prof_sp > slot) {
+        __btrc_prof_frame* f = &__btrc_prof_stack[--__btrc_prof_sp];
+        long long elapsed = now - f->start;
+        __btrc_prof_self[f->fn] += elapsed - f->child;
+        if (--__btrc_prof_active[f->fn] == 0) __btrc_prof_total[f->fn] += elapsed;
+        if (__btrc_prof_sp > 0) __btrc_prof_stack[__btrc_prof_sp - 1].child += elapsed;
+        if (!__btrc_prof_trace) continue;
+        if (__btrc_prof_event_count == __BTRC_PROF_EVENT_LIMIT) { __btrc_prof_dropped++; continue; }
+        if (__btrc_prof_event_count == __btrc_prof_event_cap)
+            __btrc_prof_events = (__btrc_prof_event*)__btrc_prof_grow(
+                __btrc_prof_events, &__btrc_prof_event_cap, sizeof(__btrc_prof_event));
+        __btrc_prof_event* e = &__btrc_prof_events[__btrc_prof_event_count++];
+        e->fn = f->fn;
+        e->start = f->start;
+        e->dur = elapsed;
+    }
+}
+
+static void __btrc_prof_write_trace(void) {
+    FILE* out = fopen(__btrc_prof_trace, "w");
+    if (!out) {
+        fprintf(stderr, "btrc: cannot write profile trace '%s'\\n", __btrc_prof_trace);
+        return;
+    }
+    fprintf(out, "{\\"traceEvents\\":[");
+    for (int i = 0; i < __btrc_prof_event_count; i++) {
+        __btrc_prof_event* e = &__btrc_prof_events[i];
+        fprintf(out, "%s\\n{\\"name\\":\\"%s\\",\\"ph\\":\\"X\\",\\"pid\\":1,\\"tid\\":1,"
+                "\\"ts\\":%.3f,\\"dur\\":%.3f}", i ? "," : "", __btrc_prof_names[e->fn],
+                (e->start - __btrc_prof_epoch) / 1e3, e->dur / 1e3);
+    }
+    fprintf(out, "\\n],\\"displayTimeUnit\\":\\"ms\\"}\\n");
+    fclose(out);
+    fprintf(stderr, "trace: %d calls written to %s", __btrc_prof_event_count, __btrc_prof_trace);
+    if (__btrc_prof_dropped) fprintf(stderr, " (%lld more dropped)", __btrc_prof_dropped);
+    fprintf(stderr, "\\n");
+}
+
+static int __btrc_prof_by_self(const void* a, const void* b) {
+    long long x = __btrc_prof_self[*(const int*)a], y = __btrc_prof_self[*(const int*)b];
+    return (x < y) - (x > y);
+}
+
+static void __btrc_prof_report(void) {
+    __btrc_prof_leave(0);  /* calls still open when exit() was called */
+    int order[__BTRC_PROF_FNS];
+    int n = 0;
+    for (int i = 0; i < __BTRC_PROF_FNS; i++)
+        if (__btrc_prof_calls[i]) order[n++] = i;
+    qsort(order, (size_t)n, sizeof(int), __btrc_prof_by_self);
+    fprintf(stderr, "\\n--- btrc profile ---\\n%12s %12s %12s  %s\\n",
+            "calls", "self ms", "total ms", "function");
+    for (int k = 0; k < n; k++) {
+        int i = order[k];
+        fprintf(stderr, "%12lld %12.3f %12.3f  %s\\n", __btrc_prof_calls[i],
+                __btrc_prof_self[i] / 1e6, __btrc_prof_total[i] / 1e6, __btrc_prof_names[i]);
+    }
+    fprintf(stderr, "ARC: %lld retains, %lld releases, %lld destroys\\n",
+            __btrc_prof_retains, __btrc_prof_releases, __btrc_prof_destroys);
+    fprintf(stderr, "cycle collector: %lld runs, %.3f ms\\n",
+            __btrc_prof_cc_runs, __btrc_prof_cc_time / 1e6);
+    fprintf(stderr, "string pool: peak %d tracked strings\\n", __btrc_prof_pool_peak);
+    if (__btrc_prof_trace) __btrc_prof_write_trace();
+}
+
+static void __btrc_prof_start(void) {
+    __btrc_prof_epoch = __btrc_prof_now();
+    __btrc_prof_trace = getenv("BTRC_PROFILE_TRACE");
+    atexit(__btrc_prof_report);
+}"""
+
+_CYCLES_TIMER = """\
+static void __btrc_collect_cycles(void) {
+    long long start = __btrc_prof_now();
+    __btrc_collect_cycles_untimed();
+    __btrc_prof_cc_runs++;
+    __btrc_prof_cc_time += __btrc_prof_now() - start;
+}
+"""
+
+
+def profile_runtime(names: list[str]) -> str:
+    """The profiler runtime for a program whose function `i` is `names[i]`."""
+    table = ",\n".join(f'    "{name}"' for name in names)
+    return _RUNTIME.replace("{count}", str(len(names))).replace("{names}", table)
+
+
+def _patched(c_source: str, old: str, new: str) -> str:
+    assert old in c_source, f"profile: helper text changed near {old!r}"
+    return c_source.replace(old, new, 1)
+
+
+def _profiled_str_track(c_source: str) -> str:
+    return _patched(c_source, "    return s;\n}", (
+        "    if (__btrc_str_pool_top > __btrc_prof_pool_peak)"
+        " __btrc_prof_pool_peak = __btrc_str_pool_top;\n"
+        "    return s;\n}"))
+
+
+def _profiled_collect_cycles(c_source: str) -> str:
+    # The collector keeps its body under another name; every caller goes
+    # through the timer defined after it
+    c_source = _patched(c_source, "static void __btrc_collect_cycles(void) {",
+                        "static void __btrc_collect_cycles_untimed(void) {")
+    return c_source + "\n" + _CYCLES_TIMER.rstrip("\n")
+
+
+# Helper name -> its C text with profiling counters added
+PROFILED_HELPERS = {
+    "__btrc_str_track": _profiled_str_track,
+    "__btrc_collect_cycles": _profiled_collect_cycles,
+}
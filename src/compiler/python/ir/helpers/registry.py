@@ -1,12 +1,15 @@
 """Registry of all runtime helper categories, aggregated into a single HELPERS dict."""
 
 from .alloc import ALLOC
+from .arena import ARENA
 from .collections import COLLECTIONS
 from .core import HelperDef
 from .cycles import CYCLES
 from .divmod import DIVMOD
 from .hash import HASH
 from .math import MATH
+from .numeric import NUMERIC
+from .sort import SORT
 from .string_pool import STRING_POOL
 from .strings import STRING
 from .threads import THREADS
@@ -14,6 +17,7 @@ from .trycatch import TRYCATCH
 
 HELPERS: dict[str, dict[str, HelperDef]] = {
     "alloc": ALLOC,
+    "arena": ARENA,
     "divmod": DIVMOD,
     "string_pool": STRING_POOL,
     "string": STRING,
@@ -23,16 +27,21 @@ HELPERS: dict[str, dict[str, HelperDef]] = {
     "collections": COLLECTIONS,
     "cycles": CYCLES,
     "threads": THREADS,
+    "sort": SORT,
+    "numeric": NUMERIC,
 }
 
 __all__ = [
     "ALLOC",
+    "ARENA",
     "COLLECTIONS",
     "CYCLES",
     "DIVMOD",
     "HASH",
     "HELPERS",
     "MATH",
+    "NUMERIC",
+    "SORT",
     "STRING",
     "STRING_POOL",
     "THREADS",
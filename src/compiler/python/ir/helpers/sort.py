@@ -0,0 +1,111 @@
+"""Sort runtime helpers -- radix sorts for Vector<int>/Vector<float>.sort() and
+the merge passes of Vector.parSort()."""
+
+from .core import HelperDef
+
+SORT = {
+    "__btrc_radix_sort_u32": HelperDef(
+        c_source=(
+            "/* LSD radix sort on 8-bit digits. A pass whose digit is the same for\n"
+            " * every key is skipped, so narrow key ranges cost fewer passes. */\n"
+            "static void __btrc_radix_sort_u32(unsigned int* keys, int n) {\n"
+            "    unsigned int* tmp = (unsigned int*)__btrc_safe_realloc(NULL, sizeof(unsigned int) * n);\n"
+            "    unsigned int* src = keys;\n"
+            "    unsigned int* dst = tmp;\n"
+            "    for (int shift = 0; shift < 32; shift += 8) {\n"
+            "        int count[256] = {0};\n"
+            "        for (int i = 0; i < n; i++) count[(src[i] >> shift) & 255]++;\n"
+            "        if (count[(src[0] >> shift) & 255] == n) continue;\n"
+            "        int pos = 0;\n"
+            "        for (int d = 0; d < 256; d++) { int c = count[d]; count[d] = pos; pos += c; }\n"
+            "        for (int i = 0; i < n; i++) dst[count[(src[i] >> shift) & 255]++] = src[i];\n"
+            "        unsigned int* t = src; src = dst; dst = t;\n"
+            "    }\n"
+            "    if (src != keys) memcpy(keys, src, sizeof(unsigned int) * n);\n"
+            "    free(tmp);\n"
+            "}"
+        ),
+        depends_on=["__btrc_safe_realloc"],
+    ),
+    "__btrc_radix_sort_int": HelperDef(
+        c_source=(
+            "/* Flipping the sign bit makes unsigned order match signed order */\n"
+            "static void __btrc_radix_sort_int(int* data, int n) {\n"
+            "    unsigned int* keys = (unsigned int*)data;\n"
+            "    for (int i = 0; i < n; i++) keys[i] ^= 0x80000000u;\n"
+            "    __btrc_radix_sort_u32(keys, n);\n"
+            "    for (int i = 0; i < n; i++) keys[i] ^= 0x80000000u;\n"
+            "}"
+        ),
+        depends_on=["__btrc_radix_sort_u32"],
+    ),
+    "__btrc_radix_sort_float": HelperDef(
+        c_source=(
+            "/* IEEE-754 bits ordered as unsigned: set the sign bit of positives,\n"
+            " * invert negatives. NaNs sort to the ends by their sign. */\n"
+            "static void __btrc_radix_sort_float(float* data, int n) {\n"
+            "    unsigned int* keys = (unsigned int*)__btrc_safe_realloc(NULL, sizeof(unsigned int) * n);\n"
+            "    for (int i = 0; i < n; i++) {\n"
+            "        unsigned int u;\n"
+            "        memcpy(&u, &data[i], sizeof(u));\n"
+            "        keys[i] = (u & 0x80000000u) ? ~u : (u | 0x80000000u);\n"
+            "    }\n"
+            "    __btrc_radix_sort_u32(keys, n);\n"
+            "    for (int i = 0; i < n; i++) {\n"
+            "        unsigned int u = (keys[i] & 0x80000000u) ? (keys[i] ^ 0x80000000u) : ~keys[i];\n"
+            "        memcpy(&data[i], &u, sizeof(u));\n"
+            "    }\n"
+            "    free(keys);\n"
+            "}"
+        ),
+        depends_on=["__btrc_radix_sort_u32", "__btrc_safe_realloc"],
+    ),
+    "__btrc_par_merge_runs": HelperDef(
+        c_source=(
+            "/* Merge passes of Vector.parSort(). __btrc_parallel_for leaves sorted\n"
+            " * runs one grain long; each pass doubles the run width and merges its\n"
+            " * pairs of runs in parallel. merge(ctx, lo, mid, hi) merges\n"
+            " * [lo, mid) and [mid, hi) in place. */\n"
+            "typedef void (*__btrc_merge_fn)(__btrc_par_ctx_t*, int, int, int);\n"
+            "\n"
+            "typedef struct {\n"
+            "    __btrc_merge_fn merge;\n"
+            "    __btrc_par_ctx_t* ctx;\n"
+            "    int lo, mid, hi;\n"
+            "} __btrc_merge_task_t;\n"
+            "\n"
+            "static void* __btrc_merge_run(void* raw) {\n"
+            "    __btrc_merge_task_t* t = (__btrc_merge_task_t*)raw;\n"
+            "    t->merge(t->ctx, t->lo, t->mid, t->hi);\n"
+            "    return NULL;\n"
+            "}\n"
+            "\n"
+            "static void __btrc_par_merge_runs(int n, __btrc_merge_fn merge, __btrc_par_ctx_t* ctx) {\n"
+            "    int most = (__btrc_par_chunks(n) + 1) / 2;\n"
+            "    __btrc_merge_task_t* tasks = (__btrc_merge_task_t*)__btrc_safe_realloc(NULL, sizeof(__btrc_merge_task_t) * most);\n"
+            "    __btrc_thread_t** handles = (__btrc_thread_t**)__btrc_safe_realloc(NULL, sizeof(__btrc_thread_t*) * most);\n"
+            "    for (int width = __btrc_par_grain(n); width < n; width = width > n / 2 ? n : width * 2) {\n"
+            "        int pairs = 0;\n"
+            "        for (int lo = 0; lo < n - width; lo += 2 * width) {\n"
+            "            tasks[pairs].merge = merge;\n"
+            "            tasks[pairs].ctx = ctx;\n"
+            "            tasks[pairs].lo = lo;\n"
+            "            tasks[pairs].mid = lo + width;\n"
+            "            tasks[pairs].hi = n - lo - width > width ? lo + 2 * width : n;\n"
+            "            pairs++;\n"
+            "        }\n"
+            "        for (int p = 1; p < pairs; p++)\n"
+            "            handles[p] = __btrc_thread_spawn(__btrc_merge_run, &tasks[p]);\n"
+            "        if (pairs > 0) __btrc_merge_run(&tasks[0]);\n"
+            "        for (int p = 1; p < pairs; p++) {\n"
+            "            __btrc_thread_join(handles[p]);\n"
+            "            __btrc_thread_free(handles[p]);\n"
+            "        }\n"
+            "    }\n"
+            "    free(handles);\n"
+            "    free(tasks);\n"
+            "}"
+        ),
+        depends_on=["__btrc_parallel_for", "__btrc_safe_realloc"],
+    ),
+}
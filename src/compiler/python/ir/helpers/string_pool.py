@@ -5,10 +5,10 @@ from .core import HelperDef
 STRING_POOL = {
     "__btrc_str_pool_globals": HelperDef(
         c_source=(
-            "/* btrc string temp pool (dynamic) */\n"
-            "static int __btrc_str_pool_cap = 256;\n"
-            "static char** __btrc_str_pool = NULL;\n"
-            "static int __btrc_str_pool_top = 0;"
+            "/* btrc string temp pool (dynamic, one per thread) */\n"
+            "static _Thread_local int __btrc_str_pool_cap = 256;\n"
+            "static _Thread_local char** __btrc_str_pool = NULL;\n"
+            "static _Thread_local int __btrc_str_pool_top = 0;"
         ),
     ),
     "__btrc_str_track": HelperDef(
@@ -40,4 +40,18 @@ STRING_POOL = {
         ),
         depends_on=["__btrc_str_pool_globals"],
     ),
+    "__btrc_str_release": HelperDef(
+        c_source=(
+            "/* Scoped flush: free the strings tracked since the matching mark */\n"
+            "static inline int __btrc_str_mark(void) {\n"
+            "    return __btrc_str_pool_top;\n"
+            "}\n"
+            "static inline void __btrc_str_release(int mark) {\n"
+            "    while (__btrc_str_pool_top > mark) {\n"
+            "        free(__btrc_str_pool[--__btrc_str_pool_top]);\n"
+            "    }\n"
+            "}"
+        ),
+        depends_on=["__btrc_str_pool_globals"],
+    ),
 }
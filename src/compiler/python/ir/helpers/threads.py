@@ -1,39 +1,159 @@
-"""Threading runtime helpers -- pthread wrappers for spawn/join."""
+"""Threading runtime helpers -- work-stealing task pool for spawn/join, Mutex<T>."""
 
 from .core import HelperDef
 
 THREADS = {
-    "__btrc_thread_spawn": HelperDef(
+    "__btrc_thread_pool": HelperDef(
         c_source=(
+            "/* Work-stealing task pool behind spawn/join. One worker per core\n"
+            " * (BTRC_THREADS overrides), each with a mutex-guarded deque: owners\n"
+            " * push and pop the bottom, idle workers steal from the top. Spawns\n"
+            " * from threads outside the pool go to a shared queue. */\n"
             "typedef struct {\n"
             "    void* (*fn)(void*);\n"
             "    void* arg;\n"
             "    void* result;\n"
-            "    pthread_t handle;\n"
+            "    _Atomic int done;\n"
             "} __btrc_thread_t;\n"
             "\n"
-            "static void* __btrc_thread_wrapper(void* raw) {\n"
-            "    __btrc_thread_t* t = (__btrc_thread_t*)raw;\n"
+            "typedef struct {\n"
+            "    pthread_mutex_t lock;\n"
+            "    __btrc_thread_t** items;\n"
+            "    int head, count, cap;\n"
+            "} __btrc_deque_t;\n"
+            "\n"
+            "static int __btrc_pool_size = 0;\n"
+            "static __btrc_deque_t* __btrc_pool_deques = NULL;\n"
+            "static _Atomic int __btrc_pool_pending = 0;\n"
+            "static pthread_mutex_t __btrc_pool_lock = PTHREAD_MUTEX_INITIALIZER;\n"
+            "static pthread_cond_t __btrc_pool_wake = PTHREAD_COND_INITIALIZER;\n"
+            "static pthread_cond_t __btrc_pool_done = PTHREAD_COND_INITIALIZER;\n"
+            "static pthread_once_t __btrc_pool_once = PTHREAD_ONCE_INIT;\n"
+            "static _Thread_local int __btrc_worker_id = -1;\n"
+            "\n"
+            "static void __btrc_deque_push(__btrc_deque_t* d, __btrc_thread_t* t) {\n"
+            "    pthread_mutex_lock(&d->lock);\n"
+            "    if (d->count == d->cap) {\n"
+            "        int cap = d->cap ? d->cap * 2 : 64;\n"
+            "        __btrc_thread_t** items = (__btrc_thread_t**)__btrc_safe_realloc(NULL, sizeof(__btrc_thread_t*) * cap);\n"
+            "        for (int i = 0; i < d->count; i++) items[i] = d->items[(d->head + i) % d->cap];\n"
+            "        free(d->items);\n"
+            "        d->items = items;\n"
+            "        d->head = 0;\n"
+            "        d->cap = cap;\n"
+            "    }\n"
+            "    d->items[(d->head + d->count) % d->cap] = t;\n"
+            "    d->count++;\n"
+            "    pthread_mutex_unlock(&d->lock);\n"
+            "}\n"
+            "\n"
+            "/* Owner end (newest first) or thief end (oldest first) */\n"
+            "static __btrc_thread_t* __btrc_deque_take(__btrc_deque_t* d, int steal) {\n"
+            "    __btrc_thread_t* t = NULL;\n"
+            "    pthread_mutex_lock(&d->lock);\n"
+            "    if (d->count > 0) {\n"
+            "        d->count--;\n"
+            "        if (steal) {\n"
+            "            t = d->items[d->head];\n"
+            "            d->head = (d->head + 1) % d->cap;\n"
+            "        } else {\n"
+            "            t = d->items[(d->head + d->count) % d->cap];\n"
+            "        }\n"
+            "    }\n"
+            "    pthread_mutex_unlock(&d->lock);\n"
+            "    return t;\n"
+            "}\n"
+            "\n"
+            "/* Next task for the calling thread: its own deque, then the shared\n"
+            " * queue, then the other workers' deques */\n"
+            "static __btrc_thread_t* __btrc_pool_take(void) {\n"
+            "    if (__btrc_pool_pending == 0) return NULL;\n"
+            "    int self = __btrc_worker_id;\n"
+            "    __btrc_thread_t* t = self >= 0 ? __btrc_deque_take(&__btrc_pool_deques[self], 0) : NULL;\n"
+            "    if (!t) t = __btrc_deque_take(&__btrc_pool_deques[__btrc_pool_size], 1);\n"
+            "    for (int i = 1; !t && i <= __btrc_pool_size; i++) {\n"
+            "        int victim = (self + i + __btrc_pool_size) % __btrc_pool_size;\n"
+            "        if (victim != self) t = __btrc_deque_take(&__btrc_pool_deques[victim], 1);\n"
+            "    }\n"
+            "    if (t) __btrc_pool_pending--;\n"
+            "    return t;\n"
+            "}\n"
+            "\n"
+            "static void __btrc_pool_run(__btrc_thread_t* t) {\n"
             "    t->result = t->fn(t->arg);\n"
+            "    pthread_mutex_lock(&__btrc_pool_lock);\n"
+            "    t->done = 1;\n"
+            "    pthread_cond_broadcast(&__btrc_pool_done);\n"
+            "    pthread_mutex_unlock(&__btrc_pool_lock);\n"
+            "}\n"
+            "\n"
+            "static void* __btrc_pool_worker(void* raw) {\n"
+            "    __btrc_worker_id = (int)(intptr_t)raw;\n"
+            "    for (;;) {\n"
+            "        __btrc_thread_t* t = __btrc_pool_take();\n"
+            "        if (t) { __btrc_pool_run(t); continue; }\n"
+            "        pthread_mutex_lock(&__btrc_pool_lock);\n"
+            "        while (__btrc_pool_pending == 0)\n"
+            "            pthread_cond_wait(&__btrc_pool_wake, &__btrc_pool_lock);\n"
+            "        pthread_mutex_unlock(&__btrc_pool_lock);\n"
+            "    }\n"
             "    return NULL;\n"
             "}\n"
             "\n"
+            "static void __btrc_pool_init(void) {\n"
+            '    const char* env = getenv("BTRC_THREADS");\n'
+            "    int n = env ? atoi(env) : (int)sysconf(_SC_NPROCESSORS_ONLN);\n"
+            "    __btrc_pool_size = n > 0 ? n : 1;\n"
+            "    __btrc_pool_deques = (__btrc_deque_t*)calloc((size_t)__btrc_pool_size + 1, sizeof(__btrc_deque_t));\n"
+            '    if (!__btrc_pool_deques) { fprintf(stderr, "btrc: thread pool alloc failed\\n"); exit(1); }\n'
+            "    for (int i = 0; i <= __btrc_pool_size; i++)\n"
+            "        pthread_mutex_init(&__btrc_pool_deques[i].lock, NULL);\n"
+            "    for (int i = 0; i < __btrc_pool_size; i++) {\n"
+            "        pthread_t handle;\n"
+            "        if (pthread_create(&handle, NULL, __btrc_pool_worker, (void*)(intptr_t)i) != 0) {\n"
+            '            fprintf(stderr, "btrc: pthread_create failed\\n");\n'
+            "            exit(1);\n"
+            "        }\n"
+            "        pthread_detach(handle);\n"
+            "    }\n"
+            "}"
+        ),
+        depends_on=["__btrc_safe_realloc"],
+    ),
+    "__btrc_thread_spawn": HelperDef(
+        c_source=(
             "static __btrc_thread_t* __btrc_thread_spawn(void* (*fn)(void*), void* arg) {\n"
+            "    pthread_once(&__btrc_pool_once, __btrc_pool_init);\n"
             "    __btrc_thread_t* t = (__btrc_thread_t*)malloc(sizeof(__btrc_thread_t));\n"
             '    if (!t) { fprintf(stderr, "btrc: thread alloc failed\\n"); exit(1); }\n'
             "    t->fn = fn;\n"
             "    t->arg = arg;\n"
             "    t->result = NULL;\n"
-            "    int err = pthread_create(&t->handle, NULL, __btrc_thread_wrapper, t);\n"
-            '    if (err != 0) { fprintf(stderr, "btrc: pthread_create failed\\n"); free(t); exit(1); }\n'
+            "    t->done = 0;\n"
+            "    int self = __btrc_worker_id;\n"
+            "    __btrc_deque_push(&__btrc_pool_deques[self >= 0 ? self : __btrc_pool_size], t);\n"
+            "    __btrc_pool_pending++;\n"
+            "    pthread_mutex_lock(&__btrc_pool_lock);\n"
+            "    pthread_cond_signal(&__btrc_pool_wake);\n"
+            "    pthread_mutex_unlock(&__btrc_pool_lock);\n"
             "    return t;\n"
             "}"
         ),
+        depends_on=["__btrc_thread_pool"],
     ),
     "__btrc_thread_join": HelperDef(
         c_source=(
+            "/* Run queued tasks while waiting, so joins inside tasks cannot\n"
+            " * starve the pool */\n"
             "static void* __btrc_thread_join(__btrc_thread_t* t) {\n"
-            "    pthread_join(t->handle, NULL);\n"
+            "    while (!t->done) {\n"
+            "        __btrc_thread_t* task = __btrc_pool_take();\n"
+            "        if (task) { __btrc_pool_run(task); continue; }\n"
+            "        pthread_mutex_lock(&__btrc_pool_lock);\n"
+            "        while (!t->done && __btrc_pool_pending == 0)\n"
+            "            pthread_cond_wait(&__btrc_pool_done, &__btrc_pool_lock);\n"
+            "        pthread_mutex_unlock(&__btrc_pool_lock);\n"
+            "    }\n"
             "    return t->result;\n"
             "}"
         ),
@@ -47,6 +167,72 @@ THREADS = {
         ),
         depends_on=["__btrc_thread_spawn"],
     ),
+    "__btrc_parallel_for": HelperDef(
+        c_source=(
+            "/* Chunked parallel loop behind Vector.par*(). Chunk sizes depend only\n"
+            " * on n (at least 1024 elements, at most 256 chunks), so per-chunk\n"
+            " * results combine in the same order on any machine. The caller runs\n"
+            " * chunk 0 itself and helps with the rest while joining. */\n"
+            "typedef struct {\n"
+            "    void* src;\n"
+            "    void* dst;\n"
+            "    void (*fn)(void);\n"
+            "    void* partial;\n"
+            "} __btrc_par_ctx_t;\n"
+            "\n"
+            "typedef void (*__btrc_par_body_fn)(__btrc_par_ctx_t*, int, int, int);\n"
+            "\n"
+            "typedef struct {\n"
+            "    __btrc_par_body_fn body;\n"
+            "    __btrc_par_ctx_t* ctx;\n"
+            "    int chunk, lo, hi;\n"
+            "} __btrc_par_task_t;\n"
+            "\n"
+            "static int __btrc_par_grain(int n) {\n"
+            "    int grain = (n + 255) / 256;\n"
+            "    return grain < 1024 ? 1024 : grain;\n"
+            "}\n"
+            "\n"
+            "static int __btrc_par_chunks(int n) {\n"
+            "    int grain = __btrc_par_grain(n);\n"
+            "    return n > 0 ? (n + grain - 1) / grain : 0;\n"
+            "}\n"
+            "\n"
+            "static void* __btrc_par_run(void* raw) {\n"
+            "    __btrc_par_task_t* t = (__btrc_par_task_t*)raw;\n"
+            "    t->body(t->ctx, t->chunk, t->lo, t->hi);\n"
+            "    return NULL;\n"
+            "}\n"
+            "\n"
+            "static void __btrc_parallel_for(int n, __btrc_par_body_fn body, __btrc_par_ctx_t* ctx) {\n"
+            "    int grain = __btrc_par_grain(n);\n"
+            "    int chunks = __btrc_par_chunks(n);\n"
+            "    if (chunks <= 1) {\n"
+            "        if (n > 0) body(ctx, 0, 0, n);\n"
+            "        return;\n"
+            "    }\n"
+            "    __btrc_par_task_t* tasks = (__btrc_par_task_t*)__btrc_safe_realloc(NULL, sizeof(__btrc_par_task_t) * chunks);\n"
+            "    __btrc_thread_t** handles = (__btrc_thread_t**)__btrc_safe_realloc(NULL, sizeof(__btrc_thread_t*) * chunks);\n"
+            "    for (int c = 1; c < chunks; c++) {\n"
+            "        int hi = (c + 1) * grain;\n"
+            "        tasks[c].body = body;\n"
+            "        tasks[c].ctx = ctx;\n"
+            "        tasks[c].chunk = c;\n"
+            "        tasks[c].lo = c * grain;\n"
+            "        tasks[c].hi = hi < n ? hi : n;\n"
+            "        handles[c] = __btrc_thread_spawn(__btrc_par_run, &tasks[c]);\n"
+            "    }\n"
+            "    body(ctx, 0, 0, grain);\n"
+            "    for (int c = 1; c < chunks; c++) {\n"
+            "        __btrc_thread_join(handles[c]);\n"
+            "        __btrc_thread_free(handles[c]);\n"
+            "    }\n"
+            "    free(handles);\n"
+            "    free(tasks);\n"
+            "}"
+        ),
+        depends_on=["__btrc_thread_join", "__btrc_thread_free", "__btrc_safe_realloc"],
+    ),
     "__btrc_mutex_val_create": HelperDef(
         c_source=(
             "typedef struct {\n"
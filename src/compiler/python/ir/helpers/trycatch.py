@@ -1,4 +1,5 @@
-"""Try/catch runtime helpers -- setjmp/longjmp-based try/catch runtime with cleanup."""
+"""Try/catch runtime helpers -- setjmp/longjmp-based try/catch runtime with cleanup,
+and the error flag that --exceptions=flag routines report throws through."""
 
 from .core import HelperDef
 
@@ -80,4 +81,38 @@ TRYCATCH = {
         ),
         depends_on=["__btrc_trycatch_globals", "__btrc_run_cleanups"],
     ),
+    "__btrc_pending": HelperDef(
+        c_source=(
+            "/* Set by a routine that returns with an exception (--exceptions=flag) */\n"
+            "static __thread int __btrc_pending = 0;"
+        ),
+        depends_on=["__btrc_trycatch_globals"],
+    ),
+    "__btrc_raise": HelperDef(
+        c_source=(
+            "static inline void __btrc_raise(const char* msg) {\n"
+            "    if (msg != __btrc_error_msg) {\n"
+            "        strncpy(__btrc_error_msg, msg, 1023);\n"
+            "        __btrc_error_msg[1023] = '\\0';\n"
+            "    }\n"
+            "    __btrc_pending = 1;\n"
+            "}"
+        ),
+        depends_on=["__btrc_pending"],
+    ),
+    "__btrc_rethrow": HelperDef(
+        c_source=(
+            "/* Hand a pending exception to the innermost setjmp try */\n"
+            "static inline void __btrc_rethrow(void) {\n"
+            "    __btrc_pending = 0;\n"
+            "    if (__btrc_try_top < 0) {\n"
+            '        fprintf(stderr, "Unhandled exception: %s\\n", __btrc_error_msg);\n'
+            "        exit(1);\n"
+            "    }\n"
+            "    __btrc_run_cleanups(__btrc_try_top);\n"
+            "    longjmp(__btrc_try_stack[__btrc_try_top--], 1);\n"
+            "}"
+        ),
+        depends_on=["__btrc_pending", "__btrc_run_cleanups"],
+    ),
 }
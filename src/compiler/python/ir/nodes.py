@@ -6,11 +6,37 @@ Rationale: C is structured, so a tree IR produces readable output.
 Key design: all AST lowering (class layout, generics, method-to-function,
 new/delete expansion, for-in expansion, f-string expansion, lambda lifting)
 happens during IR generation. The C emitter is a simple tree walk.
+
+Expression nodes live in nodes_exprs.py and are re-exported here; GPU
+compute nodes live in nodes_gpu.py.
 """
 
 from __future__ import annotations
 
 from dataclasses import dataclass, field
+from typing import TYPE_CHECKING
+
+from .nodes_exprs import (  # noqa: F401
+    IRExpr,
+    IRLiteral,
+    IRVar,
+    IRBinOp,
+    IRUnaryOp,
+    IRCall,
+    IRFieldAccess,
+    IRCast,
+    IRTernary,
+    IRSizeof,
+    IRIndex,
+    IRAddressOf,
+    IRDeref,
+    IRRawExpr,
+    IRStmtExpr,
+    IRSpawnThread,
+)
+
+if TYPE_CHECKING:
+    from .nodes_gpu import IRGpuKernel
 
 # --- C type representation ---
 
@@ -209,166 +235,3 @@ class IRBreak(IRStmt):
 class IRContinue(IRStmt):
     """Continue statement."""
     pass
-
-
-# --- Expressions ---
-
-@dataclass
-class IRExpr:
-    """Base for IR expressions."""
-    pass
-
-
-@dataclass
-class IRLiteral(IRExpr):
-    """C literal text (e.g., '42', '"hello"', 'NULL')."""
-    text: str = ""
-
-
-@dataclass
-class IRVar(IRExpr):
-    """Variable reference by C name."""
-    name: str = ""
-
-
-@dataclass
-class IRBinOp(IRExpr):
-    """Binary operator."""
-    left: IRExpr = None
-    op: str = ""
-    right: IRExpr = None
-
-
-@dataclass
-class IRUnaryOp(IRExpr):
-    """Unary operator."""
-    op: str = ""
-    operand: IRExpr = None
-    prefix: bool = True
-
-
-@dataclass
-class IRCall(IRExpr):
-    """Function call."""
-    callee: str = ""      # C function name or expression text
-    args: list[IRExpr] = field(default_factory=list)
-    helper_ref: str = ""  # if non-empty, tracks which runtime helper is used (for DCE)
-
-
-@dataclass
-class IRFieldAccess(IRExpr):
-    """Struct field access (. or ->)."""
-    obj: IRExpr = None
-    field: str = ""
-    arrow: bool = False
-
-
-@dataclass
-class IRCast(IRExpr):
-    """C type cast."""
-    target_type: CType = None
-    expr: IRExpr = None
-
-
-@dataclass
-class IRTernary(IRExpr):
-    """Ternary expression: `cond ? true_expr : false_expr`."""
-    condition: IRExpr = None
-    true_expr: IRExpr = None
-    false_expr: IRExpr = None
-
-
-@dataclass
-class IRSizeof(IRExpr):
-    """sizeof expression."""
-    operand: str = ""  # C type or expression text
-
-
-@dataclass
-class IRIndex(IRExpr):
-    """Array/pointer indexing: `obj[index]`."""
-    obj: IRExpr = None
-    index: IRExpr = None
-
-
-@dataclass
-class IRAddressOf(IRExpr):
-    """Address-of operator: `&expr`."""
-    expr: IRExpr = None
-
-
-@dataclass
-class IRDeref(IRExpr):
-    """Dereference operator: `*expr`."""
-    expr: IRExpr = None
-
-
-@dataclass
-class IRRawExpr(IRExpr):
-    """Escape hatch: pre-rendered C expression text."""
-    text: str = ""
-
-
-@dataclass
-class IRStmtExpr(IRExpr):
-    """Statement expression: evaluate setup stmts, then produce result.
-
-    The emitter hoists the stmts before the enclosing statement and uses
-    only the result in expression position. Produces standard C11.
-    """
-    stmts: list = field(default_factory=list)
-    result: IRExpr = None
-
-
-@dataclass
-class IRSpawnThread(IRExpr):
-    """Spawn a thread: __btrc_thread_spawn(fn_ptr, capture_arg)."""
-    fn_ptr: str = ""       # C function name (from lambda lowering)
-    capture_arg: IRExpr = None  # Capture struct pointer (or NULL)
-
-
-# --- GPU compute ---
-
-@dataclass
-class IRGpuBuffer:
-    """Metadata for a GPU buffer parameter."""
-    name: str = ""
-    elem_type: str = ""   # "f32", "i32"
-    access: str = "read"  # "read", "read_write"
-    binding: int = 0
-
-
-@dataclass
-class IRGpuKernel(IRStmt):
-    """A GPU compute kernel (WGSL source + metadata).
-
-    Emitted as a static C string constant containing the WGSL shader.
-    """
-    name: str = ""
-    wgsl_source: str = ""
-    workgroup_size: int = 64
-    param_buffers: list[IRGpuBuffer] = field(default_factory=list)
-    output_buffer: IRGpuBuffer = None  # None for void-returning kernels
-    uniform_params: list[tuple] = field(default_factory=list)  # (name, wgsl_type) pairs
-
-
-@dataclass
-class IRGpuDispatch(IRExpr):
-    """GPU kernel dispatch at a call site.
-
-    Extends IRExpr so it can be used in expression contexts
-    (e.g. `float[] result = vectorAdd(a, b)`).
-    The emitter hoists buffer creation, upload, dispatch, readback, and
-    cleanup as statements before the enclosing statement, then returns
-    the result variable name. Produces standard C11.
-    """
-    kernel_name: str = ""
-    args: list[IRExpr] = field(default_factory=list)
-    result_var: str = ""         # C variable to store readback result ("" for void)
-    result_elem_type: str = ""   # "float", "int" — C element type
-    array_len_expr: IRExpr = None  # expression for dispatch size (first array arg's length)
-    param_buffers: list[IRGpuBuffer] = field(default_factory=list)
-    output_buffer: IRGpuBuffer = None
-    uniform_params: list[tuple] = field(default_factory=list)
-    workgroup_size: int = 64
-    assign_target: str = ""      # If set, readback into this var via memcpy
@@ -0,0 +1,124 @@
+"""IR expression nodes (re-exported by nodes.py)."""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING
+
+if TYPE_CHECKING:
+    from .nodes import CType
+
+# --- Expressions ---
+
+@dataclass
+class IRExpr:
+    """Base for IR expressions."""
+    pass
+
+
+@dataclass
+class IRLiteral(IRExpr):
+    """C literal text (e.g., '42', '"hello"', 'NULL')."""
+    text: str = ""
+
+
+@dataclass
+class IRVar(IRExpr):
+    """Variable reference by C name."""
+    name: str = ""
+
+
+@dataclass
+class IRBinOp(IRExpr):
+    """Binary operator."""
+    left: IRExpr = None
+    op: str = ""
+    right: IRExpr = None
+
+
+@dataclass
+class IRUnaryOp(IRExpr):
+    """Unary operator."""
+    op: str = ""
+    operand: IRExpr = None
+    prefix: bool = True
+
+
+@dataclass
+class IRCall(IRExpr):
+    """Function call."""
+    callee: str = ""      # C function name or expression text
+    args: list[IRExpr] = field(default_factory=list)
+    helper_ref: str = ""  # if non-empty, tracks which runtime helper is used (for DCE)
+
+
+@dataclass
+class IRFieldAccess(IRExpr):
+    """Struct field access (. or ->)."""
+    obj: IRExpr = None
+    field: str = ""
+    arrow: bool = False
+
+
+@dataclass
+class IRCast(IRExpr):
+    """C type cast."""
+    target_type: CType = None
+    expr: IRExpr = None
+
+
+@dataclass
+class IRTernary(IRExpr):
+    """Ternary expression: `cond ? true_expr : false_expr`."""
+    condition: IRExpr = None
+    true_expr: IRExpr = None
+    false_expr: IRExpr = None
+
+
+@dataclass
+class IRSizeof(IRExpr):
+    """sizeof expression."""
+    operand: str = ""  # C type or expression text
+
+
+@dataclass
+class IRIndex(IRExpr):
+    """Array/pointer indexing: `obj[index]`."""
+    obj: IRExpr = None
+    index: IRExpr = None
+
+
+@dataclass
+class IRAddressOf(IRExpr):
+    """Address-of operator: `&expr`."""
+    expr: IRExpr = None
+
+
+@dataclass
+class IRDeref(IRExpr):
+    """Dereference operator: `*expr`."""
+    expr: IRExpr = None
+
+
+@dataclass
+class IRRawExpr(IRExpr):
+    """Escape hatch: pre-rendered C expression text."""
+    text: str = ""
+
+
+@dataclass
+class IRStmtExpr(IRExpr):
+    """Statement expression: evaluate setup stmts, then produce result.
+
+    The emitter hoists the stmts before the enclosing statement and uses
+    only the result in expression position. Produces standard C11.
+    """
+    stmts: list = field(default_factory=list)
+    result: IRExpr = None
+
+
+@dataclass
+class IRSpawnThread(IRExpr):
+    """Spawn a thread: __btrc_thread_spawn(fn_ptr, capture_arg)."""
+    fn_ptr: str = ""       # C function name (from lambda lowering)
+    capture_arg: IRExpr = None  # Capture struct pointer (or NULL)
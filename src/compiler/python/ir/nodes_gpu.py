@@ -0,0 +1,61 @@
+"""IR nodes for @gpu compute: kernels and their dispatch sites."""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from .nodes import IRExpr, IRStmt
+
+
+@dataclass
+class IRGpuBuffer:
+    """Metadata for a GPU buffer parameter."""
+    name: str = ""
+    elem_type: str = ""   # "f32", "i32"
+    access: str = "read"  # "read", "read_write"
+    binding: int = 0
+    resident: bool = False  # GpuArray<T>: bound in place, no host copies
+    collection: bool = False  # Vector<T>/Array<T>: copies ->data, ->len items
+
+
+@dataclass
+class IRGpuKernel(IRStmt):
+    """A GPU compute kernel (WGSL source + metadata).
+
+    Emitted as a static C string constant containing the WGSL shader.
+    """
+    name: str = ""
+    wgsl_source: str = ""
+    workgroup_size: tuple = (64, 1, 1)
+    grid_params: list[str] = field(default_factory=list)  # multi-D grid extents
+    param_buffers: list[IRGpuBuffer] = field(default_factory=list)
+    output_buffer: IRGpuBuffer = None  # None for void-returning kernels
+    uniform_params: list[tuple] = field(default_factory=list)  # (name, wgsl_type) pairs
+    arg_order: list[int] = field(default_factory=list)  # call args → buffers, then uniforms
+
+
+@dataclass
+class IRGpuDispatch(IRExpr):
+    """GPU kernel dispatch at a call site.
+
+    Extends IRExpr so it can be used in expression contexts
+    (e.g. `float[] result = vectorAdd(a, b)`).
+    The emitter hoists buffer creation, upload, dispatch, readback, and
+    cleanup as statements before the enclosing statement, then returns
+    the result variable name. Produces standard C11.
+    """
+    kernel_name: str = ""
+    args: list[IRExpr] = field(default_factory=list)
+    result_var: str = ""         # C variable to store readback result ("" for void)
+    result_elem_type: str = ""   # "float", "int" — C element type
+    array_len_expr: IRExpr = None  # expression for dispatch size (first array arg's length)
+    param_buffers: list[IRGpuBuffer] = field(default_factory=list)
+    output_buffer: IRGpuBuffer = None
+    uniform_params: list[tuple] = field(default_factory=list)
+    workgroup_size: tuple = (64, 1, 1)
+    grid_params: list[str] = field(default_factory=list)  # uniforms sizing a multi-D grid
+    assign_target: str = ""      # If set, readback into this var via memcpy
+    result_class: str = ""       # Mangled GpuArray<T> struct for resident output
+    batch_begin: bool = False    # Opens a command batch (optimizer fusion)
+    batch_end: bool = False      # Submits the batch after this dispatch
+    profile_label: str = ""      # Label its GPU work is charged to (--profile)
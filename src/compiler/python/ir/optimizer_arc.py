@@ -0,0 +1,202 @@
+"""ARC traffic elision pass for the IR optimizer.
+
+Works on straight-line statement lists, where the reference counts ARC
+lowering emits (`x->__rc++` for `keep`, scope-exit and `release`
+decrements) can be matched up without any flow analysis:
+
+- A retain `x->__rc++` followed by a release of `x` cancels out when the
+  statements between them can't observe or change any reference count:
+  no calls other than a few known-neutral ones, no assignment to `x`.
+  Both the plain release (`if (--x->__rc <= 0) destroy(x)`) and the
+  first phase of a cyclable scope release (a bare `--x->__rc`) match.
+  The retain keeps the count above zero, so the release never destroys.
+- A release of a variable that is provably NULL at that point (it was
+  just set to NULL, e.g. by `delete` or `release`) is dropped.
+- Statements after a `return`, `break` or `continue` in the same list
+  (the duplicated scope-exit cleanup after an early return) are dropped.
+"""
+
+from __future__ import annotations
+
+import re
+
+from .nodes import (
+    IRAddressOf,
+    IRAssign,
+    IRBinOp,
+    IRBreak,
+    IRCall,
+    IRContinue,
+    IRExpr,
+    IRExprStmt,
+    IRFieldAccess,
+    IRFunctionDef,
+    IRIf,
+    IRLiteral,
+    IRModule,
+    IRRawC,
+    IRRawExpr,
+    IRReturn,
+    IRSpawnThread,
+    IRStmt,
+    IRStmtExpr,
+    IRUnaryOp,
+    IRVar,
+    IRVarDecl,
+)
+from .nodes_gpu import IRGpuDispatch
+from .optimizer_walk import stmt_lists, walk
+
+_IDENT_RE = re.compile(r"[A-Za-z_][A-Za-z0-9_]*")
+
+# Calls that never touch an object's reference count
+_NEUTRAL_CALLS = {"assert", "printf", "__btrc_destroyed_reset"}
+
+
+def elide_arc_traffic(module: IRModule):
+    """Drop redundant retain/release pairs and dead cleanup code."""
+    for func in module.function_defs:
+        if func.body is None:
+            continue
+        escaped = _escaped_vars(func)
+        for stmts in list(stmt_lists(func)):
+            _drop_unreachable(stmts)
+            _cancel_pairs(stmts, escaped)
+            _drop_null_releases(stmts, escaped)
+
+
+def _drop_unreachable(stmts: list[IRStmt]):
+    for i, stmt in enumerate(stmts):
+        if isinstance(stmt, (IRReturn, IRBreak, IRContinue)):
+            if not any(isinstance(s, IRRawC) for s in stmts[i + 1:]):
+                del stmts[i + 1:]
+            return
+
+
+def _cancel_pairs(stmts: list[IRStmt], escaped: set[str]):
+    i = 0
+    while i < len(stmts):
+        var = _retained_var(stmts[i])
+        j = _matching_release(stmts, i, var) if var and var not in escaped else None
+        if j is None:
+            i += 1
+            continue
+        del stmts[j]
+        del stmts[i]
+
+
+def _matching_release(stmts: list[IRStmt], start: int, var: str) -> int | None:
+    for j in range(start + 1, len(stmts)):
+        stmt = stmts[j]
+        if _released_var(stmt) == var:
+            return j
+        if not _neutral(stmt, var):
+            return None
+    return None
+
+
+def _drop_null_releases(stmts: list[IRStmt], escaped: set[str]):
+    null_vars: set[str] = set()
+    i = 0
+    while i < len(stmts):
+        stmt = stmts[i]
+        if _released_var(stmt) in null_vars:
+            del stmts[i]
+            continue
+        null_vars -= _assigned_vars(stmt)
+        if (isinstance(stmt, IRAssign) and isinstance(stmt.target, IRVar)
+                and _is_null(stmt.value) and stmt.target.name not in escaped):
+            null_vars.add(stmt.target.name)
+        i += 1
+
+
+# --- Statement shapes -------------------------------------------------------
+
+def _rc_of(expr: IRExpr) -> str | None:
+    """`x` if `expr` is `x->__rc` for a plain variable `x`."""
+    if (isinstance(expr, IRFieldAccess) and expr.field == "__rc" and expr.arrow
+            and isinstance(expr.obj, IRVar)):
+        return expr.obj.name
+    return None
+
+
+def _retained_var(stmt: IRStmt) -> str | None:
+    """`x` for `x->__rc++;`."""
+    if (isinstance(stmt, IRExprStmt) and isinstance(stmt.expr, IRUnaryOp)
+            and stmt.expr.op == "++"):
+        return _rc_of(stmt.expr.operand)
+    return None
+
+
+def _released_var(stmt: IRStmt) -> str | None:
+    """`x` for `if (x != NULL) { --x->__rc ...; }` as ARC lowering emits it."""
+    if not (isinstance(stmt, IRIf) and stmt.else_block is None
+            and isinstance(stmt.condition, IRBinOp) and stmt.condition.op == "!="
+            and isinstance(stmt.condition.left, IRVar)
+            and _is_null(stmt.condition.right)
+            and stmt.then_block and len(stmt.then_block.stmts) == 1):
+        return None
+    var = stmt.condition.left.name
+    inner = stmt.then_block.stmts[0]
+    if isinstance(inner, IRExprStmt):  # phase 1: --x->__rc;
+        dec = inner.expr
+    elif (isinstance(inner, IRIf) and inner.else_block is None
+          and isinstance(inner.condition, IRBinOp) and inner.condition.op == "<="):
+        dec = inner.condition.left  # if (--x->__rc <= 0) destroy(x);
+    else:
+        return None
+    if (isinstance(dec, IRUnaryOp) and dec.op == "--" and dec.prefix
+            and _rc_of(dec.operand) == var):
+        return var
+    return None
+
+
+def _is_null(expr: IRExpr) -> bool:
+    return isinstance(expr, IRLiteral) and expr.text == "NULL"
+
+
+def _neutral(stmt: IRStmt, var: str | None) -> bool:
+    """No reference count observed or changed except through `->__rc` ops,
+    and `var` (if given) is not reassigned."""
+    if isinstance(stmt, (IRExprStmt, IRVarDecl, IRAssign, IRIf)):
+        if var is not None and var in _assigned_vars(stmt):
+            return False
+        return all(_neutral_node(n) for n in walk(stmt))
+    return False
+
+
+def _neutral_node(node) -> bool:
+    if isinstance(node, IRCall):
+        return node.callee in _NEUTRAL_CALLS
+    return not isinstance(node, (IRRawC, IRRawExpr, IRStmtExpr, IRSpawnThread))
+
+
+def _assigned_vars(stmt: IRStmt) -> set[str]:
+    names = set()
+    for node in walk(stmt):
+        if isinstance(node, IRAssign) and isinstance(node.target, IRVar):
+            names.add(node.target.name)
+        elif isinstance(node, IRBinOp) and node.op.endswith("=") and node.op not in (
+                "==", "!=", "<=", ">=") and isinstance(node.left, IRVar):
+            names.add(node.left.name)
+        elif (isinstance(node, IRUnaryOp) and node.op in ("++", "--")
+              and isinstance(node.operand, IRVar)):
+            names.add(node.operand.name)
+        elif isinstance(node, IRVarDecl):
+            names.add(node.name)
+    return names
+
+
+def _escaped_vars(func: IRFunctionDef) -> set[str]:
+    """Variables whose address is taken, that raw C text names, or that a
+    GPU dispatch writes back to."""
+    escaped = set()
+    for node in walk(func.body):
+        if isinstance(node, IRAddressOf) and isinstance(node.expr, IRVar):
+            escaped.add(node.expr.name)
+        elif isinstance(node, (IRRawC, IRRawExpr)):
+            escaped.update(_IDENT_RE.findall(node.text))
+        elif isinstance(node, IRGpuDispatch):
+            escaped.add(node.assign_target)
+            escaped.update(a.name for a in node.args if isinstance(a, IRVar))
+    return escaped
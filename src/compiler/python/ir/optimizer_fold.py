@@ -0,0 +1,195 @@
+"""Constant folding pass for the IR optimizer.
+
+Folds integer arithmetic on literals with C `int` semantics (truncating
+division, results that stay in 32-bit range, nothing that would be
+undefined behavior in C), turns the checked `__btrc_div_int` /
+`__btrc_mod_int` helpers into plain `/` and `%` when the divisor is a
+non-zero literal, and collects the literal factors of `sizeof` products
+(`sizeof(T) * 4 * 2` -> `sizeof(T) * 8`).
+"""
+
+from __future__ import annotations
+
+import re
+
+from .nodes import (
+    CType,
+    IRBinOp,
+    IRCall,
+    IRCast,
+    IRExpr,
+    IRLiteral,
+    IRModule,
+    IRSizeof,
+    IRUnaryOp,
+)
+from .optimizer_walk import rewrite_exprs
+
+_INT_RE = re.compile(r"^(0|[1-9][0-9]*)$")
+_FLOAT_RE = re.compile(r"^[0-9]+\.[0-9]*([eE][+-]?[0-9]+)?$")
+_INT_MAX = 2**31 - 1
+
+_CHECKED_DIVMOD = {
+    "__btrc_div_int": ("/", "int"),
+    "__btrc_mod_int": ("%", "int"),
+    "__btrc_div_double": ("/", "double"),
+}
+
+
+def fold_constants(module: IRModule):
+    """Fold constant expressions in every function body."""
+    for func in module.function_defs:
+        if func.body:
+            rewrite_exprs(func.body, _fold)
+
+
+def _fold(expr: IRExpr) -> IRExpr:
+    if isinstance(expr, IRBinOp):
+        return _fold_binop(expr)
+    if isinstance(expr, IRUnaryOp) and expr.prefix:
+        return _fold_unary(expr)
+    if isinstance(expr, IRCall) and expr.callee in _CHECKED_DIVMOD and len(expr.args) == 2:
+        return _fold_divmod(expr)
+    return expr
+
+
+def int_value(expr: IRExpr) -> int | None:
+    """Value of an integer constant: `42` or `-42` (as `-` applied to `42`)."""
+    if isinstance(expr, IRLiteral) and _INT_RE.match(expr.text):
+        return int(expr.text)
+    if (isinstance(expr, IRUnaryOp) and expr.op == "-" and expr.prefix
+            and isinstance(expr.operand, IRLiteral) and _INT_RE.match(expr.operand.text)):
+        return -int(expr.operand.text)
+    return None
+
+
+def _int_literal(value: int) -> IRExpr:
+    if value < 0:
+        return IRUnaryOp(op="-", operand=IRLiteral(text=str(-value)), prefix=True)
+    return IRLiteral(text=str(value))
+
+
+def _fold_unary(expr: IRUnaryOp) -> IRExpr:
+    v = int_value(expr.operand)
+    if v is None or int_value(expr) is not None:
+        return expr
+    result = {"-": -v, "+": v, "!": int(v == 0), "~": ~v}.get(expr.op)
+    if result is None or abs(result) > _INT_MAX:
+        return expr
+    return _int_literal(result)
+
+
+def _fold_binop(expr: IRBinOp) -> IRExpr:
+    a, b = int_value(expr.left), int_value(expr.right)
+    if a is None and b is None:
+        return _fold_sizeof_product(expr)
+    if a is None or b is None:
+        return _fold_logical_identity(expr, a if b is None else b)
+    result = _eval(expr.op, a, b)
+    if result is None or abs(result) > _INT_MAX:
+        return expr
+    return _int_literal(result)
+
+
+def _fold_logical_identity(expr: IRBinOp, k: int) -> IRExpr:
+    """`0 || c` and `1 && c` are `c` when `c` is already 0 or 1."""
+    other = expr.right if int_value(expr.left) is not None else expr.left
+    if ((expr.op == "||" and k == 0) or (expr.op == "&&" and k != 0)) and _is_boolean(other):
+        return other
+    if expr.op == "*":
+        return _fold_sizeof_product(expr)
+    return expr
+
+
+def _is_boolean(expr: IRExpr) -> bool:
+    if isinstance(expr, IRBinOp):
+        return expr.op in ("==", "!=", "<", "<=", ">", ">=", "&&", "||")
+    return isinstance(expr, IRUnaryOp) and expr.op == "!" and expr.prefix
+
+
+def _eval(op: str, a: int, b: int) -> int | None:
+    if op in ("+", "-", "*"):
+        return {"+": a + b, "-": a - b, "*": a * b}[op]
+    if op in ("/", "%"):
+        return _c_divmod(op, a, b)
+    if op in ("==", "!=", "<", "<=", ">", ">="):
+        return int({"==": a == b, "!=": a != b, "<": a < b,
+                    "<=": a <= b, ">": a > b, ">=": a >= b}[op])
+    if op == "&&":
+        return int(a != 0 and b != 0)
+    if op == "||":
+        return int(a != 0 or b != 0)
+    if op in ("&", "|", "^"):
+        return {"&": a & b, "|": a | b, "^": a ^ b}[op]
+    if op in ("<<", ">>") and a >= 0 and 0 <= b < 31:
+        return a << b if op == "<<" else a >> b
+    return None
+
+
+def _c_divmod(op: str, a: int, b: int) -> int | None:
+    """C99 `/` and `%`: the quotient truncates toward zero."""
+    if b == 0:
+        return None
+    q = abs(a) // abs(b)
+    if (a < 0) != (b < 0):
+        q = -q
+    return q if op == "/" else a - q * b
+
+
+def _fold_divmod(expr: IRCall) -> IRExpr:
+    """`__btrc_div_int(a, 4)` -> `a / 4`: a literal divisor can't be zero."""
+    op, c_type = _CHECKED_DIVMOD[expr.callee]
+    left, right = expr.args
+    if c_type == "int":
+        if not int_value(right):
+            return expr
+        a = int_value(left)
+        if a is not None:
+            folded = _fold_binop(IRBinOp(left=left, op=op, right=right))
+            if int_value(folded) is not None:
+                return folded
+        # The helper converts its operands to int; keep that conversion
+        if a is None:
+            left = IRCast(target_type=CType(text="int"), expr=left)
+        return IRBinOp(left=left, op=op, right=right)
+    if int_value(right) or (isinstance(right, IRLiteral) and _FLOAT_RE.match(right.text)
+                            and float(right.text) != 0.0):
+        return IRBinOp(left=IRCast(target_type=CType(text="double"), expr=left),
+                       op=op, right=right)
+    return expr
+
+
+def _fold_sizeof_product(expr: IRBinOp) -> IRExpr:
+    """Collect literal factors of a `sizeof` product into one.
+
+    size_t arithmetic wraps, so regrouping the factors is exact.
+    """
+    if expr.op != "*":
+        return expr
+    factors: list[IRExpr] = []
+    _product_factors(expr, factors)
+    sizes = [f for f in factors if isinstance(f, IRSizeof)]
+    consts = [int_value(f) for f in factors if not isinstance(f, IRSizeof)]
+    if not sizes or None in consts or any(c < 0 for c in consts):
+        return expr
+    k = 1
+    for c in consts:
+        k *= c
+    if len(consts) < 2 and k != 1:
+        return expr  # already a single factor
+    product: IRExpr = sizes[0]
+    for s in sizes[1:]:
+        product = IRBinOp(left=product, op="*", right=s)
+    if k != 1 and k <= _INT_MAX:
+        product = IRBinOp(left=product, op="*", right=IRLiteral(text=str(k)))
+    elif k != 1:
+        return expr
+    return product
+
+
+def _product_factors(expr: IRExpr, out: list[IRExpr]):
+    if isinstance(expr, IRBinOp) and expr.op == "*":
+        _product_factors(expr.left, out)
+        _product_factors(expr.right, out)
+    else:
+        out.append(expr)
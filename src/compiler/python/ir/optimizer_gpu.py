@@ -0,0 +1,87 @@
+"""GPU dispatch batching pass for the IR optimizer.
+
+Consecutive @gpu call statements are fused into one command batch: the
+first dispatch of a run opens it and the last submits it, so the whole
+run reaches the GPU queue in a single submit instead of one per call.
+"""
+
+from __future__ import annotations
+
+from .nodes import (
+    IRDoWhile,
+    IRExprStmt,
+    IRFor,
+    IRIf,
+    IRModule,
+    IRStmt,
+    IRSwitch,
+    IRVarDecl,
+    IRWhile,
+)
+from .nodes_gpu import IRGpuDispatch
+
+
+def batch_gpu_dispatches(module: IRModule):
+    """Mark runs of consecutive GPU dispatch statements for batching."""
+    if not module.gpu_kernels:
+        return
+    for func in module.function_defs:
+        if func.body:
+            _batch_block(func.body.stmts)
+
+
+def _batch_block(stmts: list[IRStmt]):
+    """Batch dispatch runs in a statement list, recursing into bodies.
+
+    A run ends at the first dispatch that reads results back to the host:
+    the readback has to flush the batch anyway, so it closes the run.
+    """
+    run: list[IRGpuDispatch] = []
+    for stmt in stmts:
+        _batch_nested(stmt)
+        dispatch = _stmt_dispatch(stmt)
+        if dispatch is None:
+            _close_run(run)
+            run = []
+            continue
+        run.append(dispatch)
+        if _reads_back(dispatch):
+            _close_run(run)
+            run = []
+    _close_run(run)
+
+
+def _batch_nested(stmt: IRStmt):
+    if isinstance(stmt, IRIf):
+        for block in (stmt.then_block, stmt.else_block):
+            if block:
+                _batch_block(block.stmts)
+    elif isinstance(stmt, (IRWhile, IRDoWhile, IRFor)):
+        if stmt.body:
+            _batch_block(stmt.body.stmts)
+    elif isinstance(stmt, IRSwitch):
+        for case in stmt.cases:
+            _batch_block(case.body)
+
+
+def _stmt_dispatch(stmt: IRStmt) -> IRGpuDispatch | None:
+    """The dispatch a statement consists of, if it is a bare @gpu call."""
+    if isinstance(stmt, IRExprStmt) and isinstance(stmt.expr, IRGpuDispatch):
+        return stmt.expr
+    if isinstance(stmt, IRVarDecl) and isinstance(stmt.init, IRGpuDispatch):
+        return stmt.init
+    return None
+
+
+def _reads_back(dispatch: IRGpuDispatch) -> bool:
+    out = dispatch.output_buffer
+    if out is not None:
+        return not out.resident
+    return any(buf.access == "read_write" and not buf.resident
+               for buf in dispatch.param_buffers)
+
+
+def _close_run(run: list[IRGpuDispatch]):
+    if len(run) > 1:
+        run[0].batch_begin = True
+        run[-1].batch_end = True
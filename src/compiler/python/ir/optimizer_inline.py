@@ -0,0 +1,207 @@
+"""Accessor inlining pass for the IR optimizer.
+
+Small functions whose whole body is one side-effect-free expression
+(`Vector.size()` -> `return self->len;`, user getters) are substituted at
+their direct call sites. Functions that check a guard first and then
+return such an expression (`Vector.get`, `first`, `last`) are inlined as
+`guard ? f(args) : expr`: the fast path reads the element in place and
+the rare failing case still goes through the real function, which
+reports the error exactly as before.
+
+Only calls whose arguments are themselves side-effect-free (variables,
+literals, field reads) are inlined, so evaluating an argument more than
+once, or not at all, is unobservable. Parameters and the result keep
+their C types through casts where the types can't be shown equal.
+"""
+
+from __future__ import annotations
+
+import copy
+import re
+from dataclasses import dataclass
+
+from .nodes import (
+    CType,
+    IRBinOp,
+    IRCall,
+    IRCast,
+    IRDeref,
+    IRExpr,
+    IRFieldAccess,
+    IRFunctionDef,
+    IRIf,
+    IRIndex,
+    IRLiteral,
+    IRModule,
+    IRParam,
+    IRReturn,
+    IRTernary,
+    IRUnaryOp,
+    IRVar,
+    IRVarDecl,
+)
+from .optimizer_fold import int_value
+from .optimizer_walk import rewrite_exprs, walk
+
+_SCALAR_RE = re.compile(
+    r"^(unsigned |signed )?(char|short|int|long|long long|float|double|bool"
+    r"|size_t|u?int(8|16|32|64)_t)$")
+_PURE_UNARY = {"-", "+", "!", "~"}
+_IMPURE_BINARY = {"=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+                  "<<=", ">>=", ","}
+_MAX_NODES = 16
+
+
+@dataclass
+class _Accessor:
+    func: IRFunctionDef
+    value: IRExpr
+    guard: IRExpr | None = None
+
+
+def inline_accessors(module: IRModule):
+    """Inline small accessor functions at their direct call sites."""
+    accessors = {}
+    for func in module.function_defs:
+        acc = _as_accessor(func)
+        if acc:
+            accessors[func.name] = acc
+    if not accessors:
+        return
+    fields = {s.name: {f.name: str(f.c_type) for f in s.fields}
+              for s in module.struct_defs}
+    for func in module.function_defs:
+        if func.body is None:
+            continue
+        env = _local_types(func)
+        rewrite_exprs(func.body, lambda e: _inline_call(e, accessors, env, fields))
+
+
+def _as_accessor(func: IRFunctionDef) -> _Accessor | None:
+    if func.body is None or not _is_scalar(str(func.return_type)):
+        return None
+    if not all(_is_scalar(str(p.c_type)) for p in func.params):
+        return None
+    params = {p.name for p in func.params}
+    stmts = func.body.stmts
+    guard = None
+    if len(stmts) == 2 and isinstance(stmts[0], IRIf) and stmts[0].else_block is None:
+        guard = stmts[0].condition
+        stmts = stmts[1:]
+    if len(stmts) != 1 or not isinstance(stmts[0], IRReturn) or stmts[0].value is None:
+        return None
+    value = stmts[0].value
+    for expr in (value, guard):
+        if expr is not None and (not _pure(expr, params) or _size(expr) > _MAX_NODES):
+            return None
+    return _Accessor(func=func, value=value, guard=guard)
+
+
+def _inline_call(expr: IRExpr, accessors: dict[str, _Accessor],
+                 env: dict[str, str], fields: dict) -> IRExpr:
+    if not isinstance(expr, IRCall):
+        return expr
+    acc = accessors.get(expr.callee)
+    if acc is None or len(expr.args) != len(acc.func.params):
+        return expr
+    if not all(_simple_arg(a) for a in expr.args):
+        return expr
+    bindings = {}
+    param_types = {}
+    for param, arg in zip(acc.func.params, expr.args):
+        bindings[param.name] = _convert(arg, str(param.c_type), _type_of(arg, env, fields))
+        param_types[param.name] = str(param.c_type)
+    value = _substitute(acc.value, bindings)
+    ret = str(acc.func.return_type)
+    if _type_of(acc.value, param_types, fields) != ret:
+        value = IRCast(target_type=CType(text=ret), expr=value)
+    if acc.guard is None:
+        return value
+    return IRTernary(condition=_substitute(acc.guard, bindings),
+                     true_expr=expr, false_expr=value)
+
+
+def _convert(arg: IRExpr, c_type: str, arg_type: str | None) -> IRExpr:
+    if arg_type == c_type:
+        return arg
+    return IRCast(target_type=CType(text=c_type), expr=arg)
+
+
+def _substitute(template: IRExpr, bindings: dict[str, IRExpr]) -> IRExpr:
+    body = copy.deepcopy(template)
+    if isinstance(body, IRVar):
+        return copy.deepcopy(bindings[body.name])
+    rewrite_exprs(body, lambda e: copy.deepcopy(bindings[e.name])
+                  if isinstance(e, IRVar) else e)
+    return body
+
+
+def _pure(expr: IRExpr, params: set[str]) -> bool:
+    """Side-effect-free and closed over the parameters (no globals, no calls)."""
+    if isinstance(expr, IRVar):
+        return expr.name in params
+    if isinstance(expr, IRLiteral):
+        return True
+    if isinstance(expr, (IRFieldAccess, IRCast, IRDeref)):
+        inner = expr.obj if isinstance(expr, IRFieldAccess) else expr.expr
+        return _pure(inner, params)
+    if isinstance(expr, IRIndex):
+        return _pure(expr.obj, params) and _pure(expr.index, params)
+    if isinstance(expr, IRBinOp):
+        return (expr.op not in _IMPURE_BINARY
+                and _pure(expr.left, params) and _pure(expr.right, params))
+    if isinstance(expr, IRUnaryOp):
+        return expr.prefix and expr.op in _PURE_UNARY and _pure(expr.operand, params)
+    if isinstance(expr, IRTernary):
+        return all(_pure(e, params) for e in (expr.condition, expr.true_expr, expr.false_expr))
+    return False
+
+
+def _simple_arg(expr: IRExpr) -> bool:
+    if isinstance(expr, (IRVar, IRLiteral)):
+        return True
+    if isinstance(expr, IRFieldAccess):
+        return _simple_arg(expr.obj)
+    if isinstance(expr, IRCast):
+        return _simple_arg(expr.expr)
+    return False
+
+
+def _size(expr: IRExpr) -> int:
+    return sum(1 for _ in walk(expr))
+
+
+def _is_scalar(c_type: str) -> bool:
+    return c_type.endswith("*") or bool(_SCALAR_RE.match(c_type))
+
+
+def _local_types(func: IRFunctionDef) -> dict[str, str]:
+    """C type of each parameter and local; names declared twice are dropped."""
+    types: dict[str, str | None] = {}
+    decls: list[IRParam | IRVarDecl] = list(func.params)
+    decls += [n for n in walk(func.body) if isinstance(n, IRVarDecl)]
+    for d in decls:
+        if d.name in types and types[d.name] != str(d.c_type):
+            types[d.name] = None
+        else:
+            types[d.name] = str(d.c_type)
+    return {k: v for k, v in types.items() if v is not None}
+
+
+def _type_of(expr: IRExpr, env: dict[str, str], fields: dict) -> str | None:
+    """C type of a variable, field or element read or int literal, when it can be told."""
+    if isinstance(expr, IRVar):
+        return env.get(expr.name)
+    if isinstance(expr, IRFieldAccess) and expr.arrow:
+        obj_type = _type_of(expr.obj, env, fields)
+        if obj_type and obj_type.endswith("*"):
+            return fields.get(obj_type[:-1], {}).get(expr.field)
+    if isinstance(expr, IRIndex):
+        obj_type = _type_of(expr.obj, env, fields)
+        if obj_type and obj_type.endswith("*"):
+            return obj_type[:-1]
+    if isinstance(expr, IRCast):
+        return str(expr.target_type)
+    if int_value(expr) is not None:
+        return "int"
+    return None
@@ -0,0 +1,76 @@
+"""Generic IR traversal shared by the optimizer passes.
+
+The IR nodes are plain dataclasses, so children are found through their
+fields: any field holding an IRExpr, IRStmt, IRBlock, IRCase or a list of
+those is a child. GPU dispatches are left alone; the GPU emitter reads
+their argument shapes directly.
+"""
+
+from __future__ import annotations
+
+from collections.abc import Callable, Iterator
+from dataclasses import fields
+
+from .nodes import (
+    IRBlock,
+    IRCase,
+    IRExpr,
+    IRFunctionDef,
+    IRStmt,
+    IRSwitch,
+)
+from .nodes_gpu import IRGpuDispatch
+
+_NODE_TYPES = (IRExpr, IRStmt, IRBlock, IRCase)
+
+
+def rewrite_exprs(node, fn: Callable[[IRExpr], IRExpr]):
+    """Rewrite every expression under `node` bottom-up with `fn`.
+
+    `fn` receives an expression whose children are already rewritten and
+    returns its replacement (or the expression itself).
+    """
+    if isinstance(node, IRGpuDispatch):
+        return
+    for f in fields(node):
+        value = getattr(node, f.name)
+        if isinstance(value, list):
+            for i, item in enumerate(value):
+                if isinstance(item, _NODE_TYPES):
+                    value[i] = _rewrite(item, fn)
+        elif isinstance(value, _NODE_TYPES):
+            setattr(node, f.name, _rewrite(value, fn))
+
+
+def _rewrite(node, fn):
+    rewrite_exprs(node, fn)
+    if isinstance(node, IRExpr) and not isinstance(node, IRGpuDispatch):
+        return fn(node)
+    return node
+
+
+def walk(node) -> Iterator:
+    """Yield `node` and every IR node below it, pre-order."""
+    yield node
+    if isinstance(node, IRGpuDispatch):
+        return
+    for f in fields(node):
+        value = getattr(node, f.name)
+        if isinstance(value, list):
+            for item in value:
+                if isinstance(item, _NODE_TYPES):
+                    yield from walk(item)
+        elif isinstance(value, _NODE_TYPES):
+            yield from walk(value)
+
+
+def stmt_lists(func: IRFunctionDef) -> Iterator[list[IRStmt]]:
+    """Yield every statement list (block bodies and case bodies) in a function."""
+    if func.body is None:
+        return
+    for node in walk(func.body):
+        if isinstance(node, IRBlock):
+            yield node.stmts
+        elif isinstance(node, IRSwitch):
+            for case in node.cases:
+                yield case.body
@@ -0,0 +1,149 @@
+"""Profiling instrumentation for `--profile`, applied after the optimizer.
+
+Every function in the module gets a number, and its body is wrapped:
+
+    int __prof_slot = __btrc_prof_enter(7);
+    ...
+    __prof_ret = <value>; __btrc_prof_leave(__prof_slot); return __prof_ret;
+
+so the value is computed inside the call's time. A setjmp `try` saves
+the depth of the profile stack, and its catch closes the calls a throw
+unwound above it, so they stop counting when the exception is caught:
+
+    int __prof_try0 = __btrc_prof_sp;
+    if (setjmp(...) == 0) { ... } else { __btrc_prof_leave(__prof_try0); ... }
+
+Flag-mode throws return through each frame's own leave. `main` first starts the
+profiler, which reports at exit. Reference count updates (`x->__rc++`,
+`--x->__rc`) also bump a retain or release counter, a class's destroy
+function counts destroys, and the string pool and cycle collector helpers
+are swapped for variants that track the pool's peak size and the
+collector's runs and time. Counting runs after ARC elision, so it sees the
+retains and releases the program really performs. main.py skips accessor
+inlining under `--profile`, so every call the source makes is counted.
+
+In a program using the GPU runtime, `main` also turns on its profiling
+(timestamp queries around every pass, bytes uploaded and read back), and
+each @gpu dispatch site labels its work with the kernel's name. The GPU
+table is printed after the profiler's report.
+
+The runtime (helpers/profile.py) is plain C11: timespec_get for the clock,
+_Thread_local state, atexit for the report.
+"""
+
+from __future__ import annotations
+
+from .gen.control_flow import SETJMP_TRY
+from .helpers.profile import PROFILED_HELPERS, profile_runtime
+from .nodes import (
+    CType,
+    IRAssign,
+    IRBinOp,
+    IRCall,
+    IRExpr,
+    IRExprStmt,
+    IRFieldAccess,
+    IRFunctionDef,
+    IRHelperDecl,
+    IRIf,
+    IRLiteral,
+    IRModule,
+    IRRawExpr,
+    IRReturn,
+    IRStmt,
+    IRUnaryOp,
+    IRVar,
+    IRVarDecl,
+)
+from .nodes_gpu import IRGpuDispatch
+from .optimizer_walk import rewrite_exprs, stmt_lists, walk
+
+_INCLUDES = ("stdio.h", "stdlib.h", "time.h")
+
+
+def instrument(module: IRModule):
+    """Add profiling counters and timers to `module`."""
+    funcs = [f for f in module.function_defs if f.body is not None]
+    rc_structs = {s.name for s in module.struct_defs
+                  if any(f.name == "__rc" for f in s.fields)}
+    uses_gpu = "btrc_gpu.h" in module.includes
+    for index, func in enumerate(funcs):
+        rewrite_exprs(func.body, _count_rc)
+        _time_calls(func, index)
+        if func.name.endswith("_destroy") and func.name[:-len("_destroy")] in rc_structs:
+            func.body.stmts.insert(0, _bump("__btrc_prof_destroys"))
+        if uses_gpu:
+            for node in walk(func.body):
+                if isinstance(node, IRGpuDispatch):
+                    node.profile_label = node.kernel_name
+        if func.name == "main":
+            func.body.stmts.insert(0, IRExprStmt(expr=IRCall(callee="__btrc_prof_start")))
+            if uses_gpu:  # registered first, so its atexit report runs last
+                func.body.stmts.insert(0, IRExprStmt(expr=IRCall(callee="btrc_gpu_profile_enable")))
+    for helper in module.helper_decls:
+        if helper.name in PROFILED_HELPERS:
+            helper.c_source = PROFILED_HELPERS[helper.name](helper.c_source)
+    module.helper_decls.insert(0, IRHelperDecl(
+        category="profile", name="__btrc_profile",
+        c_source=profile_runtime([f.name for f in funcs])))
+    module.includes += [inc for inc in _INCLUDES if inc not in module.includes]
+
+
+def _time_calls(func: IRFunctionDef, index: int):
+    returns_value = str(func.return_type) != "void"
+    for stmts in list(stmt_lists(func)):
+        stmts[:] = [new for stmt in stmts for new in _leave_before(stmt, returns_value)]
+    body = func.body.stmts
+    if not body or not isinstance(body[-1], IRReturn):
+        body.append(_leave())  # falls off the end
+    prologue: list[IRStmt] = [IRVarDecl(
+        c_type=CType(text="int"), name="__prof_slot",
+        init=IRCall(callee="__btrc_prof_enter", args=[IRLiteral(text=str(index))]))]
+    if returns_value:
+        prologue.append(IRVarDecl(c_type=func.return_type, name="__prof_ret"))
+    body[:0] = prologue
+    _close_unwound(func)
+
+
+def _close_unwound(func: IRFunctionDef):
+    count = 0
+    for stmts in list(stmt_lists(func)):
+        for i in reversed(range(len(stmts))):
+            stmt = stmts[i]
+            if not (isinstance(stmt, IRIf) and isinstance(stmt.condition, IRRawExpr)
+                    and stmt.condition.text == SETJMP_TRY and stmt.else_block):
+                continue
+            depth = f"__prof_try{count}"
+            count += 1
+            stmts.insert(i, IRVarDecl(c_type=CType(text="int"), name=depth,
+                                      init=IRVar(name="__btrc_prof_sp")))
+            stmt.else_block.stmts.insert(0, IRExprStmt(expr=IRCall(
+                callee="__btrc_prof_leave", args=[IRVar(name=depth)])))
+
+
+def _leave_before(stmt: IRStmt, returns_value: bool) -> list[IRStmt]:
+    if not isinstance(stmt, IRReturn):
+        return [stmt]
+    if stmt.value is None:
+        return [_leave(), stmt]
+    if not returns_value:  # `return f();` in a void function
+        return [IRExprStmt(expr=stmt.value), _leave(), IRReturn()]
+    return [IRAssign(target=IRVar(name="__prof_ret"), value=stmt.value), _leave(),
+            IRReturn(value=IRVar(name="__prof_ret"))]
+
+
+def _leave() -> IRStmt:
+    return IRExprStmt(expr=IRCall(callee="__btrc_prof_leave", args=[IRVar(name="__prof_slot")]))
+
+
+def _count_rc(expr: IRExpr) -> IRExpr:
+    """`(__btrc_prof_retains++, x->__rc++)` for a reference count update."""
+    if (isinstance(expr, IRUnaryOp) and expr.op in ("++", "--")
+            and isinstance(expr.operand, IRFieldAccess) and expr.operand.field == "__rc"):
+        counter = "__btrc_prof_retains" if expr.op == "++" else "__btrc_prof_releases"
+        return IRBinOp(left=_bump(counter).expr, op=",", right=expr)
+    return expr
+
+
+def _bump(counter: str) -> IRExprStmt:
+    return IRExprStmt(expr=IRUnaryOp(op="++", operand=IRVar(name=counter), prefix=False))
@@ -6,7 +6,6 @@ Usage: python main.py <input.btrc> [-o output.c] [--emit-ast] [--emit-tokens]
 
 import argparse
 import os
-import re
 import sys
 
 from .analyzer.analyzer import Analyzer
@@ -15,9 +14,12 @@ from .disk_cache import store as cache_store
 from .ir.emitter import CEmitter
 from .ir.gen.generator import generate_ir
 from .ir.optimizer import optimize
+from .ir.profile import instrument
 from .lexer import Lexer, LexerError
 from .parser.core import ParseError
 from .parser.parser import Parser
+from .sources import get_stdlib_units, resolve_include_units
+from .unit_cache import parse_units
 
 
 def _format_error(source: str, filename: str, message: str,
@@ -40,115 +42,6 @@ def _format_error(source: str, filename: str, message: str,
     )
 
 
-_BTRC_INCLUDE_RE = re.compile(r'^\s*#include\s+[<"]([^>"]+\.btrc)[>"]\s*$')
-
-# Regex to extract class names from btrc source (for skip-if-redefined)
-_CLASS_NAME_RE = re.compile(r'^\s*class\s+(\w+)', re.MULTILINE)
-
-
-def _get_stdlib_dir() -> str:
-    """Get the absolute path to the stdlib directory."""
-    # src/compiler/python/main.py → src/stdlib/
-    module_dir = os.path.dirname(os.path.abspath(__file__))
-    return os.path.join(module_dir, "..", "..", "stdlib")
-
-
-def _discover_stdlib_files() -> list[str]:
-    """Scan src/stdlib/ and return .btrc filenames in include order.
-
-    vector.btrc comes first (Map/Set/List/Array may depend on Vector),
-    then list.btrc (depends on ListNode + Vector), then rest alphabetically.
-    """
-    stdlib_dir = _get_stdlib_dir()
-    if not os.path.isdir(stdlib_dir):
-        return []
-    files = sorted(f for f in os.listdir(stdlib_dir) if f.endswith(".btrc"))
-    # vector.btrc first, list.btrc second (uses Vector), then rest alphabetical
-    priority = ["vector.btrc", "list.btrc"]
-    ordered = [f for f in priority if f in files]
-    ordered += [f for f in files if f not in priority]
-    return ordered
-
-
-def get_stdlib_source(user_source: str = "") -> str:
-    """Read stdlib sources, skipping classes already defined by the user.
-
-    Args:
-        user_source: The user's btrc source (after include resolution).
-            If a stdlib file defines a class that the user source already
-            defines, that stdlib file is skipped entirely.
-    """
-    stdlib_dir = _get_stdlib_dir()
-    user_classes = set(_CLASS_NAME_RE.findall(user_source))
-
-    parts = []
-    for fname in _discover_stdlib_files():
-        fpath = os.path.join(stdlib_dir, fname)
-        if not os.path.exists(fpath):
-            continue
-        with open(fpath, 'r') as f:
-            content = f.read()
-        # Skip if any class in this file is already defined by user
-        file_classes = set(_CLASS_NAME_RE.findall(content))
-        if file_classes & user_classes:
-            continue
-        parts.append(content)
-    return "\n".join(parts)
-
-
-def resolve_includes(source: str, source_path: str, included: set[str] | None = None) -> str:
-    """Recursively resolve #include "file.btrc" directives by textual inclusion."""
-    if included is None:
-        included = set()
-
-    source_dir = os.path.dirname(os.path.abspath(source_path))
-    abs_path = os.path.abspath(source_path)
-
-    if abs_path in included:
-        return ""  # Circular include guard
-    included.add(abs_path)
-
-    lines = source.split('\n')
-    result = []
-    for line in lines:
-        m = _BTRC_INCLUDE_RE.match(line)
-        if m:
-            include_path = m.group(1)
-            full_path = os.path.join(source_dir, include_path)
-            if not os.path.exists(full_path):
-                # Fallback: search in stdlib directory (root and subdirectories)
-                stdlib_dir = _get_stdlib_dir()
-                stdlib_path = os.path.join(stdlib_dir, include_path)
-                if os.path.exists(stdlib_path):
-                    full_path = stdlib_path
-                else:
-                    # Search stdlib subdirectories: e.g. gpu.btrc → gpu/gpu.btrc
-                    found = False
-                    fname = os.path.basename(include_path)
-                    for entry in os.listdir(stdlib_dir):
-                        sub = os.path.join(stdlib_dir, entry)
-                        if os.path.isdir(sub):
-                            candidate = os.path.join(sub, fname)
-                            if os.path.exists(candidate):
-                                full_path = candidate
-                                found = True
-                                break
-                    if not found:
-                        print(f"error: include file '{include_path}' not found\n"
-                              f"  searched: {source_dir}\n"
-                              f"  searched: {stdlib_dir}",
-                              file=sys.stderr)
-                        sys.exit(1)
-            with open(full_path, 'r') as f:
-                included_source = f.read()
-            resolved = resolve_includes(included_source, full_path, included)
-            result.append(resolved)
-        else:
-            result.append(line)
-
-    return '\n'.join(result)
-
-
 def _dump_ir(module):
     """Print a canonical IR dump for debugging."""
     print(f"# IRModule: {len(module.enum_defs)} enums, "
@@ -168,6 +61,35 @@ def _dump_ir(module):
         print(f"fn {func.name}({params}) -> {func.return_type}")
 
 
+def _parse(source: str, filename: str, emit_tokens: bool):
+    """Lex and parse the whole source; print the tokens instead if asked."""
+    # Lexing
+    try:
+        lexer = Lexer(source, filename)
+        tokens = lexer.tokenize()
+    except LexerError as e:
+        # Extract the message without "at line:col" suffix
+        raw_msg = str(e).rsplit(" at ", 1)[0] if " at " in str(e) else str(e)
+        print(_format_error(source, filename, raw_msg, e.line, e.col),
+              file=sys.stderr)
+        sys.exit(1)
+
+    if emit_tokens:
+        for tok in tokens:
+            print(tok)
+        return None
+
+    # Parsing
+    try:
+        parser = Parser(tokens)
+        return parser.parse()
+    except ParseError as e:
+        raw_msg = str(e).rsplit(" at ", 1)[0] if " at " in str(e) else str(e)
+        print(_format_error(source, filename, raw_msg, e.line, e.col),
+              file=sys.stderr)
+        sys.exit(1)
+
+
 def main():
     argparser = argparse.ArgumentParser(description="btrc transpiler")
     argparser.add_argument("input", help="Input .btrc file")
@@ -184,6 +106,18 @@ def main():
                            help="Print IR representation (after optimization)")
     argparser.add_argument("--no-cache", action="store_true",
                            help="Disable on-disk compilation cache")
+    argparser.add_argument("--atomic-rc", action="store_true",
+                           help="Use atomic reference counts for every class "
+                                "(spawn-captured classes always get them)")
+    argparser.add_argument("--exceptions", choices=["setjmp", "flag"], default="setjmp",
+                           help="Lower throws with setjmp/longjmp, or (flag) return "
+                                "an error flag that callers test where possible")
+    argparser.add_argument("-j", "--jobs", type=int, default=1,
+                           help="Parse files and generate IR for declarations "
+                                "in up to N processes")
+    argparser.add_argument("--profile", action="store_true",
+                           help="Instrument the program: time and count calls, "
+                                "ARC and string pool activity; report at exit")
 
     args = argparser.parse_args()
 
@@ -195,20 +129,19 @@ def main():
         print(f"Error: File '{args.input}' not found", file=sys.stderr)
         sys.exit(1)
 
-    # Resolve #include "file.btrc" directives
-    source = resolve_includes(source, args.input)
-
-    # Auto-include all stdlib types (skip classes user already defines)
-    stdlib_source = get_stdlib_source(source)
-    if stdlib_source:
-        source = stdlib_source + "\n" + source
+    # Resolve #include "file.btrc" directives, then auto-include all stdlib
+    # types (skip classes user already defines); one unit per file
+    units = resolve_include_units(source, args.input)
+    units = get_stdlib_units("\n".join(text for _, text in units)) + units
+    source = "\n".join(text for _, text in units)
 
     filename = os.path.basename(args.input)
 
     # Check disk cache (only for default compilation, not debug/emit modes)
     use_cache = not args.no_cache and not any([
         args.emit_tokens, args.emit_ast, args.emit_ir,
-        args.emit_optimized_ir, args.debug
+        args.emit_optimized_ir, args.debug, args.atomic_rc, args.profile,
+        args.exceptions != "setjmp",
     ])
     if use_cache:
         cached = get_cached(source)
@@ -222,31 +155,16 @@ def main():
             print(f"Transpiled {args.input} → {out_path} (cached)")
             return
 
-    # Lexing
-    try:
-        lexer = Lexer(source, filename)
-        tokens = lexer.tokenize()
-    except LexerError as e:
-        # Extract the message without "at line:col" suffix
-        raw_msg = str(e).rsplit(" at ", 1)[0] if " at " in str(e) else str(e)
-        print(_format_error(source, filename, raw_msg, e.line, e.col),
-              file=sys.stderr)
-        sys.exit(1)
-
-    if args.emit_tokens:
-        for tok in tokens:
-            print(tok)
-        return
-
-    # Parsing
-    try:
-        parser = Parser(tokens)
-        program = parser.parse()
-    except ParseError as e:
-        raw_msg = str(e).rsplit(" at ", 1)[0] if " at " in str(e) else str(e)
-        print(_format_error(source, filename, raw_msg, e.line, e.col),
-              file=sys.stderr)
-        sys.exit(1)
+    # Per-file front end: only files that changed are lexed and parsed
+    front = None
+    if (use_cache or args.jobs > 1) and not args.emit_tokens:
+        front = parse_units(units, use_cache=use_cache, jobs=args.jobs)
+    if front is not None:
+        program, decl_prints = front
+    else:
+        program, decl_prints = _parse(source, filename, args.emit_tokens), None
+        if program is None:
+            return
 
     if args.emit_ast:
         import pprint
@@ -292,13 +210,19 @@ def main():
         print(f"warning: {warn}", file=sys.stderr)
 
     # Code generation: AST → IR → optimize → C text
-    ir_module = generate_ir(analyzed, debug=args.debug, source_file=filename)
+    ir_module = generate_ir(analyzed, debug=args.debug, source_file=filename,
+                            atomic_rc=args.atomic_rc, exceptions=args.exceptions,
+                            decl_prints=decl_prints,
+                            use_cache=use_cache, jobs=args.jobs)
 
     if args.emit_ir:
         _dump_ir(ir_module)
         return
 
-    ir_module = optimize(ir_module)
+    # Profiling counts calls, so it keeps the calls inlining would remove
+    ir_module = optimize(ir_module, inline=not args.profile)
+    if args.profile:
+        instrument(ir_module)
 
     if args.emit_optimized_ir:
         _dump_ir(ir_module)
@@ -1,5 +1,7 @@
 """Simple declaration parsing: enum, rich enum, typedef, property, function/var."""
 
+import re
+
 from ..ast_nodes import (
     EnumDecl,
     EnumValue,
@@ -116,8 +118,28 @@ class SimpleDeclarationsMixin:
 
     # ---- Function or variable declaration ----
 
+    def _parse_gpu_options(self) -> list[int]:
+        """Parse optional `@gpu(workgroup=16x16)` options after @gpu.
+
+        `16x16` lexes as INT_LIT `16` followed by IDENT `x16`.
+        """
+        if not self._match(TokenType.LPAREN):
+            return []
+        key = self._expect(TokenType.IDENT, "'workgroup'")
+        if key.value != "workgroup":
+            raise self._error(f"Unknown @gpu option '{key.value}'")
+        self._expect(TokenType.EQ)
+        dims = [int(self._expect(TokenType.INT_LIT, "workgroup size").value)]
+        tok = self._peek()
+        if tok.type == TokenType.IDENT and re.fullmatch(r"(x\d+)+", tok.value):
+            self._advance()
+            dims.extend(int(d) for d in tok.value[1:].split("x"))
+        self._expect(TokenType.RPAREN)
+        return dims
+
     def _parse_function_or_var_decl(self, is_gpu: bool = False, *,
-                                     keep_return: bool = False):
+                                     keep_return: bool = False,
+                                     gpu_workgroup: list[int] | None = None):
         """Disambiguate function vs variable at top level."""
         start = self._peek()
 
@@ -143,11 +165,13 @@ class SimpleDeclarationsMixin:
             if self._match(TokenType.SEMICOLON):
                 return FunctionDecl(return_type=type_expr, name=name, params=params,
                                     body=None, is_gpu=is_gpu,
+                                    gpu_workgroup=gpu_workgroup or [],
                                     keep_return=keep_return,
                                     line=start.line, col=start.col)
             body = self._parse_block()
             return FunctionDecl(return_type=type_expr, name=name, params=params,
                                 body=body, is_gpu=is_gpu,
+                                gpu_workgroup=gpu_workgroup or [],
                                 keep_return=keep_return,
                                 line=start.line, col=start.col)
         else:
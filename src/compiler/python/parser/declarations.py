@@ -23,9 +23,11 @@ class DeclarationsMixin:
 
         is_gpu = False
         keep_return = False
+        gpu_workgroup: list[int] = []
         if tok.type == TokenType.AT_GPU:
             is_gpu = True
             self._advance()
+            gpu_workgroup = self._parse_gpu_options()
             tok = self._peek()
         if tok.type == TokenType.KEEP:
             keep_return = True
@@ -67,7 +69,8 @@ class DeclarationsMixin:
             return self._parse_typedef_decl()
 
         if self._is_type_start(tok):
-            return self._parse_function_or_var_decl(is_gpu, keep_return=keep_return)
+            return self._parse_function_or_var_decl(
+                is_gpu, keep_return=keep_return, gpu_workgroup=gpu_workgroup)
 
         raise self._error(f"Unexpected token '{tok.value}' at top level")
 
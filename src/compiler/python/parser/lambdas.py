@@ -10,6 +10,11 @@ from ..ast_nodes import (
 )
 from ..tokens import TYPE_KEYWORDS, TokenType
 
+# Tokens that never occur inside generic arguments: scanning `a < b` for a
+# closing `>` stops at the end of the statement instead of the file
+_NOT_IN_TYPE = {TokenType.SEMICOLON, TokenType.LBRACE, TokenType.RBRACE,
+                TokenType.EQ, TokenType.EOF}
+
 
 class LambdasMixin:
 
@@ -38,6 +43,8 @@ class LambdasMixin:
                         depth -= 1
                     elif t.type == TokenType.GT_GT:
                         depth -= 2
+                    elif t.type in _NOT_IN_TYPE:
+                        break
                     self.pos += 1
             # Skip pointers
             while self.pos < len(self.tokens) and self.tokens[self.pos].type == TokenType.STAR:
@@ -1,6 +1,7 @@
 """Statement dispatch, variable declaration detection and parsing."""
 
 from ..ast_nodes import (
+    ArenaStmt,
     Block,
     BreakStmt,
     ContinueStmt,
@@ -68,6 +69,10 @@ class StatementsMixin:
             expr = self._parse_expr()
             self._expect(TokenType.SEMICOLON)
             return KeepStmt(expr=expr, line=tok.line, col=tok.col)
+        if tok.type == TokenType.ARENA:
+            self._advance()
+            body = self._parse_block()
+            return ArenaStmt(body=body, line=tok.line, col=tok.col)
 
         if self._is_var_decl_start():
             return self._parse_var_decl_stmt()
@@ -0,0 +1,141 @@
+"""Source resolution: #include "file.btrc" expansion and stdlib auto-include.
+
+The compiler sees one combined source: the stdlib files, then the user
+file with every btrc include replaced by the included text. The `*_units`
+functions return the same text split into per-file units, (path, text)
+pairs whose texts joined with "\\n" are exactly the combined source, so
+each unit can be lexed, parsed and cached on its own (unit_cache.py).
+"""
+
+from __future__ import annotations
+
+import os
+import re
+import sys
+
+_BTRC_INCLUDE_RE = re.compile(r'^\s*#include\s+[<"]([^>"]+\.btrc)[>"]\s*$')
+
+# Regex to extract class names from btrc source (for skip-if-redefined).
+# The lookahead keeps static methods (`class string foo()`) from matching.
+_CLASS_NAME_RE = re.compile(r'^\s*class\s+(\w+)\s*(?=[{<]|extends\b|implements\b)',
+                            re.MULTILINE)
+
+Unit = tuple[str, str]  # (path, text)
+
+
+def _get_stdlib_dir() -> str:
+    """Get the absolute path to the stdlib directory."""
+    # src/compiler/python/sources.py → src/stdlib/
+    module_dir = os.path.dirname(os.path.abspath(__file__))
+    return os.path.join(module_dir, "..", "..", "stdlib")
+
+
+def _discover_stdlib_files() -> list[str]:
+    """Scan src/stdlib/ and return .btrc filenames in include order.
+
+    vector.btrc comes first (Map/Set/List/Array may depend on Vector),
+    then list.btrc (depends on ListNode + Vector), then rest alphabetically.
+    """
+    stdlib_dir = _get_stdlib_dir()
+    if not os.path.isdir(stdlib_dir):
+        return []
+    files = sorted(f for f in os.listdir(stdlib_dir) if f.endswith(".btrc"))
+    # vector.btrc first, list.btrc second (uses Vector), then rest alphabetical
+    priority = ["vector.btrc", "list.btrc"]
+    ordered = [f for f in priority if f in files]
+    ordered += [f for f in files if f not in priority]
+    return ordered
+
+
+def get_stdlib_units(user_source: str = "") -> list[Unit]:
+    """Stdlib files as units, skipping files whose classes the user redefines."""
+    stdlib_dir = _get_stdlib_dir()
+    user_classes = set(_CLASS_NAME_RE.findall(user_source))
+
+    units = []
+    for fname in _discover_stdlib_files():
+        fpath = os.path.join(stdlib_dir, fname)
+        if not os.path.exists(fpath):
+            continue
+        with open(fpath, 'r') as f:
+            content = f.read()
+        # Skip if any class in this file is already defined by user
+        file_classes = set(_CLASS_NAME_RE.findall(content))
+        if file_classes & user_classes:
+            continue
+        units.append((fpath, content))
+    return units
+
+
+def get_stdlib_source(user_source: str = "") -> str:
+    """Read stdlib sources, skipping classes already defined by the user.
+
+    Args:
+        user_source: The user's btrc source (after include resolution).
+            If a stdlib file defines a class that the user source already
+            defines, that stdlib file is skipped entirely.
+    """
+    return "\n".join(text for _, text in get_stdlib_units(user_source))
+
+
+def resolve_include_units(source: str, source_path: str,
+                          included: set[str] | None = None) -> list[Unit]:
+    """`source` with its btrc includes resolved, as one unit per run of lines
+    from a single file."""
+    if included is None:
+        included = set()
+
+    source_dir = os.path.dirname(os.path.abspath(source_path))
+    abs_path = os.path.abspath(source_path)
+
+    if abs_path in included:
+        return [(abs_path, "")]  # Circular include guard
+    included.add(abs_path)
+
+    units: list[Unit] = []
+    lines: list[str] = []
+    for line in source.split('\n'):
+        m = _BTRC_INCLUDE_RE.match(line)
+        if not m:
+            lines.append(line)
+            continue
+        if lines:
+            units.append((abs_path, '\n'.join(lines)))
+            lines = []
+        full_path = _find_include(m.group(1), source_dir)
+        with open(full_path, 'r') as f:
+            included_source = f.read()
+        units += resolve_include_units(included_source, full_path, included)
+    if lines:
+        units.append((abs_path, '\n'.join(lines)))
+    return units
+
+
+def resolve_includes(source: str, source_path: str, included: set[str] | None = None) -> str:
+    """Recursively resolve #include "file.btrc" directives by textual inclusion."""
+    units = resolve_include_units(source, source_path, included)
+    return '\n'.join(text for _, text in units)
+
+
+def _find_include(include_path: str, source_dir: str) -> str:
+    full_path = os.path.join(source_dir, include_path)
+    if os.path.exists(full_path):
+        return full_path
+    # Fallback: search in stdlib directory (root and subdirectories)
+    stdlib_dir = _get_stdlib_dir()
+    stdlib_path = os.path.join(stdlib_dir, include_path)
+    if os.path.exists(stdlib_path):
+        return stdlib_path
+    # Search stdlib subdirectories: e.g. gpu.btrc → gpu/gpu.btrc
+    fname = os.path.basename(include_path)
+    for entry in os.listdir(stdlib_dir):
+        sub = os.path.join(stdlib_dir, entry)
+        if os.path.isdir(sub):
+            candidate = os.path.join(sub, fname)
+            if os.path.exists(candidate):
+                return candidate
+    print(f"error: include file '{include_path}' not found\n"
+          f"  searched: {source_dir}\n"
+          f"  searched: {stdlib_dir}",
+          file=sys.stderr)
+    sys.exit(1)
@@ -2974,6 +2974,27 @@ class TestThreadMutexValidation:
         '''
         assert has_error(src, "Mutex<T> has no method 'lock'")
 
+    def test_par_lambda_cannot_capture(self):
+        """Pool threads call a par* function without a lambda's captures."""
+        src = '''
+            class Vector<T> {
+                public int len;
+                public Vector<T> parMap(__fn_ptr<T, T> f) { return self; }
+                public Vector<T> map(__fn_ptr<T, T> f) { return self; }
+            }
+            int main() {
+                Vector<int> v = new Vector<int>();
+                int k = 3;
+                Vector<int> a = v.parMap((int x) => x * 2);
+                Vector<int> b = v.map((int x) => x * k);
+                Vector<int> c = v.parMap((int x) => x * k);
+                return 0;
+            }
+        '''
+        errs = errors(src)
+        assert len(errs) == 1
+        assert "Lambda passed to 'parMap' cannot capture 'k'" in errs[0]
+
 
 # --- Interface & Abstract compliance ---
 
@@ -3197,6 +3218,63 @@ class TestGpuValidFunctions:
         '''
         assert no_errors(src)
 
+    def test_gpu_resident_array_params(self):
+        """GpuArray<T> params are bound as device-resident buffers."""
+        src = '''
+            class GpuArray<T> { public void* _buffer; public int len; }
+            @gpu void axpy(GpuArray<float> y, GpuArray<float> x, float a) {
+                int i = gpu_id();
+                y[i] = y[i] + a * x[i];
+            }
+        '''
+        assert no_errors(src)
+
+    def test_gpu_resident_array_return(self):
+        """GpuArray<T> return keeps the output on the device."""
+        src = '''
+            class GpuArray<T> { public void* _buffer; public int len; }
+            @gpu GpuArray<int> twice(GpuArray<int> a) {
+                int i = gpu_id();
+                return a[i] * 2;
+            }
+        '''
+        assert no_errors(src)
+
+    def test_gpu_vector_params(self):
+        """Vector<T> and Array<T> params are uploaded from ->data, sized by ->len."""
+        src = '''
+            @gpu float[] add(Vector<float> a, Array<float> b) {
+                int i = gpu_id();
+                return a[i] + b[i];
+            }
+            void run(Vector<float> xs, Array<float> ys) { add(xs, ys); }
+        '''
+        assert no_errors(src)
+
+    def test_gpu_shared_tile_and_barrier(self):
+        """gpu_shared() tile with gpu_local_id(), gpu_barrier(), gpu_group_id()."""
+        src = '''
+            @gpu(workgroup=64)
+            float[] sums(float[] a) {
+                float[] tile = gpu_shared(64);
+                int l = gpu_local_id();
+                tile[l] = a[gpu_id()];
+                gpu_barrier();
+                return tile[0] + (float)gpu_group_id();
+            }
+        '''
+        assert no_errors(src)
+
+    def test_gpu_2d_workgroup(self):
+        """@gpu(workgroup=16x16) with int grid extents and gpu_id_x/y."""
+        src = '''
+            @gpu(workgroup=16x16)
+            float[] tr(int w, int h, float[] m) {
+                return m[gpu_id_x() * h + gpu_id_y()];
+            }
+        '''
+        assert no_errors(src)
+
 
 class TestGpuInvalidParams:
     """Tests that invalid @gpu function parameters produce errors."""
@@ -3214,10 +3292,19 @@ class TestGpuInvalidParams:
         assert any("not allowed" in e or "generic" in e for e in result.errors)
 
     def test_gpu_vector_param_error(self):
-        """Vector param is not allowed (generic type)."""
-        src = '@gpu void bad(Vector<int> v) { }'
+        """Vector<string> is not allowed (only int/float elements)."""
+        src = '@gpu void bad(Vector<string> v) { }'
         result = analyze(src)
-        assert any("not allowed" in e or "generic" in e for e in result.errors)
+        assert any("int or float" in e for e in result.errors)
+
+    def test_gpu_array_param_forwarded_error(self):
+        """A float[] function parameter has no length at a @gpu call."""
+        src = '''
+            @gpu void scale(float[] a) { int i = gpu_id(); a[i] = a[i] * 2.0; }
+            void run(float[] xs) { scale(xs); }
+        '''
+        result = analyze(src)
+        assert any("no length" in e for e in result.errors)
 
     def test_gpu_pointer_param_error(self):
         """Pointer param is not allowed."""
@@ -3254,6 +3341,27 @@ class TestGpuInvalidParams:
         result = analyze(src)
         assert any("int or float" in e or "not allowed" in e or "string" in e for e in result.errors)
 
+    def test_gpu_resident_double_param_error(self):
+        """GpuArray<double> is not allowed (only int/float elements)."""
+        src = '''
+            class GpuArray<T> { public void* _buffer; public int len; }
+            @gpu void bad(GpuArray<double> d) { }
+        '''
+        result = analyze(src)
+        assert any("int or float" in e for e in result.errors)
+
+    def test_gpu_workgroup_too_large_error(self):
+        """32x32 exceeds the 256 threads per workgroup limit."""
+        src = '@gpu(workgroup=32x32) void bad(int w, int h, float[] a) { }'
+        result = analyze(src)
+        assert any("256" in e for e in result.errors)
+
+    def test_gpu_workgroup_missing_extents_error(self):
+        """A 2-D workgroup needs two leading int scalar params."""
+        src = '@gpu(workgroup=8x8) void bad(float[] a, float s) { }'
+        result = analyze(src)
+        assert any("grid extents" in e for e in result.errors)
+
     def test_gpu_long_param_error(self):
         """long param is not allowed (only int, float, bool scalars)."""
         src = '@gpu void bad(long x) { }'
@@ -3303,6 +3411,24 @@ class TestGpuInvalidBody:
         result = analyze(src)
         assert any("print" in e for e in result.errors)
 
+    def test_gpu_shared_size_error(self):
+        """gpu_shared() needs an integer literal size."""
+        src = '@gpu void bad(float[] a, int n) { float[] t = gpu_shared(n); }'
+        result = analyze(src)
+        assert any("integer literal" in e for e in result.errors)
+
+    def test_gpu_shared_outside_decl_error(self):
+        """gpu_shared() only initializes an array variable."""
+        src = '@gpu void bad(float[] a) { a[0] = gpu_shared(4); }'
+        result = analyze(src)
+        assert any("array variable" in e for e in result.errors)
+
+    def test_gpu_barrier_outside_gpu_error(self):
+        """gpu_barrier() is only valid inside @gpu functions."""
+        src = 'void f() { gpu_barrier(); }'
+        result = analyze(src)
+        assert any("inside @gpu" in e for e in result.errors)
+
     def test_gpu_string_literal_error(self):
         """String literal is not allowed."""
         src = '@gpu void bad(float[] a) { int i = gpu_id(); }'
@@ -3539,3 +3665,248 @@ class TestGpuInvalidBody:
             }
         '''
         assert no_errors(src)
+
+
+class TestArenaBlocks:
+    """Tests for arena-allocated values escaping their block."""
+
+    _CLASSES = '''
+        class P {
+            public int x;
+            public string name;
+            public P friend;
+            public P(int x) { self.x = x; }
+            public void adopt(P other) { self.friend = other; }
+        }
+    '''
+
+    def test_arena_local_use_ok(self):
+        src = self._CLASSES + '''
+            void test() {
+                arena {
+                    P a = new P(1);
+                    P b = a;
+                    b.name = f"p{a.x}";
+                    b.adopt(a);
+                    while (true) { break; }
+                }
+            }
+        '''
+        assert no_errors(src)
+
+    def test_object_escapes_to_outer_var(self):
+        src = self._CLASSES + '''
+            void test() {
+                P outer = null;
+                arena {
+                    P a = new P(1);
+                    P b = a;
+                    outer = b;
+                }
+            }
+        '''
+        assert has_error(src, "cannot escape to 'outer'")
+
+    def test_object_escapes_to_outer_field_and_method(self):
+        src = self._CLASSES + '''
+            void test(P keeper) {
+                arena {
+                    keeper.name = "ok";
+                    keeper.adopt(new P(2));
+                }
+            }
+        '''
+        errs = errors(src)
+        assert len(errs) == 1
+        assert "cannot be passed to 'adopt'" in errs[0]
+
+    def test_object_escapes_through_function_or_receiver(self):
+        src = self._CLASSES + '''
+            P kept = null;
+            void stash(P p) { kept = p; }
+            int weigh(P p) { return p.x; }
+            class R {
+                public int x;
+                public R(int x) { self.x = x; }
+                public void reg() { held = self; }
+                public int get() { return self.x; }
+            }
+            R held = null;
+            void test() {
+                arena {
+                    P a = new P(41);
+                    R r = new R(1);
+                    int w = weigh(a) + r.get();
+                    stash(a);
+                    r.reg();
+                }
+            }
+        '''
+        errs = errors(src)
+        assert len(errs) == 2
+        assert "cannot be passed to 'stash'" in errs[0]
+        assert "cannot call 'reg'" in errs[1]
+
+    def test_string_kept_by_function_is_copied(self):
+        src = self._CLASSES + '''
+            string last = "";
+            void stashs(string s) { last = s; }
+            int size(string s) { return s.len(); }
+            void test() {
+                arena {
+                    P a = new P(1);
+                    stashs(f"s{a.x}");
+                    int n = size(f"t{a.x}");
+                    a.name = "x";
+                }
+            }
+        '''
+        result = analyze(src)
+        assert result.errors == []
+        assert len(result.arena_copies) == 1
+
+    def test_string_escape_is_copied(self):
+        src = self._CLASSES + '''
+            void test() {
+                string last = "";
+                arena {
+                    string s = f"x{1}";
+                    last = s;
+                }
+            }
+        '''
+        result = analyze(src)
+        assert result.errors == []
+        assert len(result.arena_copies) == 1
+
+    def test_return_and_break_cannot_leave_arena(self):
+        src = '''
+            int test() {
+                while (true) {
+                    arena {
+                        break;
+                    }
+                }
+                arena {
+                    return 1;
+                }
+            }
+        '''
+        assert has_error(src, "'break' cannot leave an arena block")
+        assert has_error(src, "'return' cannot leave an arena block")
+
+    def test_delete_arena_object(self):
+        src = self._CLASSES + '''
+            void test() {
+                arena {
+                    P a = P(1);
+                    delete a;
+                }
+            }
+        '''
+        assert has_error(src, "Cannot delete an object allocated in an arena block")
+
+    def test_arena_value_captured_by_lambda_or_spawn(self):
+        src = self._CLASSES + '''
+            int test() {
+                int base = 1;
+                Thread<int> t = spawn(() => base);
+                arena {
+                    P a = new P(1);
+                    string s = f"p{base}";
+                    var f = () => a.x + base;
+                    t = spawn(() => s.len());
+                    var g = (int n) => n + base;
+                }
+                return t.join();
+            }
+        '''
+        errs = errors(src)
+        assert len(errs) == 2
+        assert "Arena-allocated 'a' cannot be captured" in errs[0]
+        assert "Arena-allocated 's' cannot be captured" in errs[1]
+
+
+class TestEscapeAnalysis:
+    """Tests for finding new instances that can be stack-allocated."""
+
+    _CLASSES = '''
+        class V {
+            public float x;
+            public float y;
+            public V(float x, float y) { self.x = x; self.y = y; }
+            public float dot(V o) { return self.x * o.x + self.y * o.y; }
+            public V __add__(V o) { return V(self.x + o.x, self.y + o.y); }
+            public V me() { return self; }
+        }
+        class Box {
+            public V held;
+            public Box() { self.held = null; }
+            public void put(V v) { self.held = v; }
+        }
+    '''
+
+    @staticmethod
+    def _on_stack(src: str) -> set[str]:
+        result = analyze(src)
+        assert result.errors == []
+        names = set()
+        stack = [result.program]
+        while stack:
+            node = stack.pop()
+            if id(node) in result.stack_objects:
+                names.add(node.name)
+            for value in vars(node).values() if hasattr(node, '__dataclass_fields__') else []:
+                stack.extend(value if isinstance(value, list) else [value])
+        return names
+
+    def test_local_use_stays(self):
+        src = self._CLASSES + '''
+            float test() {
+                V a = V(1.0, 2.0);
+                V b = new V(3.0, 4.0);
+                a.x = b.y;
+                V c = a + b;
+                if (a != null && b) { return a.dot(b) + c.x; }
+                return 0.0;
+            }
+        '''
+        # `c` holds the result of V.__add__, allocated there
+        assert self._on_stack(src) == {"a", "b"}
+
+    def test_escapes(self):
+        src = self._CLASSES + '''
+            V ret() { V r = V(1.0, 1.0); return r; }
+            void stored(Box box) { V s = V(1.0, 1.0); box.put(s); }
+            void aliased() { V a = V(1.0, 1.0); V b = a; b.x = 2.0; }
+            void fluent() { V f = V(1.0, 1.0); f.me(); }
+            void captured() {
+                V l = V(1.0, 1.0);
+                var fn = () => l.x;
+            }
+            void deleted() { V d = V(1.0, 1.0); delete d; }
+        '''
+        assert self._on_stack(src) == set()
+
+    def test_through_functions(self):
+        src = self._CLASSES + '''
+            float length(V v) { return v.dot(v); }
+            float forward(V v) { return length(v); }
+            V keepIt(V v) { return v; }
+            void test() {
+                V a = V(1.0, 2.0);
+                float n = forward(a);
+                V b = V(1.0, 2.0);
+                keepIt(b);
+            }
+        '''
+        assert self._on_stack(src) == {"a"}
+
+    def test_owning_classes_stay_on_heap(self):
+        src = self._CLASSES + '''
+            void test() {
+                Box b = Box();
+                b.held = null;
+            }
+        '''
+        assert self._on_stack(src) == set()
@@ -0,0 +1,166 @@
+"""Tests for the incremental build: per-file AST cache and per-declaration IR."""
+
+import os
+import tempfile
+
+from src.compiler.python.analyzer.analyzer import Analyzer
+from src.compiler.python.disk_cache import cache_dir, load_record, store_record
+from src.compiler.python.ir.emitter import CEmitter
+from src.compiler.python.ir.gen.generator import generate_ir
+from src.compiler.python.ir.optimizer import optimize
+from src.compiler.python.lexer import Lexer
+from src.compiler.python.parser.parser import Parser
+from src.compiler.python.sources import resolve_include_units, resolve_includes
+from src.compiler.python.unit_cache import parse_units
+
+_LIB = '''
+class Counter {
+    public int n;
+    public Counter() { self.n = 0; }
+    public void add(int k) { self.n += k; }
+}
+
+int twice(int x) { return x * 2; }
+'''
+
+_MAIN = '''
+int main() {
+    Counter c = Counter();
+    var inc = (int x) => x + 1;
+    c.add(twice(inc(3)));
+    return c.n;
+}
+'''
+
+
+def _compile(units, *, use_cache: bool = False, jobs: int = 1) -> str:
+    source = "\n".join(text for _, text in units)
+    if use_cache or jobs > 1:
+        program, prints = parse_units(units, use_cache=use_cache, jobs=jobs)
+    else:
+        program, prints = Parser(Lexer(source).tokenize()).parse(), None
+    analyzed = Analyzer().analyze(program)
+    assert analyzed.errors == []
+    module = generate_ir(analyzed, decl_prints=prints, use_cache=use_cache, jobs=jobs)
+    return CEmitter().emit(optimize(module))
+
+
+class _CacheDir:
+    """Run with the working directory and $BTRC_CACHE_DIR in temp dirs."""
+
+    def __enter__(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self._cwd = os.getcwd()
+        self._env = os.environ.get("BTRC_CACHE_DIR")
+        self.root = os.path.join(self._tmp.name, "cache")
+        os.environ["BTRC_CACHE_DIR"] = self.root
+        os.mkdir(os.path.join(self._tmp.name, "project"))
+        os.chdir(os.path.join(self._tmp.name, "project"))
+        return self
+
+    def __exit__(self, *exc):
+        os.chdir(self._cwd)
+        if self._env is None:
+            del os.environ["BTRC_CACHE_DIR"]
+        else:
+            os.environ["BTRC_CACHE_DIR"] = self._env
+        self._tmp.cleanup()
+
+    def records(self, kind: str) -> int:
+        path = os.path.join(cache_dir(), kind)
+        return len(os.listdir(path)) if os.path.isdir(path) else 0
+
+
+# --- Source units ---
+
+class TestSourceUnits:
+    def test_units_join_to_resolved_source(self):
+        with _CacheDir():
+            with open("lib.btrc", "w") as f:
+                f.write(_LIB)
+            main = '#include "lib.btrc"\n' + _MAIN
+            units = resolve_include_units(main, "main.btrc")
+            assert [os.path.basename(p) for p, _ in units] == ["lib.btrc", "main.btrc"]
+            assert "\n".join(t for _, t in units) == resolve_includes(main, "main.btrc")
+
+    def test_units_parse_like_whole_source(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        whole = Parser(Lexer(_LIB + "\n" + _MAIN).tokenize()).parse()
+        program, prints = parse_units(units, use_cache=False)
+        assert repr(program) == repr(whole)
+        assert set(prints) == {id(d) for d in program.declarations}
+
+    def test_moved_unit_gets_shifted_lines(self):
+        with _CacheDir():
+            parse_units([("lib.btrc", _LIB), ("main.btrc", _MAIN)])
+            program, _ = parse_units([("lib.btrc", "\n\n" + _LIB), ("main.btrc", _MAIN)])
+            whole = Parser(Lexer("\n\n" + _LIB + "\n" + _MAIN).tokenize()).parse()
+            assert repr(program) == repr(whole)
+
+    def test_unit_that_fails_alone_falls_back(self):
+        # Split inside a class body: neither half parses on its own
+        half = _LIB.index("public void")
+        units = [("a.btrc", _LIB[:half]), ("b.btrc", _LIB[half:])]
+        assert parse_units(units, use_cache=False) is None
+
+    def test_signature_ignores_bodies_and_positions(self):
+        _, before = parse_units([("lib.btrc", _LIB)], use_cache=False)
+        edited = "\n" + _LIB.replace("return x * 2;", "return x + x;")
+        _, after = parse_units([("lib.btrc", edited)], use_cache=False)
+        (body1, sig1), (body2, sig2) = list(before.values())[1], list(after.values())[1]
+        assert sig1 == sig2
+        assert body1 != body2
+
+
+# --- Per-declaration IR ---
+
+class TestDeclCache:
+    def test_cached_build_matches_uncached(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        with _CacheDir() as cache:
+            first = _compile(units, use_cache=True)
+            assert cache.records("ir") == 3
+            assert _compile(units, use_cache=True) == first
+        assert first == _compile(units)
+
+    def test_body_edit_relowers_only_that_declaration(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        edited = [units[0], ("main.btrc", _MAIN.replace("inc(3)", "inc(4)"))]
+        with _CacheDir() as cache:
+            _compile(units, use_cache=True)
+            out = _compile(edited, use_cache=True)
+            assert cache.records("ir") == 4
+        assert out == _compile(edited)
+
+    def test_signature_edit_relowers_dependents(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        lib = _LIB.replace("int twice(int x) { return x * 2; }",
+                           "int twice(int x, int y = 2) { return x * y; }")
+        with _CacheDir():
+            _compile(units, use_cache=True)
+            out = _compile([("lib.btrc", lib), units[1]], use_cache=True)
+        assert "twice(" in out
+        assert out == _compile([("lib.btrc", lib), units[1]])
+
+    def test_parallel_matches_serial(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        assert _compile(units, jobs=2) == _compile(units)
+
+
+# --- Cache location ---
+
+class TestCacheLocation:
+    def test_nothing_is_written_to_the_working_directory(self):
+        units = [("lib.btrc", _LIB), ("main.btrc", _MAIN)]
+        with _CacheDir() as cache:
+            _compile(units, use_cache=True)
+            assert os.listdir(".") == []
+            assert cache.records("ir") == 3
+
+    def test_shared_cache_directory_is_not_read(self):
+        with _CacheDir():
+            store_record("ir", "k", [1, 2])
+            assert load_record("ir", "k") == [1, 2]
+            os.chmod(cache_dir(), 0o777)
+            assert cache_dir() is None
+            assert load_record("ir", "k") is None
@@ -0,0 +1,175 @@
+"""Tests for --exceptions=flag: which throws skip setjmp, and that programs
+behave as they do with the default setjmp lowering."""
+
+import os
+import subprocess
+import tempfile
+
+from src.compiler.python.analyzer.analyzer import Analyzer
+from src.compiler.python.cache import get_stdlib_source_cached
+from src.compiler.python.ir.emitter import CEmitter
+from src.compiler.python.ir.gen.generator import IRGenerator
+from src.compiler.python.ir.optimizer import optimize
+from src.compiler.python.lexer import Lexer
+from src.compiler.python.parser.parser import Parser
+
+# Same compiler settings as the golden tests (src/tests/runner.py)
+_CC = os.environ.get("BTRC_CC", "cc")
+_CFLAGS = os.environ.get("BTRC_CFLAGS", "-std=c11 -pedantic").split()
+_TESTS = os.path.join(os.path.dirname(__file__), "..", "..", "..", "tests")
+
+_SOURCE = '''
+int alive = 0;
+
+class Res {
+    public int id;
+    public Res(int id) { self.id = id; alive++; }
+    public void __del__() { alive--; }
+}
+
+class Account {
+    public int balance;
+    public Account(int balance) { self.balance = balance; }
+    public void withdraw(int amount) {
+        if (amount > self.balance) { throw f"insufficient: {amount}"; }
+        self.balance = self.balance - amount;
+    }
+}
+
+int parse(int x) {
+    Res r = new Res(x);
+    if (x < 0) { throw "negative"; }
+    return x * 2;
+}
+
+int twice(int x) {
+    int a = parse(x);
+    return parse(a);
+}
+
+void fill(int n) {
+    for (int i = 0; i < n; i++) {
+        Res r = new Res(i);
+        parse(3 - i);
+    }
+}
+
+int main() {
+    try {
+        int v = twice(5);
+        print(v);
+        twice(-1);
+        print("unreachable");
+    } catch (string e) {
+        print(f"caught {e}");
+    }
+    try {
+        fill(10);
+    } catch (string e) {
+        print(f"fill {e}");
+    }
+    Account acct = new Account(100);
+    try {
+        acct.withdraw(30);
+        acct.withdraw(500);
+    } catch (string e) {
+        print(e);
+    } finally {
+        print(acct.balance);
+    }
+    try {
+        try {
+            parse(-1);
+        } catch (string e) {
+            throw f"wrapped {e}";
+        }
+    } catch (string e) {
+        print(e);
+    }
+    print(f"alive {alive}");
+    parse(-7);
+    return 0;
+}
+'''
+
+
+def _compile(source: str, exceptions: str = "flag") -> str:
+    stdlib = get_stdlib_source_cached(source)
+    if stdlib:
+        source = stdlib + "\n" + source
+    analyzed = Analyzer().analyze(Parser(Lexer(source).tokenize()).parse())
+    assert analyzed.errors == []
+    return CEmitter().emit(optimize(IRGenerator(analyzed, exceptions=exceptions).generate()))
+
+
+def _run(c_source: str) -> subprocess.CompletedProcess:
+    with tempfile.TemporaryDirectory() as tmp:
+        c_path, bin_path = os.path.join(tmp, "p.c"), os.path.join(tmp, "p")
+        with open(c_path, "w") as f:
+            f.write(c_source)
+        subprocess.run([_CC] + _CFLAGS + [c_path, "-o", bin_path, "-lm"],
+                       check=True, capture_output=True, text=True)
+        return subprocess.run([bin_path], capture_output=True, text=True, timeout=30)
+
+
+class TestLowering:
+    def test_off_by_default(self):
+        c = _compile(_SOURCE, "setjmp")
+        assert "setjmp(__btrc_try_stack" in c
+        assert "__btrc_pending" not in c
+
+    def test_no_setjmp_when_every_call_is_checked(self):
+        c = _compile(_SOURCE)
+        assert "setjmp(" not in c
+        assert "__btrc_register_cleanup" not in c
+        assert "if (__btrc_pending) {" in c
+        assert "goto __btrc_catch_" in c
+
+    def test_unchecked_call_keeps_setjmp(self):
+        source = _SOURCE.replace("int v = twice(5);", "int v = 1 + twice(5);")
+        c = _compile(source)
+        # twice now longjmps (rethrowing what parse flags), so only its try needs setjmp
+        assert c.count("setjmp(__btrc_try_stack") == 1
+        assert "__btrc_rethrow();" in c
+        flag = _run(c).stdout.splitlines()
+        assert flag[-1] == "alive 0"
+        assert flag[:-1] == _run(_compile(source, "setjmp")).stdout.splitlines()[:-1]
+
+    def test_throwing_lambda_disables_the_plan(self):
+        source = _SOURCE.replace("int main() {", (
+            "int main() {\n"
+            "    var check = (int x) => { if (x < 0) { throw \"lambda\"; } return x; };\n"
+            "    print(check(1));"))
+        assert _compile(source) == _compile(source, "setjmp")
+
+
+class TestBehaviour:
+    def test_same_output_as_setjmp(self):
+        flag = _run(_compile(_SOURCE.replace('print(f"alive {alive}");', "")))
+        plain = _run(_compile(_SOURCE.replace('print(f"alive {alive}");', ""), "setjmp"))
+        assert flag.stdout == plain.stdout
+        assert flag.stdout.splitlines()[:5] == [
+            "20", "caught negative", "fill negative", "insufficient: 500", "70"]
+
+    def test_unwinding_releases_callee_locals(self):
+        # longjmp skips the Res locals of parse and fill; the flag returns through them
+        assert "alive 0\n" in _run(_compile(_SOURCE)).stdout
+        assert "alive 0\n" not in _run(_compile(_SOURCE, "setjmp")).stdout
+
+    def test_unhandled_exception(self):
+        result = _run(_compile(_SOURCE))
+        assert result.returncode == 1
+        assert result.stderr == "Unhandled exception: negative\n"
+
+    def test_try_catch_golden_tests(self):
+        names = sorted(f for f in os.listdir(os.path.join(_TESTS, "control_flow"))
+                       if f.startswith("test_try_catch") and f.endswith(".btrc"))
+        names.append(os.path.join("..", "memory", "test_arc_exception.btrc"))
+        for name in names:
+            path = os.path.join(_TESTS, "control_flow", name)
+            with open(path) as f:
+                c = _compile(f.read())
+            expected = os.path.join(os.path.dirname(path), "expected",
+                                    os.path.basename(name)[:-len(".btrc")] + ".stdout")
+            with open(expected) as f:
+                assert _run(c).stdout == f.read(), name
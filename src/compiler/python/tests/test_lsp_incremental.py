@@ -0,0 +1,139 @@
+"""Tests for the LSP's incremental reanalysis (src/devex/lsp/incremental.py).
+
+Each edit is applied to the previous document state and the result is
+compared with analyzing the edited text from scratch, which is what
+compute_diagnostics does without a previous state.
+"""
+
+from src.compiler.python.ast_nodes import TypeExpr
+from src.compiler.python.lexer import Lexer
+from src.devex.lsp.incremental import analyze_tokens, analyzed_program
+
+_SOURCE = '''
+class Counter {
+    public int n;
+    public Counter() { self.n = 0; }
+    public void add(int k) { self.n += k; }
+}
+
+int twice(int x) {
+    return x * 2;
+}
+
+int broken() {
+    int x = "a";
+    return x;
+}
+
+int main() {
+    Counter c = Counter();
+    var inc = (int x) => x + 1;
+    c.add(twice(inc(3)));
+    string s = f"{c.n}";
+    return c.n;
+}
+'''
+
+
+def _tokens(source: str):
+    return Lexer(source, "x.btrc").tokenize()
+
+
+def _type_text(t) -> str:
+    """A type without its source position."""
+    if not isinstance(t, TypeExpr):
+        return repr(t)
+    args = ",".join(_type_text(a) for a in t.generic_args)
+    return (f"{t.base}<{args}>{'*' * t.pointer_depth}"
+            f"{'[]' if t.is_array else ''}{'?' if t.is_nullable else ''}")
+
+
+def _typed_nodes(program, node_types) -> list[tuple]:
+    """(node kind, line, col, type) for every typed node, in source order."""
+    out, seen = [], set()
+
+    def visit(node):
+        if id(node) in seen or isinstance(node, TypeExpr):
+            return
+        seen.add(id(node))
+        if id(node) in node_types:
+            out.append((type(node).__name__, getattr(node, "line", 0),
+                        getattr(node, "col", 0), _type_text(node_types[id(node)])))
+        for name in node.__dataclass_fields__:
+            value = getattr(node, name)
+            for item in value if isinstance(value, list) else [value]:
+                if hasattr(item, "__dataclass_fields__"):
+                    visit(item)
+
+    for decl in program.declarations:
+        visit(decl)
+    return out
+
+
+def _assert_matches_fresh(state, source: str):
+    got = analyzed_program(state)
+    want = analyzed_program(analyze_tokens(_tokens(source)))
+    assert got.errors == want.errors
+    assert got.warnings == want.warnings
+    assert _typed_nodes(got.program, got.node_types) == \
+        _typed_nodes(want.program, want.node_types)
+
+
+def _edit(state, source: str):
+    """Apply `source` on top of `state`; also return the declaration nodes
+    the edit kept from it."""
+    before = {id(d.node) for d in state.decls}
+    state = analyze_tokens(_tokens(source), state)
+    kept = [d.node for d in state.decls if id(d.node) in before]
+    return state, kept
+
+
+class TestIncrementalMatchesFresh:
+    def test_initial_analysis(self):
+        state = analyze_tokens(_tokens(_SOURCE))
+        errors = analyzed_program(state).errors
+        assert errors == ["Cannot assign 'string' to variable 'x' of type 'int' at 13:5"]
+        _assert_matches_fresh(state, _SOURCE)
+
+    def test_body_only_edit(self):
+        edited = _SOURCE.replace("return x * 2;", "int y = x;\n    return y + x;")
+        state, kept = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        assert len(kept) == 3  # only twice was parsed again
+        _assert_matches_fresh(state, edited)
+
+    def test_body_edit_that_fixes_an_error(self):
+        edited = _SOURCE.replace('int x = "a";', "int x = 1;")
+        state, kept = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        assert len(kept) == 3
+        assert analyzed_program(state).errors == []
+        _assert_matches_fresh(state, edited)
+
+    def test_signature_change_reanalyzes_everything(self):
+        edited = _SOURCE.replace("int twice(int x)", "int twice(int x, int y = 2)")
+        state, kept = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        assert kept == []
+        _assert_matches_fresh(state, edited)
+
+    def test_new_declaration_reanalyzes_everything(self):
+        edited = _SOURCE.replace("int broken()", "int three() { return 3; }\n\nint broken()")
+        state, kept = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        assert kept == []
+        _assert_matches_fresh(state, edited)
+
+    def test_edit_then_undo(self):
+        edited = _SOURCE.replace("self.n += k;", "self.n += k * 2;")
+        state, _ = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        state, kept = _edit(state, _SOURCE)
+        assert len(kept) == 3
+        _assert_matches_fresh(state, _SOURCE)
+
+    def test_lines_added_above_kept_declarations(self):
+        edited = _SOURCE.replace("return x * 2;", "int y = x;\n\n\n    return y * 2;")
+        state, kept = _edit(analyze_tokens(_tokens(_SOURCE)), edited)
+        assert len(kept) == 3
+        assert analyzed_program(state).errors[0].endswith(" at 16:5")
+        _assert_matches_fresh(state, edited)
+
+    def test_unchanged_source_keeps_the_state(self):
+        state = analyze_tokens(_tokens(_SOURCE))
+        assert analyze_tokens(_tokens(_SOURCE), state) is state
@@ -3,6 +3,7 @@
 import pytest
 
 from src.compiler.python.ast_nodes import (
+    ArenaStmt,
     AssignExpr,
     BinaryExpr,
     Block,
@@ -173,6 +174,12 @@ class TestFunctions:
         assert f.is_gpu is True
         assert f.params[0].type.is_array is True
 
+    def test_parse_gpu_workgroup(self):
+        prog = parse('@gpu(workgroup=16x16) void kern(int w, int h) { }')
+        f = prog.declarations[0]
+        assert f.is_gpu is True
+        assert f.gpu_workgroup == [16, 16]
+
     def test_parse_function_pointer_return(self):
         prog = parse('int* create() { return null; }')
         f = prog.declarations[0]
@@ -392,6 +399,11 @@ class TestStatements:
         assert isinstance(stmt, Block)
         assert len(stmt.statements) == 2
 
+    def test_parse_arena(self):
+        stmt = parse_stmt('arena { var p = new Point(1, 2); print(p.x); }')
+        assert isinstance(stmt, ArenaStmt)
+        assert len(stmt.body.statements) == 2
+
 
 # --- Expressions ---
 
@@ -0,0 +1,175 @@
+"""Tests for --profile: instrumented IR and the report the program prints."""
+
+import json
+import os
+import subprocess
+import tempfile
+
+from src.compiler.python.analyzer.analyzer import Analyzer
+from src.compiler.python.cache import get_stdlib_source_cached
+from src.compiler.python.ir.emitter import CEmitter
+from src.compiler.python.ir.gen.generator import IRGenerator
+from src.compiler.python.ir.optimizer import optimize
+from src.compiler.python.ir.profile import instrument
+from src.compiler.python.lexer import Lexer
+from src.compiler.python.parser.parser import Parser
+
+# Same compiler settings as the golden tests (src/tests/runner.py)
+_CC = os.environ.get("BTRC_CC", "cc")
+_CFLAGS = os.environ.get("BTRC_CFLAGS", "-std=c11 -pedantic").split()
+
+_SOURCE = '''
+class Node {
+    public int value;
+    public Node next;
+    public Node(int value) { self.value = value; self.next = null; }
+}
+
+int fib(int n) {
+    if (n < 2) { return n; }
+    return fib(n - 1) + fib(n - 2);
+}
+
+void fail(int n) {
+    if (n > 0) { throw "boom"; }
+}
+
+int main() {
+    Node a = Node(1);
+    a.next = Node(2);
+    try { fail(1); } catch (string e) { }
+    print(fib(10) + a.next.value);
+    return 0;
+}
+'''
+
+
+def _compile(source: str, *, profile: bool = True) -> str:
+    stdlib = get_stdlib_source_cached(source)
+    if stdlib:
+        source = stdlib + "\n" + source
+    analyzed = Analyzer().analyze(Parser(Lexer(source).tokenize()).parse())
+    assert analyzed.errors == []
+    module = optimize(IRGenerator(analyzed).generate(), inline=not profile)
+    if profile:
+        instrument(module)
+    return CEmitter().emit(module)
+
+
+def _run(c_source: str, env: dict) -> subprocess.CompletedProcess:
+    with tempfile.TemporaryDirectory() as tmp:
+        c_path, bin_path = os.path.join(tmp, "p.c"), os.path.join(tmp, "p")
+        with open(c_path, "w") as f:
+            f.write(c_source)
+        subprocess.run([_CC] + _CFLAGS + [c_path, "-o", bin_path, "-lm"],
+                       check=True, capture_output=True, text=True)
+        return subprocess.run([bin_path], capture_output=True, text=True,
+                              env={**os.environ, **env}, timeout=30)
+
+
+def _calls(report: str) -> dict[str, int]:
+    calls = {}
+    for line in report.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[0].isdigit():
+            calls[parts[3]] = int(parts[0])
+    return calls
+
+
+class TestInstrumentation:
+    def test_functions_are_wrapped(self):
+        c = _compile(_SOURCE)
+        assert "__btrc_prof_enter(" in c
+        assert "__btrc_prof_leave(__prof_slot);" in c
+        assert "__prof_ret = " in c
+        main = c[c.index("int main("):]
+        assert main.index("__btrc_prof_start()") < main.index("__btrc_prof_enter(")
+
+    def test_arc_updates_are_counted(self):
+        c = _compile(_SOURCE)
+        assert "__btrc_prof_retains++" in c or "__btrc_prof_releases++" in c
+        assert "__btrc_prof_destroys++" in c
+
+    def test_runtime_comes_first(self):
+        c = _compile(_SOURCE)
+        assert c.index("__btrc_prof_now(void)") < c.index("int fib(")
+        assert "#include <time.h>" in c
+
+    def test_catch_closes_unwound_calls(self):
+        c = _compile(_SOURCE)
+        main = c[c.index("int main("):]
+        assert "int __prof_try0 = __btrc_prof_sp;" in main
+        catch = main[main.index("} else {"):]
+        assert catch.index("__btrc_prof_leave(__prof_try0);") < catch.index("fib(")
+
+    def test_off_by_default(self):
+        assert "__btrc_prof" not in _compile(_SOURCE, profile=False)
+
+
+class TestReport:
+    def test_program_output_is_unchanged(self):
+        plain = _run(_compile(_SOURCE, profile=False), {})
+        profiled = _run(_compile(_SOURCE), {})
+        assert profiled.stdout == plain.stdout == "57\n"
+
+    def test_counts_calls_and_arc(self):
+        report = _run(_compile(_SOURCE), {}).stderr
+        calls = _calls(report)
+        assert calls["fib"] == 177
+        assert calls["fail"] == 1
+        assert calls["main"] == 1
+        assert "Node_destroy" in calls
+        assert "ARC: " in report and "2 destroys" in report
+
+    def test_writes_chrome_trace(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "trace.json")
+            _run(_compile(_SOURCE), {"BTRC_PROFILE_TRACE": path})
+            with open(path) as f:
+                events = json.load(f)["traceEvents"]
+        names = [e["name"] for e in events]
+        assert names.count("fib") == 177
+        assert all(e["ph"] == "X" and e["dur"] >= 0 for e in events)
+        # The throw unwound fail; it ends at the catch, before fib starts
+        fail = next(e for e in events if e["name"] == "fail")
+        first_fib = min(e["ts"] for e in events if e["name"] == "fib")
+        assert fail["ts"] + fail["dur"] <= first_fib
+
+    def test_accessors_are_counted(self):
+        source = _SOURCE.replace("print(fib(10) + a.next.value);",
+                                 "Vector<int> v = [1, 2];\n    print(fib(10) + v.size() + 53);")
+        assert _calls(_run(_compile(source), {}).stderr)["btrc_Vector_int_size"] == 1
+
+
+_GPU_SOURCE = '''
+#include <btrc_gpu.h>
+
+@gpu
+float[] scale(float[] a) {
+    int i = gpu_id();
+    return a[i] * 2.0;
+}
+
+int main() {
+    float[] a = [1.0, 2.0, 3.0, 4.0];
+    a = scale(a);
+    print(a[0]);
+    return 0;
+}
+'''
+
+
+class TestGpuProfile:
+    def test_dispatches_are_labelled(self):
+        c = _compile(_GPU_SOURCE)
+        assert 'btrc_gpu_label(__gpu, "scale");' in c
+        assert "btrc_gpu_label(__gpu, NULL);" in c
+        main = c[c.index("int main("):]
+        assert main.index("btrc_gpu_profile_enable()") < main.index("__btrc_prof_start()")
+
+    def test_unlabelled_without_profile(self):
+        c = _compile(_GPU_SOURCE, profile=False)
+        assert "btrc_gpu_label" not in c and "btrc_gpu_profile_enable" not in c
+
+    def test_cpu_only_program_leaves_gpu_alone(self):
+        assert "btrc_gpu_profile_enable" not in _compile(_SOURCE)
@@ -52,6 +52,7 @@ class TokenType(Enum):
 
     # btrc keywords
     ABSTRACT = auto()
+    ARENA = auto()
     BOOL = auto()
     CATCH = auto()
     CLASS = auto()
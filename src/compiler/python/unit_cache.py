@@ -0,0 +1,142 @@
+"""Per-file front-end cache: lex and parse one source unit at a time.
+
+sources.py splits the combined source into units, one per stdlib file and
+per run of lines from each included file. The parser is context-free, so a
+unit parses on its own into exactly the declarations the whole source
+would give for it, and its AST is stored under the hash of its text. A
+build only lexes and parses the files that changed, in parallel with
+`--jobs`. The token stream is not stored: once the AST is known, nothing
+later in the pipeline reads the tokens.
+
+A record remembers the line its unit started on. When the unit has moved
+(lines were added above it), the lines of its nodes are shifted.
+
+Each record also holds two fingerprints per declaration, which key its IR
+(ir/gen/decl_cache.py): `body` hashes its tokens without their positions,
+`signature` hashes what other declarations can see of it: a function or
+non-generic class with its bodies left out, anything else (including a
+@gpu kernel, whose body decides its buffers) in full.
+
+If any unit doesn't lex or parse on its own, `parse_units` returns None and
+the caller parses the whole source, so errors read exactly as before.
+"""
+
+from __future__ import annotations
+
+import hashlib
+
+from .ast_nodes import ClassDecl, FunctionDecl, Program
+from .disk_cache import load_record, record_key, store_record
+from .lexer import Lexer
+from .parser.parser import Parser
+from .sources import Unit
+from .workers import map_in_processes
+
+_KIND = "ast"
+_BODY_FIELDS = ("body", "getter_body", "setter_body")
+
+DeclPrint = tuple[str, str]  # (body, signature) fingerprints
+
+
+def parse_units(units: list[Unit], *, use_cache: bool = True,
+                jobs: int = 1) -> tuple[Program, dict[int, DeclPrint]] | None:
+    """The program for the combined source of `units`, and the fingerprints
+    of each top-level declaration by id, or None if a unit fails alone."""
+    starts = []
+    line = 1
+    for _, text in units:
+        starts.append(line)
+        line += text.count("\n") + 1
+    keys = [record_key(_KIND, text) for _, text in units]
+    records = [load_record(_KIND, key) if use_cache else None for key in keys]
+    missing = [i for i, record in enumerate(records) if record is None]
+    parsed = map_in_processes(
+        _parse_unit, [(units[i][1], starts[i]) for i in missing], jobs)
+    for i, record in zip(missing, parsed):
+        if record is None:
+            return None
+        if use_cache:
+            store_record(_KIND, keys[i], record)
+        records[i] = record
+    decls, prints = [], {}
+    for start, (line, unit_decls, unit_prints) in zip(starts, records):
+        if line != start:
+            _shift_lines(unit_decls, start - line)
+        decls += unit_decls
+        prints.update(zip(map(id, unit_decls), unit_prints))
+    return Program(declarations=decls), prints
+
+
+def _parse_unit(job: tuple[str, int]):
+    """(start line, declarations, fingerprints) for one unit, or None."""
+    text, start = job
+    lexer = Lexer(text)
+    lexer.line = start
+    try:
+        parser = Parser(lexer.tokenize())
+        decls, prints = [], []
+        while not parser._at_end():
+            first = parser.pos
+            decl = parser._parse_top_level_item()
+            decls.append(decl)
+            prints.append(decl_fingerprints(decl, parser.tokens[first:parser.pos]))
+    except Exception:  # the whole-source parse reports it
+        return None
+    return start, decls, prints
+
+
+def decl_fingerprints(decl, tokens) -> DeclPrint:
+    """The fingerprints of `decl`, parsed from `tokens`."""
+    body = _digest(f"{t.type.name} {t.value}" for t in tokens)
+    if (isinstance(decl, FunctionDecl) and not decl.is_gpu) or (
+            isinstance(decl, ClassDecl) and not decl.generic_params):
+        return body, _digest(_shape(decl))
+    return body, body
+
+
+def _digest(parts) -> str:
+    h = hashlib.sha256()
+    for part in parts:
+        h.update(part.encode("utf-8"))
+        h.update(b"\0")
+    return h.hexdigest()
+
+
+def _shape(node):
+    """`node` as strings, without positions and with bodies reduced to
+    whether they are present."""
+    if isinstance(node, list):
+        yield "["
+        for item in node:
+            yield from _shape(item)
+        yield "]"
+    elif hasattr(node, "__dataclass_fields__"):
+        yield type(node).__name__
+        for name in node.__dataclass_fields__:
+            if name in ("line", "col"):
+                continue
+            value = getattr(node, name)
+            if name in _BODY_FIELDS:
+                yield str(value is not None)
+            else:
+                yield from _shape(value)
+    else:
+        yield repr(node)
+
+
+def _shift_lines(decls: list, delta: int):
+    seen = set()
+    stack = list(decls)
+    while stack:
+        node = stack.pop()
+        if id(node) in seen:
+            continue
+        seen.add(id(node))
+        for name in node.__dataclass_fields__:
+            value = getattr(node, name)
+            if name == "line":
+                node.line = value + delta
+            elif isinstance(value, list):
+                stack += [v for v in value if hasattr(v, "__dataclass_fields__")]
+            elif hasattr(value, "__dataclass_fields__"):
+                stack.append(value)
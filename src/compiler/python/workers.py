@@ -0,0 +1,26 @@
+"""Process-parallel map for the compiler's independent work items.
+
+Workers are forked, so they start with a copy of the parent's state (the
+analyzed program, the IR generator) and only the items and results cross
+process boundaries. Where fork is unavailable, or there is nothing to
+split, the work runs in this process.
+"""
+
+from __future__ import annotations
+
+import multiprocessing
+from concurrent.futures import ProcessPoolExecutor
+
+
+def map_in_processes(fn, items: list, jobs: int) -> list:
+    """`[fn(item) for item in items]`, spread over up to `jobs` processes.
+
+    `fn` must be a module-level function; results come back in order.
+    """
+    if jobs <= 1 or len(items) < 2 or "fork" not in multiprocessing.get_all_start_methods():
+        return [fn(item) for item in items]
+    workers = min(jobs, len(items))
+    chunk = -(-len(items) // workers)
+    with ProcessPoolExecutor(max_workers=workers,
+                             mp_context=multiprocessing.get_context("fork")) as pool:
+        return list(pool.map(fn, items, chunksize=chunk))
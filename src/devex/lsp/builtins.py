@@ -211,10 +211,16 @@ VECTOR_MEMBERS: list[BuiltinMember] = [
     BuiltinMember("removeAll", "void", "method", [("T", "val")], "removeAll"),
     BuiltinMember("distinct", "Vector<T>", "method", [], "distinct"),
     BuiltinMember("sort", "void", "method", [], "sort"),
+    BuiltinMember("sortBy", "void", "method", [("__fn_ptr<int, T>", "key")], "sortBy"),
+    BuiltinMember("sortWith", "void", "method", [("__fn_ptr<int, T, T>", "cmp")], "sortWith"),
     BuiltinMember("sorted", "Vector<T>", "method", [], "sorted"),
     BuiltinMember("min", "T", "method", [], "min"),
     BuiltinMember("max", "T", "method", [], "max"),
     BuiltinMember("sum", "T", "method", [], "sum"),
+    BuiltinMember("dot", "T", "method", [("Vector<T>", "other")], "dot"),
+    BuiltinMember("axpy", "void", "method", [("T", "a"), ("Vector<T>", "x")], "axpy"),
+    BuiltinMember("scale", "void", "method", [("T", "a")], "scale"),
+    BuiltinMember("add", "void", "method", [("Vector<T>", "other")], "add"),
     BuiltinMember("join", "string", "method", [("string", "sep")], "join"),
     BuiltinMember("joinToString", "string", "method", [("string", "sep")], "joinToString"),
     BuiltinMember("filter", "Vector<T>", "method", [("__fn_ptr<bool, T>", "pred")], "filter"),
@@ -224,6 +230,11 @@ VECTOR_MEMBERS: list[BuiltinMember] = [
     BuiltinMember("any", "bool", "method", [("__fn_ptr<bool, T>", "pred")], "any"),
     BuiltinMember("all", "bool", "method", [("__fn_ptr<bool, T>", "pred")], "all"),
     BuiltinMember("reduce", "T", "method", [("T", "init"), ("__fn_ptr<T, T, T>", "fn")], "reduce"),
+    BuiltinMember("parMap", "Vector<T>", "method", [("__fn_ptr<T, T>", "fn")], "parMap"),
+    BuiltinMember("parFilter", "Vector<T>", "method", [("__fn_ptr<bool, T>", "pred")], "parFilter"),
+    BuiltinMember("parReduce", "T", "method", [("T", "init"), ("__fn_ptr<T, T, T>", "fn")], "parReduce"),
+    BuiltinMember("parForEach", "void", "method", [("__fn_ptr<void, T>", "fn")], "parForEach"),
+    BuiltinMember("parSort", "void", "method", [], "parSort"),
     BuiltinMember("copy", "Vector<T>", "method", [], "copy"),
     BuiltinMember("removeAt", "void", "method", [("int", "idx")], "removeAt"),
     BuiltinMember("iterLen", "int", "method", [], "iterLen"),
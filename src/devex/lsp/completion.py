@@ -63,6 +63,7 @@ _BTRC_KEYWORDS = [
     ("parallel", "Mark a for loop for parallel execution"),
     ("keep", "Marks a parameter as stored (rc++) or a return as transferring ownership"),
     ("release", "Decrement reference count; free at zero; set variable to NULL"),
+    ("arena", "Block whose objects and strings are bump-allocated and freed together at exit"),
 ]
 
 
@@ -1,7 +1,9 @@
 """Diagnostic computation for btrc documents.
 
 Runs the compiler pipeline (lexer -> parser -> analyzer) on source text
-and converts errors into LSP Diagnostic objects.
+and converts errors into LSP Diagnostic objects. Given the document's
+previous state, only the declarations an edit touched are parsed and
+analyzed again (incremental.py).
 """
 
 import os
@@ -11,14 +13,13 @@ from urllib.parse import unquote, urlparse
 
 from lsprotocol import types as lsp
 
-from src.compiler.python.analyzer.analyzer import Analyzer
 from src.compiler.python.analyzer.core import AnalyzedProgram
 from src.compiler.python.ast_nodes import Program
 from src.compiler.python.lexer import Lexer, LexerError
-from src.compiler.python.main import resolve_includes
 from src.compiler.python.parser.core import ParseError
-from src.compiler.python.parser.parser import Parser
+from src.compiler.python.sources import resolve_includes
 from src.compiler.python.tokens import Token
+from src.devex.lsp.incremental import DocumentState, analyze_tokens, analyzed_program
 
 # Regex to parse analyzer error strings: "message at line:col"
 _ANALYZER_ERROR_RE = re.compile(r"^(.+) at (\d+):(\d+)$")
@@ -34,6 +35,8 @@ class AnalysisResult:
     tokens: list[Token] | None = None
     ast: Program | None = None
     analyzed: AnalyzedProgram | None = None
+    # What the next edit can reuse (see incremental.py)
+    state: DocumentState | None = None
 
 
 def uri_to_path(uri: str) -> str:
@@ -66,8 +69,13 @@ def _make_diagnostic(
     )
 
 
-def compute_diagnostics(uri: str, source: str) -> AnalysisResult:
-    """Run the compiler pipeline and return diagnostics."""
+def compute_diagnostics(uri: str, source: str,
+                        previous: DocumentState | None = None) -> AnalysisResult:
+    """Run the compiler pipeline and return diagnostics.
+
+    `previous` is the state of the last analysis that parsed; it is updated
+    in place where the edit allows, so it must not be used again.
+    """
     result = AnalysisResult(uri=uri, source=source)
     file_path = uri_to_path(uri)
     filename = os.path.basename(file_path)
@@ -87,18 +95,15 @@ def compute_diagnostics(uri: str, source: str) -> AnalysisResult:
         result.diagnostics.append(_make_diagnostic(e.line, e.col, str(e)))
         return result
 
-    # Parsing
+    # Parsing and semantic analysis
     try:
-        parser = Parser(tokens)
-        program = parser.parse()
-        result.ast = program
+        state = analyze_tokens(tokens, previous)
     except ParseError as e:
         result.diagnostics.append(_make_diagnostic(e.line, e.col, str(e)))
         return result
-
-    # Semantic analysis
-    analyzer = Analyzer()
-    analyzed = analyzer.analyze(program)
+    analyzed = analyzed_program(state)
+    result.state = state
+    result.ast = analyzed.program
     result.analyzed = analyzed
 
     for err_str in analyzed.errors:
@@ -117,6 +117,8 @@ _KEYWORD_DOCS = {
             "or a return type as transferring ownership to the caller.",
     "release": "Decrements the reference count. If the count reaches zero, "
                "the object is destroyed and memory is freed. Sets the variable to NULL.",
+    "arena": "Opens a block whose objects and strings are bump-allocated and freed "
+             "together when the block ends. Arena values may not escape the block.",
 }
 
 # Auto-generate hover docs for types in _MEMBER_TABLES
@@ -0,0 +1,276 @@
+"""Incremental reanalysis of an open document.
+
+A DocumentState remembers the document's tokens, its top-level
+declarations with the token range each was parsed from, and the analyzer
+that checked them. On an edit the new source is lexed whole (semantic
+tokens and cursor lookups read every token) and compared with the old
+tokens:
+
+- Declarations inside the unchanged run of tokens at the start, or the
+  unchanged run at the end (the same tokens, moved down or up by whole
+  lines), are kept; only the span between them is parsed again. Kept
+  declarations after the edit have their lines shifted.
+- If the re-parsed declarations are functions and classes whose signature
+  fingerprints (unit_cache.py) are unchanged, nothing the rest of the
+  document sees of them has changed: the analyzer's tables are pointed at
+  the new nodes and only those declarations are analyzed again. The
+  errors and node types found in the others are kept.
+- Any other edit (a new or removed declaration, a changed signature, a
+  global) parses and analyzes the document in full.
+
+Arena blocks are checked last, through escape summaries of every
+function (analyzer/arena_calls.py), so a body edit anywhere can change
+their errors: they are checked again after each edit.
+
+The stdlib is not part of the LSP pipeline (builtins.py describes its
+types), so the state of each open document is all there is to keep.
+"""
+
+from __future__ import annotations
+
+import itertools
+import re
+from dataclasses import dataclass, field
+
+from src.compiler.python.analyzer.analyzer import Analyzer
+from src.compiler.python.analyzer.core import AnalyzedProgram
+from src.compiler.python.ast_nodes import (
+    ClassDecl,
+    FStringExpr,
+    FunctionDecl,
+    Program,
+    TypeExpr,
+)
+from src.compiler.python.parser.parser import Parser
+from src.compiler.python.tokens import Token
+from src.compiler.python.unit_cache import decl_fingerprints
+
+_POSITION_RE = re.compile(r" at (\d+):(\d+)$")
+
+
+@dataclass
+class _Decl:
+    """A top-level declaration and what analyzing it produced."""
+
+    node: object
+    start: int  # token range [start, end)
+    end: int
+    signature: str
+    errors: list[str] = field(default_factory=list)
+    warnings: list[str] = field(default_factory=list)
+    typed: list[int] = field(default_factory=list)  # its node_types keys
+    arenas: list = field(default_factory=list)  # its arena blocks
+
+
+@dataclass
+class DocumentState:
+    tokens: list[Token]
+    decls: list[_Decl]
+    analyzer: Analyzer
+    # Found while building the tables, before any declaration is analyzed
+    head_errors: list[str]
+    head_warnings: list[str]
+    arena_errors: list[str] = field(default_factory=list)
+
+
+def analyze_tokens(tokens: list[Token],
+                   previous: DocumentState | None = None) -> DocumentState:
+    """Parse and analyze `tokens`, reusing what still holds of `previous`.
+
+    Raises ParseError like Parser.parse() when the document doesn't parse.
+    """
+    if previous is not None:
+        state = _update(previous, tokens)
+        if state is previous:
+            return state
+        if state is not None:
+            _check_arenas(state)
+            return state
+    parser = Parser(list(tokens))
+    decls = []
+    while not parser._at_end():
+        decls.append(_parse_decl(parser, len(tokens)))
+    analyzer = Analyzer()
+    analyzer._prepare(Program(declarations=[d.node for d in decls]))
+    state = DocumentState(tokens, decls, analyzer,
+                          analyzer.errors[:], analyzer.warnings[:])
+    del analyzer.errors[:], analyzer.warnings[:]
+    for decl in decls:
+        _analyze(analyzer, decl)
+    _check_arenas(state)
+    return state
+
+
+def analyzed_program(state: DocumentState) -> AnalyzedProgram:
+    """The document's analysis, in the form the compiler's analyzer gives.
+
+    Escape facts are left out: they only feed code generation.
+    """
+    analyzer = state.analyzer
+    program = Program(declarations=[d.node for d in state.decls])
+    result = analyzer._result(program)
+    result.errors = (state.head_errors + [e for d in state.decls for e in d.errors]
+                     + state.arena_errors)
+    result.warnings = state.head_warnings + [w for d in state.decls for w in d.warnings]
+    return result
+
+
+def _parse_decl(parser: Parser, size: int) -> _Decl:
+    """Parse the next declaration. The parser works on a copy of the
+    document's `size` tokens, into which it inserts a token whenever it
+    splits a '>>'; the range is given in the document's tokens."""
+    first = parser.pos
+    start = first - (len(parser.tokens) - size)
+    node = parser._parse_top_level_item()
+    _, signature = decl_fingerprints(node, parser.tokens[first:parser.pos])
+    return _Decl(node, start, parser.pos - (len(parser.tokens) - size), signature)
+
+
+def _analyze(analyzer: Analyzer, decl: _Decl):
+    """Analyze one declaration, moving what it reports onto `decl`."""
+    typed = len(analyzer.node_types)
+    analyzer._analyze_decl(decl.node)
+    decl.errors, decl.warnings = analyzer.errors[:], analyzer.warnings[:]
+    del analyzer.errors[:], analyzer.warnings[:]
+    decl.typed = list(itertools.islice(analyzer.node_types, typed, None))
+    decl.arenas = list(analyzer._arena_blocks.values())
+    analyzer._arena_blocks.clear()
+
+
+def _check_arenas(state: DocumentState):
+    """Check every arena block against fresh escape summaries."""
+    blocks = [b for d in state.decls for b in d.arenas]
+    analyzer = state.analyzer
+    analyzer.arena_copies.clear()
+    if blocks:
+        analyzer._analyze_escapes(Program(declarations=[d.node for d in state.decls]))
+        analyzer.stack_objects.clear()
+        analyzer._check_arenas(blocks)
+    state.arena_errors = analyzer.errors[:]
+    del analyzer.errors[:], analyzer.warnings[:]
+
+
+# ---- Reuse ----
+
+def _update(previous: DocumentState, tokens: list[Token]) -> DocumentState | None:
+    """The new state after a body-only edit, or None to start over."""
+    old = previous.tokens
+    n_old, n_new = len(old) - 1, len(tokens) - 1  # without EOF
+    shift = tokens[-1].line - old[-1].line
+    limit = min(n_old, n_new)
+    head = 0
+    while head < limit and _same(old[head], tokens[head], 0):
+        head += 1
+    if head == n_old == n_new and shift == 0:
+        return previous
+    tail = 0
+    while tail < limit - head and _same(old[n_old - 1 - tail], tokens[n_new - 1 - tail], shift):
+        tail += 1
+
+    # A kept declaration must be followed by an unchanged token, so the
+    # parser's lookahead saw the same thing when it ended there
+    first = 0
+    while first < len(previous.decls) and previous.decls[first].end < head:
+        first += 1
+    last = len(previous.decls)
+    while last > first and previous.decls[last - 1].start >= n_old - tail:
+        last -= 1
+    replaced = previous.decls[first:last]
+    lo = replaced[0].start if replaced else _start(previous.decls, first, n_old)
+    hi = _start(previous.decls, last, n_old) + n_new - n_old
+
+    parser = Parser(list(tokens))
+    parser.pos = end = lo
+    fresh = []
+    try:
+        while end < hi:
+            fresh.append(_parse_decl(parser, len(tokens)))
+            end = fresh[-1].end
+    except Exception:  # the full parse reports it
+        return None
+    if end != hi or [d.signature for d in fresh] != [d.signature for d in replaced]:
+        return None
+    if not all(_body_only(d.node) for d in fresh):
+        return None
+
+    analyzer = previous.analyzer
+    swap = {}
+    for old_decl, new_decl in zip(replaced, fresh):
+        swap[id(old_decl.node)] = new_decl.node
+        if isinstance(old_decl.node, ClassDecl):
+            swap.update(zip(map(id, old_decl.node.members), new_decl.node.members))
+        for key in old_decl.typed:
+            analyzer.node_types.pop(key, None)
+    _swap_tables(analyzer, swap)
+    for decl in fresh:
+        _analyze(analyzer, decl)
+    kept_tail = previous.decls[last:]
+    for decl in kept_tail:
+        decl.start += n_new - n_old
+        decl.end += n_new - n_old
+        if shift:
+            _shift(decl, shift)
+    return DocumentState(tokens, previous.decls[:first] + fresh + kept_tail, analyzer,
+                         previous.head_errors, previous.head_warnings)
+
+
+def _same(a: Token, b: Token, shift: int) -> bool:
+    return (a.type == b.type and a.value == b.value and a.col == b.col
+            and a.line + shift == b.line)
+
+
+def _start(decls: list[_Decl], index: int, end: int) -> int:
+    return decls[index].start if index < len(decls) else end
+
+
+def _body_only(node) -> bool:
+    """Whether a same-signature edit of `node` stays inside it."""
+    return isinstance(node, ClassDecl | FunctionDecl)
+
+
+def _swap_tables(analyzer: Analyzer, swap: dict[int, object]):
+    """Point the analyzer's tables at re-parsed declarations and members."""
+    table = analyzer.function_table
+    for name, decl in table.items():
+        if id(decl) in swap:
+            table[name] = swap[id(decl)]
+    for info in analyzer.class_table.values():
+        for members in (info.fields, info.methods, info.properties):
+            for name, member in members.items():
+                if id(member) in swap:
+                    members[name] = swap[id(member)]
+        if id(info.constructor) in swap:
+            info.constructor = swap[id(info.constructor)]
+
+
+def _shift(decl: _Decl, delta: int):
+    """Move a kept declaration, and what it reported, down `delta` lines.
+
+    Type nodes (with their array sizes) are left alone: analysis can share one between declarations
+    (an inferred `var` type), and nothing reads their lines afterwards. So
+    are f-string expressions, whose lines count from the string's start.
+    """
+    seen = set()
+    stack = [decl.node]
+    while stack:
+        node = stack.pop()
+        if id(node) in seen or isinstance(node, TypeExpr | FStringExpr):
+            continue
+        seen.add(id(node))
+        for name in node.__dataclass_fields__:
+            value = getattr(node, name)
+            if name == "line" and value:
+                node.line = value + delta
+            elif isinstance(value, list):
+                stack += [v for v in value if hasattr(v, "__dataclass_fields__")]
+            elif hasattr(value, "__dataclass_fields__"):
+                stack.append(value)
+    decl.errors = [_shift_message(e, delta) for e in decl.errors]
+    decl.warnings = [_shift_message(w, delta) for w in decl.warnings]
+
+
+def _shift_message(message: str, delta: int) -> str:
+    def move(m):
+        line = int(m.group(1))
+        return f" at {line + delta if line else 0}:{m.group(2)}"
+    return _POSITION_RE.sub(move, message)
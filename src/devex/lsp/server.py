@@ -4,8 +4,14 @@
 Provides diagnostics, document symbols, hover, code completion, and
 signature help for .btrc files by reusing the compiler's lexer, parser,
 and analyzer.
+
+Edits are analyzed incrementally (incremental.py) and debounced: a change
+schedules validation shortly after the last keystroke, and any request
+for the document first runs a validation that is still pending, so hover,
+completion and references always read the tables for the current text.
 """
 
+import asyncio
 import logging
 import sys
 from pathlib import Path
@@ -38,10 +44,18 @@ _analysis_cache: dict[str, AnalysisResult] = {}
 # Cache: uri -> AnalysisResult (last successful analysis with AST + class_table)
 _good_analysis_cache: dict[str, AnalysisResult] = {}
 
+# Validations scheduled by did_change: uri -> timer
+_pending: dict[str, asyncio.TimerHandle] = {}
+
+# Quiet period after an edit before the document is analyzed again
+_DEBOUNCE_SECONDS = 0.2
+
 
 def _validate_document(uri: str, source: str):
     """Run the compiler pipeline and publish diagnostics."""
-    result = compute_diagnostics(uri, source)
+    _cancel_pending(uri)
+    good = _good_analysis_cache.get(uri)
+    result = compute_diagnostics(uri, source, good.state if good else None)
     _analysis_cache[uri] = result
     # Keep a copy of the last successful analysis for completion fallback
     if result.analyzed and result.ast:
@@ -51,6 +65,31 @@ def _validate_document(uri: str, source: str):
     )
 
 
+def _schedule_validation(uri: str):
+    """Validate *uri* once edits have paused for _DEBOUNCE_SECONDS."""
+    _cancel_pending(uri)
+    _pending[uri] = asyncio.get_running_loop().call_later(_DEBOUNCE_SECONDS, _validate_current, uri)
+
+
+def _validate_current(uri: str):
+    doc = server.workspace.get_text_document(uri)
+    _validate_document(uri, doc.source)
+
+
+def _cancel_pending(uri: str) -> bool:
+    handle = _pending.pop(uri, None)
+    if handle is None:
+        return False
+    handle.cancel()
+    return True
+
+
+def _flush_pending(uri: str):
+    """Run a scheduled validation of *uri* now, so a request sees the latest edit."""
+    if _cancel_pending(uri):
+        _validate_current(uri)
+
+
 def _get_best_result(uri: str) -> AnalysisResult | None:
     """Return the best available analysis for *uri*.
 
@@ -59,6 +98,7 @@ def _get_best_result(uri: str) -> AnalysisResult | None:
     go-to-definition, hover, and find-references keep working while the
     user is typing and the file has transient parse errors.
     """
+    _flush_pending(uri)
     result = _analysis_cache.get(uri)
     if result and result.ast and result.analyzed:
         return result
@@ -78,8 +118,7 @@ def did_open(params: lsp.DidOpenTextDocumentParams):
 
 @server.feature(lsp.TEXT_DOCUMENT_DID_CHANGE)
 def did_change(params: lsp.DidChangeTextDocumentParams):
-    doc = server.workspace.get_text_document(params.text_document.uri)
-    _validate_document(params.text_document.uri, doc.source)
+    _schedule_validation(params.text_document.uri)
 
 
 @server.feature(lsp.TEXT_DOCUMENT_DID_SAVE)
@@ -91,6 +130,7 @@ def did_save(params: lsp.DidSaveTextDocumentParams):
 @server.feature(lsp.TEXT_DOCUMENT_DID_CLOSE)
 def did_close(params: lsp.DidCloseTextDocumentParams):
     uri = params.text_document.uri
+    _cancel_pending(uri)
     _analysis_cache.pop(uri, None)
     _good_analysis_cache.pop(uri, None)
     server.text_document_publish_diagnostics(
@@ -128,6 +168,8 @@ def goto_definition(params: lsp.TextDocumentPositionParams):
 def completion(params: lsp.CompletionParams):
     uri = params.text_document.uri
 
+    _flush_pending(uri)
+
     # Get current document source for extracting text around cursor
     doc = server.workspace.get_text_document(uri)
     current_source = doc.source if doc else None
@@ -175,6 +217,8 @@ def completion(params: lsp.CompletionParams):
 def signature_help(params: lsp.SignatureHelpParams):
     uri = params.text_document.uri
 
+    _flush_pending(uri)
+
     # Get current document source for cursor context
     doc = server.workspace.get_text_document(uri)
     current_source = doc.source if doc else None
@@ -223,9 +223,9 @@ INTRINSIC_COLLECTION_MEMBERS: dict[str, list[tuple]] = {
 # ---------------------------------------------------------------------------
 
 # Auto-detect implementation details to hide from LSP.
-# Hidden fields: pointer-typed fields, "cap", "occupied" — internal to stdlib.
+# Hidden fields: pointer-typed fields, "cap", "used" — internal to stdlib.
 # Hidden methods: "resize" — internal resizing logic.
-_ALWAYS_HIDDEN_FIELDS = {"cap", "occupied"}
+_ALWAYS_HIDDEN_FIELDS = {"cap", "used"}
 _ALWAYS_HIDDEN_METHODS = {"resize"}
 
 INTRINSIC_FUNCTIONS = {
@@ -9,10 +9,19 @@
 
 #include "btrc_gpu.h"
 #include <webgpu.h>
+/* wgpu-native extensions (blocking device poll); Dawn falls back to
+ * pumping wgpuInstanceProcessEvents */
+#if defined(__has_include)
+#if __has_include(<wgpu.h>)
+#include <wgpu.h>
+#define BTRC_GPU_HAVE_DEVICE_POLL 1
+#endif
+#endif
 #include <GLFW/glfw3.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /* ---- macOS: Metal surface via Objective-C ---- */
 #ifdef __APPLE__
@@ -63,6 +72,18 @@ static WGPUSurface create_surface_linux(WGPUInstance instance, GLFWwindow* windo
  * Internal structs
  * ================================================================ */
 
+/* Passes timed between two reads of the timestamp queries */
+#define BTRC_GPU_TIMED_PASSES 256
+
+/* webgpu.h merged the compute and render pass timestamp structs */
+#ifdef WGPU_PASS_TIMESTAMP_WRITES_INIT
+typedef WGPUPassTimestampWrites        GPUComputeTimestamps_;
+typedef WGPUPassTimestampWrites        GPURenderTimestamps_;
+#else
+typedef WGPUComputePassTimestampWrites GPUComputeTimestamps_;
+typedef WGPURenderPassTimestampWrites  GPURenderTimestamps_;
+#endif
+
 typedef struct {
     GLFWwindow* glfw;
     int         width;
@@ -82,14 +103,44 @@ typedef struct {
     WGPUTexture            frame_texture;
     WGPUTextureView        frame_view;
     GPUWindow_*            window;
+    /* Readback staging pool (see staging_acquire) */
+    struct GPUStaging_*    staging;
+    int                    staging_len;
+    /* Compute pipeline cache (see btrc_gpu_get_compute_pipeline) */
+    struct GPUPipelineCacheEntry_* pipeline_cache;
+    int                    pipeline_cache_len;
+    int                    pipeline_cache_cap;
+    /* Open command batch (see btrc_gpu_batch_begin) */
+    WGPUCommandEncoder     batch;
+    int                    batch_depth;
+    /* Shared render layout + per-frame uniform arena (see arena_alloc) */
+    WGPUBindGroupLayout    uniform_layout;
+    WGPUBindGroupLayout    instance_layout;
+    WGPUPipelineLayout     render_layout;
+    WGPUBuffer             arena;
+    WGPUBindGroup          arena_group;
+    unsigned char*         arena_data;
+    size_t                 arena_used;
+    size_t                 arena_cap;
+    WGPUBuffer             no_instances;
+    WGPUBindGroup          no_instances_group;
+    /* Profiling (see btrc_gpu_profile_enable) */
+    const char*            label;
+    bool                   timing;    /* device has timestamp queries */
+    WGPUQuerySet           query_set;
+    WGPUBuffer             query_resolve;
+    int                    timed_len; /* passes awaiting their timestamps */
+    int                    timed[BTRC_GPU_TIMED_PASSES];  /* stats index */
 } GPU_;
 
 typedef struct {
     WGPUShaderModule module;
+    bool             shared_layout;  /* fits the shared render layout */
 } GPUShader_;
 
 typedef struct {
     WGPURenderPipeline pipeline;
+    bool               shared_layout;
 } GPURenderPipeline_;
 
 /* ================================================================
@@ -118,6 +169,31 @@ static void on_device(WGPURequestDeviceStatus status, WGPUDevice device,
     }
 }
 
+static bool profile_enabled_ = false;  /* see btrc_gpu_profile_enable */
+
+/* Device (AllowSpontaneous: callback fires during the request call).
+ * Profiled contexts ask for timestamp queries when the adapter has them. */
+static void request_device(GPU_* gpu) {
+    WGPUFeatureName timestamps = WGPUFeatureName_TimestampQuery;
+    WGPUDeviceDescriptor desc = {
+        .requiredFeatureCount = 1,
+        .requiredFeatures     = &timestamps,
+    };
+    gpu->timing = profile_enabled_
+        && wgpuAdapterHasFeature(gpu->adapter, timestamps);
+    wgpuAdapterRequestDevice(
+        gpu->adapter, gpu->timing ? &desc : NULL,
+        (WGPURequestDeviceCallbackInfo){
+            .mode = WGPUCallbackMode_AllowSpontaneous,
+            .callback = on_device,
+            .userdata1 = gpu,
+        });
+    if (!gpu->device) {
+        fprintf(stderr, "[btrc-gpu] device request failed\n");
+        exit(1);
+    }
+}
+
 /* ================================================================
  * Window
  * ================================================================ */
@@ -220,18 +296,7 @@ void* btrc_gpu_init(void* win_) {
         exit(1);
     }
 
-    /* Device (AllowSpontaneous: callback fires during the request call) */
-    wgpuAdapterRequestDevice(
-        gpu->adapter, NULL,
-        (WGPURequestDeviceCallbackInfo){
-            .mode = WGPUCallbackMode_AllowSpontaneous,
-            .callback = on_device,
-            .userdata1 = gpu,
-        });
-    if (!gpu->device) {
-        fprintf(stderr, "[btrc-gpu] device request failed\n");
-        exit(1);
-    }
+    request_device(gpu);
 
     /* Queue */
     gpu->queue = wgpuDeviceGetQueue(gpu->device);
@@ -256,9 +321,20 @@ void* btrc_gpu_init(void* win_) {
     return gpu;
 }
 
+static void pipeline_cache_release(GPU_* gpu);
+static void staging_pool_release(GPU_* gpu);
+static void render_state_release(GPU_* gpu);
+static void timing_release(GPU_* gpu);
+static bool timing_begin(GPU_* gpu, const char* fallback, uint32_t* first);
+
 void btrc_gpu_destroy(void* gpu_) {
     GPU_* gpu = (GPU_*)gpu_;
     if (!gpu) return;
+    timing_release(gpu);
+    if (gpu->batch)    wgpuCommandEncoderRelease(gpu->batch);
+    pipeline_cache_release(gpu);
+    staging_pool_release(gpu);
+    render_state_release(gpu);
     if (gpu->queue)    wgpuQueueRelease(gpu->queue);
     if (gpu->device)   wgpuDeviceRelease(gpu->device);
     if (gpu->adapter)  wgpuAdapterRelease(gpu->adapter);
@@ -271,6 +347,46 @@ void btrc_gpu_destroy(void* gpu_) {
  * Shader
  * ================================================================ */
 
+/* Is `var` (the text after `var`) the address space the shared render
+ * layout puts at @group(group) @binding(binding)? */
+static bool binding_fits(int group, int binding, const char* var) {
+    char space[32];
+    int n = 0;
+    for (; *var && *var != '>' && n < 31; var++) {
+        if (*var != ' ' && *var != '\t' && *var != '\n' && *var != '\r') {
+            space[n++] = *var;
+        }
+    }
+    space[n] = '\0';
+    if (group == 0 && binding == 0) return strcmp(space, "<uniform") == 0;
+    if (group == 1 && binding == 0) {
+        return strcmp(space, "<storage") == 0
+            || strcmp(space, "<storage,read") == 0;
+    }
+    return false;
+}
+
+/* Does every resource the shader declares match the shared render
+ * layout (see render_layouts_init)? Textures, samplers, writable
+ * storage and other slots need a layout derived from the shader. */
+static bool shader_fits_render_layout(const char* wgsl) {
+    for (const char* p = strstr(wgsl, "@group("); p;
+         p = strstr(p + 1, "@group(")) {
+        const char* start = p;
+        while (start > wgsl && start[-1] != ';' && start[-1] != '}') start--;
+        const char* end = strchr(p, ';');
+        const char* binding = strstr(start, "@binding(");
+        const char* var = strstr(start, "var");
+        if (!end || !binding || binding > end || !var || var > end) {
+            return false;
+        }
+        if (!binding_fits(atoi(p + 7), atoi(binding + 9), var + 3)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void* btrc_gpu_create_shader(void* gpu_, char* wgsl_source) {
     GPU_* gpu = (GPU_*)gpu_;
     WGPUShaderSourceWGSL wgsl = {
@@ -288,6 +404,7 @@ void* btrc_gpu_create_shader(void* gpu_, char* wgsl_source) {
 
     GPUShader_* s = (GPUShader_*)calloc(1, sizeof(GPUShader_));
     s->module = mod;
+    s->shared_layout = shader_fits_render_layout(wgsl_source);
     return s;
 }
 
@@ -298,6 +415,212 @@ void btrc_gpu_shader_destroy(void* s_) {
     free(s);
 }
 
+/* ================================================================
+ * Render layout and per-frame uniform arena
+ *
+ * Render pipelines whose shaders use only the standard bindings share
+ * one explicit layout: @group(0) @binding(0) is a uniform bound with a
+ * dynamic offset into the frame's uniform arena, @group(1) @binding(0)
+ * a read-only storage buffer of per-instance data. Bind groups are
+ * therefore valid for any of them. Other shaders keep the layout
+ * derived from the shader, and draws with them bind the uniform's own
+ * buffer through groups made from that layout (bind_own_group).
+ *
+ * Draws copy their uniform's CPU shadow into the arena at the next
+ * 256-byte aligned offset (minUniformBufferOffsetAlignment) and bind it
+ * there; btrc_gpu_end_frame uploads the whole arena with one queue
+ * write before the frame's submit. An arena that fills up mid-frame is
+ * written out and replaced by one twice the size, so later frames are
+ * back to a single write.
+ * ================================================================ */
+
+#define BTRC_GPU_UNIFORM_ALIGN  256
+#define BTRC_GPU_UNIFORM_WINDOW 16384   /* bytes visible per binding */
+#define BTRC_GPU_ARENA_INITIAL  65536
+
+static void render_layouts_init(GPU_* gpu) {
+    if (gpu->render_layout) return;
+    WGPUShaderStage stages = WGPUShaderStage_Vertex | WGPUShaderStage_Fragment;
+
+    WGPUBindGroupLayoutEntry uniform_entry = {
+        .binding    = 0,
+        .visibility = stages,
+        .buffer     = {
+            .type             = WGPUBufferBindingType_Uniform,
+            .hasDynamicOffset = true,
+            .minBindingSize   = 0,
+        },
+    };
+    gpu->uniform_layout = wgpuDeviceCreateBindGroupLayout(
+        gpu->device, &(WGPUBindGroupLayoutDescriptor){
+            .entryCount = 1,
+            .entries    = &uniform_entry,
+        });
+
+    WGPUBindGroupLayoutEntry instance_entry = {
+        .binding    = 0,
+        .visibility = stages,
+        .buffer     = { .type = WGPUBufferBindingType_ReadOnlyStorage },
+    };
+    gpu->instance_layout = wgpuDeviceCreateBindGroupLayout(
+        gpu->device, &(WGPUBindGroupLayoutDescriptor){
+            .entryCount = 1,
+            .entries    = &instance_entry,
+        });
+
+    WGPUBindGroupLayout layouts[2] = { gpu->uniform_layout,
+                                       gpu->instance_layout };
+    gpu->render_layout = wgpuDeviceCreatePipelineLayout(
+        gpu->device, &(WGPUPipelineLayoutDescriptor){
+            .bindGroupLayoutCount = 2,
+            .bindGroupLayouts     = layouts,
+        });
+    if (!gpu->uniform_layout || !gpu->instance_layout || !gpu->render_layout) {
+        fprintf(stderr, "[btrc-gpu] render layout creation failed\n");
+        exit(1);
+    }
+}
+
+/* Bind group over an instance storage buffer (group 1) */
+static WGPUBindGroup instance_group_create(GPU_* gpu, WGPUBuffer buffer) {
+    WGPUBindGroupEntry entry = {
+        .binding = 0,
+        .buffer  = buffer,
+        .offset  = 0,
+        .size    = wgpuBufferGetSize(buffer),
+    };
+    return wgpuDeviceCreateBindGroup(gpu->device, &(WGPUBindGroupDescriptor){
+        .layout     = gpu->instance_layout,
+        .entryCount = 1,
+        .entries    = &entry,
+    });
+}
+
+/* Write out the current arena and start a larger one */
+static void arena_grow(GPU_* gpu) {
+    if (gpu->arena && gpu->arena_used > 0) {
+        wgpuQueueWriteBuffer(gpu->queue, gpu->arena, 0, gpu->arena_data,
+                             gpu->arena_used);
+    }
+    /* Draws already recorded keep the old buffer and group alive */
+    if (gpu->arena_group) wgpuBindGroupRelease(gpu->arena_group);
+    if (gpu->arena) wgpuBufferRelease(gpu->arena);
+
+    size_t cap = gpu->arena_cap ? gpu->arena_cap * 2 : BTRC_GPU_ARENA_INITIAL;
+    unsigned char* data = (unsigned char*)realloc(gpu->arena_data, cap);
+    if (!data) {
+        fprintf(stderr, "[btrc-gpu] uniform arena allocation failed\n");
+        exit(1);
+    }
+    gpu->arena_data = data;
+    gpu->arena_cap  = cap;
+    gpu->arena_used = 0;
+
+    WGPUBufferDescriptor desc = {
+        .size  = (uint64_t)cap,
+        .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
+        .mappedAtCreation = false,
+    };
+    gpu->arena = wgpuDeviceCreateBuffer(gpu->device, &desc);
+    if (!gpu->arena) {
+        fprintf(stderr, "[btrc-gpu] uniform arena creation failed\n");
+        exit(1);
+    }
+    WGPUBindGroupEntry entry = {
+        .binding = 0,
+        .buffer  = gpu->arena,
+        .offset  = 0,
+        .size    = BTRC_GPU_UNIFORM_WINDOW,
+    };
+    gpu->arena_group = wgpuDeviceCreateBindGroup(
+        gpu->device, &(WGPUBindGroupDescriptor){
+            .layout     = gpu->uniform_layout,
+            .entryCount = 1,
+            .entries    = &entry,
+        });
+}
+
+/* Copy `size` bytes into the arena; returns their dynamic offset */
+static uint32_t arena_alloc(GPU_* gpu, const void* data, size_t size) {
+    render_layouts_init(gpu);
+    if (!gpu->arena
+        || gpu->arena_used + BTRC_GPU_UNIFORM_WINDOW > gpu->arena_cap) {
+        arena_grow(gpu);
+    }
+    size_t offset = gpu->arena_used;
+    if (size > 0) {
+        memcpy(gpu->arena_data + offset, data, size);
+        gpu->arena_used = offset + (size + BTRC_GPU_UNIFORM_ALIGN - 1)
+                                   / BTRC_GPU_UNIFORM_ALIGN
+                                   * BTRC_GPU_UNIFORM_ALIGN;
+    }
+    return (uint32_t)offset;
+}
+
+/* The one arena upload of the frame */
+static void arena_flush(GPU_* gpu) {
+    if (gpu->arena && gpu->arena_used > 0) {
+        wgpuQueueWriteBuffer(gpu->queue, gpu->arena, 0, gpu->arena_data,
+                             gpu->arena_used);
+    }
+    gpu->arena_used = 0;
+}
+
+/* Set both render groups; draws without instances get an empty buffer */
+static void bind_render_groups(GPU_* gpu, uint32_t uniform_offset,
+                               WGPUBindGroup instances) {
+    if (!instances) {
+        if (!gpu->no_instances_group) {
+            WGPUBufferDescriptor desc = {
+                .size  = 16,
+                .usage = WGPUBufferUsage_Storage,
+                .mappedAtCreation = false,
+            };
+            gpu->no_instances = wgpuDeviceCreateBuffer(gpu->device, &desc);
+            gpu->no_instances_group =
+                instance_group_create(gpu, gpu->no_instances);
+        }
+        instances = gpu->no_instances_group;
+    }
+    wgpuRenderPassEncoderSetBindGroup(gpu->pass, 0, gpu->arena_group,
+                                      1, &uniform_offset);
+    wgpuRenderPassEncoderSetBindGroup(gpu->pass, 1, instances, 0, NULL);
+}
+
+/* A one-buffer group for a pipeline on its own layout; the pass keeps it
+ * alive until the frame is submitted */
+static void bind_own_group(GPU_* gpu, GPURenderPipeline_* pipeline,
+                           uint32_t group, WGPUBuffer buffer, uint64_t size) {
+    WGPUBindGroupLayout layout =
+        wgpuRenderPipelineGetBindGroupLayout(pipeline->pipeline, group);
+    WGPUBindGroupEntry entry = {
+        .binding = 0,
+        .buffer  = buffer,
+        .offset  = 0,
+        .size    = size,
+    };
+    WGPUBindGroup bg = wgpuDeviceCreateBindGroup(
+        gpu->device, &(WGPUBindGroupDescriptor){
+            .layout     = layout,
+            .entryCount = 1,
+            .entries    = &entry,
+        });
+    wgpuRenderPassEncoderSetBindGroup(gpu->pass, group, bg, 0, NULL);
+    wgpuBindGroupRelease(bg);
+    wgpuBindGroupLayoutRelease(layout);
+}
+
+static void render_state_release(GPU_* gpu) {
+    if (gpu->no_instances_group) wgpuBindGroupRelease(gpu->no_instances_group);
+    if (gpu->no_instances)    wgpuBufferRelease(gpu->no_instances);
+    if (gpu->arena_group)     wgpuBindGroupRelease(gpu->arena_group);
+    if (gpu->arena)           wgpuBufferRelease(gpu->arena);
+    if (gpu->render_layout)   wgpuPipelineLayoutRelease(gpu->render_layout);
+    if (gpu->instance_layout) wgpuBindGroupLayoutRelease(gpu->instance_layout);
+    if (gpu->uniform_layout)  wgpuBindGroupLayoutRelease(gpu->uniform_layout);
+    free(gpu->arena_data);
+}
+
 /* ================================================================
  * Render Pipeline
  * ================================================================ */
@@ -308,8 +631,11 @@ void* btrc_gpu_create_render_pipeline(
 
     GPU_* gpu = (GPU_*)gpu_;
     GPUShader_* shader = (GPUShader_*)shader_;
+    if (shader->shared_layout) render_layouts_init(gpu);
 
     WGPURenderPipelineDescriptor desc = {
+        /* NULL: derive the layout from the shader */
+        .layout = shader->shared_layout ? gpu->render_layout : NULL,
         .vertex = {
             .module     = shader->module,
             .entryPoint = { .data = vertex_entry, .length = strlen(vertex_entry) },
@@ -342,6 +668,7 @@ void* btrc_gpu_create_render_pipeline(
 
     GPURenderPipeline_* p = (GPURenderPipeline_*)calloc(1, sizeof(GPURenderPipeline_));
     p->pipeline = rp;
+    p->shared_layout = shader->shared_layout;
     return p;
 }
 
@@ -389,6 +716,12 @@ bool btrc_gpu_begin_frame(void* gpu_, float r, float g, float b, float a) {
     gpu->frame_texture = st.texture;
     gpu->frame_view = wgpuTextureCreateView(st.texture, NULL);
 
+    /* Timestamps (profiled contexts), taken before the frame's encoder
+     * is open so reading earlier ones can't split it */
+    uint32_t first;
+    GPURenderTimestamps_ stamps = { 0 };
+    bool timed = timing_begin(gpu, "render", &first);
+
     /* Command encoder */
     gpu->encoder = wgpuDeviceCreateCommandEncoder(gpu->device, NULL);
 
@@ -404,6 +737,12 @@ bool btrc_gpu_begin_frame(void* gpu_, float r, float g, float b, float a) {
         .colorAttachmentCount = 1,
         .colorAttachments     = &color_att,
     };
+    if (timed) {
+        stamps.querySet                  = gpu->query_set;
+        stamps.beginningOfPassWriteIndex = first;
+        stamps.endOfPassWriteIndex       = first + 1;
+        rp_desc.timestampWrites          = &stamps;
+    }
     gpu->pass = wgpuCommandEncoderBeginRenderPass(gpu->encoder, &rp_desc);
     return true;
 }
@@ -412,6 +751,9 @@ void btrc_gpu_draw(void* gpu_, void* pipeline_, int vertex_count) {
     GPU_* gpu = (GPU_*)gpu_;
     GPURenderPipeline_* pipeline = (GPURenderPipeline_*)pipeline_;
     wgpuRenderPassEncoderSetPipeline(gpu->pass, pipeline->pipeline);
+    if (pipeline->shared_layout) {
+        bind_render_groups(gpu, arena_alloc(gpu, NULL, 0), NULL);
+    }
     wgpuRenderPassEncoderDraw(gpu->pass, (uint32_t)vertex_count, 1, 0, 0);
 }
 
@@ -422,6 +764,8 @@ void btrc_gpu_end_frame(void* gpu_) {
     wgpuRenderPassEncoderRelease(gpu->pass);
     gpu->pass = NULL;
 
+    /* Frame uniforms reach the queue ahead of the commands using them */
+    arena_flush(gpu);
     WGPUCommandBuffer cmd = wgpuCommandEncoderFinish(gpu->encoder, NULL);
     wgpuQueueSubmit(gpu->queue, 1, &cmd);
     wgpuSurfacePresent(gpu->surface);
@@ -467,22 +811,244 @@ void* btrc_gpu_init_compute(void) {
         exit(1);
     }
 
-    wgpuAdapterRequestDevice(
-        gpu->adapter, NULL,
-        (WGPURequestDeviceCallbackInfo){
-            .mode = WGPUCallbackMode_AllowSpontaneous,
-            .callback = on_device,
-            .userdata1 = gpu,
-        });
-    if (!gpu->device) {
-        fprintf(stderr, "[btrc-gpu] device request failed\n");
-        exit(1);
-    }
+    request_device(gpu);
 
     gpu->queue = wgpuDeviceGetQueue(gpu->device);
     return gpu;
 }
 
+/* Process-wide headless context shared by all @gpu dispatch sites and
+ * GpuArray buffers, so device-resident data is valid for every kernel. */
+static void* default_compute_ = NULL;
+
+static void release_default_compute(void) {
+    btrc_gpu_destroy(default_compute_);
+    default_compute_ = NULL;
+}
+
+void* btrc_gpu_default_compute(void) {
+    if (!default_compute_) {
+        default_compute_ = btrc_gpu_init_compute();
+        atexit(release_default_compute);
+    }
+    return default_compute_;
+}
+
+/* ================================================================
+ * Command batches
+ *
+ * While a batch is open, dispatches, copies and buffer writes are
+ * recorded into one command encoder and reach the queue in a single
+ * submit. Batches nest; only the outermost submit flushes. Readbacks
+ * flush the open batch so they observe everything recorded before them.
+ * ================================================================ */
+
+/* Encoder to record into: the open batch, or a fresh one-shot encoder. */
+static WGPUCommandEncoder record_begin(GPU_* gpu) {
+    if (gpu->batch_depth > 0) {
+        if (!gpu->batch) {
+            gpu->batch = wgpuDeviceCreateCommandEncoder(gpu->device, NULL);
+        }
+        return gpu->batch;
+    }
+    return wgpuDeviceCreateCommandEncoder(gpu->device, NULL);
+}
+
+static void encoder_submit(GPU_* gpu, WGPUCommandEncoder enc) {
+    WGPUCommandBuffer cmd = wgpuCommandEncoderFinish(enc, NULL);
+    wgpuQueueSubmit(gpu->queue, 1, &cmd);
+    wgpuCommandBufferRelease(cmd);
+    wgpuCommandEncoderRelease(enc);
+}
+
+/* Submits a one-shot encoder; batched work waits for the batch submit. */
+static void record_end(GPU_* gpu, WGPUCommandEncoder enc) {
+    if (enc != gpu->batch) encoder_submit(gpu, enc);
+}
+
+static void batch_flush(GPU_* gpu) {
+    if (gpu->batch) {
+        encoder_submit(gpu, gpu->batch);
+        gpu->batch = NULL;
+    }
+}
+
+void btrc_gpu_batch_begin(void* gpu_) {
+    ((GPU_*)gpu_)->batch_depth++;
+}
+
+void btrc_gpu_batch_submit(void* gpu_) {
+    GPU_* gpu = (GPU_*)gpu_;
+    if (gpu->batch_depth > 0 && --gpu->batch_depth == 0) batch_flush(gpu);
+}
+
+/* ================================================================
+ * Profiling
+ *
+ * A profiled context owns a query set with two timestamps per pass.
+ * Each compute or render pass takes the next pair as it is recorded,
+ * together with the label it is charged to. The pairs are resolved and
+ * read back in one go when the set is full, when stats are asked for,
+ * and when the context is destroyed, so timing costs no readback per
+ * dispatch. Reading them flushes an open batch but never an open frame:
+ * a pass recorded mid-frame while the set is full goes untimed. Totals
+ * are kept per label for the whole process and outlive their contexts.
+ *
+ * WebGPU timestamps are nanoseconds. wgpu-native reports raw device
+ * ticks, which are nanoseconds on most Vulkan and Metal devices; build
+ * with -DBTRC_GPU_TIMESTAMP_PERIOD=<ns per tick> where they are not.
+ * ================================================================ */
+
+#ifndef BTRC_GPU_TIMESTAMP_PERIOD
+#define BTRC_GPU_TIMESTAMP_PERIOD 1.0
+#endif
+
+static BtrcGpuStats* stats_     = NULL;
+static int           stats_len_ = 0;
+static int           stats_cap_ = 0;
+
+static void readback_finish(void* readback);
+
+static double now_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* Index of the totals for gpu's label (or `fallback`), added on first use */
+static int stats_index(GPU_* gpu, const char* fallback) {
+    const char* label = gpu->label ? gpu->label : fallback;
+    for (int i = 0; i < stats_len_; i++) {
+        if (strcmp(stats_[i].label, label) == 0) return i;
+    }
+    if (stats_len_ == stats_cap_) {
+        int cap = stats_cap_ ? stats_cap_ * 2 : 16;
+        BtrcGpuStats* grown = (BtrcGpuStats*)realloc(
+            stats_, (size_t)cap * sizeof(BtrcGpuStats));
+        if (!grown) {
+            fprintf(stderr, "[btrc-gpu] stats allocation failed\n");
+            exit(1);
+        }
+        stats_     = grown;
+        stats_cap_ = cap;
+    }
+    size_t len = strlen(label) + 1;
+    char* copy = (char*)malloc(len);
+    memcpy(copy, label, len);
+    stats_[stats_len_] = (BtrcGpuStats){ .label = copy };
+    return stats_len_++;
+}
+
+static void stats_transfer(GPU_* gpu, int uploaded, int read, double wait_ms) {
+    int stat = stats_index(gpu, "(other)");  /* may move stats_ */
+    BtrcGpuStats* s = &stats_[stat];
+    s->bytes_uploaded += uploaded;
+    s->bytes_read     += read;
+    s->wait_ms        += wait_ms;
+}
+
+/* Read the timestamps of the passes recorded so far into their totals */
+static void timing_drain(GPU_* gpu) {
+    if (gpu->timed_len == 0 || gpu->encoder) return;
+    uint32_t queries = (uint32_t)gpu->timed_len * 2;
+    uint64_t ticks[BTRC_GPU_TIMED_PASSES * 2];
+    WGPUCommandEncoder enc = record_begin(gpu);
+    wgpuCommandEncoderResolveQuerySet(enc, gpu->query_set, 0, queries,
+                                      gpu->query_resolve, 0);
+    record_end(gpu, enc);
+    readback_finish(btrc_gpu_read_buffer_async(
+        gpu, gpu->query_resolve, ticks, (int)(queries * sizeof(uint64_t))));
+    for (int i = 0; i < gpu->timed_len; i++) {
+        uint64_t begin = ticks[2 * i], end = ticks[2 * i + 1];
+        if (end > begin) {
+            stats_[gpu->timed[i]].gpu_ms +=
+                (double)(end - begin) * BTRC_GPU_TIMESTAMP_PERIOD / 1e6;
+        }
+    }
+    gpu->timed_len = 0;
+}
+
+/* Charge a pass to the current label (or `fallback`). True, with the
+ * index of the pass's first query, when the pass is to be timed. */
+static bool timing_begin(GPU_* gpu, const char* fallback, uint32_t* first) {
+    if (!profile_enabled_) return false;
+    int stat = stats_index(gpu, fallback);
+    stats_[stat].passes++;
+    if (gpu->timing && gpu->timed_len == BTRC_GPU_TIMED_PASSES) {
+        timing_drain(gpu);
+    }
+    if (!gpu->timing || gpu->timed_len == BTRC_GPU_TIMED_PASSES) {
+        stats_[stat].untimed++;
+        return false;
+    }
+    if (!gpu->query_set) {
+        uint32_t queries = BTRC_GPU_TIMED_PASSES * 2;
+        gpu->query_set = wgpuDeviceCreateQuerySet(
+            gpu->device, &(WGPUQuerySetDescriptor){
+                .type  = WGPUQueryType_Timestamp,
+                .count = queries,
+            });
+        gpu->query_resolve = wgpuDeviceCreateBuffer(
+            gpu->device, &(WGPUBufferDescriptor){
+                .size  = queries * sizeof(uint64_t),
+                .usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+            });
+        if (!gpu->query_set || !gpu->query_resolve) {
+            fprintf(stderr, "[btrc-gpu] timestamp query creation failed\n");
+            exit(1);
+        }
+    }
+    gpu->timed[gpu->timed_len] = stat;
+    *first = (uint32_t)gpu->timed_len++ * 2;
+    return true;
+}
+
+static void timing_release(GPU_* gpu) {
+    timing_drain(gpu);
+    if (gpu->query_resolve) wgpuBufferRelease(gpu->query_resolve);
+    if (gpu->query_set)     wgpuQuerySetRelease(gpu->query_set);
+    gpu->query_resolve = NULL;
+    gpu->query_set     = NULL;
+}
+
+static void stats_report(void) {
+    if (stats_len_ == 0) return;
+    fprintf(stderr, "\n--- btrc gpu profile ---\n%8s %12s %12s %12s %12s  %s\n",
+            "passes", "gpu ms", "upload KiB", "read KiB", "wait ms", "label");
+    for (int i = 0; i < stats_len_; i++) {
+        BtrcGpuStats* s = &stats_[i];
+        fprintf(stderr, "%8d ", s->passes);
+        if (s->passes > 0 && s->untimed == s->passes) {
+            fprintf(stderr, "%12s ", "n/a");
+        } else {
+            fprintf(stderr, "%12.3f ", s->gpu_ms);
+        }
+        fprintf(stderr, "%12.1f %12.1f %12.3f  %s",
+                (double)s->bytes_uploaded / 1024.0,
+                (double)s->bytes_read / 1024.0, s->wait_ms, s->label);
+        if (s->untimed > 0 && s->untimed < s->passes) {
+            fprintf(stderr, " (%d untimed)", s->untimed);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+void btrc_gpu_profile_enable(void) {
+    if (profile_enabled_) return;
+    profile_enabled_ = true;
+    atexit(stats_report);
+}
+
+void btrc_gpu_label(void* gpu_, const char* label) {
+    ((GPU_*)gpu_)->label = label;
+}
+
+int btrc_gpu_stats(void* gpu_, BtrcGpuStats* out, int max) {
+    if (gpu_) timing_drain((GPU_*)gpu_);
+    for (int i = 0; i < stats_len_ && i < max; i++) out[i] = stats_[i];
+    return stats_len_;
+}
+
 /* ================================================================
  * Buffers
  * ================================================================ */
@@ -510,72 +1076,248 @@ void* btrc_gpu_create_buffer(void* gpu_, int size, int usage) {
 
 void btrc_gpu_write_buffer(void* gpu_, void* buf, void* data, int size) {
     GPU_* gpu = (GPU_*)gpu_;
-    wgpuQueueWriteBuffer(gpu->queue, (WGPUBuffer)buf, 0, data, (size_t)size);
+    if (size <= 0) return;  /* empty Vector<T>: nothing to upload */
+    if (profile_enabled_) stats_transfer(gpu, size, 0, 0.0);
+    if (!gpu->batch) {
+        wgpuQueueWriteBuffer(gpu->queue, (WGPUBuffer)buf, 0, data,
+                             (size_t)size);
+        return;
+    }
+
+    /* Queue writes land before the batch's submit, ahead of commands
+     * already recorded; stage the data and record a copy to keep order. */
+    WGPUBufferDescriptor desc = {
+        .size             = (uint64_t)size,
+        .usage            = WGPUBufferUsage_CopySrc,
+        .mappedAtCreation = true,
+    };
+    WGPUBuffer upload = wgpuDeviceCreateBuffer(gpu->device, &desc);
+    if (!upload) {
+        fprintf(stderr, "[btrc-gpu] upload buffer creation failed\n");
+        exit(1);
+    }
+    memcpy(wgpuBufferGetMappedRange(upload, 0, (size_t)size), data,
+           (size_t)size);
+    wgpuBufferUnmap(upload);
+    wgpuCommandEncoderCopyBufferToBuffer(gpu->batch, upload, 0,
+                                          (WGPUBuffer)buf, 0, (uint64_t)size);
+    wgpuBufferRelease(upload);
+}
+
+void btrc_gpu_copy_buffer(void* gpu_, void* src, void* dst, int size) {
+    GPU_* gpu = (GPU_*)gpu_;
+    WGPUCommandEncoder enc = record_begin(gpu);
+    wgpuCommandEncoderCopyBufferToBuffer(enc, (WGPUBuffer)src, 0,
+                                          (WGPUBuffer)dst, 0, (uint64_t)size);
+    record_end(gpu, enc);
+}
+
+/* ---- Readback staging pool ----
+ *
+ * MapRead staging buffers are kept in a small per-context ring and reused
+ * by power-of-two size class, so steady-state readbacks allocate nothing.
+ * A readback that finds every slot busy gets a one-off buffer instead.
+ */
+
+#define BTRC_GPU_STAGING_SLOTS    16
+#define BTRC_GPU_STAGING_MIN_SIZE 256
+
+typedef struct GPUStaging_ {
+    WGPUBuffer buffer;
+    uint64_t   size;    /* size class (power of two) */
+    bool       in_use;
+} GPUStaging_;
+
+static uint64_t staging_size_class(uint64_t size) {
+    uint64_t cls = BTRC_GPU_STAGING_MIN_SIZE;
+    while (cls < size) cls <<= 1;
+    return cls;
+}
+
+static WGPUBuffer staging_create(GPU_* gpu, uint64_t size) {
+    WGPUBufferDescriptor desc = {
+        .size  = size,
+        .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_MapRead,
+    };
+    WGPUBuffer buf = wgpuDeviceCreateBuffer(gpu->device, &desc);
+    if (!buf) {
+        fprintf(stderr, "[btrc-gpu] staging buffer creation failed\n");
+        exit(1);
+    }
+    return buf;
+}
+
+/* Returns a staging slot, or NULL with *out set to a one-off buffer. */
+static GPUStaging_* staging_acquire(GPU_* gpu, uint64_t size, WGPUBuffer* out) {
+    uint64_t cls = staging_size_class(size);
+    if (!gpu->staging) {
+        gpu->staging = (GPUStaging_*)calloc(BTRC_GPU_STAGING_SLOTS,
+                                            sizeof(GPUStaging_));
+    }
+
+    /* 1. Reuse an idle buffer of the same size class */
+    GPUStaging_* victim = NULL;
+    for (int i = 0; i < gpu->staging_len; i++) {
+        GPUStaging_* s = &gpu->staging[i];
+        if (s->in_use) continue;
+        if (s->size == cls) {
+            s->in_use = true;
+            *out = s->buffer;
+            return s;
+        }
+        if (!victim) victim = s;
+    }
+
+    /* 2. Fill an empty slot, or 3. replace an idle one of another class */
+    GPUStaging_* slot = NULL;
+    if (gpu->staging_len < BTRC_GPU_STAGING_SLOTS) {
+        slot = &gpu->staging[gpu->staging_len++];
+    } else if (victim) {
+        wgpuBufferRelease(victim->buffer);
+        slot = victim;
+    }
+    if (!slot) {
+        *out = staging_create(gpu, cls);
+        return NULL;
+    }
+    slot->buffer = staging_create(gpu, cls);
+    slot->size   = cls;
+    slot->in_use = true;
+    *out = slot->buffer;
+    return slot;
+}
+
+static void staging_pool_release(GPU_* gpu) {
+    for (int i = 0; i < gpu->staging_len; i++) {
+        if (gpu->staging[i].buffer) wgpuBufferRelease(gpu->staging[i].buffer);
+    }
+    free(gpu->staging);
+    gpu->staging     = NULL;
+    gpu->staging_len = 0;
 }
 
+/* ---- Readback ---- */
+
 typedef struct {
-    bool done;
+    GPU_*              gpu;
+    WGPUBuffer         staging;
+    GPUStaging_*       slot;    /* NULL for a one-off staging buffer */
+    void*              dst;
+    int                size;
+    volatile bool      done;
     WGPUMapAsyncStatus status;
-} MapCallbackData_;
+} GPUReadback_;
 
 static void on_buffer_map(WGPUMapAsyncStatus status,
                           WGPUStringView message,
                           void* ud1, void* ud2) {
     (void)message;
     (void)ud2;
-    MapCallbackData_* data = (MapCallbackData_*)ud1;
-    data->status = status;
-    data->done = true;
+    GPUReadback_* rb = (GPUReadback_*)ud1;
+    rb->status = status;
+    rb->done = true;
 }
 
-void btrc_gpu_read_buffer(void* gpu_, void* buf_, void* dst, int size) {
+void* btrc_gpu_read_buffer_async(void* gpu_, void* buf_, void* dst, int size) {
     GPU_* gpu = (GPU_*)gpu_;
     WGPUBuffer src_buf = (WGPUBuffer)buf_;
 
-    /* Create a staging buffer for readback */
-    WGPUBufferDescriptor staging_desc = {
-        .size  = (uint64_t)size,
-        .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_MapRead,
-    };
-    WGPUBuffer staging = wgpuDeviceCreateBuffer(gpu->device, &staging_desc);
+    GPUReadback_* rb = (GPUReadback_*)calloc(1, sizeof(GPUReadback_));
+    rb->gpu  = gpu;
+    rb->dst  = dst;
+    rb->size = size;
+    rb->slot = staging_acquire(gpu, (uint64_t)size, &rb->staging);
 
-    /* Copy source → staging */
-    WGPUCommandEncoder enc = wgpuDeviceCreateCommandEncoder(gpu->device, NULL);
-    wgpuCommandEncoderCopyBufferToBuffer(enc, src_buf, 0, staging, 0,
+    /* Copy source → staging; an open batch is flushed along with it */
+    WGPUCommandEncoder enc = record_begin(gpu);
+    wgpuCommandEncoderCopyBufferToBuffer(enc, src_buf, 0, rb->staging, 0,
                                           (uint64_t)size);
-    WGPUCommandBuffer cmd = wgpuCommandEncoderFinish(enc, NULL);
-    wgpuQueueSubmit(gpu->queue, 1, &cmd);
-    wgpuCommandBufferRelease(cmd);
-    wgpuCommandEncoderRelease(enc);
+    if (enc == gpu->batch) {
+        batch_flush(gpu);
+    } else {
+        encoder_submit(gpu, enc);
+    }
 
-    /* Map staging buffer and poll until done */
-    MapCallbackData_ cb_data = { .done = false };
-    wgpuBufferMapAsync(staging, WGPUMapMode_Read, 0, (size_t)size,
+    /* Map staging buffer; completion is observed by ready/wait */
+    wgpuBufferMapAsync(rb->staging, WGPUMapMode_Read, 0, (size_t)size,
                        (WGPUBufferMapCallbackInfo){
                            .mode = WGPUCallbackMode_AllowSpontaneous,
                            .callback = on_buffer_map,
-                           .userdata1 = &cb_data,
+                           .userdata1 = rb,
                        });
+    return rb;
+}
 
-    while (!cb_data.done) {
-        wgpuInstanceProcessEvents(gpu->instance);
+bool btrc_gpu_readback_ready(void* rb_) {
+    GPUReadback_* rb = (GPUReadback_*)rb_;
+    if (!rb->done) {
+#ifdef BTRC_GPU_HAVE_DEVICE_POLL
+        wgpuDevicePoll(rb->gpu->device, false, NULL);
+#else
+        wgpuInstanceProcessEvents(rb->gpu->instance);
+#endif
+    }
+    return rb->done;
+}
+
+/* Wait for a readback and free it, uncounted (timing_drain's own) */
+static void readback_finish(void* rb_) {
+    GPUReadback_* rb = (GPUReadback_*)rb_;
+
+    /* Block in the driver rather than spinning the CPU */
+    while (!rb->done) {
+#ifdef BTRC_GPU_HAVE_DEVICE_POLL
+        wgpuDevicePoll(rb->gpu->device, true, NULL);
+#else
+        wgpuInstanceProcessEvents(rb->gpu->instance);
+#endif
     }
 
-    if (cb_data.status == WGPUMapAsyncStatus_Success) {
-        const void* mapped = wgpuBufferGetConstMappedRange(staging, 0, (size_t)size);
+    if (rb->status == WGPUMapAsyncStatus_Success) {
+        const void* mapped = wgpuBufferGetConstMappedRange(
+            rb->staging, 0, (size_t)rb->size);
         if (mapped) {
-            memcpy(dst, mapped, (size_t)size);
+            memcpy(rb->dst, mapped, (size_t)rb->size);
         }
-        wgpuBufferUnmap(staging);
+        wgpuBufferUnmap(rb->staging);
     } else {
         fprintf(stderr, "[btrc-gpu] buffer map failed: status=%d\n",
-                cb_data.status);
+                rb->status);
+    }
+
+    if (rb->slot) {
+        rb->slot->in_use = false;
+    } else {
+        wgpuBufferRelease(rb->staging);
+    }
+    free(rb);
+}
+
+void btrc_gpu_readback_wait(void* rb_) {
+    GPUReadback_* rb = (GPUReadback_*)rb_;
+    if (!rb) return;
+    if (!profile_enabled_) {
+        readback_finish(rb);
+        return;
     }
-    wgpuBufferRelease(staging);
+    GPU_* gpu = rb->gpu;
+    int size = rb->size;
+    double start = now_ms();
+    readback_finish(rb);
+    stats_transfer(gpu, 0, size, now_ms() - start);
+}
+
+void btrc_gpu_read_buffer(void* gpu, void* buf, void* dst, int size) {
+    if (size <= 0) return;
+    btrc_gpu_readback_wait(btrc_gpu_read_buffer_async(gpu, buf, dst, size));
 }
 
+static void bind_group_cache_evict(void* pipeline, void* buffer);
+
 void btrc_gpu_buffer_destroy(void* buf) {
-    if (buf) wgpuBufferRelease((WGPUBuffer)buf);
+    if (!buf) return;
+    bind_group_cache_evict(NULL, buf);
+    wgpuBufferRelease((WGPUBuffer)buf);
 }
 
 /* ================================================================
@@ -612,22 +1354,169 @@ void* btrc_gpu_create_compute_pipeline(void* gpu_, void* shader_,
 void btrc_gpu_compute_pipeline_destroy(void* p_) {
     GPUComputePipeline_* p = (GPUComputePipeline_*)p_;
     if (!p) return;
+    bind_group_cache_evict(p, NULL);
     if (p->pipeline) wgpuComputePipelineRelease(p->pipeline);
     free(p);
 }
 
+/* ================================================================
+ * Compute pipeline cache
+ *
+ * @gpu dispatch sites pass their static `<kernel>_wgsl` constant as
+ * the key, so each kernel's shader module and pipeline are compiled
+ * once per GPU context. Entries are owned by the context and released
+ * in btrc_gpu_destroy.
+ * ================================================================ */
+
+typedef struct GPUPipelineCacheEntry_ {
+    const char* wgsl_source;  /* key: identity of the WGSL constant */
+    char*       entry;
+    void*       shader;
+    void*       pipeline;
+} GPUPipelineCacheEntry_;
+
+void* btrc_gpu_get_compute_pipeline(void* gpu_, char* wgsl_source,
+                                     char* entry) {
+    GPU_* gpu = (GPU_*)gpu_;
+    for (int i = 0; i < gpu->pipeline_cache_len; i++) {
+        GPUPipelineCacheEntry_* e = &gpu->pipeline_cache[i];
+        if (e->wgsl_source == wgsl_source && strcmp(e->entry, entry) == 0) {
+            return e->pipeline;
+        }
+    }
+
+    if (gpu->pipeline_cache_len == gpu->pipeline_cache_cap) {
+        int cap = gpu->pipeline_cache_cap ? gpu->pipeline_cache_cap * 2 : 8;
+        GPUPipelineCacheEntry_* grown = (GPUPipelineCacheEntry_*)realloc(
+            gpu->pipeline_cache, (size_t)cap * sizeof(GPUPipelineCacheEntry_));
+        if (!grown) {
+            fprintf(stderr, "[btrc-gpu] pipeline cache allocation failed\n");
+            exit(1);
+        }
+        gpu->pipeline_cache = grown;
+        gpu->pipeline_cache_cap = cap;
+    }
+
+    void* shader = btrc_gpu_create_shader(gpu, wgsl_source);
+    size_t entry_len = strlen(entry) + 1;
+    GPUPipelineCacheEntry_* e = &gpu->pipeline_cache[gpu->pipeline_cache_len++];
+    e->wgsl_source = wgsl_source;
+    e->entry       = (char*)malloc(entry_len);
+    memcpy(e->entry, entry, entry_len);
+    e->shader      = shader;
+    e->pipeline    = btrc_gpu_create_compute_pipeline(gpu, shader, entry);
+    return e->pipeline;
+}
+
+static void pipeline_cache_release(GPU_* gpu) {
+    for (int i = 0; i < gpu->pipeline_cache_len; i++) {
+        GPUPipelineCacheEntry_* e = &gpu->pipeline_cache[i];
+        btrc_gpu_compute_pipeline_destroy(e->pipeline);
+        btrc_gpu_shader_destroy(e->shader);
+        free(e->entry);
+    }
+    free(gpu->pipeline_cache);
+    gpu->pipeline_cache     = NULL;
+    gpu->pipeline_cache_len = 0;
+    gpu->pipeline_cache_cap = 0;
+}
+
 /* ================================================================
  * Bind Group
+ *
+ * Bind groups are memoized on (pipeline, buffer set): a dispatch that
+ * binds the same buffers again (e.g. GpuArray<T> arguments in a loop)
+ * reuses the group instead of creating one per call. Groups are
+ * refcounted; the cache holds one reference and each caller another,
+ * dropped by btrc_gpu_bind_group_destroy. Destroying a buffer or a
+ * compute pipeline evicts the entries that use it, so a recycled handle
+ * can never match a stale entry.
  * ================================================================ */
 
+#define BTRC_GPU_BIND_GROUP_CACHE 64
+#define BTRC_GPU_MAX_BINDINGS     16
+
 typedef struct {
     WGPUBindGroup group;
+    int           refs;
 } GPUBindGroup_;
 
+typedef struct {
+    void*          pipeline;
+    int            count;
+    void*          buffers[BTRC_GPU_MAX_BINDINGS];
+    GPUBindGroup_* group;
+} GPUBindGroupCacheEntry_;
+
+/* Shared by all contexts: buffers are destroyed without their context */
+static GPUBindGroupCacheEntry_ bind_group_cache_[BTRC_GPU_BIND_GROUP_CACHE];
+static int bind_group_cache_next_ = 0;
+
+void btrc_gpu_bind_group_destroy(void* bg_) {
+    GPUBindGroup_* bg = (GPUBindGroup_*)bg_;
+    if (!bg || --bg->refs > 0) return;
+    if (bg->group) wgpuBindGroupRelease(bg->group);
+    free(bg);
+}
+
+static void bind_group_cache_clear(GPUBindGroupCacheEntry_* e) {
+    btrc_gpu_bind_group_destroy(e->group);
+    memset(e, 0, sizeof(*e));
+}
+
+/* Drop entries using `pipeline` or `buffer` (either may be NULL) */
+static void bind_group_cache_evict(void* pipeline, void* buffer) {
+    for (int i = 0; i < BTRC_GPU_BIND_GROUP_CACHE; i++) {
+        GPUBindGroupCacheEntry_* e = &bind_group_cache_[i];
+        if (!e->group) continue;
+        bool hit = pipeline && e->pipeline == pipeline;
+        for (int b = 0; !hit && buffer && b < e->count; b++) {
+            hit = e->buffers[b] == buffer;
+        }
+        if (hit) bind_group_cache_clear(e);
+    }
+}
+
+static GPUBindGroup_* bind_group_cache_find(void* pipeline, void** buffers,
+                                            int count) {
+    for (int i = 0; i < BTRC_GPU_BIND_GROUP_CACHE; i++) {
+        GPUBindGroupCacheEntry_* e = &bind_group_cache_[i];
+        if (e->group && e->pipeline == pipeline && e->count == count
+            && memcmp(e->buffers, buffers,
+                      (size_t)count * sizeof(void*)) == 0) {
+            return e->group;
+        }
+    }
+    return NULL;
+}
+
+/* Round-robin replacement once the cache is full */
+static void bind_group_cache_insert(void* pipeline, void** buffers,
+                                    int count, GPUBindGroup_* group) {
+    GPUBindGroupCacheEntry_* e = &bind_group_cache_[bind_group_cache_next_];
+    bind_group_cache_next_ =
+        (bind_group_cache_next_ + 1) % BTRC_GPU_BIND_GROUP_CACHE;
+    if (e->group) bind_group_cache_clear(e);
+    e->pipeline = pipeline;
+    e->count    = count;
+    memcpy(e->buffers, buffers, (size_t)count * sizeof(void*));
+    e->group    = group;
+    group->refs++;
+}
+
 void* btrc_gpu_create_bind_group(void* gpu_, void* pipeline_,
                                   void** buffers, int count) {
     GPU_* gpu = (GPU_*)gpu_;
     GPUComputePipeline_* pipeline = (GPUComputePipeline_*)pipeline_;
+    bool cacheable = count > 0 && count <= BTRC_GPU_MAX_BINDINGS;
+
+    if (cacheable) {
+        GPUBindGroup_* hit = bind_group_cache_find(pipeline, buffers, count);
+        if (hit) {
+            hit->refs++;
+            return hit;
+        }
+    }
 
     /* Get bind group layout from pipeline */
     WGPUBindGroupLayout layout =
@@ -662,71 +1551,90 @@ void* btrc_gpu_create_bind_group(void* gpu_, void* pipeline_,
 
     GPUBindGroup_* g = (GPUBindGroup_*)calloc(1, sizeof(GPUBindGroup_));
     g->group = bg;
+    g->refs  = 1;
+    if (cacheable) bind_group_cache_insert(pipeline, buffers, count, g);
     return g;
 }
 
-void btrc_gpu_bind_group_destroy(void* bg_) {
-    GPUBindGroup_* bg = (GPUBindGroup_*)bg_;
-    if (!bg) return;
-    if (bg->group) wgpuBindGroupRelease(bg->group);
-    free(bg);
-}
-
 /* ================================================================
  * Dispatch
  * ================================================================ */
 
-void btrc_gpu_dispatch(void* gpu_, void* pipeline_, void* bg_,
-                        int workgroups_x) {
+/* WebGPU default maxComputeWorkgroupsPerDimension */
+#define BTRC_GPU_MAX_WORKGROUPS 65535
+
+void btrc_gpu_dispatch3(void* gpu_, void* pipeline_, void* bg_,
+                         int workgroups_x, int workgroups_y,
+                         int workgroups_z) {
     GPU_* gpu = (GPU_*)gpu_;
     GPUComputePipeline_* pipeline = (GPUComputePipeline_*)pipeline_;
     GPUBindGroup_* bg = (GPUBindGroup_*)bg_;
+    if (workgroups_x <= 0 || workgroups_y <= 0 || workgroups_z <= 0) return;
+
+    /* Timestamps first: reading earlier ones flushes the open batch */
+    uint32_t first;
+    GPUComputeTimestamps_ stamps = { 0 };
+    WGPUComputePassDescriptor desc = { 0 };
+    if (timing_begin(gpu, "(other)", &first)) {
+        stamps.querySet                  = gpu->query_set;
+        stamps.beginningOfPassWriteIndex = first;
+        stamps.endOfPassWriteIndex       = first + 1;
+        desc.timestampWrites             = &stamps;
+    }
 
-    WGPUCommandEncoder enc = wgpuDeviceCreateCommandEncoder(gpu->device, NULL);
-    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(enc, NULL);
+    WGPUCommandEncoder enc = record_begin(gpu);
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(enc, &desc);
 
     wgpuComputePassEncoderSetPipeline(pass, pipeline->pipeline);
     wgpuComputePassEncoderSetBindGroup(pass, 0, bg->group, 0, NULL);
     wgpuComputePassEncoderDispatchWorkgroups(
-        pass, (uint32_t)workgroups_x, 1, 1);
+        pass, (uint32_t)workgroups_x, (uint32_t)workgroups_y,
+        (uint32_t)workgroups_z);
 
     wgpuComputePassEncoderEnd(pass);
     wgpuComputePassEncoderRelease(pass);
+    record_end(gpu, enc);
+}
 
-    WGPUCommandBuffer cmd = wgpuCommandEncoderFinish(enc, NULL);
-    wgpuQueueSubmit(gpu->queue, 1, &cmd);
-    wgpuCommandBufferRelease(cmd);
-    wgpuCommandEncoderRelease(enc);
+/* 1-D launches beyond the per-dimension limit are folded into a 2-D grid;
+ * @gpu kernels rebuild the linear index from gid.y and num_workgroups. */
+void btrc_gpu_dispatch(void* gpu_, void* pipeline_, void* bg_,
+                        int workgroups_x) {
+    int y = 1;
+    if (workgroups_x > BTRC_GPU_MAX_WORKGROUPS) {
+        y = (workgroups_x + BTRC_GPU_MAX_WORKGROUPS - 1)
+            / BTRC_GPU_MAX_WORKGROUPS;
+        workgroups_x = (workgroups_x + y - 1) / y;
+    }
+    btrc_gpu_dispatch3(gpu_, pipeline_, bg_, workgroups_x, y, 1);
 }
 
 /* ================================================================
  * Uniform buffer helpers (for rendering with bound data)
+ *
+ * Draws take a uniform's CPU shadow through the frame arena; the
+ * standalone GPU buffer exists for btrc_gpu_upload_uniform and for
+ * pipelines on their own layout.
  * ================================================================ */
 
 typedef struct {
-    WGPUBuffer buffer;
+    WGPUBuffer buffer;       /* created on first btrc_gpu_upload_uniform */
     float*     data;         /* CPU shadow copy */
     int        count;
     int        aligned_size; /* byte size rounded up to 16 */
 } GPUUniform_;
 
 void* btrc_gpu_create_uniform(void* gpu_, int float_count) {
-    GPU_* gpu = (GPU_*)gpu_;
+    (void)gpu_;
     GPUUniform_* u = (GPUUniform_*)calloc(1, sizeof(GPUUniform_));
     u->count = float_count;
     u->aligned_size = ((float_count * 4 + 15) / 16) * 16;
-    u->data = (float*)calloc((size_t)u->aligned_size, 1);
-
-    WGPUBufferDescriptor desc = {
-        .size            = (uint64_t)u->aligned_size,
-        .usage           = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
-        .mappedAtCreation = false,
-    };
-    u->buffer = wgpuDeviceCreateBuffer(gpu->device, &desc);
-    if (!u->buffer) {
-        fprintf(stderr, "[btrc-gpu] uniform buffer creation failed\n");
+    if (u->aligned_size > BTRC_GPU_UNIFORM_WINDOW) {
+        fprintf(stderr, "[btrc-gpu] uniform of %d floats exceeds %d bytes\n",
+                float_count, BTRC_GPU_UNIFORM_WINDOW);
         exit(1);
     }
+    u->data = (float*)calloc((size_t)u->aligned_size, 1);
     return u;
 }
 
@@ -740,6 +1648,18 @@ void btrc_gpu_set_uniform(void* uniform_, int index, float value) {
 void btrc_gpu_upload_uniform(void* gpu_, void* uniform_) {
     GPU_* gpu = (GPU_*)gpu_;
     GPUUniform_* u = (GPUUniform_*)uniform_;
+    if (!u->buffer) {
+        WGPUBufferDescriptor desc = {
+            .size            = (uint64_t)u->aligned_size,
+            .usage           = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
+            .mappedAtCreation = false,
+        };
+        u->buffer = wgpuDeviceCreateBuffer(gpu->device, &desc);
+        if (!u->buffer) {
+            fprintf(stderr, "[btrc-gpu] uniform buffer creation failed\n");
+            exit(1);
+        }
+    }
     wgpuQueueWriteBuffer(gpu->queue, u->buffer, 0,
                           u->data, (size_t)u->aligned_size);
 }
@@ -750,35 +1670,15 @@ void btrc_gpu_draw_uniform(void* gpu_, void* pipeline_, int vertex_count,
     GPURenderPipeline_* pipeline = (GPURenderPipeline_*)pipeline_;
     GPUUniform_* u = (GPUUniform_*)uniform_;
 
-    /* Upload CPU shadow → GPU buffer */
-    wgpuQueueWriteBuffer(gpu->queue, u->buffer, 0,
-                          u->data, (size_t)u->aligned_size);
-
-    /* Get bind group layout from auto-layout render pipeline */
-    WGPUBindGroupLayout layout =
-        wgpuRenderPipelineGetBindGroupLayout(pipeline->pipeline, 0);
-
-    WGPUBindGroupEntry entry = {
-        .binding = 0,
-        .buffer  = u->buffer,
-        .offset  = 0,
-        .size    = (uint64_t)u->aligned_size,
-    };
-    WGPUBindGroupDescriptor bg_desc = {
-        .layout     = layout,
-        .entryCount = 1,
-        .entries    = &entry,
-    };
-    WGPUBindGroup bg = wgpuDeviceCreateBindGroup(gpu->device, &bg_desc);
-
-    /* Draw */
     wgpuRenderPassEncoderSetPipeline(gpu->pass, pipeline->pipeline);
-    wgpuRenderPassEncoderSetBindGroup(gpu->pass, 0, bg, 0, NULL);
+    if (pipeline->shared_layout) {
+        bind_render_groups(gpu, arena_alloc(gpu, u->data, (size_t)u->aligned_size),
+                           NULL);
+    } else {
+        btrc_gpu_upload_uniform(gpu, u);
+        bind_own_group(gpu, pipeline, 0, u->buffer, (uint64_t)u->aligned_size);
+    }
     wgpuRenderPassEncoderDraw(gpu->pass, (uint32_t)vertex_count, 1, 0, 0);
-
-    /* Cleanup temporaries */
-    wgpuBindGroupRelease(bg);
-    wgpuBindGroupLayoutRelease(layout);
 }
 
 void btrc_gpu_uniform_destroy(void* uniform_) {
@@ -788,3 +1688,122 @@ void btrc_gpu_uniform_destroy(void* uniform_) {
     free(u->data);
     free(u);
 }
+
+/* ================================================================
+ * Instance buffers (per-instance data for instanced draws)
+ *
+ * A CPU shadow of `stride` floats per instance, uploaded once per draw
+ * into a storage buffer bound at @group(1) @binding(0). Shaders index it
+ * with @builtin(instance_index) (or loop over it), so N objects cost one
+ * upload and one draw instead of N uniform updates and N draws.
+ * ================================================================ */
+
+typedef struct {
+    WGPUBuffer    buffer;
+    float*        data;          /* CPU shadow copy */
+    int           stride;        /* floats per instance */
+    int           count;         /* instances written this frame */
+    int           capacity;      /* instances the shadow can hold */
+    int           gpu_capacity;  /* instances `buffer` can hold */
+    WGPUBindGroup bind_group;    /* over `buffer`, rebuilt when it grows */
+} GPUInstances_;
+
+void* btrc_gpu_create_instances(void* gpu_, int floats_per_instance) {
+    (void)gpu_;
+    GPUInstances_* inst = (GPUInstances_*)calloc(1, sizeof(GPUInstances_));
+    inst->stride = floats_per_instance > 0 ? floats_per_instance : 1;
+    return inst;
+}
+
+void btrc_gpu_set_instance(void* inst_, int index, int field, float value) {
+    GPUInstances_* inst = (GPUInstances_*)inst_;
+    if (index < 0 || field < 0 || field >= inst->stride) return;
+    if (index >= inst->capacity) {
+        int cap = inst->capacity ? inst->capacity * 2 : 64;
+        while (cap <= index) cap *= 2;
+        float* grown = (float*)realloc(
+            inst->data, (size_t)cap * (size_t)inst->stride * sizeof(float));
+        if (!grown) {
+            fprintf(stderr, "[btrc-gpu] instance buffer allocation failed\n");
+            exit(1);
+        }
+        memset(grown + (size_t)inst->capacity * (size_t)inst->stride, 0,
+               (size_t)(cap - inst->capacity) * (size_t)inst->stride
+                   * sizeof(float));
+        inst->data = grown;
+        inst->capacity = cap;
+    }
+    inst->data[(size_t)index * (size_t)inst->stride + (size_t)field] = value;
+    if (index >= inst->count) inst->count = index + 1;
+}
+
+int btrc_gpu_instance_count(void* inst_) {
+    return ((GPUInstances_*)inst_)->count;
+}
+
+void btrc_gpu_clear_instances(void* inst_) {
+    ((GPUInstances_*)inst_)->count = 0;
+}
+
+/* Upload the written instances, growing the storage buffer as needed
+ * (which also invalidates the bind group that refers to it) */
+static void instances_upload(GPU_* gpu, GPUInstances_* inst) {
+    if (!inst->buffer || inst->gpu_capacity < inst->capacity) {
+        if (inst->bind_group) wgpuBindGroupRelease(inst->bind_group);
+        if (inst->buffer) wgpuBufferRelease(inst->buffer);
+        inst->bind_group = NULL;
+        inst->gpu_capacity = inst->capacity > 0 ? inst->capacity : 1;
+        WGPUBufferDescriptor desc = {
+            .size  = (uint64_t)inst->gpu_capacity * (uint64_t)inst->stride
+                         * sizeof(float),
+            .usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+            .mappedAtCreation = false,
+        };
+        inst->buffer = wgpuDeviceCreateBuffer(gpu->device, &desc);
+        if (!inst->buffer) {
+            fprintf(stderr, "[btrc-gpu] instance buffer creation failed\n");
+            exit(1);
+        }
+    }
+    if (inst->count > 0) {
+        wgpuQueueWriteBuffer(gpu->queue, inst->buffer, 0, inst->data,
+                             (size_t)inst->count * (size_t)inst->stride
+                                 * sizeof(float));
+    }
+}
+
+void btrc_gpu_draw_instanced(void* gpu_, void* pipeline_, int vertex_count,
+                              int instance_count, void* uniform_,
+                              void* instances_) {
+    GPU_* gpu = (GPU_*)gpu_;
+    GPURenderPipeline_* pipeline = (GPURenderPipeline_*)pipeline_;
+    GPUUniform_* u = (GPUUniform_*)uniform_;
+    GPUInstances_* inst = (GPUInstances_*)instances_;
+    if (instance_count <= 0) return;
+
+    instances_upload(gpu, inst);
+    wgpuRenderPassEncoderSetPipeline(gpu->pass, pipeline->pipeline);
+    if (pipeline->shared_layout) {
+        uint32_t offset = arena_alloc(gpu, u->data, (size_t)u->aligned_size);
+        if (!inst->bind_group) {
+            inst->bind_group = instance_group_create(gpu, inst->buffer);
+        }
+        bind_render_groups(gpu, offset, inst->bind_group);
+    } else {
+        btrc_gpu_upload_uniform(gpu, u);
+        bind_own_group(gpu, pipeline, 0, u->buffer, (uint64_t)u->aligned_size);
+        bind_own_group(gpu, pipeline, 1, inst->buffer,
+                       wgpuBufferGetSize(inst->buffer));
+    }
+    wgpuRenderPassEncoderDraw(gpu->pass, (uint32_t)vertex_count,
+                              (uint32_t)instance_count, 0, 0);
+}
+
+void btrc_gpu_instances_destroy(void* inst_) {
+    GPUInstances_* inst = (GPUInstances_*)inst_;
+    if (!inst) return;
+    if (inst->bind_group) wgpuBindGroupRelease(inst->bind_group);
+    if (inst->buffer) wgpuBufferRelease(inst->buffer);
+    free(inst->data);
+    free(inst);
+}
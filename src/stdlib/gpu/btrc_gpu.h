@@ -42,6 +42,7 @@ void btrc_gpu_end_frame(void* gpu);
 
 /* ---- Headless compute ---- */
 void* btrc_gpu_init_compute(void);
+void* btrc_gpu_default_compute(void);  /* lazily-created shared context */
 
 /* ---- Buffers ---- */
 void* btrc_gpu_create_buffer(void* gpu, int size, int usage);
@@ -49,17 +50,62 @@ void  btrc_gpu_write_buffer(void* gpu, void* buf, void* data, int size);
 void  btrc_gpu_read_buffer(void* gpu, void* buf, void* dst, int size);
 void  btrc_gpu_buffer_destroy(void* buf);
 
+/* Non-blocking readback: returns a handle once the copy is queued.
+ * dst must stay valid until btrc_gpu_readback_wait, which blocks until
+ * the data has landed in dst and frees the handle. */
+void* btrc_gpu_read_buffer_async(void* gpu, void* buf, void* dst, int size);
+bool  btrc_gpu_readback_ready(void* readback);
+void  btrc_gpu_readback_wait(void* readback);
+
 /* ---- Compute pipeline ---- */
 void* btrc_gpu_create_compute_pipeline(void* gpu, void* shader, char* entry);
 void  btrc_gpu_compute_pipeline_destroy(void* pipeline);
 
+/* Cached compute pipeline, keyed by the WGSL source pointer + entry.
+ * Compiled on first use; owned by the context (freed in btrc_gpu_destroy). */
+void* btrc_gpu_get_compute_pipeline(void* gpu, char* wgsl_source, char* entry);
+
 /* ---- Bind group ---- */
+/* Memoized on (pipeline, buffers): binding the same buffers again returns
+ * the cached group. Every call must be paired with a destroy. */
 void* btrc_gpu_create_bind_group(void* gpu, void* pipeline,
                                   void** buffers, int count);
 void  btrc_gpu_bind_group_destroy(void* bg);
 
 /* ---- Dispatch ---- */
 void  btrc_gpu_dispatch(void* gpu, void* pipeline, void* bg, int workgroups_x);
+void  btrc_gpu_dispatch3(void* gpu, void* pipeline, void* bg,
+                         int workgroups_x, int workgroups_y, int workgroups_z);
+
+/* ---- Command batches ----
+ * Dispatches, copies and writes between begin and submit share one
+ * command encoder and one queue submit. Batches nest (the outermost
+ * submit flushes); readbacks flush the open batch first. */
+void  btrc_gpu_batch_begin(void* gpu);
+void  btrc_gpu_batch_submit(void* gpu);
+void  btrc_gpu_copy_buffer(void* gpu, void* src, void* dst, int size);
+
+/* ---- Profiling ----
+ * Contexts created after btrc_gpu_profile_enable time every compute pass
+ * and render pass on the device with timestamp queries (when the adapter
+ * supports them), and count the bytes uploaded and read back. Work is
+ * charged to the context's current label: @gpu dispatch sites built with
+ * --profile set it to the kernel name. The totals are printed to stderr
+ * at exit; btrc_gpu_stats copies them (resolving gpu's pending queries
+ * first, unless a frame is open) and returns how many labels there are. */
+typedef struct {
+    const char* label;          /* kernel name, "render" or "(other)" */
+    int         passes;         /* compute or render passes */
+    int         untimed;        /* passes without device timestamps */
+    double      gpu_ms;         /* device time of the timed passes */
+    long long   bytes_uploaded;
+    long long   bytes_read;
+    double      wait_ms;        /* host time blocked in readbacks */
+} BtrcGpuStats;
+
+void  btrc_gpu_profile_enable(void);
+void  btrc_gpu_label(void* gpu, const char* label);
+int   btrc_gpu_stats(void* gpu, BtrcGpuStats* out, int max);
 
 /* ---- Keyboard ---- */
 bool  btrc_gpu_window_key_pressed(void* win, int key);
@@ -67,17 +113,34 @@ bool  btrc_gpu_window_key_pressed(void* win, int key);
 /* ---- Time ---- */
 float btrc_gpu_get_time(void);
 
-/* ---- Uniform buffer helpers (for rendering with bound data) ---- */
+/* ---- Uniform buffer helpers (for rendering with bound data) ----
+ * Draws copy the uniform's values into a per-frame arena (256-byte
+ * aligned dynamic offsets at @group(0) @binding(0), at most 16 KiB each)
+ * that btrc_gpu_end_frame uploads in one write. */
 void* btrc_gpu_create_uniform(void* gpu, int float_count);
 void  btrc_gpu_set_uniform(void* uniform, int index, float value);
 void  btrc_gpu_upload_uniform(void* gpu, void* uniform);
 void  btrc_gpu_draw_uniform(void* gpu, void* pipeline, int vertex_count, void* uniform);
 void  btrc_gpu_uniform_destroy(void* uniform);
 
+/* ---- Instanced drawing ----
+ * Per-instance floats live in a storage buffer at @group(1) @binding(0);
+ * the uniform stays at @group(0). Writing past the end grows the buffer
+ * and the instance count; clear resets the count for the next frame. */
+void* btrc_gpu_create_instances(void* gpu, int floats_per_instance);
+void  btrc_gpu_set_instance(void* instances, int index, int field, float value);
+int   btrc_gpu_instance_count(void* instances);
+void  btrc_gpu_clear_instances(void* instances);
+void  btrc_gpu_draw_instanced(void* gpu, void* pipeline, int vertex_count,
+                              int instance_count, void* uniform,
+                              void* instances);
+void  btrc_gpu_instances_destroy(void* instances);
+
 /* ---- Buffer usage flags ---- */
 #define BTRC_GPU_STORAGE  0x80
 #define BTRC_GPU_UNIFORM  0x40
 #define BTRC_GPU_COPY_DST 0x08
 #define BTRC_GPU_COPY_SRC 0x04
+#define BTRC_GPU_RESIDENT (BTRC_GPU_STORAGE | BTRC_GPU_COPY_DST | BTRC_GPU_COPY_SRC)
 
 #endif /* BTRC_GPU_H */
@@ -17,7 +17,7 @@ from src.compiler.python.ir.emitter import CEmitter
 from src.compiler.python.ir.gen.generator import generate_ir
 from src.compiler.python.ir.optimizer import optimize
 from src.compiler.python.lexer import Lexer
-from src.compiler.python.main import get_stdlib_source, resolve_includes
+from src.compiler.python.sources import get_stdlib_source, resolve_includes
 from src.compiler.python.parser.parser import Parser
 
 BTRC_TEST_DIR = os.path.dirname(os.path.abspath(__file__))
@@ -20,7 +20,7 @@ from src.compiler.python.ir.emitter import CEmitter
 from src.compiler.python.ir.gen.generator import IRGenerator
 from src.compiler.python.ir.optimizer import optimize
 from src.compiler.python.lexer import Lexer
-from src.compiler.python.main import resolve_includes
+from src.compiler.python.sources import resolve_includes
 from src.compiler.python.parser.parser import Parser
 
 BTRC_TEST_DIR = os.path.dirname(__file__)